@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "core/backend/audio_conversion.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// A typical AAC frame at the rate the player opens the device with.
+constexpr int BENCHMARK_SAMPLES_NB = 1024;
+constexpr int BENCHMARK_SAMPLE_RATE = 48000;
+
+struct AudioFrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using AudioFramePtr = std::unique_ptr<AVFrame, AudioFrameDeleter>;
+
+[[nodiscard]] AudioFramePtr make_fltp_frame(std::uint64_t channel_layout)
+{
+    AudioFramePtr av_frame(av_frame_alloc());
+
+    av_frame->format = AV_SAMPLE_FMT_FLTP;
+    av_frame->channel_layout = channel_layout;
+    av_frame->channels = av_get_channel_layout_nb_channels(channel_layout);
+    av_frame->sample_rate = BENCHMARK_SAMPLE_RATE;
+    av_frame->nb_samples = BENCHMARK_SAMPLES_NB;
+
+    if (av_frame_get_buffer(av_frame.get(), 0) < 0) {
+        return nullptr;
+    }
+
+    // A different tone per channel, so a kernel mixing up the planes would show.
+    for (int channel = 0; channel < av_frame->channels; ++channel) {
+        auto* samples = reinterpret_cast<float*>(av_frame->extended_data[channel]);
+
+        for (int i = 0; i < av_frame->nb_samples; ++i) {
+            samples[i] = 0.25f * std::sin(0.01f * static_cast<float>((channel + 1) * i));
+        }
+    }
+
+    return av_frame;
+}
+
+[[nodiscard]] ResamplerKey make_key(const AVFrame* av_frame)
+{
+    ResamplerKey key =
+        ResamplerKey::from_frame(av_frame, AV_SAMPLE_FMT_FLT, av_frame->sample_rate);
+    key.out_channel_layout = AudioConverter::get_stereo_downmix_layout(key.in_channel_layout);
+
+    return key;
+}
+
+void convert_with_kernel(benchmark::State& state, std::uint64_t channel_layout)
+{
+    const auto isa = static_cast<ConversionISA>(state.range(0));
+
+    ColorConverter::set_max_isa(isa);
+
+    if (ColorConverter::get_active_isa() != isa) {
+        state.SkipWithError("The instruction set isn't supported by this CPU");
+        return;
+    }
+
+    const AudioFramePtr av_frame = make_fltp_frame(channel_layout);
+    const ResamplerKey key = make_key(av_frame.get());
+
+    std::vector<float> samples(static_cast<std::size_t>(BENCHMARK_SAMPLES_NB) * 2);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(AudioConverter::convert(key, av_frame.get(), samples.data()));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetLabel(ColorConverter::isa_to_string(isa));
+    state.SetItemsProcessed(state.iterations() * BENCHMARK_SAMPLES_NB);
+
+    ColorConverter::set_max_isa(ConversionISA::AVX2);
+}
+
+// The same conversion through swresample, what the player did for every frame before.
+void convert_with_swr(benchmark::State& state, std::uint64_t channel_layout)
+{
+    const AudioFramePtr av_frame = make_fltp_frame(channel_layout);
+    const ResamplerKey key = make_key(av_frame.get());
+
+    ResamplerCache resamplers;
+    const ResamplerPtr resampler = resamplers.acquire(key);
+
+    if (!resampler) {
+        state.SkipWithError("Failed to initialize the resampler");
+        return;
+    }
+
+    std::vector<float> samples(static_cast<std::size_t>(BENCHMARK_SAMPLES_NB) * 2);
+    std::array<float*, 1> out_data = { samples.data() };
+
+    const auto in_data = const_cast<const std::uint8_t**>(av_frame->extended_data);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(swr_convert(resampler.get(),
+            reinterpret_cast<std::uint8_t**>(out_data.data()), BENCHMARK_SAMPLES_NB, in_data,
+            BENCHMARK_SAMPLES_NB));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCHMARK_SAMPLES_NB);
+}
+
+void apply_isa_args(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgName("isa");
+
+    for (const auto isa : { ConversionISA::SCALAR, ConversionISA::SSE41, ConversionISA::AVX2 }) {
+        benchmark->Arg(static_cast<int>(isa));
+    }
+}
+
+void BM_InterleaveStereoKernel(benchmark::State& state)
+{
+    convert_with_kernel(state, AV_CH_LAYOUT_STEREO);
+}
+
+void BM_InterleaveStereoSwr(benchmark::State& state)
+{
+    convert_with_swr(state, AV_CH_LAYOUT_STEREO);
+}
+
+void BM_Downmix51Kernel(benchmark::State& state)
+{
+    convert_with_kernel(state, AV_CH_LAYOUT_5POINT1);
+}
+
+void BM_Downmix51Swr(benchmark::State& state)
+{
+    convert_with_swr(state, AV_CH_LAYOUT_5POINT1);
+}
+} // namespace
+
+BENCHMARK(BM_InterleaveStereoKernel)->Apply(apply_isa_args);
+BENCHMARK(BM_InterleaveStereoSwr);
+BENCHMARK(BM_Downmix51Kernel)->Apply(apply_isa_args);
+BENCHMARK(BM_Downmix51Swr);
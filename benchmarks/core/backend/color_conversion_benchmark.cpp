@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "core/backend/color_conversion.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr int BENCHMARK_WIDTH = 1920;
+constexpr int BENCHMARK_HEIGHT = 1080;
+
+struct FrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+[[nodiscard]] FramePtr make_frame(AVPixelFormat pix_fmt)
+{
+    FramePtr av_frame(av_frame_alloc());
+
+    av_frame->format = pix_fmt;
+    av_frame->width = BENCHMARK_WIDTH;
+    av_frame->height = BENCHMARK_HEIGHT;
+    av_frame->colorspace = AVCOL_SPC_BT709;
+    av_frame->color_range = AVCOL_RANGE_MPEG;
+
+    if (av_frame_get_buffer(av_frame.get(), 0) < 0) {
+        return nullptr;
+    }
+
+    // A gradient, the content doesn't change the work of any of the paths.
+    for (int plane = 0; plane < 3 && av_frame->data[plane]; ++plane) {
+        const int rows_nb = plane == 0 ? BENCHMARK_HEIGHT : BENCHMARK_HEIGHT / 2;
+
+        for (int row = 0; row < rows_nb; ++row) {
+            std::uint8_t* samples = av_frame->data[plane] + row * av_frame->linesize[plane];
+
+            for (int i = 0; i < av_frame->linesize[plane]; ++i) {
+                samples[i] = static_cast<std::uint8_t>(row + i);
+            }
+        }
+    }
+
+    return av_frame;
+}
+
+void convert_with_kernel(benchmark::State& state, AVPixelFormat pix_fmt)
+{
+    const auto isa = static_cast<ConversionISA>(state.range(0));
+
+    ColorConverter::set_max_isa(isa);
+
+    if (ColorConverter::get_active_isa() != isa) {
+        state.SkipWithError("The instruction set isn't supported by this CPU");
+        return;
+    }
+
+    const FramePtr av_frame = make_frame(pix_fmt);
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(BENCHMARK_WIDTH) * 4 *
+        BENCHMARK_HEIGHT);
+
+    for (auto _ : state) {
+        ColorConverter::convert(av_frame.get(), pixels.data(), BENCHMARK_WIDTH * 4);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetLabel(ColorConverter::isa_to_string(isa));
+    state.SetItemsProcessed(state.iterations() * BENCHMARK_WIDTH * BENCHMARK_HEIGHT);
+
+    ColorConverter::set_max_isa(ConversionISA::AVX2);
+}
+
+// The same conversion through sws_scale, with the flags update_framebuffer used before.
+void convert_with_swscale(benchmark::State& state, AVPixelFormat pix_fmt)
+{
+    const FramePtr av_frame = make_frame(pix_fmt);
+
+    SwsContext* sws_ctx = sws_getContext(BENCHMARK_WIDTH, BENCHMARK_HEIGHT, pix_fmt,
+        BENCHMARK_WIDTH, BENCHMARK_HEIGHT, AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr,
+        nullptr);
+
+    if (!sws_ctx) {
+        state.SkipWithError("Failed to create the swscale context");
+        return;
+    }
+
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(BENCHMARK_WIDTH) * 4 *
+        BENCHMARK_HEIGHT);
+
+    std::array<std::uint8_t*, 4> dest = { pixels.data(), nullptr, nullptr, nullptr };
+    std::array<int, 4> dest_linesize = { BENCHMARK_WIDTH * 4, 0, 0, 0 };
+
+    for (auto _ : state) {
+        sws_scale(sws_ctx, av_frame->data, av_frame->linesize, 0, BENCHMARK_HEIGHT,
+            dest.data(), dest_linesize.data());
+        benchmark::ClobberMemory();
+    }
+
+    sws_freeContext(sws_ctx);
+
+    state.SetItemsProcessed(state.iterations() * BENCHMARK_WIDTH * BENCHMARK_HEIGHT);
+}
+
+void apply_isa_args(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgName("isa");
+
+    for (const auto isa : { ConversionISA::SCALAR, ConversionISA::SSE41, ConversionISA::AVX2 }) {
+        benchmark->Arg(static_cast<int>(isa));
+    }
+}
+
+void BM_YUV420PKernel(benchmark::State& state)
+{
+    convert_with_kernel(state, AV_PIX_FMT_YUV420P);
+}
+
+void BM_YUV420PSwscale(benchmark::State& state)
+{
+    convert_with_swscale(state, AV_PIX_FMT_YUV420P);
+}
+
+void BM_NV12Kernel(benchmark::State& state)
+{
+    convert_with_kernel(state, AV_PIX_FMT_NV12);
+}
+
+void BM_NV12Swscale(benchmark::State& state)
+{
+    convert_with_swscale(state, AV_PIX_FMT_NV12);
+}
+} // namespace
+
+BENCHMARK(BM_YUV420PKernel)->Apply(apply_isa_args)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_YUV420PSwscale)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_NV12Kernel)->Apply(apply_isa_args)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_NV12Swscale)->Unit(benchmark::kMicrosecond);
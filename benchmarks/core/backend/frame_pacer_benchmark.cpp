@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "core/backend/frame_pacer.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// The presentation error the pacer is meant to stay under for 99% of the frames.
+constexpr double TARGET_P99_ERROR_MS = 1.0;
+
+/**
+ * @brief Keeps the thread busy for a while, like the upload and render of a frame.
+ */
+void simulate_work(double duration)
+{
+    const double end_time = FramePacer::now() + duration;
+    std::uint64_t counter = 0;
+
+    while (FramePacer::now() < end_time) {
+        benchmark::DoNotOptimize(++counter);
+    }
+}
+
+// Paces a headless presentation loop at a fixed frame rate, the way present_frames() does
+// with the frame timer, after a share of the frame spent on work. Fails the run when the
+// p99 error misses the target.
+void BM_FramePacerPresentation(benchmark::State& state)
+{
+    const double frame_duration = 1.0 / static_cast<double>(state.range(0));
+    const double work_duration = frame_duration * static_cast<double>(state.range(1)) / 100.0;
+
+    FramePacer frame_pacer;
+    double deadline = FramePacer::now() + frame_duration;
+
+    for (auto _ : state) {
+        simulate_work(work_duration);
+        benchmark::DoNotOptimize(frame_pacer.wait_until(deadline));
+        deadline += frame_duration;
+    }
+
+    const PacingStats stats = frame_pacer.get_stats();
+    const bool is_on_target = !stats.is_p99_overflow && stats.p99_error_ms < TARGET_P99_ERROR_MS;
+
+    state.counters["p50_ms"] = stats.p50_error_ms;
+    state.counters["p99_ms"] = stats.p99_error_ms;
+    state.counters["max_ms"] = stats.max_error_ms;
+    state.counters["overflow"] = stats.overflow_nb;
+    state.counters["p99_overflow"] = stats.is_p99_overflow ? 1.0 : 0.0;
+    state.counters["spin_ms"] = stats.spin_threshold_ms;
+    state.counters["p99_on_target"] = is_on_target ? 1.0 : 0.0;
+
+    if (!is_on_target) {
+        state.SkipWithError("The p99 presentation error is over the target");
+    }
+}
+
+// A deadline that already passed, only the cost of reading the clock.
+void BM_FramePacerLateFrame(benchmark::State& state)
+{
+    FramePacer frame_pacer;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(frame_pacer.wait_until(0.0));
+    }
+}
+
+void BM_FramePacerStats(benchmark::State& state)
+{
+    FramePacer frame_pacer;
+    double deadline = FramePacer::now();
+
+    // Fill the window, get_stats() runs every UI frame on a full one.
+    for (int i = 0; i < PACING_WINDOW_SIZE; i++) {
+        deadline += 10e-6;
+        frame_pacer.wait_until(deadline);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(frame_pacer.get_stats());
+    }
+}
+} // namespace
+
+// Two seconds of frames at each rate, with half and most of each frame spent on work. The
+// waits are real time by nature.
+BENCHMARK(BM_FramePacerPresentation)
+    ->ArgNames({ "fps", "work_pct" })
+    ->Args({ 60, 50 })
+    ->Args({ 60, 90 })
+    ->Iterations(120)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_FramePacerPresentation)
+    ->ArgNames({ "fps", "work_pct" })
+    ->Args({ 144, 50 })
+    ->Args({ 144, 90 })
+    ->Iterations(288)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_FramePacerLateFrame);
+BENCHMARK(BM_FramePacerStats);
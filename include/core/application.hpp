@@ -29,6 +29,8 @@ class VideoPlayer;
 class ThumbnailLoader;
 class WaveformLoader;
 class Exporter;
+class TextureUploader;
+class YUVRenderer;
 
 struct SubtitleGizmo;
 
@@ -96,8 +98,8 @@ public:
 
 public:
     void update_texture();
+    void update_planar_texture();
     void refresh_timeline_waveform();
-    void seek_to_requested_timestamp();
     void refresh_thumbnails();
 
     SDL_Window* window;
@@ -116,6 +118,11 @@ private:
     std::unique_ptr<ThumbnailLoader> m_thumbnail_loader;
     std::unique_ptr<WaveformLoader> m_waveform_loader;
     std::unique_ptr<SubtitleGizmo> m_current_subtitle_gizmo;
+    std::unique_ptr<YUVRenderer> m_yuv_renderer;
+    std::unique_ptr<TextureUploader> m_texture_uploader;
+
+    // The frame taken over from VideoPlayer::s_PreviewFrame while its planes are uploaded.
+    AVFrame* m_planar_frame;
 
 private:
     bool has_loaded_a_video = true;
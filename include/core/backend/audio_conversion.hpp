@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/backend/color_conversion.hpp"
+#include "core/backend/resampler_cache.hpp"
+
+namespace YAVE
+{
+// The downmix matrix swresample uses for float output by default (center and surround at
+// -3 dB, no LFE, no normalization), so switching between the two paths doesn't change the
+// level.
+constexpr float DOWNMIX_CENTER_LEVEL = 0.70710678f;
+constexpr float DOWNMIX_SURROUND_LEVEL = 0.70710678f;
+
+constexpr float S16_TO_FLOAT_SCALE = 1.0f / 32768.0f;
+constexpr float S32_TO_FLOAT_SCALE = 1.0f / 2147483648.0f;
+
+/**
+ * @brief One decoded audio frame to convert to interleaved floats.
+ */
+struct AudioConversionJob {
+    const std::uint8_t* const* src = nullptr; ///< AVFrame::extended_data
+    float* dest = nullptr;
+    int samples_nb = 0;  ///< Per channel.
+    int channels_nb = 0; ///< Of the source.
+};
+
+using AudioKernel = void (*)(const AudioConversionJob& job);
+
+namespace AudioKernels
+{
+void copy_flt(const AudioConversionJob& job);
+
+void interleave_fltp_scalar(const AudioConversionJob& job);
+void convert_s16_scalar(const AudioConversionJob& job);
+void convert_s32_scalar(const AudioConversionJob& job);
+void interleave_s16p_scalar(const AudioConversionJob& job);
+void interleave_s32p_scalar(const AudioConversionJob& job);
+void downmix_51_scalar(const AudioConversionJob& job);
+
+#ifdef YAVE_ARCH_X86
+void interleave_fltp_sse41(const AudioConversionJob& job);
+void convert_s16_sse41(const AudioConversionJob& job);
+void convert_s32_sse41(const AudioConversionJob& job);
+void downmix_51_sse41(const AudioConversionJob& job);
+
+void interleave_fltp_avx2(const AudioConversionJob& job);
+void convert_s16_avx2(const AudioConversionJob& job);
+void convert_s32_avx2(const AudioConversionJob& job);
+void downmix_51_avx2(const AudioConversionJob& job);
+#endif
+
+#pragma region Scalar Helpers
+/**
+ * @brief Downmixes the samples [begin, end) of a 5.1 frame, also the tails of the SIMD loops.
+ */
+inline void downmix_51_tail(const AudioConversionJob& job, int begin, int end)
+{
+    const auto* fl = reinterpret_cast<const float*>(job.src[0]);
+    const auto* fr = reinterpret_cast<const float*>(job.src[1]);
+    const auto* fc = reinterpret_cast<const float*>(job.src[2]);
+    const auto* sl = reinterpret_cast<const float*>(job.src[4]);
+    const auto* sr = reinterpret_cast<const float*>(job.src[5]);
+
+    for (int i = begin; i < end; ++i) {
+        const float center = fc[i] * DOWNMIX_CENTER_LEVEL;
+
+        job.dest[2 * i] = fl[i] + center + sl[i] * DOWNMIX_SURROUND_LEVEL;
+        job.dest[2 * i + 1] = fr[i] + center + sr[i] * DOWNMIX_SURROUND_LEVEL;
+    }
+}
+#pragma endregion Scalar Helpers
+} // namespace AudioKernels
+
+/**
+ * @brief Fast paths for the audio conversions that don't need a real resampler.
+ *
+ * Most sources only have to be interleaved (FLTP from AAC, Opus or Vorbis) or scaled to
+ * float (S16 and S32 from PCM), and 5.1 only has to be mixed down to stereo. swr_convert
+ * runs its whole pipeline for these, the kernels do them in one pass. Anything that changes
+ * the rate, or a format or layout without a kernel, is left to swresample.
+ *
+ * The instruction set follows ColorConverter, so the Debugger's ISA limit applies here too.
+ */
+class AudioConverter
+{
+public:
+    /**
+     * @brief Get the kernel for a conversion.
+     * @return nullptr if the conversion needs swresample.
+     */
+    [[nodiscard]] static AudioKernel get_kernel(const ResamplerKey& key);
+
+    /**
+     * @brief Converts a frame with the kernel that get_kernel() picks for the key.
+     * @return The number of samples per channel written, a negative integer if the caller
+     *         has to fall back to swresample.
+     */
+    static int convert(const ResamplerKey& key, const AVFrame* av_frame, float* dest);
+
+    /**
+     * @brief The layout a source is mixed down to when only stereo is needed.
+     * @return Stereo for 5.1, the layout itself for anything else.
+     */
+    [[nodiscard]] static std::uint64_t get_stereo_downmix_layout(std::uint64_t channel_layout);
+};
+} // namespace YAVE
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace YAVE
+{
+/**
+ * @enum AudioLatency
+ * @brief The device buffer sizes the player steps through. The last step can't be selected,
+ *        it is only reached by growing after underruns at the largest selectable one.
+ */
+enum class AudioLatency : int { MS_5 = 0, MS_10, MS_20, MS_40, MS_80, COUNT };
+
+constexpr AudioLatency DEFAULT_AUDIO_LATENCY = AudioLatency::MS_20;
+constexpr AudioLatency MAX_SELECTABLE_AUDIO_LATENCY = AudioLatency::MS_40;
+
+// The underrun history shown in the Debugger, one bin per second.
+constexpr int UNDERRUN_HISTORY_SECONDS = 60;
+
+/**
+ * @brief The state of the audio device buffer shown in the Debugger.
+ */
+struct AudioLatencyStats {
+    AudioLatency requested = DEFAULT_AUDIO_LATENCY;
+    AudioLatency effective = DEFAULT_AUDIO_LATENCY;
+    int device_samples = 0;        ///< The buffer size the device was actually opened with.
+    double device_latency_ms = 0.0;
+    std::uint64_t underruns_nb = 0;      ///< The callback found the PCM ring empty.
+    std::uint64_t late_callbacks_nb = 0; ///< The device asked for a buffer too late.
+    int grows_nb = 0;
+    int shrinks_nb = 0;
+};
+
+/**
+ * @brief Sizes the audio device buffer from a latency setting instead of the codec frame
+ *        size, and grows it while the machine can't keep up.
+ *
+ * The callback reports every buffer it fills. A buffer counts as an underrun when the PCM
+ * ring runs dry, or when the callback comes more than LATE_CALLBACK_RATIO periods after the
+ * previous one (the device most likely played silence in between). The audio decode thread
+ * then grows the buffer by one step, and shrinks it one step back towards the requested
+ * latency after a stable period without underruns. The device has to be reopened for
+ * either, so the steps are spaced by a cooldown.
+ *
+ * Nothing here takes a lock, the callback must never wait.
+ */
+class AudioLatencyController
+{
+public:
+    AudioLatencyController() = default;
+
+    AudioLatencyController(const AudioLatencyController&) = delete;
+    AudioLatencyController& operator=(const AudioLatencyController&) = delete;
+
+    /**
+     * @brief Records a buffer handed to the device, called from the audio callback.
+     * @param is_underrun The PCM ring couldn't fill the whole buffer in mid-playback.
+     */
+    void record_callback(double current_time, bool is_underrun) noexcept;
+
+    /**
+     * @brief Steps the latency after underruns or a stable period, called from the audio
+     *        decode thread.
+     * @return true if the device has to be reopened with get_buffer_samples().
+     */
+    [[nodiscard]] bool update(double current_time) noexcept;
+
+    /**
+     * @brief Called once the device is open, with the buffer it actually got.
+     */
+    void set_device_buffer(int samples, int sample_rate) noexcept;
+
+    /**
+     * @brief Ignores the underruns of the next moment, e.g. after a seek, a pause or a
+     *        reopened device, since the ring or the callback timing starts over.
+     */
+    void hold(double current_time) noexcept;
+
+    /**
+     * @brief The latency the user asked for, the device never goes below it.
+     */
+    void set_requested(AudioLatency latency) noexcept;
+
+    [[nodiscard]] inline AudioLatency get_requested() const noexcept
+    {
+        return m_requested.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline AudioLatency get_effective() const noexcept
+    {
+        return m_effective.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The device buffer for the effective latency, rounded up to a power of two.
+     */
+    [[nodiscard]] int get_buffer_samples(int sample_rate) const noexcept;
+
+    [[nodiscard]] AudioLatencyStats get_stats() const noexcept;
+
+    /**
+     * @brief The underruns and late callbacks of each of the last seconds, oldest first.
+     */
+    [[nodiscard]] std::array<float, UNDERRUN_HISTORY_SECONDS> get_history(
+        double current_time) const noexcept;
+
+    [[nodiscard]] static int latency_to_ms(AudioLatency latency) noexcept;
+    [[nodiscard]] static const char* latency_to_string(AudioLatency latency);
+
+private:
+    void set_effective(AudioLatency latency, double current_time) noexcept;
+
+    std::atomic<AudioLatency> m_requested = DEFAULT_AUDIO_LATENCY;
+    std::atomic<AudioLatency> m_effective = DEFAULT_AUDIO_LATENCY;
+    std::atomic<bool> m_is_requested_changed = false;
+
+    std::atomic<int> m_device_samples = 0;
+    std::atomic<double> m_device_period = 0.0;
+    std::atomic<double> m_hold_until = 0.0;
+
+    std::atomic<std::uint64_t> m_underruns_nb = 0;
+    std::atomic<std::uint64_t> m_late_callbacks_nb = 0;
+    std::atomic<int> m_grows_nb = 0;
+    std::atomic<int> m_shrinks_nb = 0;
+
+    // Written by the callback only. Each bin is stamped with the second it counts.
+    std::array<std::atomic<std::uint32_t>, UNDERRUN_HISTORY_SECONDS> m_history{};
+    std::array<std::atomic<std::int64_t>, UNDERRUN_HISTORY_SECONDS> m_history_seconds{};
+    double m_last_callback_time = -1.0;
+
+    // Only touched by the audio decode thread.
+    std::uint64_t m_seen_underruns_nb = 0;
+    double m_last_change_time = 0.0;
+    double m_last_underrun_time = 0.0;
+};
+} // namespace YAVE
@@ -1,10 +1,19 @@
 #pragma once
 
 #include <SDL.h>
+#include <cmath>
 #include <optional>
 #include <thread>
 
+#include "core/backend/audio_latency.hpp"
+#include "core/backend/audio_stretcher.hpp"
+#include "core/backend/clock_network.hpp"
+#include "core/backend/drift_compensator.hpp"
+#include "core/backend/frame_pacer.hpp"
+#include "core/backend/resampler_cache.hpp"
 #include "core/backend/video_loader.hpp"
+#include "core/utils/pcm_ring.hpp"
+#include "core/utils/seqlock.hpp"
 
 #include <SDL_mixer.h>
 #include <SDL_mutex.h>
@@ -17,12 +26,25 @@ class PacketQueue;
 
 constexpr int DEFAULT_SAMPLES_BUFFER_SIZE = 1024;
 
+// How far the audio decode thread runs ahead of the audio callback.
+constexpr int DEFAULT_AUDIO_RING_MS = 100;
+
+// The PCM ring is allocated once, large enough for the fill target at any supported format.
+constexpr int MAX_AUDIO_RING_MS = 250;
+constexpr int MAX_AUDIO_SAMPLE_RATE = 192000;
+constexpr int MAX_AUDIO_CHANNELS = 8;
+
+// The device is always opened in stereo. 5.1 is mixed down by the kernels of AudioConverter,
+// any other layout by swresample.
+constexpr std::uint64_t AUDIO_OUTPUT_CHANNEL_LAYOUT = AV_CH_LAYOUT_STEREO;
+constexpr int AUDIO_OUTPUT_CHANNELS_NB = 2;
+
+// How long the audio decode thread sleeps when the ring is full.
+constexpr int AUDIO_RING_WAIT_MS = 5;
+
 // A/V Synchronization Constants
-constexpr int SAMPLE_CORRECTION_PERCENT_MAX = 10;
-constexpr double AV_DIFFERENCE_AVG_COEF = 0.99;
-constexpr double AV_DIFFERENCE_COUNT = 20.0;
 constexpr double SYNC_THRESHOLD = 0.045;
-constexpr double NOSYNC_THRESHOLD = 1.0;
+constexpr double SYNC_THRESHOLD_MAX = 0.1;
 
 /**
  * @typedef SampleRate
@@ -95,6 +117,27 @@ inline AudioFlags operator~(AudioFlags lhs)
 
 #pragma endregion Audio Flags
 
+/**
+ * @brief Where the audio decode thread stopped writing, so the callback can tell the
+ *        timestamp of what it plays.
+ */
+struct PCMRingPosition {
+    std::size_t write_index = 0; ///< PCMRing::get_write_index() after the last write.
+    double pts = 0.0;            ///< The timestamp of the sample at write_index.
+    double sample_duration = 0.0; ///< The media time of one sample, follows the playback rate.
+    int channel_nb = 2;
+    int sample_rate = 44100;
+};
+
+/**
+ * @brief The state of the PCM ring shown in the Debugger.
+ */
+struct PCMRingStats {
+    double buffered_ms = 0.0;
+    int target_ms = 0;
+    std::uint64_t underruns_nb = 0;
+};
+
 struct AudioResamplingState {
     std::vector<float>* audio_buffer = nullptr;
     int num_samples = 0;
@@ -102,13 +145,6 @@ struct AudioResamplingState {
     int out_samples = 0;
 };
 
-struct AudioBufferInfo {
-    int channel_nb = 2;
-    int buffer_size = 0;
-    int sample_rate = 44100;
-    int buffer_index = 0;
-};
-
 /**
  * @struct AudioDeviceInfo
  * @brief Contains information about the audio device.
@@ -119,11 +155,20 @@ struct AudioDeviceInfo {
     SDL_AudioSpec wanted_spec;
 };
 
-struct ClockNetwork {
-    double video_internal_clock = 0.0;
-    double audio_internal_clock = 0.0;
-    double pause_start_time = 0.0;
-    double pause_end_time = 0.0;
+/**
+ * @struct PlaybackLocks
+ * @brief One lock per shared resource, so that codec work on one stream never waits
+ *        on another stream. When more than one lock is needed, take them in the order
+ *        they are declared here.
+ */
+struct PlaybackLocks {
+    SDL_mutex* file_queue = nullptr;     ///< Guards VideoPlayer::s_VideoFileQueue.
+    SDL_mutex* demuxer = nullptr;        ///< Guards the format context. (read, seek, switch)
+    SDL_mutex* video_codec = nullptr;    ///< Guards the video codec context.
+    SDL_mutex* audio_codec = nullptr;    ///< Guards the audio codec context.
+    SDL_mutex* playback_state = nullptr; ///< Guards the pause flags and their conditions.
+    SDL_mutex* preview_frame = nullptr;  ///< Guards VideoPlayer::s_PreviewFrame.
+    SDL_mutex* audio_device = nullptr;   ///< Guards the audio device. (open, close, pause)
 };
 
 #pragma region Audio Player
@@ -143,36 +188,59 @@ public:
     struct AudioState {
         AVCodecContext* av_codec_ctx = nullptr;
         AVPacket* latest_audio_packet = nullptr;
+        AVFrame* latest_audio_frame = nullptr;
         AudioFlags flags = AudioFlags::NONE;
         SampleRate sample_rate;
         double pts = 0;
-        double delta_accum = 0;
-        double audio_diff_avg_count = 0;
-    };
 
-    static int add_dummy_samples(float* samples, int* samples_size, int wanted_size, int max_size,
-        const int total_sample_bytes);
+        // Only used by the audio decode thread.
+        double next_pts = 0.0;
+        std::vector<float> samples{};
+        ResamplerCache resamplers;
+        ResamplerPtr resampler = nullptr; ///< The resampler of the latest frame.
+        DriftCompensator drift_compensator;
+
+        // The time-stretch of the playback rate, bypassed at 1x.
+        AudioStretcher stretcher;
+        std::vector<float> stretched_samples{};
+        double stretched_pts = 0.0; ///< The timestamp of the next stretched sample.
+        unsigned int stretcher_serial = 0;
+
+        // Only used by the audio callback. Set while the callback gets full buffers.
+        bool is_ring_primed = false;
+
+        // Owned by the player, reopened by the audio decode thread when the latency steps.
+        AudioDeviceInfo* device_info = nullptr;
+    };
 
     /**
-     * @brief Calculates the ideal number of samples for A/V synchronization.
+     * @brief Filters the A/V clock difference and sets the resampler compensation that
+     *        removes it while the next frame is converted.
      * @param audio_state Contains relevant information about the audio.
-     * @param samples This is the audio buffer data
-     * @param num_samples The number of samples avaiable inside the frame.
-     * @param[in, out] initial_buffer_size The initial size of buffer before synchronization.
-     * @return 0 <= for sucess, and a negative integer if there is an error.
+     * @param out_samples The number of samples the frame has after resampling.
+     * @return The number of samples the compensation adds to the frame, negative if it
+     *         removes samples.
      */
-    static int synchronize_audio(
-        AudioState* audio_state, float* samples, int num_samples, int* initial_buffer_size);
+    static int synchronize_audio(AudioState* audio_state, int out_samples);
 
     /**
-     * @brief Callback that feeds the audio device with samples.
+     * @brief Callback that feeds the audio device with samples. It only copies from the
+     *        PCM ring, it never decodes, allocates or waits on a mutex.
      */
     static void SDLCALL audio_callback(void* userdata, Uint8* stream, int len);
 
+    /**
+     * @brief Decodes, resamples and sync-corrects the audio ahead of the callback into
+     *        the PCM ring.
+     * @param data The audio state
+     * @return 0 <= for success, a negative integer for error.
+     */
+    static int decode_audio_ahead(void* data);
+
     /**
      * @brief Sends the packets from the packet queue to the decoder
      *        and recieves the audio frame. This function is called by
-     *        the audio callback.
+     *        the audio decode thread.
      *
      * @param av_packet The audio packet that will be decoded.
      *
@@ -182,9 +250,55 @@ public:
     static int decode_audio_packet(AudioState* userdata, AVPacket* audio_packet);
 
     /**
-     * @brief Resamples the audio buffer and writes it to the SDL stream.
+     * @brief Converts the latest audio frame to interleaved stereo floats in userdata->samples,
+     *        stretched by the A/V sync correction.
+     * @return The size of the converted samples in bytes, a negative integer for error.
+     */
+    static int convert_audio_frame(AudioState* userdata);
+
+    /**
+     * @brief Stretches the converted samples to the playback rate and writes what atempo
+     *        returns to the PCM ring.
+     */
+    static void stretch_audio_samples(
+        AudioState* userdata, int buffer_size, double playback_rate, unsigned int serial);
+
+    /**
+     * @brief Writes samples to the PCM ring, waiting while it is full.
+     * @param samples_nb The number of interleaved samples.
+     * @param start_pts The timestamp of the first sample.
+     * @param duration The media time the samples cover.
+     * @param serial The audio packet queue serial the frame was decoded under. The samples
+     *        are dropped when the queue is cleared (e.g. by a seek) in the meantime.
      */
-    static int update_audio_stream(AudioState* userdata, Uint8* sdl_stream, int& len);
+    static void write_audio_samples(AudioState* userdata, const float* samples,
+        std::size_t samples_nb, double start_pts, double duration, unsigned int serial);
+
+    /**
+     * @brief Sets how far the decode thread runs ahead of the callback, in milliseconds.
+     */
+    static inline void set_audio_ring_target(int milliseconds) noexcept
+    {
+        s_AudioRingTargetMs = std::clamp(milliseconds, 1, MAX_AUDIO_RING_MS);
+    }
+
+    [[nodiscard]] static PCMRingStats get_audio_ring_stats();
+
+    /**
+     * @brief Sets the latency the audio device buffer is sized for. It may still grow
+     *        after underruns, the audio decode thread reopens the device either way.
+     */
+    static inline void set_audio_latency(AudioLatency latency) noexcept
+    {
+        s_AudioLatency->set_requested(latency);
+    }
+
+    [[nodiscard]] static inline AudioLatencyStats get_audio_latency_stats() noexcept
+    {
+        return s_AudioLatency->get_stats();
+    }
+
+    [[nodiscard]] static std::array<float, UNDERRUN_HISTORY_SECONDS> get_underrun_history();
 
     /**
      * @brief Recurses until it gets a valid audio frame.
@@ -197,10 +311,20 @@ public:
 
 #pragma region Helper Functions
     /**
-     * @brief Converts planar audio data to an interleaved audio data.
+     * @brief Converts the audio data to interleaved floats.
      * @param audio_data See \ref AudioResamplingState for the structure definition.
+     * @return The number of samples per channel written, a negative integer for error.
+     */
+    static int resample_audio(
+        SwrContext* resampler, AVFrame* latest_frame, struct AudioResamplingState audio_data);
+
+    /**
+     * @brief Converts the latest frame with the kernels of AudioConverter, for frames
+     *        without a drift correction. Samples the resampler still holds are flushed first.
+     * @return The number of samples per channel written, a negative integer if the frame
+     *         has to go through the resampler.
      */
-    static void resample_audio(AVFrame* latest_frame, struct AudioResamplingState audio_data);
+    static int convert_without_resampler(AudioState* userdata, const ResamplerKey& key);
 
     /**
      * @brief Toggles the flag \ref AudioFlags::IS_MUTED
@@ -214,17 +338,16 @@ public:
 
     [[nodiscard]] inline void pause_audio()
     {
+        SDL_LockMutex(s_Locks->audio_device);
+
         m_audio_state->flags ^= AudioFlags::IS_PAUSED;
         bool should_resume = m_audio_state->flags & AudioFlags::IS_PAUSED;
 
         SDL_PauseAudioDevice(m_device_info->device_id, should_resume);
+        s_ClockNetwork->set_audio_paused(should_resume);
+        s_AudioLatency->hold(FramePacer::now());
 
-        if (should_resume) {
-            s_ClockNetwork->pause_end_time = av_gettime() / static_cast<double>(AV_TIME_BASE);
-            return;
-        }
-
-        s_ClockNetwork->pause_start_time = av_gettime() / static_cast<double>(AV_TIME_BASE);
+        SDL_UnlockMutex(s_Locks->audio_device);
     }
 
     [[nodiscard]] inline auto& get_packet_queue()
@@ -232,17 +355,23 @@ public:
         return s_AudioPacketQueue;
     }
 
-    [[nodiscard]] static inline double& get_video_internal_clock()
+    [[nodiscard]] static inline double get_video_internal_clock()
     {
-        return s_ClockNetwork->video_internal_clock;
+        return s_ClockNetwork->get_video_clock();
     }
 
-    [[nodiscard]] static inline double& get_audio_internal_clock()
+    [[nodiscard]] static inline double get_audio_internal_clock()
     {
-        return s_ClockNetwork->audio_internal_clock;
+        return s_ClockNetwork->get_audio_clock();
     }
 
-    [[nodiscard]] int guess_correct_buffer_size(const StreamInfoPtr& stream_info);
+    /**
+     * @brief The format of the audio that was last handed to the device.
+     */
+    [[nodiscard]] static inline AudioBufferInfo get_audio_buffer_info()
+    {
+        return s_ClockNetwork->get_audio_snapshot().buffer_info;
+    }
 
     /**
      * @brief Checks if the denominator and numerator is a non-zero integer.
@@ -255,35 +384,51 @@ public:
     }
 #pragma endregion Helper Functions
 
-    static std::unique_ptr<AudioBufferInfo> s_AudioBufferInfo;
     static std::unique_ptr<PacketQueue> s_AudioPacketQueue;
 
+    // Decoded audio on its way from the audio decode thread to the callback.
+    static std::unique_ptr<PCMRing> s_PCMRing;
+    static SeqLock<PCMRingPosition> s_PCMRingPosition;
+    static std::atomic<int> s_AudioRingTargetMs;
+    static std::atomic<std::uint64_t> s_AudioUnderrunsNb;
+    static std::unique_ptr<AudioLatencyController> s_AudioLatency;
+    static std::unique_ptr<PlaybackLocks> s_Locks;
+
     static SDL_cond* s_FrameAvailabilityCond;
     static SDL_cond* s_VideoPausedCond;
+    static SDL_cond* s_PresenterParkedCond;
     static SDL_cond* s_VideoAvailabilityCond;
 
 protected:
     /**
-     * @brief Initializes the resampler library.
-     * @param num_channels The number of audio channels.
+     * @brief Initializes the SDL mixer library. The device buffer is sized for the
+     *        latency of \ref s_AudioLatency.
+     * @param num_channels The number of audio channels. (e.g mono, stereo, or surround)
      * @return 0 <= for success, a negative integer for error.
      */
-    static int init_swr_ctx(AVFrame* av_frame, SampleRate sample_rate);
+    int init_sdl_mixer(int num_channels);
 
     /**
-     * @brief Initializes the SDL mixer library.
-     * @param num_channels The number of audio channels. (e.g mono, stereo, or surround)
-     * @param nb_samples The number of samples inside a frame.
+     * @brief Opens the device with the wanted spec and the buffer size of the effective
+     *        latency. Has to be called with the audio device lock held.
+     * @param should_pause The device is left paused instead of started.
      * @return 0 <= for success, a negative integer for error.
      */
-    int init_sdl_mixer(int num_channels, int nb_samples);
+    static int open_audio_device(AudioState* userdata, bool should_pause);
+
+    /**
+     * @brief Reopens the device after the effective latency stepped, keeping it paused if
+     *        the playback is. Called from the audio decode thread.
+     */
+    static void reopen_audio_device(AudioState* userdata);
 
     /**
-     * @brief Frees the memory allocated by the resampler context.
+     * @brief Frees the resamplers of the audio formats played so far.
      */
     inline void free_resampler_ctx()
     {
-        swr_free(&s_Resampler_Context);
+        m_audio_state->resampler = nullptr;
+        m_audio_state->resamplers.clear();
     };
 
     void free_sdl_mixer();
@@ -299,23 +444,9 @@ protected:
 
     inline static void reset_audio_buffer_info()
     {
-        // Reset audio buffer information
-        s_AudioBufferInfo->buffer_index = 0;
-        s_AudioBufferInfo->buffer_size = 0;
-        s_AudioBufferInfo->channel_nb = 2;
-        s_AudioBufferInfo->sample_rate = 44100;
+        s_ClockNetwork->reset_audio_buffer_info();
     }
 
-private:
-    static SwrContext* s_Resampler_Context;
-
-    [[nodiscard]] static inline int calculate_bounds(int size, bool is_max)
-    {
-        auto sample_correction = (SAMPLE_CORRECTION_PERCENT_MAX / 100.0);
-        sample_correction *= -1 * !is_max;
-
-        return static_cast<int>(size * (1.0 + sample_correction));
-    };
 };
 
 #pragma endregion Audio Player
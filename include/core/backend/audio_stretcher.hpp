@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include "core/backend/video_loader.hpp"
+
+extern "C" {
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+}
+
+namespace YAVE
+{
+// Older atempo builds only take factors in this range, larger changes are chained.
+constexpr double MIN_ATEMPO_FACTOR = 0.5;
+constexpr double MAX_ATEMPO_FACTOR = 2.0;
+
+/**
+ * @brief The format a stretcher graph was built for.
+ */
+struct StretcherFormat {
+    int sample_rate = 0;
+    int channels_nb = 0;
+    double tempo = 1.0;
+
+    bool operator==(const StretcherFormat&) const = default;
+};
+
+/**
+ * @brief Changes the tempo of interleaved float audio without changing its pitch, through
+ *        libavfilter's atempo.
+ *
+ * The graph is abuffer -> atempo (one or more) -> abuffersink and is rebuilt whenever the
+ * format or the tempo changes. atempo keeps a window of audio, so the output of one call
+ * doesn't line up with its input; the output does cover exactly tempo times less time in
+ * total, so a timeline started at the first input stays in step with the media.
+ *
+ * Only used by the audio decode thread.
+ */
+class AudioStretcher
+{
+public:
+    AudioStretcher() = default;
+    ~AudioStretcher();
+
+    AudioStretcher(const AudioStretcher&) = delete;
+    AudioStretcher& operator=(const AudioStretcher&) = delete;
+
+    /**
+     * @brief Builds the graph for a format unless it is already built for it. Whatever the
+     *        previous graph still held is dropped.
+     * @return 1 if the graph was rebuilt, 0 if it was kept, a negative integer for error.
+     */
+    int configure(const StretcherFormat& format);
+
+    /**
+     * @brief Stretches interleaved floats.
+     * @param frames_nb The number of samples per channel.
+     * @param dest Receives the stretched samples, it is cleared first.
+     * @return The number of samples per channel written, a negative integer for error.
+     */
+    int process(const float* samples, int frames_nb, std::vector<float>& dest);
+
+    void reset();
+
+    [[nodiscard]] inline bool is_configured() const noexcept
+    {
+        return m_graph != nullptr;
+    }
+
+    /**
+     * @brief Splits a tempo into atempo factors that every FFmpeg version accepts.
+     */
+    [[nodiscard]] static std::vector<double> split_tempo(double tempo);
+
+private:
+    int build_graph();
+
+    AVFilterGraph* m_graph = nullptr;
+    AVFilterContext* m_source = nullptr;
+    AVFilterContext* m_sink = nullptr;
+
+    AVFrame* m_in_frame = nullptr;
+    AVFrame* m_out_frame = nullptr;
+
+    StretcherFormat m_format;
+    std::int64_t m_next_pts = 0;
+};
+} // namespace YAVE
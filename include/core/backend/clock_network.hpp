@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+
+#include "core/utils/seqlock.hpp"
+
+namespace YAVE
+{
+constexpr double MIN_PLAYBACK_RATE = 0.25;
+constexpr double MAX_PLAYBACK_RATE = 4.0;
+
+/**
+ * @brief The format of the audio that was last handed to the device.
+ */
+struct AudioBufferInfo {
+    int channel_nb = 2;
+    int buffer_size = 0; ///< In bytes.
+    int sample_rate = 44100;
+    int buffer_index = 0;
+};
+
+/**
+ * @brief Everything the audio callback knew the last time it handed data to the device.
+ */
+struct AudioClockSnapshot {
+    double pts = 0.0;           ///< The audio clock at the end of the data handed over.
+    double buffered_time = 0.0; ///< How much of that data was in the last buffer, in seconds.
+    double capture_time = 0.0;  ///< FramePacer::now() when the buffer was handed over.
+    double paused_clock = 0.0;  ///< The playback position when the device was paused.
+    double playback_rate = 1.0; ///< The media time the device plays per second.
+    bool is_paused = false;
+    AudioBufferInfo buffer_info;
+};
+
+/**
+ * @brief The audio and video clocks used for A/V synchronization.
+ *
+ * The audio callback, the video threads, the subtitle thread and the UI all use the
+ * clocks, so nothing is stored as a plain double. The audio state is published as one
+ * snapshot through a seqlock and the video clock is a single atomic, so readers always get
+ * consistent values without taking a lock, and the writers never wait for the readers.
+ *
+ * Between two callbacks the playback position is extrapolated from the time that passed
+ * since the last buffer was handed over, instead of jumping once per buffer.
+ *
+ * All clocks are in media time. At a playback rate other than 1x the device plays the
+ * time-stretched audio, so a second of wall time moves the clocks by the rate.
+ */
+class ClockNetwork
+{
+public:
+    ClockNetwork() = default;
+
+    ClockNetwork(const ClockNetwork&) = delete;
+    ClockNetwork& operator=(const ClockNetwork&) = delete;
+
+#pragma region Audio Clock
+    /**
+     * @brief Called by the audio callback after a buffer was handed to the device.
+     * @param pts The timestamp at the end of the buffer, the new audio clock.
+     * @param duration The media time the buffer covers, in seconds.
+     * @param playback_rate The rate the buffer was stretched for.
+     */
+    void update_audio_clock(double pts, double duration, const AudioBufferInfo& buffer_info,
+        double playback_rate = 1.0) noexcept;
+
+    /**
+     * @brief Freezes the extrapolation while the device is paused.
+     */
+    void set_audio_paused(bool is_paused) noexcept;
+
+    /**
+     * @brief The audio clock, i.e. the end of the audio handed to the device so far.
+     */
+    [[nodiscard]] double get_audio_clock() const noexcept;
+
+    /**
+     * @brief The position the audio device is playing right now, the master clock for the
+     *        video.
+     */
+    [[nodiscard]] double get_reference_clock() const noexcept;
+
+    [[nodiscard]] inline AudioClockSnapshot get_audio_snapshot() const noexcept
+    {
+        return m_audio.load();
+    }
+
+    void reset_audio_buffer_info() noexcept;
+#pragma endregion Audio Clock
+
+#pragma region Video Clock
+    [[nodiscard]] inline double get_video_clock() const noexcept
+    {
+        return m_video_clock.load(std::memory_order_acquire);
+    }
+
+    inline void set_video_clock(double pts) noexcept
+    {
+        m_video_clock.store(pts, std::memory_order_release);
+    }
+
+    /**
+     * @brief Only the presenter advances the video clock.
+     */
+    inline void advance_video_clock(double duration) noexcept
+    {
+        m_video_clock.fetch_add(duration, std::memory_order_acq_rel);
+    }
+#pragma endregion Video Clock
+
+    /**
+     * @brief Takes the time playback spent paused since the last call, in seconds.
+     */
+    [[nodiscard]] inline double take_paused_time() noexcept
+    {
+        return m_paused_time.exchange(0.0, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Moves both clocks, e.g. to the target of a seek.
+     */
+    void reset(double seconds) noexcept;
+
+    /**
+     * @brief The rate the player was asked to play at. The audio clock follows once the
+     *        audio stretched for it reaches the device.
+     */
+    inline void set_playback_rate(double rate) noexcept
+    {
+        m_playback_rate.store(
+            std::clamp(rate, MIN_PLAYBACK_RATE, MAX_PLAYBACK_RATE), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline double get_playback_rate() const noexcept
+    {
+        return m_playback_rate.load(std::memory_order_relaxed);
+    }
+
+private:
+    SeqLock<AudioClockSnapshot> m_audio;
+    std::atomic<double> m_video_clock = 0.0;
+    std::atomic<double> m_playback_rate = 1.0;
+
+    std::atomic<double> m_pause_start_time = 0.0;
+    std::atomic<double> m_paused_time = 0.0;
+};
+} // namespace YAVE
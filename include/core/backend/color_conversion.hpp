@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "core/backend/video_loader.hpp"
+#include "core/backend/worker_pool.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define YAVE_ARCH_X86 1
+#endif
+
+// MSVC exposes every intrinsic unconditionally, GCC and Clang need a per-function target
+// so the rest of the project can still be built for the baseline ISA.
+#if defined(YAVE_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define YAVE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define YAVE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define YAVE_TARGET_SSE41
+#define YAVE_TARGET_AVX2
+#endif
+
+namespace YAVE
+{
+// Below this many pixels per slice the hand-off to the pool costs more than it saves.
+constexpr int MIN_PIXELS_PER_SLICE = 512 * 1024;
+constexpr int MIN_ROWS_PER_SLICE = 16;
+
+/**
+ * @brief A horizontal band of a picture, the unit of work of the sliced conversions.
+ */
+struct FrameSlice {
+    int row_begin = 0;
+    int row_end = 0;
+};
+
+/**
+ * @brief Splits a picture into bands for the worker pool, larger pictures get more slices.
+ * @param row_alignment The slice boundaries are kept on multiples of this (for chroma rows).
+ */
+[[nodiscard]] std::vector<FrameSlice> split_into_slices(
+    int width, int height, int max_slices_nb, int row_alignment = 2);
+
+/**
+ * @enum ConversionISA
+ * @brief The instruction sets the YUV to RGBA kernels are written for, ordered by preference.
+ */
+enum class ConversionISA : int { SCALAR = 0, SSE41, AVX2 };
+
+/**
+ * @brief The YUV to RGB matrix of the kernels in floating point.
+ *        R = Y' + rv * V', G = Y' + gu * U' + gv * V', B = Y' + bu * U'
+ *        where Y' = (Y - y_offset) * y_gain and U', V' are centered on 0.
+ */
+struct YUVMatrix {
+    float y_offset = 16.0f;
+    float y_gain = 1.0f;
+    float rv = 0.0f;
+    float gu = 0.0f;
+    float gv = 0.0f;
+    float bu = 0.0f;
+};
+
+/**
+ * @brief The YUV to RGB matrix in the form the kernels use, in Q13 like swscale's full chroma
+ *        path: S = (Y - y_offset) * y_gain + (U - 128) * u + (V - 128) * v + ROUNDING.
+ *
+ * The SIMD kernels compute the sums in 32-bit lanes with pmaddwd and the scalar kernel does
+ * exactly the same arithmetic, so all kernels produce the pixels swscale produces.
+ */
+struct YUVCoefficients {
+    std::int16_t y_offset = 16;
+    std::int16_t y_gain = 8192;
+    std::int16_t rv = 0;
+    std::int16_t gu = 0;
+    std::int16_t gv = 0;
+    std::int16_t bu = 0;
+};
+
+/**
+ * @brief Everything a kernel needs to convert a range of rows of one picture.
+ */
+struct ConversionJob {
+    const std::uint8_t* src[3] = { nullptr, nullptr, nullptr };
+    int src_linesize[3] = { 0, 0, 0 };
+
+    std::uint8_t* dest = nullptr;
+    int dest_linesize = 0;
+
+    int width = 0;
+    int height = 0;
+
+    int chroma_shift_y = 1;     ///< 1 for 4:2:0, 0 for 4:2:2.
+    bool is_semi_planar = false; ///< NV12 stores U and V interleaved in the second plane.
+
+    YUVCoefficients coefficients{};
+};
+
+using ConversionKernel = void (*)(const ConversionJob& job, int row_begin, int row_end);
+
+namespace ColorKernels
+{
+void convert_rows_scalar(const ConversionJob& job, int row_begin, int row_end);
+
+#ifdef YAVE_ARCH_X86
+void convert_rows_sse41(const ConversionJob& job, int row_begin, int row_end);
+void convert_rows_avx2(const ConversionJob& job, int row_begin, int row_end);
+#endif
+
+#pragma region Scalar Helpers
+constexpr int COEFFICIENT_ROUNDING = 1 << 12;
+
+/**
+ * @brief Turns a Q13 sum into a channel the way swscale does in 32 bits.
+ *
+ * The sum is shifted up to 30 bits before the top byte is taken, so a sum far past white
+ * (only reachable with samples outside the nominal range) wraps around to black. It is
+ * reproduced on purpose, the kernels have to match swscale everywhere.
+ */
+[[nodiscard]] inline std::uint8_t pack_channel(std::int32_t sum)
+{
+    const auto scaled = static_cast<std::int32_t>(static_cast<std::uint32_t>(sum) << 9);
+    return static_cast<std::uint8_t>(std::clamp(scaled >> 22, 0, 255));
+}
+
+/**
+ * @brief Converts a single pixel, used by the scalar kernel and the tails of the SIMD rows.
+ */
+inline void convert_pixel(
+    const YUVCoefficients& c, int y, int u, int v, std::uint8_t* rgba)
+{
+    const int luma = (y - c.y_offset) * c.y_gain + COEFFICIENT_ROUNDING;
+    const int cb = u - 128;
+    const int cr = v - 128;
+
+    rgba[0] = pack_channel(luma + cr * c.rv);
+    rgba[1] = pack_channel(luma + cb * c.gu + cr * c.gv);
+    rgba[2] = pack_channel(luma + cb * c.bu);
+    rgba[3] = 0xFF;
+}
+
+/**
+ * @brief Converts the pixels [x_begin, width) of one row.
+ */
+inline void convert_row_tail(const ConversionJob& job, int row, int x_begin)
+{
+    const std::uint8_t* y_row = job.src[0] + row * job.src_linesize[0];
+    const int chroma_row = row >> job.chroma_shift_y;
+
+    std::uint8_t* dest_row = job.dest + row * job.dest_linesize;
+
+    // NV12 is handled as interleaved U and V samples with a step of 2.
+    const int chroma_step = job.is_semi_planar ? 2 : 1;
+    const std::uint8_t* u_row = job.src[1] + chroma_row * job.src_linesize[1];
+    const std::uint8_t* v_row =
+        job.is_semi_planar ? u_row + 1 : job.src[2] + chroma_row * job.src_linesize[2];
+
+    for (int x = x_begin; x < job.width; ++x) {
+        const int chroma_index = (x >> 1) * chroma_step;
+
+        convert_pixel(
+            job.coefficients, y_row[x], u_row[chroma_index], v_row[chroma_index], dest_row + x * 4);
+    }
+}
+#pragma endregion Scalar Helpers
+} // namespace ColorKernels
+
+/**
+ * @brief A fast path for the same-size YUV to RGBA conversion that the player and the
+ *        thumbnail loader do for every frame.
+ *
+ * Handles 8-bit YUV420P, YUVJ420P, NV12, YUV422P and YUVJ422P with BT.601 or BT.709 in
+ * limited or full range, at even sizes. The output is bit-identical to swscale with
+ * SAME_SIZE_SWS_FLAGS. Each chroma sample covers its 2 pixels (its 2x2 block in 4:2:0).
+ * Anything else is left to swscale.
+ */
+/**
+ * @brief The swscale configuration the kernels reproduce bit for bit: nearest chroma in full
+ *        precision, with set_sws_colorspace(). The player's own swscale paths keep
+ *        SWS_BILINEAR, whose unscaled tables are more than 10x faster and within 3 LSB of it
+ *        on in-range planar frames (NV12 chroma gets interpolated there).
+ */
+constexpr int SAME_SIZE_SWS_FLAGS =
+    SWS_POINT | SWS_FULL_CHR_H_INT | SWS_ACCURATE_RND | SWS_BITEXACT;
+
+class ColorConverter
+{
+public:
+    /**
+     * @brief Checks if a frame can be converted by the kernels.
+     */
+    [[nodiscard]] static bool is_supported(const AVFrame* frame);
+
+    /**
+     * @brief Fills a conversion job from a decoded frame.
+     * @return 0 <= for success, a negative integer if the frame is not supported.
+     */
+    static int prepare_job(
+        const AVFrame* frame, std::uint8_t* dest, int dest_linesize, ConversionJob* job);
+
+    /**
+     * @brief Converts a whole frame into a packed RGBA buffer of the same size.
+     * @return 0 <= for success, a negative integer if the caller has to fall back to swscale.
+     */
+    static int convert(const AVFrame* frame, std::uint8_t* dest, int dest_linesize);
+
+    /**
+     * @brief Same as convert(), but the frame is split into slices that run on the pool.
+     * @param slices_nb Receives the number of slices that were used, can be nullptr.
+     * @return 0 <= for success, a negative integer if the caller has to fall back to swscale.
+     */
+    static int convert_parallel(const AVFrame* frame, std::uint8_t* dest, int dest_linesize,
+        WorkerPool& pool, int* slices_nb = nullptr);
+
+    /**
+     * @brief Gives a swscale context the colorspace and the range of a frame, the same ones
+     *        the kernels read. Without it swscale treats every frame as limited BT.601.
+     */
+    static void set_sws_colorspace(SwsContext* sws_ctx, const AVFrame* frame);
+
+    /**
+     * @brief Computes the YUV to RGB matrix of a colorspace and a range, the kernel
+     *        coefficients in floating point.
+     */
+    [[nodiscard]] static YUVMatrix get_matrix(AVColorSpace colorspace, bool is_full_range);
+
+    /**
+     * @brief Checks if a frame uses the full 0-255 range (JPEG range).
+     */
+    [[nodiscard]] static bool is_full_range(const AVFrame* frame);
+
+    /**
+     * @brief Computes the kernel coefficients of a colorspace and a range.
+     */
+    [[nodiscard]] static YUVCoefficients get_coefficients(
+        AVColorSpace colorspace, bool is_full_range);
+
+    /**
+     * @brief Get the kernel picked for this CPU.
+     */
+    [[nodiscard]] static ConversionKernel get_kernel();
+
+    /**
+     * @brief Limits the dispatch to an instruction set, mostly useful to compare kernels.
+     */
+    static void set_max_isa(ConversionISA isa);
+
+    [[nodiscard]] static ConversionISA get_active_isa();
+    [[nodiscard]] static const char* isa_to_string(ConversionISA isa);
+
+private:
+    [[nodiscard]] static ConversionISA detect_isa();
+
+    static std::atomic<ConversionISA> s_MaxISA;
+};
+} // namespace YAVE
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+
+#include <SDL.h>
+#include <SDL_mutex.h>
+
+#include "core/backend/video_loader.hpp"
+
+namespace YAVE
+{
+// FFmpeg's frame threading stops scaling (and starts wasting memory) past 16 threads.
+constexpr int MAX_DECODER_THREADS = 16;
+
+/**
+ * @enum DecoderUseCase
+ * @brief Every place that opens a decoder, each one gets its own share of the cores.
+ */
+enum class DecoderUseCase : int { PLAYER = 0, REVERSE, STEP, THUMBNAIL, WAVEFORM, COUNT };
+
+/**
+ * @brief The threading options that are passed to the codec context before avcodec_open2.
+ */
+struct DecoderThreadingConfig {
+    int thread_count = 0; ///< 0 means "pick from the core count".
+    int thread_type = 0;  ///< 0 means the default thread type of the use case.
+};
+
+/**
+ * @brief The decode throughput that was measured while a specific setting was active.
+ */
+struct DecoderThroughput {
+    std::uint64_t frames_nb = 0;
+    std::int64_t decode_time_us = 0;
+
+    [[nodiscard]] inline double frames_per_second() const
+    {
+        return decode_time_us > 0 ? static_cast<double>(frames_nb) * 1e6 / decode_time_us : 0.0;
+    }
+};
+
+/**
+ * @brief The decoder threading policy shared by the player, the thumbnail loader and
+ *        the waveform loader.
+ *
+ * The player gets most of the cores, while the background loaders get a small budget
+ * so they don't compete with playback. Every budget can be overridden at runtime, the
+ * new setting is picked up the next time a decoder is opened.
+ */
+class DecoderThreading
+{
+public:
+    /**
+     * @brief Sets the thread count and the thread type of a codec context.
+     *        This must be called before avcodec_open2.
+     */
+    static void apply(AVCodecContext* av_codec_ctx, DecoderUseCase use_case);
+
+    /**
+     * @brief Records the setting that FFmpeg actually picked, call this after avcodec_open2.
+     */
+    static void on_codec_opened(const AVCodecContext* av_codec_ctx, DecoderUseCase use_case);
+
+    /**
+     * @brief Overrides the policy of a use case. A thread count of 0 restores the
+     *        automatic budget.
+     */
+    static void set_config(DecoderUseCase use_case, const DecoderThreadingConfig& config);
+    [[nodiscard]] static DecoderThreadingConfig get_config(DecoderUseCase use_case);
+
+    /**
+     * @brief The thread count picked from the number of cores for a use case.
+     */
+    [[nodiscard]] static int get_auto_thread_count(DecoderUseCase use_case);
+
+    /**
+     * @brief The thread type used when the config doesn't override it.
+     */
+    [[nodiscard]] static int get_default_thread_type(DecoderUseCase use_case);
+
+    /**
+     * @brief Adds a decoding interval to the throughput of the active setting.
+     * @param frames_nb The number of frames produced during the interval.
+     * @param elapsed_us The time spent inside the decoder in microseconds.
+     */
+    static void record_decode(DecoderUseCase use_case, int frames_nb, std::int64_t elapsed_us);
+
+    /**
+     * @brief Get the throughput of every setting a use case has run with, keyed by
+     *        a label like "8 threads (frame+slice)".
+     */
+    [[nodiscard]] static std::map<std::string, DecoderThroughput> get_throughput(
+        DecoderUseCase use_case);
+
+    [[nodiscard]] static std::string get_active_setting(DecoderUseCase use_case);
+
+    [[nodiscard]] static const char* use_case_to_string(DecoderUseCase use_case);
+
+private:
+    struct UseCaseState {
+        DecoderThreadingConfig config{};
+        std::string active_setting = "Not opened";
+        std::map<std::string, DecoderThroughput> throughput{};
+    };
+
+    [[nodiscard]] static std::string describe_setting(int thread_count, int thread_type);
+
+    static std::array<UseCaseState, static_cast<std::size_t>(DecoderUseCase::COUNT)> s_States;
+    static SDL_mutex* s_Mutex;
+};
+
+/**
+ * @brief Measures the time between its construction and record(), used around the
+ *        avcodec_send_packet/avcodec_receive_frame calls.
+ */
+class DecodeTimer
+{
+public:
+    explicit DecodeTimer(DecoderUseCase use_case)
+        : m_use_case(use_case)
+        , m_start_time(av_gettime_relative())
+    {
+    }
+
+    inline void record(int frames_nb) const
+    {
+        DecoderThreading::record_decode(
+            m_use_case, frames_nb, av_gettime_relative() - m_start_time);
+    }
+
+private:
+    DecoderUseCase m_use_case;
+    std::int64_t m_start_time;
+};
+} // namespace YAVE
@@ -0,0 +1,52 @@
+#pragma once
+
+namespace YAVE
+{
+// The A/V difference is averaged over about 1 / (1 - AV_DIFFERENCE_AVG_COEF) frames, the
+// first AV_DIFFERENCE_COUNT frames only fill the average.
+constexpr double AV_DIFFERENCE_AVG_COEF = 0.99;
+constexpr int AV_DIFFERENCE_COUNT = 20;
+
+// A difference this large isn't drift (e.g. right after a seek), the average starts over.
+constexpr double NOSYNC_THRESHOLD = 1.0;
+
+// The audio drift is removed by stretching the audio with the resampler. The stretch is
+// proportional to the filtered drift, so a drift below AUDIO_DRIFT_CORRECTION_TIME * 2% is
+// removed with that time constant, anything larger at the 2% cap (about a third of a
+// semitone, inaudible on most material).
+constexpr double AUDIO_DRIFT_CORRECTION_TIME = 2.0;
+constexpr double MAX_AUDIO_DRIFT_CORRECTION = 0.02;
+
+/**
+ * @brief Turns the A/V clock difference into the number of samples the resampler adds to,
+ *        or removes from, the next audio frame.
+ *
+ * The difference is filtered first, so the jitter of the clocks doesn't turn into a
+ * stretch that changes every frame. Only used by the audio decode thread.
+ */
+class DriftCompensator
+{
+public:
+    /**
+     * @brief Adds the difference of a frame to the average.
+     * @param diff The audio clock minus the video clock, in seconds.
+     * @param out_samples The number of samples the frame has after resampling.
+     * @return The number of samples to add to the frame, negative to remove some. 0 while
+     *         the average fills up and when the difference is too large to be drift.
+     */
+    int update(double diff, int out_samples);
+
+    void reset() noexcept;
+
+    /**
+     * @brief How many samples to add to a frame to remove the filtered A/V difference.
+     *        Spread evenly over the frame by the resampler, so there are no clicks.
+     * @param avg_diff The filtered audio clock minus the video clock, in seconds.
+     */
+    [[nodiscard]] static int calculate_compensation(double avg_diff, int out_samples);
+
+private:
+    double m_diff_accum = 0.0;
+    int m_diffs_nb = 0;
+};
+} // namespace YAVE
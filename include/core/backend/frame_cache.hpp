@@ -0,0 +1,126 @@
+#pragma once
+
+#include <limits>
+#include <list>
+#include <map>
+#include <string>
+
+#include <SDL.h>
+#include <SDL_mutex.h>
+
+#include "core/backend/video_loader.hpp"
+
+namespace YAVE
+{
+// The decoded frames are kept as references to the decoder's own YUV buffers, a 1080p
+// 4:2:0 frame takes about 3 MiB.
+constexpr std::size_t DEFAULT_FRAME_CACHE_BUDGET_MIB = 512;
+
+// The frame decoded right before a cached one isn't known.
+constexpr std::int64_t UNKNOWN_PREVIOUS_TIMESTAMP = std::numeric_limits<std::int64_t>::min();
+
+struct FrameCacheStats {
+    std::uint64_t hits_nb = 0;
+    std::uint64_t misses_nb = 0;
+    std::size_t frames_nb = 0;
+    std::size_t bytes_used = 0;
+    std::size_t budget_bytes = 0;
+
+    [[nodiscard]] inline double hit_rate() const noexcept
+    {
+        const std::uint64_t lookups_nb = hits_nb + misses_nb;
+        return lookups_nb > 0 ? static_cast<double>(hits_nb) / lookups_nb : 0.0;
+    }
+};
+
+/**
+ * @brief The decoded frames of every file, keyed by file and timestamp, evicted in least
+ *        recently used order once they take more than the budget.
+ *
+ * Seeking and stepping back to a frame that was on screen a moment ago only costs its
+ * conversion. Every frame remembers the timestamp of the frame decoded right before it,
+ * so a lookup knows whether a frame is really the first one at a timestamp or only the
+ * first one that happens to be cached.
+ *
+ * The timestamps are in the timebase of the video stream. Thread-safe.
+ */
+class FrameCache
+{
+public:
+    /**
+     * @brief Keeps a new reference to a frame, unless the frame is already cached.
+     * @param previous_timestamp The frame decoded right before it, if it is known.
+     */
+    static void insert(const std::string& path, const AVFrame* frame, std::int64_t timestamp,
+        std::int64_t previous_timestamp = UNKNOWN_PREVIOUS_TIMESTAMP);
+
+    /**
+     * @brief Finds the first frame at or after a timestamp, the frame a seek shows.
+     * @param dest_frame Receives a new reference to the frame, untouched on a miss.
+     * @return 0 <= for a hit, a negative integer for a miss.
+     */
+    static int find_from(const std::string& path, std::int64_t timestamp, AVFrame* dest_frame,
+        std::int64_t* dest_timestamp);
+
+    /**
+     * @brief Finds the last frame before a timestamp, the frame a step back shows.
+     * @param dest_frame Receives a new reference to the frame, untouched on a miss.
+     * @return 0 <= for a hit, a negative integer for a miss.
+     */
+    static int find_before(const std::string& path, std::int64_t timestamp, AVFrame* dest_frame,
+        std::int64_t* dest_timestamp);
+
+    /**
+     * @brief Changes the budget, the least recently used frames above it are freed.
+     */
+    static void set_budget(std::size_t budget_bytes);
+
+    [[nodiscard]] static FrameCacheStats get_stats();
+
+    /**
+     * @brief The bytes a frame keeps alive, the sizes of the buffers it references.
+     */
+    [[nodiscard]] static std::size_t calculate_frame_bytes(const AVFrame* frame);
+
+    static void clear();
+
+private:
+    using LRUList = std::list<std::pair<std::string, std::int64_t>>;
+
+    struct CachedFrame {
+        AVFrame* frame = nullptr;
+        std::int64_t previous_timestamp = UNKNOWN_PREVIOUS_TIMESTAMP;
+        std::size_t bytes = 0;
+        LRUList::iterator lru_it;
+    };
+
+    using FileFrames = std::map<std::int64_t, CachedFrame>;
+
+    /**
+     * @brief Finds the cached frame that comes first at or after a timestamp. The caller
+     *        holds the mutex.
+     * @return nullptr if no cached frame is known to be that frame.
+     */
+    [[nodiscard]] static const FileFrames::value_type* find_locked(
+        const FileFrames& frames, std::int64_t timestamp);
+
+    /**
+     * @brief Hands a cached frame out, marks it as the most recently used one and counts
+     *        the lookup. The caller holds the mutex.
+     * @param entry nullptr for a miss.
+     */
+    static int hand_out_locked(
+        const FileFrames::value_type* entry, AVFrame* dest_frame, std::int64_t* dest_timestamp);
+
+    static void evict_locked(std::size_t budget_bytes);
+
+    static std::unordered_map<std::string, FileFrames> s_Files;
+
+    // The most recently used frame at the front.
+    static LRUList s_LRU;
+
+    static FrameCacheStats s_Stats;
+    static std::size_t s_BudgetBytes;
+    static SDL_mutex* s_Mutex;
+};
+} // namespace YAVE
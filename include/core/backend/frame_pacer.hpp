@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include <SDL.h>
+#include <SDL_mutex.h>
+
+namespace YAVE
+{
+// The histogram resolution and range of the presentation error. Errors past the range are
+// counted in one more overflow bin after the last one.
+constexpr double PACING_BIN_WIDTH = 25e-6;
+constexpr int PACING_BINS_NB = 200;
+constexpr int PACING_OVERFLOW_BIN = PACING_BINS_NB;
+constexpr double PACING_RANGE = PACING_BINS_NB * PACING_BIN_WIDTH;
+
+// The number of frames the histogram covers, 10 seconds at 60 fps.
+constexpr int PACING_WINDOW_SIZE = 600;
+
+/**
+ * @brief The presentation error percentiles of the frames in the window.
+ *
+ * A percentile that lands in the overflow bin is only known to be at least PACING_RANGE, it
+ * is reported as PACING_RANGE with its overflow flag set. The max is the exact error.
+ */
+struct PacingStats {
+    int frames_nb = 0;
+    int overflow_nb = 0;
+    double p50_error_ms = 0.0;
+    double p99_error_ms = 0.0;
+    double max_error_ms = 0.0;
+    double spin_threshold_ms = 0.0;
+    bool is_p50_overflow = false;
+    bool is_p99_overflow = false;
+};
+
+/**
+ * @brief Waits for absolute frame deadlines with sub-millisecond precision.
+ *
+ * Sleeping alone is only as precise as the scheduler (a millisecond at best, often a lot
+ * more), so the pacer sleeps until the deadline is close and spins for the rest. The spin
+ * threshold follows how much the sleeps actually overshoot, it stays small on a precise
+ * timer and grows on a coarse one. Deadlines are on a steady clock, the wall clock can jump
+ * and av_gettime_relative() falls back to it on some platforms.
+ *
+ * The error of every frame that had to wait is kept over the last PACING_WINDOW_SIZE frames,
+ * along with a histogram of them.
+ */
+class FramePacer
+{
+public:
+    FramePacer();
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    /**
+     * @brief The current time of the steady clock in seconds.
+     */
+    [[nodiscard]] static double now() noexcept;
+
+    /**
+     * @brief Blocks until a deadline of now(). Returns right away if it already passed.
+     * @return How late the call returned, in seconds.
+     */
+    double wait_until(double deadline);
+
+    [[nodiscard]] PacingStats get_stats() const;
+
+    /**
+     * @brief The number of frames in each bin of the histogram, the overflow bin last.
+     */
+    [[nodiscard]] std::array<float, PACING_BINS_NB + 1> get_histogram() const;
+
+    void reset();
+
+private:
+    void record_error(double error);
+    void update_spin_threshold(double oversleep) noexcept;
+
+    [[nodiscard]] static int get_bin(double error) noexcept;
+
+    /**
+     * @brief The upper edge of the bin the percentile lands in. The caller holds the mutex.
+     */
+    [[nodiscard]] double get_percentile(double percentile, bool& is_overflow) const;
+
+    std::array<std::uint32_t, PACING_BINS_NB + 1> m_bins{};
+    std::array<double, PACING_WINDOW_SIZE> m_window{}; ///< The error of every frame.
+    int m_window_index = 0;
+    int m_frames_nb = 0;
+
+    // Only touched by the thread that waits.
+    double m_sleep_overshoot = 0.0;
+
+    // Written by the thread that waits, read by get_stats() from the UI thread.
+    std::atomic<double> m_spin_threshold;
+
+    SDL_mutex* m_mutex;
+};
+} // namespace YAVE
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "core/backend/video_loader.hpp"
+#include "core/utils/spsc_ring.hpp"
+
+namespace YAVE
+{
+constexpr std::size_t MIN_PICTURE_QUEUE_SIZE = 2;
+constexpr std::size_t DEFAULT_PICTURE_QUEUE_SIZE = 4;
+constexpr std::size_t MAX_PICTURE_QUEUE_SIZE = 16;
+
+/**
+ * @struct DecodedFrame
+ * @brief A decoded picture waiting to be presented.
+ */
+struct DecodedFrame {
+    AVFrame* frame = nullptr;
+    double pts = 0.0;
+};
+
+/**
+ * @brief A bounded lookahead of decoded pictures between the decoder and the presenter.
+ *
+ * The decoder fills it ahead of time so that a slow frame only drains the queue
+ * instead of showing up as a stutter.
+ */
+class FrameQueue
+{
+public:
+    FrameQueue(std::size_t capacity = DEFAULT_PICTURE_QUEUE_SIZE);
+    ~FrameQueue();
+
+    /**
+     * @brief Moves a decoded frame into the queue, waiting for a free slot.
+     * @param src_frame The frame, it will be left blank on success.
+     * @param pts The presentation timestamp in seconds.
+     * @param timeout_ms The maximum time to wait for a free slot.
+     * @return 0 <= for success, AVERROR(EAGAIN) if the timeout expired.
+     */
+    int enqueue(AVFrame* src_frame, double pts, int timeout_ms);
+
+    /**
+     * @brief Get the next frame to present without removing it.
+     * @param timeout_ms The maximum time to wait for a frame.
+     * @return A pointer to the frame, or nullptr if the timeout expired.
+     */
+    [[nodiscard]] DecodedFrame* peek(int timeout_ms);
+
+    /**
+     * @brief Releases the frame returned by peek().
+     */
+    void pop();
+
+    /**
+     * @brief Discards every queued frame. (e.g after seeking)
+     */
+    inline void clear()
+    {
+        m_ring.flush();
+        m_serial.fetch_add(1);
+    }
+
+    inline void wake_all()
+    {
+        m_ring.wake_all();
+    }
+
+    [[nodiscard]] inline unsigned int getSerial() const
+    {
+        return m_serial.load();
+    }
+
+    [[nodiscard]] inline unsigned int getCount() const
+    {
+        return static_cast<unsigned int>(m_ring.size());
+    }
+
+    [[nodiscard]] inline unsigned int getCapacity() const
+    {
+        return static_cast<unsigned int>(m_ring.capacity());
+    }
+
+private:
+    void drop_stale_frames();
+
+    SPSCRing<DecodedFrame> m_ring;
+    std::atomic<unsigned int> m_serial{ 0 };
+};
+} // namespace YAVE
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include "core/backend/frame_cache.hpp"
+#include "core/backend/gop_decoder.hpp"
+
+namespace YAVE
+{
+// The decoded frames kept around the one on screen, in their native format. A step past
+// either end of the window decodes again from the keyframe before it.
+constexpr std::size_t FRAME_STEP_WINDOW_CAPACITY = 16;
+
+/**
+ * @enum FrameStep
+ * @brief The direction of a single-frame step, stored in user.code of FF_STEP_FRAME_EVENT.
+ */
+enum class FrameStep : std::int32_t { PREVIOUS = -1, NEXT = 1 };
+
+/**
+ * @brief Finds the exact frame before or after a frame, for the frame step commands.
+ *
+ * The frames are decoded on a GopDecoder and kept in a window of consecutive frames, so
+ * repeated steps in either direction are served without seeking or decoding. The window
+ * always holds every frame between its first and its last timestamp, so a frame in the
+ * window knows its neighbours. Past the window the FrameCache is asked before decoding,
+ * and every decoded frame is added to it.
+ *
+ * Only used by the UI thread.
+ */
+class FrameStepper
+{
+public:
+    FrameStepper();
+    ~FrameStepper();
+
+    FrameStepper(const FrameStepper&) = delete;
+    FrameStepper& operator=(const FrameStepper&) = delete;
+
+    /**
+     * @brief Finds the frame next to a frame.
+     * @param path The media file.
+     * @param pts The presentation timestamp of the frame on screen, in seconds.
+     * @param dest_frame Receives a new reference to the frame, untouched if there is none.
+     * @param dest_pts Receives the presentation timestamp of the frame, in seconds.
+     * @return 0 <= for success, a negative integer at either end of the stream or for error.
+     */
+    int step(const std::string& path, double pts, FrameStep direction, AVFrame* dest_frame,
+        double* dest_pts);
+
+    /**
+     * @brief Releases the frames of the window.
+     */
+    void clear();
+
+private:
+    struct WindowFrame {
+        AVFrame* frame = nullptr;
+        std::int64_t timestamp = 0;
+    };
+
+    /**
+     * @brief Looks the neighbour of a frame up in the window.
+     * @return nullptr if the window doesn't cover it.
+     */
+    [[nodiscard]] const WindowFrame* find(std::int64_t timestamp, FrameStep direction) const;
+
+    /**
+     * @brief Decodes the frames right before a timestamp into the window.
+     */
+    int fill_before(std::int64_t end_timestamp);
+
+    /**
+     * @brief Decodes the frames from a timestamp on into the window.
+     */
+    int fill_from(std::int64_t timestamp);
+
+    /**
+     * @brief Moves a decoded frame to the end of the window.
+     * @return false if the frame couldn't be allocated.
+     */
+    bool push_frame(AVFrame* frame, std::int64_t timestamp);
+
+    GopDecoder m_decoder;
+
+    std::deque<WindowFrame> m_window;
+
+    // Every frame up to this timestamp is in the window, past the last frame at the end of
+    // the stream.
+    std::int64_t m_covered_until = 0;
+};
+} // namespace YAVE
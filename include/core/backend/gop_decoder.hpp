@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <string>
+
+#include "core/backend/decoder_threading.hpp"
+#include "core/backend/keyframe_index.hpp"
+
+namespace YAVE
+{
+/**
+ * @brief Receives a decoded frame and its timestamp in the stream timebase. The frame may
+ *        be moved out of, it is unreferenced afterwards either way.
+ * @return false to stop decoding.
+ */
+using GopFrameCallback = std::function<bool(AVFrame* frame, std::int64_t timestamp)>;
+
+/**
+ * @brief Decodes the video stream of a file from any keyframe, on its own demuxer and codec.
+ *
+ * Codecs only decode forward from a keyframe, so every random access is a seek to the
+ * keyframe before the target followed by a decode up to it. Used by the reverse playback
+ * and the frame stepping, which both need frames the forward pipeline has already passed.
+ * Not thread-safe, each user owns its own instance.
+ */
+class GopDecoder
+{
+public:
+    explicit GopDecoder(DecoderUseCase use_case);
+    ~GopDecoder();
+
+    GopDecoder(const GopDecoder&) = delete;
+    GopDecoder& operator=(const GopDecoder&) = delete;
+
+    /**
+     * @brief Opens the video stream of a file, unless it is already open.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    int open(const std::string& path);
+
+    void close();
+
+    [[nodiscard]] inline bool is_open() const noexcept
+    {
+        return m_codec_ctx != nullptr;
+    }
+
+    /**
+     * @brief Seeks to the keyframe at or before a timestamp and decodes forward from it.
+     *        The keyframe index of the file is used once it is built, a sparse container
+     *        index that lands after the timestamp is retried further back.
+     * @return 0 <= if the callback stopped, AVERROR_EOF at the end of the stream, another
+     *         negative integer for error.
+     */
+    int decode_from(std::int64_t timestamp, const GopFrameCallback& on_frame);
+
+    /**
+     * @brief Decodes the frames right before a timestamp, from the keyframe before them.
+     * @param end_timestamp The first timestamp that isn't passed to the callback.
+     * @return The number of frames passed to the callback, 0 at the start of the stream, a
+     *         negative integer for error or if the callback stopped.
+     */
+    int decode_before(std::int64_t end_timestamp, const GopFrameCallback& on_frame);
+
+    [[nodiscard]] inline std::int64_t to_timestamp(double seconds) const noexcept
+    {
+        return static_cast<std::int64_t>(std::llround(seconds / av_q2d(m_timebase)));
+    }
+
+    [[nodiscard]] inline double to_seconds(std::int64_t timestamp) const noexcept
+    {
+        return static_cast<double>(timestamp) * av_q2d(m_timebase);
+    }
+
+    [[nodiscard]] inline const std::string& get_path() const noexcept
+    {
+        return m_path;
+    }
+
+private:
+    /**
+     * @brief Decodes from the current position of the demuxer.
+     */
+    int decode_frames(const GopFrameCallback& on_frame);
+
+    DecoderUseCase m_use_case;
+
+    AVFormatContext* m_format_ctx = nullptr;
+    AVCodecContext* m_codec_ctx = nullptr;
+    AVPacket* m_packet = nullptr;
+    AVFrame* m_frame = nullptr;
+
+    std::string m_path;
+    int m_stream_index = -1;
+    AVRational m_timebase{ 0, 1 };
+    std::int64_t m_first_timestamp = 0;
+
+    std::shared_ptr<const KeyframeIndex> m_keyframe_index;
+};
+} // namespace YAVE
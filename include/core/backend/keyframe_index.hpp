@@ -0,0 +1,102 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+#include <SDL.h>
+#include <SDL_mutex.h>
+
+#include "core/backend/video_loader.hpp"
+
+namespace YAVE
+{
+/**
+ * @brief A keyframe of the video stream, as the demuxer saw its packet.
+ */
+struct KeyframeEntry {
+    std::int64_t pts = AV_NOPTS_VALUE; ///< In the stream timebase, the dts if it had none.
+    std::int64_t dts = AV_NOPTS_VALUE;
+    std::int64_t position = -1;        ///< The byte offset of the packet, -1 if unknown.
+    std::int64_t frame_number = 0;     ///< The number of video packets before it.
+};
+
+/**
+ * @brief The keyframes of a file's video stream, sorted by pts.
+ *
+ * Some containers (MPEG-TS, MKV without cues) have a sparse index or none at all, so
+ * av_seek_frame guesses and may land far from the target. A packet-only scan of the whole
+ * file finds every keyframe without decoding anything, after which a seek is a binary
+ * search and a byte seek straight to the keyframe packet.
+ *
+ * The indexes are built once per file and shared by every demuxer that opens it. They
+ * never change after they are built, so they can be read without locks.
+ */
+class KeyframeIndex
+{
+public:
+    KeyframeIndex() = default;
+
+    /**
+     * @brief Wraps keyframes that were found another way. The index isn't shared with the
+     *        demuxers, and seek() refuses every stream.
+     * @param entries Sorted by pts.
+     */
+    explicit KeyframeIndex(std::vector<KeyframeEntry> entries, std::int64_t frames_nb = 0);
+
+    /**
+     * @brief Get the index of a file, scanning the file if it wasn't indexed yet. Blocks
+     *        for the whole scan, only call it from a background thread.
+     * @return nullptr if the file couldn't be read.
+     */
+    static std::shared_ptr<const KeyframeIndex> build(const std::string& path);
+
+    /**
+     * @brief Get the index of a file without building it.
+     * @return nullptr if the file wasn't indexed yet.
+     */
+    [[nodiscard]] static std::shared_ptr<const KeyframeIndex> get(const std::string& path);
+
+    /**
+     * @brief Finds the last keyframe at or before a timestamp, or the first keyframe when
+     *        the timestamp comes before it.
+     * @return nullptr if the stream has no keyframes.
+     */
+    [[nodiscard]] const KeyframeEntry* find(std::int64_t timestamp) const;
+
+    /**
+     * @brief Moves a demuxer to the keyframe that find() returns. Formats that can't seek
+     *        by bytes seek to the exact timestamp of the keyframe instead.
+     * @param stream_index The video stream of the demuxer, it has to be the indexed one.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    int seek(AVFormatContext* av_format_ctx, int stream_index, std::int64_t timestamp) const;
+
+    [[nodiscard]] inline const std::vector<KeyframeEntry>& get_entries() const noexcept
+    {
+        return m_entries;
+    }
+
+    [[nodiscard]] inline std::int64_t get_frames_nb() const noexcept
+    {
+        return m_frames_nb;
+    }
+
+private:
+    /**
+     * @brief Reads every packet of the file without decoding them.
+     */
+    static std::shared_ptr<KeyframeIndex> scan(const std::string& path);
+
+    std::vector<KeyframeEntry> m_entries;
+    std::int64_t m_frames_nb = 0;
+    int m_stream_index = -1;
+
+    static std::unordered_map<std::string, std::shared_ptr<const KeyframeIndex>> s_Indexes;
+
+    // The files some thread is scanning right now, the others wait for it.
+    static std::set<std::string> s_PendingPaths;
+
+    static SDL_mutex* s_Mutex;
+    static SDL_cond* s_BuiltCond;
+};
+} // namespace YAVE
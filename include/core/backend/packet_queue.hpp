@@ -1,81 +1,124 @@
 #pragma once
 
-#include <deque>
-
 #include "core/backend/video_player.hpp"
+#include "core/utils/spsc_ring.hpp"
 
 namespace YAVE
 {
 constexpr std::size_t MAX_PACKETS_NB = 24;
 
+// How long the demuxer waits for a free slot before checking if it should stop.
+constexpr int PACKET_QUEUE_WAIT_MS = 10;
+
 /**
- * @typedef PacketDeque
- * @brief An double-ended queue for audio and video packets.
+ * @brief A pre-allocated packet and the serial the demuxer read before demuxing it.
  */
-using PacketDeque = std::deque<AVPacket>;
+struct PacketSlot {
+    AVPacket* av_packet = nullptr;
+    unsigned int serial = 0;
+};
 
 /**
- * @typedef PacketDequeType
- * @brief The value type of the packet deque. (AVPacket)
+ * @typedef PacketRing
+ * @brief A bounded ring of pre-allocated audio or video packets.
  */
-using PacketDequeType = PacketDeque::value_type;
+using PacketRing = SPSCRing<PacketSlot>;
 
 class PacketQueue
 {
 public:
-    PacketQueue();
-    ~PacketQueue() = default;
+    PacketQueue(std::size_t capacity = MAX_PACKETS_NB);
+    ~PacketQueue();
 
     /**
-     * @brief Adds a new packet to the packet deque.
-     * @param src_packet The packet that will be added.
-     * @return 0 <= for success, a negative integer for errors.
+     * @brief Adds a new packet without blocking.
+     * @param src_packet The packet that will be referenced by the queue.
+     * @param serial The serial read before the packet was demuxed. The packet is dropped if
+     *        the queue was cleared since, even if the clear lands after it was added.
+     * @return 0 <= for success (or a dropped packet), AVERROR(EAGAIN) if the queue is full,
+     *         and a negative integer for other errors.
      */
-    int enqueue(const AVPacket* src_packet);
+    int try_enqueue(const AVPacket* src_packet, unsigned int serial);
 
     /**
-     * @brief Removes the first packet.
+     * @brief Removes the first packet without blocking.
      * @param dest_packet A pointer to the destination packet.
-     * @return 0 <= for sucess, a negative integer for errors.
+     * @return 0 <= for success, AVERROR(EAGAIN) if the queue is empty,
+     *         and a negative integer for other errors.
+     */
+    int try_dequeue(AVPacket* dest_packet);
+
+    /**
+     * @brief Adds a new packet, waiting for a free slot if the queue is full.
+     * @param src_packet The packet that will be referenced by the queue.
+     * @param serial The serial read before the packet was demuxed, see try_enqueue().
+     * @param timeout_ms The maximum time to wait for a free slot.
+     * @return 0 <= for success (or a dropped packet), AVERROR(EAGAIN) if the timeout expired.
      */
-    int dequeue(AVPacket* dest_packet);
+    int enqueue(
+        const AVPacket* src_packet, unsigned int serial, int timeout_ms = PACKET_QUEUE_WAIT_MS);
 
-    [[nodiscard]] inline bool isEmpty()
+    /**
+     * @brief Removes the first packet, waiting for one if the queue is empty.
+     * @param dest_packet A pointer to the destination packet.
+     * @param timeout_ms The maximum time to wait for a packet.
+     * @return 0 <= for success, AVERROR(EAGAIN) if the timeout expired or the packets that
+     *         arrived in the meantime were all cleared.
+     */
+    int dequeue(AVPacket* dest_packet, int timeout_ms = PACKET_QUEUE_WAIT_MS);
+
+    [[nodiscard]] inline bool isEmpty() const
     {
-        return m_nb_packets == 0;
+        return m_ring.empty();
     };
-    [[nodiscard]] inline bool isFull()
+
+    [[nodiscard]] inline bool isFull() const
     {
-        return m_nb_packets >= MAX_PACKETS_NB;
+        return m_ring.full();
     };
 
+    /**
+     * @brief Discards every queued packet. The consumer releases them on its next dequeue,
+     *        along with the packets that were read before the clear but added after it.
+     */
     inline void clear()
     {
-        m_packet_deque.clear();
-        m_nb_packets = 0;
+        m_ring.flush();
+        m_serial.fetch_add(1);
     }
 
-    [[nodiscard]] inline unsigned int getCount() const
-    {
-        return m_nb_packets;
-    };
-
-    [[nodiscard]] inline const PacketDequeType getFront() const
+    /**
+     * @brief Get the number of times the queue was cleared. Used to detect stale packets.
+     */
+    [[nodiscard]] inline unsigned int getSerial() const
     {
-        return m_packet_deque.front();
+        return m_serial.load();
     }
-    [[nodiscard]] inline const PacketDequeType getBack() const
+
+    /**
+     * @brief Wakes up threads that are blocked on this queue. (e.g when stopping)
+     */
+    inline void wake_all()
     {
-        return m_packet_deque.back();
+        m_ring.wake_all();
     }
 
-    static SDL_mutex* s_GlobalMutex;
-    static SDL_cond* s_PacketAvailabilityCond;
+    [[nodiscard]] inline unsigned int getCount() const
+    {
+        return static_cast<unsigned int>(m_ring.size());
+    };
 
-    static bool start_audio_dequeue;
+    [[nodiscard]] inline unsigned int getCapacity() const
+    {
+        return static_cast<unsigned int>(m_ring.capacity());
+    };
 
 private:
-    PacketDeque m_packet_deque;
-    unsigned int m_nb_packets;
+    [[nodiscard]] bool is_front_stale();
+
+    void drop_stale_packets();
+
+    PacketRing m_ring;
+    std::atomic<unsigned int> m_serial{ 0 };
 };
-} // namespace YAVE
\ No newline at end of file
+} // namespace YAVE
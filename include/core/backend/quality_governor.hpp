@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+
+#include "core/backend/video_loader.hpp"
+
+namespace YAVE
+{
+// From this playback rate on the non-reference frames are skipped at every level, most of
+// them couldn't be shown in time anyway and the decode cost would grow with the rate.
+constexpr double SKIP_NONREF_PLAYBACK_RATE = 2.0;
+
+/**
+ * @enum DecodeQuality
+ * @brief The shortcuts the preview decoder may take, every level keeps the ones before it.
+ */
+enum class DecodeQuality : int {
+    FULL = 0,
+    SKIP_LOOP_FILTER,   ///< skip_loop_filter = AVDISCARD_ALL
+    SKIP_NONREF_FRAMES, ///< skip_frame = AVDISCARD_NONREF
+    LOWRES,             ///< lowres = 1, only for decoders that support it.
+    PREVIEW_DOWNSCALE,  ///< The RGBA preview is converted at half of the selected size.
+    COUNT
+};
+
+/**
+ * @brief Lowers the decode quality of the preview while playback falls behind the clock
+ *        and raises it again once there is headroom.
+ *
+ * The presenter reports how late every frame is, the decoder thread applies the current
+ * level to its codec context. The level goes down one step at a time when the frames are
+ * late by more than a frame on average, and up one step after a few seconds on time with
+ * the picture queue at least half full. Both directions wait for a cooldown, so a single
+ * slow frame or a burst of easy ones doesn't make it oscillate.
+ *
+ * Only the player's decoder is governed, the exporter never sees these settings.
+ */
+class QualityGovernor
+{
+public:
+    QualityGovernor() = default;
+
+    QualityGovernor(const QualityGovernor&) = delete;
+    QualityGovernor& operator=(const QualityGovernor&) = delete;
+
+    /**
+     * @brief Records the lateness of a presented frame, called from the presenter thread.
+     * @param diff The frame pts minus the reference clock, negative when the frame is late.
+     * @param frame_duration The duration of the frame in seconds.
+     * @param queue_fill How full the decoded picture queue is, from 0 to 1.
+     */
+    void record_lateness(double diff, double frame_duration, double queue_fill);
+
+    /**
+     * @brief Sets the skip options of the current level on the decoder. Has to be called
+     *        with the codec lock held.
+     */
+    void apply(AVCodecContext* av_codec_ctx);
+
+    /**
+     * @brief The lowres value the decoder should be opened with at the current level.
+     */
+    [[nodiscard]] int get_lowres() const noexcept;
+
+    [[nodiscard]] inline bool is_preview_downscaled() const noexcept
+    {
+        return get_level() >= DecodeQuality::PREVIEW_DOWNSCALE;
+    }
+
+    [[nodiscard]] inline DecodeQuality get_level() const noexcept
+    {
+        return m_level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The moving average of how late the frames are, in seconds.
+     */
+    [[nodiscard]] inline double get_average_lateness() const noexcept
+    {
+        return m_average_lateness.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Skips the non-reference frames from SKIP_NONREF_PLAYBACK_RATE on.
+     */
+    inline void set_playback_rate(double playback_rate) noexcept
+    {
+        m_playback_rate.store(playback_rate, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Disabling the governor restores the full quality.
+     */
+    void set_enabled(bool is_enabled) noexcept;
+
+    [[nodiscard]] inline bool is_enabled() const noexcept
+    {
+        return m_is_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Forgets the measured lateness, e.g. after a seek.
+     * @param reset_level Also go back to the full quality, e.g. for a new input.
+     */
+    void reset(bool reset_level) noexcept;
+
+    [[nodiscard]] static const char* quality_to_string(DecodeQuality quality);
+
+private:
+    /**
+     * @brief The next level in a direction, skipping lowres when the decoder can't do it.
+     */
+    [[nodiscard]] DecodeQuality next_level(DecodeQuality level, int direction) const noexcept;
+
+    void set_level(DecodeQuality level, double current_time);
+
+    std::atomic<DecodeQuality> m_level = DecodeQuality::FULL;
+    std::atomic<bool> m_is_enabled = true;
+    std::atomic<double> m_average_lateness = 0.0;
+    std::atomic<double> m_playback_rate = 1.0;
+
+    // Written by the decoder thread once it knows the codec.
+    std::atomic<int> m_max_lowres = 0;
+
+    // Set from the UI thread, taken by the presenter before its next measurement.
+    std::atomic<bool> m_needs_reset = false;
+
+    // Only touched by the presenter thread.
+    double m_last_change_time = 0.0;
+    double m_on_time_since = -1.0;
+};
+} // namespace YAVE
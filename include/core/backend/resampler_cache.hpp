@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <SDL_mutex.h>
+
+#include "core/backend/video_loader.hpp"
+
+namespace YAVE
+{
+// Enough for a few streams with different formats, e.g. switching back and forth between
+// clips, without keeping the resamplers of every file ever opened.
+constexpr std::size_t DEFAULT_RESAMPLER_CACHE_SIZE = 4;
+
+/**
+ * @brief Everything a resampler is configured with.
+ */
+struct ResamplerKey {
+    std::uint64_t in_channel_layout = 0;
+    AVSampleFormat in_sample_format = AV_SAMPLE_FMT_NONE;
+    int in_sample_rate = 0;
+
+    std::uint64_t out_channel_layout = 0;
+    AVSampleFormat out_sample_format = AV_SAMPLE_FMT_NONE;
+    int out_sample_rate = 0;
+
+    int flags = 0; ///< SWR_FLAG_*
+
+    bool operator==(const ResamplerKey&) const = default;
+
+    /**
+     * @brief The key that converts the frame to the given format at the given rate, keeping
+     *        its channel layout.
+     */
+    [[nodiscard]] static ResamplerKey from_frame(
+        const AVFrame* av_frame, AVSampleFormat out_sample_format, int out_sample_rate,
+        int flags = 0);
+};
+
+using ResamplerPtr = std::shared_ptr<SwrContext>;
+
+/**
+ * @brief Writes out the samples a resampler still holds, e.g. the end of the last frame of a
+ *        drift correction, and resets it for the next one. Needed before frames skip the
+ *        resampler, or its delayed samples would be lost.
+ * @param dest Receives the interleaved float samples, grown if it's too small.
+ * @return The number of samples per channel written, a negative integer for error.
+ */
+int drain_resampler(SwrContext* resampler, const ResamplerKey& key, std::vector<float>& dest);
+
+/**
+ * @brief Keeps the resamplers of the audio formats a player or a loader ran into.
+ *
+ * acquire() hands out the resampler for the current frame parameters and builds a new one
+ * when they changed, so a clip with a different channel count or rate never goes through the
+ * resampler of the previous one. The least recently used resampler is dropped once the cache
+ * is full. A resampler keeps state between calls (delayed samples, compensation), so each
+ * owner only uses it from one thread, the cache itself may be shared.
+ */
+class ResamplerCache
+{
+public:
+    explicit ResamplerCache(std::size_t capacity = DEFAULT_RESAMPLER_CACHE_SIZE);
+    ~ResamplerCache();
+
+    ResamplerCache(const ResamplerCache&) = delete;
+    ResamplerCache& operator=(const ResamplerCache&) = delete;
+
+    /**
+     * @brief Returns the resampler for the key, creating and initializing it if needed.
+     *        An evicted resampler stays valid for as long as it is held.
+     * @return nullptr if the resampler couldn't be initialized.
+     */
+    [[nodiscard]] ResamplerPtr acquire(const ResamplerKey& key);
+
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    [[nodiscard]] static ResamplerPtr create_resampler(const ResamplerKey& key);
+
+    struct Entry {
+        ResamplerKey key;
+        ResamplerPtr resampler;
+        std::uint64_t last_use = 0;
+    };
+
+    std::vector<Entry> m_entries;
+    std::size_t m_capacity;
+    std::uint64_t m_use_counter = 0;
+
+    SDL_mutex* m_mutex;
+};
+} // namespace YAVE
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include <SDL.h>
+
+#include "core/backend/frame_queue.hpp"
+#include "core/backend/gop_decoder.hpp"
+#include "core/utils/spsc_ring.hpp"
+
+namespace YAVE
+{
+// The frames of one segment are decoded forward and presented backward. A segment holds a
+// whole GOP when the budget allows it, so each GOP is decoded once. A longer GOP is split
+// into several segments, each one decoded again from its keyframe.
+constexpr std::size_t REVERSE_SEGMENT_MAX_FRAMES = 300;
+
+// About 165 frames of 1080p 4:2:0, both segments are filled at the same time at most.
+constexpr std::size_t REVERSE_SEGMENT_BUDGET_MIB = 512;
+
+// One segment is presented while the one before it is decoded.
+constexpr std::size_t REVERSE_SEGMENTS_NB = 2;
+
+/**
+ * @brief A run of consecutive frames, decoded forward from a keyframe.
+ *
+ * The frames are kept in a circular buffer, so when a GOP has more frames than the
+ * capacity only the last ones before the end of the segment are kept.
+ */
+struct ReverseSegment {
+    std::array<DecodedFrame, REVERSE_SEGMENT_MAX_FRAMES> frames{};
+    std::array<std::int64_t, REVERSE_SEGMENT_MAX_FRAMES> timestamps{}; ///< In the stream timebase.
+
+    // How many frames fit in the budget, set from the size of the first frame.
+    std::size_t capacity = REVERSE_SEGMENT_MAX_FRAMES;
+
+    std::size_t first_index = 0; ///< The oldest frame in the circular buffer.
+    std::size_t frames_nb = 0;
+    std::size_t presented_nb = 0; ///< Only touched by the consumer.
+
+    // Set on an empty segment, there is nothing left before the previous one.
+    bool is_start_of_stream = false;
+
+    [[nodiscard]] inline std::size_t index_of(std::size_t position) const noexcept
+    {
+        return (first_index + position) % capacity;
+    }
+};
+
+/**
+ * @brief Decodes a video backwards, one GOP at a time.
+ *
+ * Codecs only decode forward from a keyframe, so the decoder seeks to the keyframe before
+ * the frames that are still missing, decodes up to the last presented frame and hands the
+ * segment over in one piece. The consumer walks it backwards while the next segment back is
+ * decoded, so the seek and the decode of a GOP are hidden behind the presentation of the
+ * previous one.
+ *
+ * The GOPs are decoded on a GopDecoder, the forward pipeline is left untouched and
+ * resumes from wherever the reverse playback stopped. Only the UI thread starts and stops
+ * it, and only the presenter consumes the frames.
+ */
+class ReverseDecoder
+{
+public:
+    ReverseDecoder();
+    ~ReverseDecoder();
+
+    ReverseDecoder(const ReverseDecoder&) = delete;
+    ReverseDecoder& operator=(const ReverseDecoder&) = delete;
+
+    /**
+     * @brief Starts decoding backwards from a frame, the frame itself is not decoded again.
+     *        The file is only reopened when it changed since the last call.
+     * @param path The media file.
+     * @param seconds The presentation timestamp of the last presented frame.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    int start(const std::string& path, double seconds);
+
+    /**
+     * @brief Stops the decode thread. The segments that were handed over are dropped by
+     *        the consumer the next time it looks at them.
+     */
+    void stop();
+
+    [[nodiscard]] inline bool is_running() const noexcept
+    {
+        return m_thread != nullptr;
+    }
+
+    /**
+     * @brief Get the next frame back without removing it.
+     * @param timeout_ms The maximum time to wait for the next segment.
+     * @return A pointer to the frame, or nullptr if the timeout expired or the start of
+     *         the stream was reached.
+     */
+    [[nodiscard]] DecodedFrame* peek(int timeout_ms);
+
+    /**
+     * @brief Releases the frame returned by peek().
+     */
+    void pop();
+
+    /**
+     * @brief Whether peek() ran into the start of the stream since the last call.
+     */
+    [[nodiscard]] inline bool take_start_of_stream() noexcept
+    {
+        return m_has_reached_start.exchange(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Frees the frames of the segments that were handed over before the last stop().
+     *        Only the consumer may call this.
+     */
+    void drop_stale_segments();
+
+private:
+    static int decode_backward(void* data);
+
+    /**
+     * @brief Fills a segment with the frames right before a timestamp.
+     * @param end_timestamp The first timestamp that is not part of the segment.
+     * @return 0 <= for success, a negative integer for error or if the decoder is stopping.
+     */
+    int decode_segment(std::int64_t end_timestamp, ReverseSegment& segment);
+
+    static void keep_frame(ReverseSegment& segment, AVFrame* frame, std::int64_t timestamp,
+        double pts);
+
+    static void release_segment(ReverseSegment& segment);
+
+    SPSCRing<ReverseSegment> m_segments;
+    GopDecoder m_decoder;
+
+    SDL_Thread* m_thread = nullptr;
+    std::atomic<bool> m_is_stopping = false;
+    std::atomic<bool> m_has_reached_start = false;
+    std::int64_t m_start_timestamp = 0;
+};
+} // namespace YAVE
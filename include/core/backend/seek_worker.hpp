@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+
+#include <SDL.h>
+#include <SDL_mutex.h>
+
+#include "core/backend/frame_stepper.hpp"
+
+namespace YAVE
+{
+using SeekFunction = std::function<void(float seconds)>;
+using StepFunction = std::function<void(FrameStep direction)>;
+using TransportFunction = std::function<void()>;
+
+/**
+ * @brief Runs the seeks, the frame steps and the transport commands (pause, shuttle) off
+ *        the UI thread, one at a time and in the order they were requested.
+ *
+ * Scrubbing asks for a new position every UI frame, far more often than a paused seek can
+ * decode one. Only the latest target is kept, an older one that wasn't started is
+ * replaced, and the seek that is running checks is_stale() to give up as soon as a newer
+ * target arrives. The steps are counted instead, so none of the key presses are lost. A
+ * seek or a transport command drops the steps that are still waiting.
+ *
+ * The transport commands go through the same queue, so the playback state never changes
+ * under a running seek or step and the UI thread never waits for one.
+ *
+ * The frames reach the UI thread the usual way, through the preview framebuffers and
+ * FF_REFRESH_VIDEO_EVENT.
+ */
+class SeekWorker
+{
+public:
+    SeekWorker(SeekFunction seek, StepFunction step);
+    ~SeekWorker();
+
+    SeekWorker(const SeekWorker&) = delete;
+    SeekWorker& operator=(const SeekWorker&) = delete;
+
+    /**
+     * @brief Replaces the pending target, the thread is started on the first request.
+     */
+    void request_seek(float seconds);
+
+    void request_step(FrameStep direction);
+
+    /**
+     * @brief Runs a command that changes the playback state after the requests before it.
+     */
+    void request_transport(TransportFunction command);
+
+    /**
+     * @brief Whether a newer seek was requested since the running one started. Always
+     *        false outside of the worker thread, so the seek can also run synchronously.
+     */
+    [[nodiscard]] bool is_stale() const noexcept;
+
+    /**
+     * @brief Drops the requests that didn't start and waits for the running one.
+     */
+    void stop();
+
+private:
+    enum class RequestType { SEEK, STEP, TRANSPORT };
+
+    struct Request {
+        RequestType type = RequestType::SEEK;
+        float seconds = 0.0f;
+        int steps_nb = 0; ///< Negative for steps back.
+        TransportFunction command;
+    };
+
+    static int run(void* data);
+
+    /**
+     * @brief Starts the thread if it isn't running yet. The caller holds the mutex.
+     */
+    int start_locked();
+
+    /**
+     * @brief Removes the waiting requests of a type. The caller holds the mutex.
+     */
+    void drop_requests_locked(RequestType type);
+
+    SeekFunction m_seek;
+    StepFunction m_step;
+
+    std::deque<Request> m_requests;
+
+    // Bumped by every seek request, the running seek is stale once it moves on. A step
+    // doesn't make it stale, it starts from the frame the seek lands on.
+    std::atomic<std::uint64_t> m_generation = 0;
+    std::uint64_t m_running_generation = 0;
+
+    bool m_is_stopping = false;
+
+    SDL_Thread* m_thread = nullptr;
+    SDL_threadID m_thread_id = 0;
+
+    SDL_mutex* m_mutex = nullptr;
+    SDL_cond* m_request_cond = nullptr;
+};
+} // namespace YAVE
@@ -55,6 +55,7 @@ public:
     void srt_refresh();
 
 private:
+    static SDL_mutex* s_SubtitleMutex;
     static SDL_cond* s_SubtitleAvailabilityCond;
     std::unique_ptr<SubtitleParserFactory> m_parser_factory;
     std::vector<SubtitleItem*> m_subtitles;
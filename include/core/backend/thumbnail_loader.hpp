@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/backend/keyframe_index.hpp"
 #include "core/backend/video_player.hpp"
 #include <numeric>
 
@@ -52,5 +53,8 @@ private:
     AVPacket* m_av_packet;
     AVFrame* m_av_frame;
     int64_t m_duration;
+
+    // The index of the file being loaded, built before its thumbnail is picked.
+    std::shared_ptr<const KeyframeIndex> m_keyframe_index;
 };
 } // namespace YAVE
\ No newline at end of file
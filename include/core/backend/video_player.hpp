@@ -13,7 +13,18 @@
 
 #include "core/application.hpp"
 #include "core/backend/audio_player.hpp"
+#include "core/backend/color_conversion.hpp"
+#include "core/backend/decoder_threading.hpp"
+#include "core/backend/frame_cache.hpp"
+#include "core/backend/frame_pacer.hpp"
+#include "core/backend/frame_queue.hpp"
+#include "core/backend/frame_stepper.hpp"
+#include "core/backend/keyframe_index.hpp"
 #include "core/backend/packet_queue.hpp"
+#include "core/backend/quality_governor.hpp"
+#include "core/backend/reverse_decoder.hpp"
+#include "core/backend/seek_worker.hpp"
+#include "core/utils/triple_buffer.hpp"
 
 namespace YAVE
 {
@@ -28,10 +39,37 @@ enum CustomVideoEvents : std::uint32_t {
     FF_LOAD_SRT_FILE_EVENT,
     FF_TOGGLE_PAUSE_EVENT,
     FF_MUTE_AUDIO_EVENT,
-    FF_SEEK_TO_TIMESTAMP_EVENT,
     FF_REFRESH_THUMBNAIL,
     FF_REFRESH_WAVEFORM,
-    FF_REFRESH_SUBTITLES
+    FF_REFRESH_SUBTITLES,
+    FF_SHUTTLE_EVENT,
+    FF_STEP_FRAME_EVENT
+};
+
+/**
+ * @enum ShuttleCommand
+ * @brief The J/K/L shuttle keys, stored in user.code of FF_SHUTTLE_EVENT.
+ */
+enum class ShuttleCommand : std::int32_t {
+    REVERSE = 0, ///< J: plays backward, pressed again it speeds up.
+    PAUSE,       ///< K
+    FORWARD      ///< L: plays forward, pressed again it speeds up.
+};
+
+// The speeds a shuttle key steps through while it is pressed repeatedly.
+constexpr std::array<double, 3> SHUTTLE_RATES = { 1.0, 2.0, 4.0 };
+
+// A seek target is passed around as a float, the frame it was taken from may round to just
+// below it.
+constexpr double SEEK_TARGET_TOLERANCE = 1e-3;
+
+/**
+ * @enum FrameRefreshType
+ * @brief Tells the UI thread what FF_REFRESH_VIDEO_EVENT carries (stored in user.code).
+ */
+enum class FrameRefreshType : std::int32_t {
+    RGBA_BUFFER = 0, ///< The RGBA framebuffer of the video state was updated.
+    PLANAR_FRAME,    ///< VideoPlayer::s_PreviewFrame holds YUV planes for the shader path.
 };
 
 constexpr int COLOR_CHANNELS_NB = 4;
@@ -46,6 +84,7 @@ enum class VideoFlags : std::uint32_t {
   IS_SWS_INITIALIZED         = 1 << 2,
   IS_INPUT_ACTIVE            = 1 << 3,
   IS_DECODING_THREAD_ACTIVE  = 1 << 4,
+  IS_REVERSE                 = 1 << 5,
 };
 // clang-format on
 
@@ -92,6 +131,39 @@ inline VideoFlags operator^=(VideoFlags& lhs, VideoFlags rhs)
     return lhs;
 }
 
+/**
+ * @brief Applies an update to shared flags atomically, so updates from different threads
+ *        never overwrite each other.
+ */
+template <typename Operation>
+inline VideoFlags update_flags(std::atomic<VideoFlags>& flags, Operation operation)
+{
+    VideoFlags current_flags = flags.load();
+
+    while (!flags.compare_exchange_weak(current_flags, operation(current_flags))) {
+    }
+
+    return operation(current_flags);
+}
+
+inline VideoFlags operator|=(std::atomic<VideoFlags>& lhs, VideoFlags rhs)
+{
+    return update_flags(lhs, [rhs](VideoFlags flags) { return flags | rhs; });
+}
+
+inline VideoFlags operator&=(std::atomic<VideoFlags>& lhs, VideoFlags rhs)
+{
+    return update_flags(lhs, [rhs](VideoFlags flags) {
+        return static_cast<VideoFlags>(
+            static_cast<VideoFlagType>(flags) & static_cast<VideoFlagType>(rhs));
+    });
+}
+
+inline VideoFlags operator^=(std::atomic<VideoFlags>& lhs, VideoFlags rhs)
+{
+    return update_flags(lhs, [rhs](VideoFlags flags) { return flags ^ rhs; });
+}
+
 #pragma endregion Video Flags
 
 struct VideoDimension {
@@ -99,20 +171,116 @@ struct VideoDimension {
     int y = 360;
 };
 
+/**
+ * @enum PreviewQuality
+ * @brief The size of the RGBA preview frames. FIT follows the size of the preview panel,
+ *        the others are fractions of the source. The preview is never larger than the source.
+ */
+enum class PreviewQuality : int { FIT = 0, FULL, HALF, QUARTER };
+
+// The fitted width is rounded up to this, so resizing the panel doesn't rebuild the scaler
+// and the framebuffers on every pixel of the resize.
+constexpr int PREVIEW_WIDTH_STEP = 64;
+
+/**
+ * @brief One RGBA preview frame, owned by one side of the triple buffer at a time.
+ */
+struct PreviewFramebuffer {
+    std::uint8_t* data = nullptr;
+    std::size_t capacity = 0; ///< In bytes, the buffer only grows.
+    VideoDimension dimensions{ 0, 0 };
+};
+
+/**
+ * @enum FrameDropPolicy
+ * @brief What the presenter does with frames that already missed their presentation time.
+ *        Dropped frames are still decoded, so the frames that reference them stay correct.
+ */
+enum class FrameDropPolicy : int {
+    NEVER = 0,       ///< Every frame is shown, playback slips behind the audio instead.
+    DROP_LATE,       ///< Frames that are late even for the next slot are not converted.
+    DROP_TO_KEYFRAME ///< After such a frame, everything up to the next keyframe is dropped.
+};
+
+/**
+ * @brief How the frames that went through the presenter were timed.
+ */
+struct FrameTimingStats {
+    std::atomic<std::uint64_t> on_time_nb = 0;
+    std::atomic<std::uint64_t> late_nb = 0;    ///< Shown after their presentation time.
+    std::atomic<std::uint64_t> dropped_nb = 0; ///< Decoded but never converted or uploaded.
+};
+
 struct VideoState {
     SwsContext* sws_scaler_ctx = nullptr;
+
+    // One scaler per slice, sws_scale can't run the slices of one context in parallel.
+    std::vector<SwsContext*> sws_slice_ctxs{};
+
     AVFormatContext* av_format_ctx = nullptr;
-    std::uint8_t* buffer = nullptr;
 
-    double current_pts = 0.0;
-    double previous_pts = 0.0;
+    // The RGBA framebuffers, the presenter converts into the back one while the UI thread
+    // uploads the front one. Its counters tell how many frames were skipped on the way.
+    TripleBuffer<PreviewFramebuffer> framebuffers;
+
+    // The preview size the UI thread asks for, read by the presenter for every frame.
+    std::atomic<PreviewQuality> preview_quality = PreviewQuality::FIT;
+    std::atomic<int> viewport_width = 0;
+    std::atomic<int> viewport_height = 0;
+
+    // The size of the last RGBA preview frame, written by the presenter.
+    std::atomic<VideoDimension> preview_dimensions = VideoDimension{ 0, 0 };
+
+    // Read and written by the UI thread, the seek worker and the presenter.
+    std::atomic<double> current_pts = 0.0;
+    std::atomic<double> previous_pts = 0.0;
     double previous_delay = 40e-3;
 
-    VideoFlags flags = VideoFlags::NONE;
+    // The frames before the target of the last seek are decoded but never presented.
+    std::atomic<double> seek_target_pts = 0.0;
+
+    std::atomic<VideoFlags> flags = VideoFlags::NONE;
     VideoDimension dimensions;
 
+    // The deadline of the next frame on FramePacer::now(), kept by the presenter.
     double frame_timer = 0.0;
+    FramePacer frame_pacer;
     bool is_first_frame = false;
+
+    // Whether the last frame was converted by the SIMD kernels instead of swscale.
+    bool is_using_fast_conversion = false;
+
+    // Whether the last frame was handed to the GPU as YUV planes.
+    bool is_using_planar_upload = false;
+
+    // The wall time of the last frame conversion (including the join of the slices).
+    double conversion_time_ms = 0.0;
+    double average_conversion_time_ms = 0.0;
+    int conversion_slices_nb = 1;
+
+    // The number of decoded pictures the decoder may run ahead of the presenter.
+    std::size_t picture_queue_size = DEFAULT_PICTURE_QUEUE_SIZE;
+
+    // Lowers the decode quality of the preview while the frames are presented late.
+    QualityGovernor quality_governor;
+
+    std::atomic<FrameDropPolicy> frame_drop_policy = FrameDropPolicy::DROP_LATE;
+    FrameTimingStats frame_timing;
+
+    // The pts of the last synchronized frame minus the reference clock.
+    double frame_diff = 0.0;
+
+    // Set by DROP_TO_KEYFRAME until a keyframe arrives, only used by the presenter.
+    bool is_dropping_to_keyframe = false;
+
+    // Set by the presenter once it waits for the playback to resume, it doesn't touch the
+    // latest frame or the framebuffers until then. Guarded by the playback_state lock.
+    bool is_presenter_parked = false;
+
+    // Reverse playback keeps its own deadlines, so the forward ones still line up with the
+    // paused time once the audio resumes.
+    double reverse_frame_timer = 0.0;
+    bool is_first_reverse_frame = false;
 };
 
 struct VideoPreviewRequest {
@@ -143,21 +311,35 @@ public:
     int init_threads(AVRational* timebase);
 
     /**
-     * @brief Allocates memory for the frame buffer.
-     * @param width The width of the frame.
-     * @param height The height of the frame.
+     * @brief Makes a preview framebuffer large enough for a frame, it only grows.
+     * @param framebuffer The slot of the triple buffer owned by the calling thread.
+     * @param dimensions The size of the RGBA frame.
      * @return 0 <= for success, a negative integer for error.
      */
-    int allocate_frame_buffer(AVPixelFormat pix_fmt, VideoDimension dimensions);
+    static int allocate_frame_buffer(PreviewFramebuffer& framebuffer, VideoDimension dimensions);
 
     /**
-     * @brief Updates the framebuffer with the next packet when the last frame
-     *        has finished rendering.
+     * @brief Computes the size of the RGBA preview from the quality and the panel size.
+     * @return The preview size, never larger than the source and always even.
+     */
+    [[nodiscard]] static VideoDimension calculate_preview_dimensions(
+        const VideoState* video_state, VideoDimension source);
+
+    /**
+     * @brief Decodes the video packets and fills the decoded picture queue.
      * @param data The video state
      * @return 0 <= for success, a negative integer for error.
      */
     static int video_callback(void* data);
 
+    /**
+     * @brief Takes the decoded pictures from the queue and presents them on time.
+     *        This thread only does timing and the handoff to the UI thread.
+     * @param data The video state
+     * @return 0 <= for success, a negative integer for error.
+     */
+    static int present_frames(void* data);
+
     /**
      * @brief Sends the video packets to the decoder and then recieves the frame from the codec.
      * @return 0 <= for success, a negative integer for error.
@@ -165,12 +347,44 @@ public:
     static int decode_video_frame(
         VideoState* video_state, AVPacket* video_packet, AVFrame* dummy_frame = nullptr);
 
+    /**
+     * @brief Receives the next frame that the decoder has ready.
+     * @return 0 <= for success, AVERROR(EAGAIN) if the decoder needs more packets.
+     */
+    static int receive_video_frame(AVFrame* dest_frame);
+
+    /**
+     * @brief Reopens the video decoder with another lowres factor. Has to be called with
+     *        the video codec lock held, right before a keyframe is sent.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    static int reopen_video_decoder(int lowres);
+
+    /**
+     * @brief Sets how many decoded pictures the decoder may buffer. This only
+     *        takes effect before the video threads are started.
+     */
+    inline void set_picture_queue_size(std::size_t size)
+    {
+        m_video_state->picture_queue_size =
+            std::clamp(size, MIN_PICTURE_QUEUE_SIZE, MAX_PICTURE_QUEUE_SIZE);
+    }
+
     /**
      * @brief Enqueues audio and video packets in a separate thread.
      * @param data The video state
      */
     static int enqueue_packets(void* data);
 
+    /**
+     * @brief Enqueues a packet, blocking while the queue is full.
+     * @param queue The destination packet queue.
+     * @param packet The packet that will be referenced by the queue.
+     * @param serial The serial of the queue when the packet was read.
+     * @return 0 <= for success, a negative integer if the queue was flushed or stopped.
+     */
+    static int push_packet(PacketQueue* queue, const AVPacket* packet, unsigned int serial);
+
     /**
      * @brief Open other input files
      *
@@ -181,12 +395,24 @@ public:
     static int switch_input(AVFormatContext** av_format_context, const std::string& url);
 
     /**
-     * @brief Jump to specific timestamp.
+     * @brief Jump to the exact frame at a timestamp. The demuxer lands on the keyframe
+     *        before it, through the keyframe index once the file was indexed, and the frames
+     *        up to the target are decoded without being shown.
      * @param seconds The timestamp in seconds.
+     * @param update_frame While paused, shows the frame at the target. It comes from the
+     *        FrameCache when it was decoded before, and is decoded and cached otherwise.
+     *        Either way the decoder is left right after the target for the playback.
+     *        On the seek worker, the decoding gives up once a newer seek is requested.
      * @return 0 <= for success, a negative integer for error.
      */
     int seek_frame(float seconds, bool update_frame = false);
 
+    /**
+     * @brief Seeks on the seek worker, the calling thread doesn't wait for the decoding.
+     *        A target that wasn't reached yet is replaced by the new one.
+     */
+    void request_seek(float seconds);
+
     /**
      * @brief After decoding the packet will be translated into a framebuffer.
      * @param width The width of the video frame.
@@ -204,9 +430,17 @@ public:
 
     /**
      * @brief This signals the application to refresh the OpenGL texture.
+     * @param type Whether the RGBA framebuffer or the planar preview frame is ready.
      * @return 0 <= for success, a negative integer for error.
      */
-    static int refresh_texture();
+    static int refresh_texture(FrameRefreshType type = FrameRefreshType::RGBA_BUFFER);
+
+    /**
+     * @brief Hands the latest frame to the UI thread as YUV planes, the conversion
+     *        happens in a shader. Guarded by PlaybackLocks::preview_frame.
+     * @return 0 <= for success, a negative integer if the frame can't take this path.
+     */
+    static int share_preview_frame(VideoState* video_state);
 
 #pragma region Helper Functions
     /**
@@ -219,12 +453,77 @@ public:
     }
 
     /**
-     * @brief Access the framebuffer of the current video.
-     * @return std::uint8_t*&
+     * @brief Access the framebuffers of the current video. Only the UI thread may read them.
+     * @return TripleBuffer<PreviewFramebuffer>&
      */
-    [[nodiscard]] inline std::uint8_t*& get_framebuffer() noexcept
+    [[nodiscard]] inline TripleBuffer<PreviewFramebuffer>& get_framebuffers() noexcept
     {
-        return m_video_state->buffer;
+        return m_video_state->framebuffers;
+    }
+
+    /**
+     * @brief Tells the presenter how large the preview is drawn, in pixels.
+     */
+    inline void set_preview_viewport(int width, int height) noexcept
+    {
+        m_video_state->viewport_width = width;
+        m_video_state->viewport_height = height;
+    }
+
+    inline void set_preview_quality(PreviewQuality quality) noexcept
+    {
+        m_video_state->preview_quality = quality;
+    }
+
+    [[nodiscard]] inline PreviewQuality get_preview_quality() const noexcept
+    {
+        return m_video_state->preview_quality;
+    }
+
+    [[nodiscard]] static const char* preview_quality_to_string(PreviewQuality quality);
+
+    inline void set_frame_drop_policy(FrameDropPolicy policy) noexcept
+    {
+        m_video_state->frame_drop_policy = policy;
+    }
+
+    [[nodiscard]] inline FrameDropPolicy get_frame_drop_policy() const noexcept
+    {
+        return m_video_state->frame_drop_policy;
+    }
+
+    /**
+     * @brief Plays from 0.25x to 4x. The audio is time-stretched without changing its
+     *        pitch, the video skips its non-reference frames from 2x on.
+     */
+    void set_playback_rate(double playback_rate) noexcept;
+
+    [[nodiscard]] static inline double get_playback_rate() noexcept
+    {
+        return s_ClockNetwork->get_playback_rate();
+    }
+
+    [[nodiscard]] static const char* frame_drop_policy_to_string(FrameDropPolicy policy);
+
+    /**
+     * @brief Applies a J/K/L shuttle key on the seek worker, after the seeks and steps
+     *        requested before it. A direction key starts playback at 1x in its direction,
+     *        or steps through SHUTTLE_RATES when it already plays that way. The audio is
+     *        paused while playing backward.
+     */
+    void shuttle(ShuttleCommand command);
+
+    /**
+     * @brief Pauses and shows the frame right before or after the one on screen, decoded
+     *        exactly instead of from the nearest keyframe. Playback resumes from that frame.
+     *        The step runs on the seek worker, after the requests made before it.
+     * @return 0 <= if the step was requested, a negative integer for error.
+     */
+    int step_frame(FrameStep direction);
+
+    [[nodiscard]] inline bool is_playing_reverse() const noexcept
+    {
+        return m_video_state->flags & VideoFlags::IS_REVERSE;
     }
 
     /**
@@ -238,9 +537,9 @@ public:
 
     /**
      * @brief Access the video flags.
-     * @return VideoFlags&
+     * @return std::atomic<VideoFlags>&
      */
-    [[nodiscard]] inline VideoFlags& get_flags() noexcept
+    [[nodiscard]] inline std::atomic<VideoFlags>& get_flags() noexcept
     {
         return m_video_state->flags;
     }
@@ -266,6 +565,10 @@ public:
     [[nodiscard]] static double calculate_actual_delay(
         VideoState* video_state, double& frame_timer);
 
+    /**
+     * @brief Toggles the pause on the seek worker, after the seeks and steps requested
+     *        before it. The steps that didn't start yet are dropped.
+     */
     void pause_video();
 
     static void add_stream(StreamInfoPtr stream_ptr, std::string name);
@@ -279,45 +582,129 @@ public:
     void stop_threads();
     void update_video_dimensions();
 
-    [[nodiscard]] int nb_samples_per_frame(AVPacket* packet, AVFrame* frame);
     int restart_audio_thread();
 
     int init_codecs();
 
     static std::unique_ptr<PacketQueue> s_VideoPacketQueue;
+    static std::unique_ptr<FrameQueue> s_PictureQueue;
     static VideoQueue s_VideoFileQueue;
+    static std::unique_ptr<ReverseDecoder> s_ReverseDecoder;
+
+    // The latest frame for the planar preview, only valid while s_UsePlanarPreview is set.
+    static AVFrame* s_PreviewFrame;
+    static std::atomic<bool> s_UsePlanarPreview;
 
 protected:
     std::shared_ptr<VideoState> m_video_state;
     std::int64_t m_duration;
 
     SDL_Thread* m_decoding_tid;
+    SDL_Thread* m_audio_decode_tid;
     SDL_Thread* m_video_tid;
+    SDL_Thread* m_presentation_tid;
 
     inline static void reset_internal_clocks()
     {
         // Reset the audio and video internal clock.
-        s_ClockNetwork->audio_internal_clock = 0.0;
-        s_ClockNetwork->video_internal_clock = 0.0;
+        s_ClockNetwork->reset(0.0);
     }
 
 private:
     std::unique_ptr<VideoLoader> m_loader;
 
-    static int init_sws_scaler_ctx(VideoState* video_state);
+    /**
+     * @brief Prepares the scaler from the latest frame to the preview size.
+     *        The context is only rebuilt when one of the sizes or the format changes.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    static int init_sws_scaler_ctx(VideoState* video_state, VideoDimension dest_dimensions);
+
+    /**
+     * @brief Converts the latest frame with swscale, split into slices on the worker pool.
+     * @param slices_nb Receives the number of slices that were used.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    static int scale_frame_sliced(
+        VideoState* video_state, std::uint8_t* dest_buffer, int dest_stride, int* slices_nb);
     int create_context_for_stream(StreamInfoPtr& stream_info);
     int init_mutex();
 
 private:
-    static void update_pts(VideoState* video_state, AVPacket* video_packet);
-    static void synchronize_video(VideoState* video_state);
+    [[nodiscard]] static double calculate_frame_pts(const AVFrame* frame);
+    /**
+     * @brief Waits until the latest frame is due.
+     * @return false if the frame should be dropped instead of presented.
+     */
+    static bool synchronize_video(VideoState* video_state);
+
+    /**
+     * @brief Applies the frame drop policy to the latest frame, after it was synchronized.
+     */
+    [[nodiscard]] static bool should_drop_frame(VideoState* video_state, bool is_late);
+
+    /**
+     * @brief Presents the next frame of the reverse decoder, paced on the wall clock.
+     */
+    static void present_reverse_frame(VideoState* video_state);
+
+    /**
+     * @brief Blocks the calling thread while any of the flags is set.
+     * @param wait_flags The forward pipeline also waits during reverse playback.
+     */
+    static void wait_while_paused(
+        VideoState* video_state, VideoFlags wait_flags = VideoFlags::IS_PAUSED);
+
+    /**
+     * @brief Same as wait_while_paused() for the presenter, which also acknowledges that it
+     *        is parked through s_PresenterParkedCond.
+     */
+    static void park_presenter(VideoState* video_state);
+
+    /**
+     * @brief Blocks until the presenter is parked, after which the latest frame and the
+     *        framebuffers may be replaced by the calling thread.
+     * @return false if the playback isn't paused, the presenter still owns the frame.
+     */
+    bool wait_for_presenter_to_park();
+
+    int start_reverse_playback();
+
+    /**
+     * @brief Hands the playback back to the forward pipeline, from the last reverse frame.
+     * @param should_pause Stops on that frame instead of playing forward.
+     */
+    void stop_reverse_playback(bool should_pause);
+
+    /**
+     * @brief Pauses or resumes right away, on the seek worker. Once paused, the presenter
+     *        is parked.
+     */
+    void toggle_pause();
+
+    void apply_shuttle(ShuttleCommand command);
+
+    /**
+     * @brief Pauses and replaces the latest frame with its neighbour, on the seek worker.
+     * @return 0 <= for success, a negative integer at either end of the stream or for error.
+     */
+    int apply_frame_step(FrameStep direction);
 
 private:
     void free_ffmpeg();
+    void free_frame_buffers();
 
 private:
     std::string m_opened_file{ "" };
     bool m_is_input_open{ false };
+
+    FrameStepper m_frame_stepper;
+
+    // The frame on screen was stepped to, the forward pipeline is still where it paused.
+    bool m_has_stepped{ false };
+
+    // Declared last, so its thread stops before anything it uses is destroyed.
+    std::unique_ptr<SeekWorker> m_seek_worker;
 };
 #pragma endregion Video Player
 
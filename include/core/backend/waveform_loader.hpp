@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "core/application.hpp"
+#include "core/backend/resampler_cache.hpp"
 #include "core/backend/video_loader.hpp"
 
 namespace YAVE
@@ -47,13 +48,11 @@ public:
     static SDL_cond* cond;
 
 private:
-    static int init_swr_resampler_context(Waveform* waveform);
-
     static int open_file(std::string filename, Waveform* waveform_out, int* stream_index_ptr);
 
     static int start(void* data);
     static int get_audio_frames_from_packet(Waveform* waveform, int stream_index);
-    static int populate_audio_data(Waveform* waveform);
+    static int populate_audio_data(Waveform* waveform, ResamplerCache& resamplers);
     static int send_waveform_to_main_thread(Waveform* waveform, int segment_index);
 
     struct FileQueue {
@@ -67,10 +66,10 @@ private:
     };
 
     static WaveformCache s_LoadedWaveforms;
-    static SwrContext* s_ResamplerContext;
 
     static std::unique_ptr<VideoLoader> s_VideoLoader;
     FileQueue* m_file_queue;
+    ResamplerCache m_resamplers;
     SDL_Thread* m_waveform_loader_thread;
 };
 } // namespace YAVE
\ No newline at end of file
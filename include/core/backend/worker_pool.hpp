@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <SDL.h>
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+
+namespace YAVE
+{
+/**
+ * @brief A small pool of SDL threads for data-parallel work like slicing a frame.
+ *
+ * The pool only runs batches of indexed tasks. The thread that submits a batch works on
+ * it too and returns once every task is done, so the caller can treat parallel_for()
+ * like a plain loop.
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int workers_nb);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Runs task(0) ... task(tasks_nb - 1) on the pool and the calling thread.
+     *        Blocks until all of them are finished.
+     */
+    void parallel_for(int tasks_nb, const std::function<void(int)>& task);
+
+    [[nodiscard]] inline int get_workers_nb() const noexcept
+    {
+        return static_cast<int>(m_workers.size());
+    }
+
+    /**
+     * @brief The pool shared by the frame conversion paths.
+     */
+    [[nodiscard]] static WorkerPool& shared();
+
+private:
+    struct Batch {
+        const std::function<void(int)>* task = nullptr;
+        int tasks_nb = 0;
+        std::atomic<int> next_index{ 0 };
+        std::atomic<int> remaining{ 0 };
+        int workers_nb = 0; ///< Workers holding the batch, guarded by m_mutex.
+    };
+
+    static int worker_loop(void* data);
+
+    /**
+     * @brief Claims and runs tasks of a batch until there are none left.
+     */
+    void run_tasks(Batch* batch);
+
+    std::vector<SDL_Thread*> m_workers;
+    std::deque<Batch*> m_batches;
+
+    SDL_mutex* m_mutex;
+    SDL_cond* m_work_cond;
+    SDL_cond* m_done_cond;
+
+    bool m_is_running;
+};
+} // namespace YAVE
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "application.hpp"
+#include "core/texture_uploader.hpp"
 #include <string>
 
 namespace YAVE
@@ -14,11 +15,14 @@ public:
     void init();
     void update();
     void render();
+    void render_decoder_threading();
+    void render_frame_cache();
 
     [[nodiscard]] inline int calculate_kilobytes_per_second() const
     {
-        const int channels_nb = AudioPlayer::s_AudioBufferInfo->channel_nb;
-        const int sample_rate = AudioPlayer::s_AudioBufferInfo->sample_rate;
+        const AudioBufferInfo buffer_info = AudioPlayer::get_audio_buffer_info();
+        const int channels_nb = buffer_info.channel_nb;
+        const int sample_rate = buffer_info.sample_rate;
         const int sample_bytes = channels_nb * sizeof(float);
 
         return (sample_rate * sample_bytes) / 1000;
@@ -26,6 +30,7 @@ public:
 
     std::shared_ptr<VideoState> video_state;
     double time_base;
+    TextureUploadStats texture_upload;
 
 private:
 };
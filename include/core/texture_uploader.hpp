@@ -0,0 +1,107 @@
+#pragma once
+
+#define NO_SDL_GLEXT
+#define GLEW_STATIC
+
+#include <GL/glew.h>
+
+#include <array>
+#include <cstdint>
+
+namespace YAVE
+{
+// Enough buffers that the driver can still be reading the previous frames while the
+// current one is written.
+constexpr int PIXEL_BUFFERS_NB = 3;
+
+struct TextureUploadStats {
+    bool is_using_pixel_buffers = false;
+    double upload_time_ms = 0.0;
+    double average_upload_time_ms = 0.0;
+};
+
+/**
+ * @brief Streams RGBA frames into a texture through a ring of pixel buffer objects.
+ *
+ * Each frame is copied into the next buffer of the ring, and the texture is updated from
+ * the buffer the previous call filled. So the copy of a frame runs while the driver is
+ * still transferring the one before, and glTexSubImage2D only queues a transfer of pixels
+ * that are already in the buffer. A frame reaches the texture one call later, or on
+ * flush() when no new frame comes. Without pixel buffer objects the pixels are uploaded
+ * directly like before.
+ *
+ * Every method has to be called on the thread that owns the GL context.
+ */
+class TextureUploader
+{
+public:
+    TextureUploader() = default;
+    ~TextureUploader();
+
+    TextureUploader(const TextureUploader&) = delete;
+    TextureUploader& operator=(const TextureUploader&) = delete;
+
+    /**
+     * @brief Creates the pixel buffers if the context supports them.
+     * @return 0 <= for success, a negative integer if the direct upload will be used.
+     */
+    int init();
+
+    /**
+     * @brief Uploads a packed RGBA frame into the bound GL_TEXTURE_2D. The texture is
+     *        reallocated with the given internal format when the size changes.
+     *
+     * With pixel buffers, the texture receives the frame of the previous call and this one
+     * is left pending until the next upload() or flush().
+     * @return 0 <= for success, a negative integer for error.
+     */
+    int upload(const std::uint8_t* pixels, int width, int height, GLint internal_format);
+
+    /**
+     * @brief Transfers the pending frame into the bound GL_TEXTURE_2D, if there is one.
+     */
+    void flush();
+
+    [[nodiscard]] inline bool has_pending_frame() const noexcept
+    {
+        return m_pending_index >= 0;
+    }
+
+    [[nodiscard]] inline const TextureUploadStats& get_stats() const noexcept
+    {
+        return m_stats;
+    }
+
+private:
+    void resize_texture(int width, int height, GLint internal_format);
+    void resize_pixel_buffers(int width, int height);
+
+    /**
+     * @brief Copies the frame into the next pixel buffer, which becomes the pending one.
+     * @return 0 <= for success, a negative integer if the buffer couldn't be mapped.
+     */
+    int write_pixel_buffer(const std::uint8_t* pixels);
+
+    void transfer_pending_buffer();
+
+    /**
+     * @brief Accounts the time the GL thread spent on one frame, its copy and its transfer.
+     */
+    void record_upload_time(double upload_time_ms);
+
+    void release();
+
+    std::array<GLuint, PIXEL_BUFFERS_NB> m_pixel_buffers{};
+    int m_buffer_index = 0;
+    std::size_t m_buffer_size = 0;
+
+    // The buffer written by the last upload() that the texture hasn't received yet.
+    int m_pending_index = -1;
+    double m_pending_write_time_ms = 0.0;
+
+    int m_width = 0;
+    int m_height = 0;
+
+    TextureUploadStats m_stats;
+};
+} // namespace YAVE
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <string>
 #include <vector>
@@ -19,6 +20,9 @@ struct VideoDimension;
 constexpr unsigned int NUMBER_OF_TRACKS = 5;
 constexpr float SEGMENT_THUMBNAIL_WIDTH = 80.f;
 
+// The rates offered by the transport bar, from MIN_PLAYBACK_RATE to MAX_PLAYBACK_RATE.
+constexpr std::array<double, 7> PLAYBACK_RATE_PRESETS = { 0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 4.0 };
+
 // clang-format off
 constexpr ImPlotAxisFlags WAVEFORM_AXIS_FLAGS =
     ImPlotAxisFlags_NoDecorations | 
@@ -90,11 +94,11 @@ public:
     };
 
     /**
-     * @brief Pushes FF_SEEK_TO_TIMESTAMP_EVENT to the event listener.
-     * @param[in] mouse_pos A pointer to the requested timestamp.
+     * @brief Hands the timestamp to the seek worker, dragging only replaces its target.
+     * @param[in] seconds The requested timestamp.
      * @return 1 for success, 0 for error.
      */
-    int request_seek_frame(std::unique_ptr<float> mouse_pos);
+    int request_seek_frame(float seconds);
 
     /**
      * @brief Handles the ruler events
@@ -112,6 +116,12 @@ public:
      */
     int handle_playhead_events(const ImVec2& min, const ImVec2& max);
 
+    /**
+     * @brief Pushes FF_SHUTTLE_EVENT for the J/K/L keys and FF_STEP_FRAME_EVENT for the
+     *        left/right arrows, unless a text field has the keyboard.
+     */
+    void handle_transport_keys();
+
     std::shared_ptr<VideoPlayer> video_processor;
 
 private:
@@ -134,6 +144,11 @@ private:
     void render_ruler(const ImVec2& timestamp_max);
     void render_playhead();
 
+    /**
+     * @brief Formats a playback rate for the transport bar, e.g. "1.5x".
+     */
+    [[nodiscard]] static std::string format_playback_rate(double playback_rate);
+
     ImVec2 m_window_size;
     ImVec2 m_child_window_size;
 
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace YAVE
+{
+/**
+ * @brief A lock-free single-producer/single-consumer ring of interleaved float samples.
+ *
+ * Unlike SPSCRing it moves runs of samples instead of slots, and it never blocks or takes
+ * a mutex on either side, so the consumer can be a real-time audio callback. A producer
+ * that runs out of room has to poll. The indices only grow, the position in the storage
+ * is the index modulo the capacity.
+ *
+ * Both sides move whole sample frames when given the channel count. A partial frame would
+ * leave the interleaved channels rotated for the rest of the playback.
+ */
+class PCMRing
+{
+public:
+    explicit PCMRing(std::size_t capacity)
+        : m_samples(capacity)
+        , m_head(0)
+        , m_tail(0)
+        , m_flush_index(0)
+    {
+    }
+
+    PCMRing(const PCMRing&) = delete;
+    PCMRing& operator=(const PCMRing&) = delete;
+
+#pragma region Producer
+    /**
+     * @brief Copies as many whole frames as there is room for.
+     * @param frame_size The number of interleaved channels.
+     * @return The number of samples written.
+     */
+    std::size_t write(
+        const float* samples, std::size_t samples_nb, std::size_t frame_size = 1) noexcept
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t free_nb = capacity() - (tail - m_head.load(std::memory_order_acquire));
+
+        std::size_t count = std::min(samples_nb, free_nb);
+        count -= count % frame_size;
+
+        copy_in(tail, samples, count);
+        m_tail.store(tail + count, std::memory_order_release);
+
+        return count;
+    }
+#pragma endregion Producer
+
+#pragma region Consumer
+    /**
+     * @brief Copies up to samples_nb samples out in whole frames, skipping the ones written
+     *        before the last flush().
+     * @param frame_size The number of interleaved channels.
+     * @return The number of samples read.
+     */
+    std::size_t read(float* dest, std::size_t samples_nb, std::size_t frame_size = 1) noexcept
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        const std::size_t head = std::max(
+            m_head.load(std::memory_order_relaxed), m_flush_index.load(std::memory_order_acquire));
+
+        // A flush can't point past the samples it saw, but stay safe if the tail was reset.
+        const std::size_t start = std::min(head, tail);
+
+        std::size_t count = std::min(samples_nb, tail - start);
+        count -= count % frame_size;
+
+        copy_out(start, dest, count);
+        m_head.store(start + count, std::memory_order_release);
+
+        return count;
+    }
+
+    /**
+     * @brief The index of the next sample the consumer will read.
+     */
+    [[nodiscard]] inline std::size_t get_read_index() const noexcept
+    {
+        return m_head.load(std::memory_order_acquire);
+    }
+#pragma endregion Consumer
+
+    /**
+     * @brief Marks every sample written so far as stale. Safe to call from any thread.
+     */
+    void flush() noexcept
+    {
+        m_flush_index.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @brief The index after the last written sample.
+     */
+    [[nodiscard]] inline std::size_t get_write_index() const noexcept
+    {
+        return m_tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief The number of samples waiting for the consumer, stale ones included.
+     */
+    [[nodiscard]] inline std::size_t size() const noexcept
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] inline std::size_t capacity() const noexcept
+    {
+        return m_samples.size();
+    }
+
+private:
+    void copy_in(std::size_t index, const float* samples, std::size_t count) noexcept
+    {
+        const std::size_t offset = index % capacity();
+        const std::size_t first_nb = std::min(count, capacity() - offset);
+
+        std::memcpy(m_samples.data() + offset, samples, first_nb * sizeof(float));
+        std::memcpy(m_samples.data(), samples + first_nb, (count - first_nb) * sizeof(float));
+    }
+
+    void copy_out(std::size_t index, float* dest, std::size_t count) const noexcept
+    {
+        const std::size_t offset = index % capacity();
+        const std::size_t first_nb = std::min(count, capacity() - offset);
+
+        std::memcpy(dest, m_samples.data() + offset, first_nb * sizeof(float));
+        std::memcpy(dest + first_nb, m_samples.data(), (count - first_nb) * sizeof(float));
+    }
+
+    std::vector<float> m_samples;
+
+    alignas(64) std::atomic<std::size_t> m_head;
+    alignas(64) std::atomic<std::size_t> m_tail;
+    alignas(64) std::atomic<std::size_t> m_flush_index;
+};
+} // namespace YAVE
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace YAVE
+{
+/**
+ * @brief Publishes a small trivially copyable value that readers can take without a lock.
+ *
+ * A writer makes the sequence odd, stores the value and makes it even again. A reader
+ * retries whenever the sequence was odd or changed while it was copying, so it never sees
+ * half of an update. Writers don't wait for readers, and concurrent writers take turns
+ * through the sequence itself. The value is kept in relaxed atomic words, which makes the
+ * racy copy of a retried read well defined.
+ *
+ * @tparam T The published value, copied in and out with memcpy.
+ */
+template <typename T> class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied with memcpy.");
+
+public:
+    SeqLock()
+        : SeqLock(T{})
+    {
+    }
+
+    explicit SeqLock(const T& value)
+        : m_sequence(0)
+    {
+        store_words(value);
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /**
+     * @brief Takes a consistent copy of the latest value.
+     */
+    [[nodiscard]] T load() const noexcept
+    {
+        T value;
+
+        while (true) {
+            const std::uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+
+            if (sequence & 1) {
+                continue;
+            }
+
+            value = load_words();
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+                return value;
+            }
+        }
+    }
+
+    void store(const T& value) noexcept
+    {
+        update([&value](T& current) { current = value; });
+    }
+
+    /**
+     * @brief Changes the value in place. No reader or other writer sees the value between
+     *        the read and the write, so read-modify-write updates are never lost.
+     */
+    template <typename Function> void update(Function&& function) noexcept
+    {
+        const std::uint32_t sequence = lock();
+
+        T value = load_words();
+        function(value);
+        store_words(value);
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t WORDS_NB = (sizeof(T) + sizeof(std::uint64_t) - 1) /
+        sizeof(std::uint64_t);
+
+    [[nodiscard]] std::uint32_t lock() noexcept
+    {
+        std::uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+
+        while (true) {
+            if (!(sequence & 1) &&
+                m_sequence.compare_exchange_weak(
+                    sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                break;
+            }
+
+            sequence = m_sequence.load(std::memory_order_relaxed);
+        }
+
+        // The words must not be written before the odd sequence is visible.
+        std::atomic_thread_fence(std::memory_order_release);
+
+        return sequence;
+    }
+
+    [[nodiscard]] T load_words() const noexcept
+    {
+        std::array<std::uint64_t, WORDS_NB> words;
+
+        for (std::size_t i = 0; i < WORDS_NB; i++) {
+            words[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+
+        return value;
+    }
+
+    void store_words(const T& value) noexcept
+    {
+        std::array<std::uint64_t, WORDS_NB> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        for (std::size_t i = 0; i < WORDS_NB; i++) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<std::uint32_t> m_sequence;
+    std::array<std::atomic<std::uint64_t>, WORDS_NB> m_words;
+};
+} // namespace YAVE
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <SDL_mutex.h>
+
+namespace YAVE
+{
+/**
+ * @brief A bounded single-producer/single-consumer ring of pre-allocated slots.
+ *
+ * The producer and the consumer only touch their own index on the hot path, so
+ * neither side needs a mutex. The mutex and the condition variables are only
+ * used when a side decides to block until the other one makes progress.
+ *
+ * @tparam T The slot type. Slots are constructed once and reused.
+ */
+template <typename T> class SPSCRing
+{
+public:
+    explicit SPSCRing(std::size_t capacity)
+        : m_slots(capacity)
+        , m_head(0)
+        , m_tail(0)
+        , m_flush_index(0)
+        , m_data_waiters(0)
+        , m_space_waiters(0)
+        , m_mutex(SDL_CreateMutex())
+        , m_data_cond(SDL_CreateCond())
+        , m_space_cond(SDL_CreateCond())
+    {
+    }
+
+    ~SPSCRing()
+    {
+        SDL_DestroyCond(m_space_cond);
+        SDL_DestroyCond(m_data_cond);
+        SDL_DestroyMutex(m_mutex);
+    }
+
+    SPSCRing(const SPSCRing&) = delete;
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+#pragma region Producer
+    /**
+     * @brief Get the slot that will be published by the next commit().
+     * @return A pointer to the free slot, or nullptr if the ring is full.
+     */
+    [[nodiscard]] T* back() noexcept
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_head.load(std::memory_order_acquire) >= m_slots.size()) {
+            return nullptr;
+        }
+
+        return &m_slots[tail % m_slots.size()];
+    }
+
+    /**
+     * @brief Publishes the slot returned by back() to the consumer.
+     */
+    void commit() noexcept
+    {
+        m_tail.fetch_add(1, std::memory_order_release);
+        notify(m_data_waiters, m_data_cond);
+    }
+#pragma endregion Producer
+
+#pragma region Consumer
+    /**
+     * @brief Get the oldest published slot.
+     * @return A pointer to the slot, or nullptr if the ring is empty.
+     */
+    [[nodiscard]] T* front() noexcept
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        return &m_slots[head % m_slots.size()];
+    }
+
+    /**
+     * @brief Hands the slot returned by front() back to the producer.
+     */
+    void pop() noexcept
+    {
+        m_head.fetch_add(1, std::memory_order_release);
+        notify(m_space_waiters, m_space_cond);
+    }
+
+    /**
+     * @brief Checks if the front slot was published before the last flush().
+     * The consumer is responsible for releasing stale slots.
+     */
+    [[nodiscard]] bool is_front_stale() const noexcept
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        return head < m_flush_index.load(std::memory_order_acquire) &&
+            head != m_tail.load(std::memory_order_acquire);
+    }
+#pragma endregion Consumer
+
+    /**
+     * @brief Marks every published slot as stale. Safe to call from any thread.
+     */
+    void flush() noexcept
+    {
+        m_flush_index.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @brief Blocks until a slot is published or the timeout expires.
+     * @return true if the ring has data.
+     */
+    bool wait_for_data(int timeout_ms)
+    {
+        return wait(m_data_waiters, m_data_cond, timeout_ms, [this] { return !empty(); });
+    }
+
+    /**
+     * @brief Blocks until a slot is released or the timeout expires.
+     * @return true if the ring has a free slot.
+     */
+    bool wait_for_space(int timeout_ms)
+    {
+        return wait(m_space_waiters, m_space_cond, timeout_ms, [this] { return !full(); });
+    }
+
+    /**
+     * @brief Wakes up every blocked producer and consumer.
+     */
+    void wake_all()
+    {
+        SDL_LockMutex(m_mutex);
+        SDL_CondBroadcast(m_data_cond);
+        SDL_CondBroadcast(m_space_cond);
+        SDL_UnlockMutex(m_mutex);
+    }
+
+    [[nodiscard]] inline std::size_t size() const noexcept
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] inline std::size_t capacity() const noexcept
+    {
+        return m_slots.size();
+    }
+
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    [[nodiscard]] inline bool full() const noexcept
+    {
+        return size() >= m_slots.size();
+    }
+
+    /**
+     * @brief Direct access to the slot storage for one-time setup and teardown.
+     */
+    [[nodiscard]] inline std::vector<T>& slots() noexcept
+    {
+        return m_slots;
+    }
+
+private:
+    void notify(std::atomic<int>& waiters, SDL_cond* cond)
+    {
+        // Only pay for the mutex when the other side is actually sleeping.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (waiters.load() == 0) {
+            return;
+        }
+
+        SDL_LockMutex(m_mutex);
+        SDL_CondSignal(cond);
+        SDL_UnlockMutex(m_mutex);
+    }
+
+    template <typename Predicate>
+    bool wait(std::atomic<int>& waiters, SDL_cond* cond, int timeout_ms, Predicate is_ready)
+    {
+        if (is_ready()) {
+            return true;
+        }
+
+        SDL_LockMutex(m_mutex);
+        waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!is_ready()) {
+            SDL_CondWaitTimeout(cond, m_mutex, static_cast<Uint32>(timeout_ms));
+        }
+
+        waiters.fetch_sub(1);
+        SDL_UnlockMutex(m_mutex);
+
+        return is_ready();
+    }
+
+    std::vector<T> m_slots;
+
+    alignas(64) std::atomic<std::size_t> m_head;
+    alignas(64) std::atomic<std::size_t> m_tail;
+    alignas(64) std::atomic<std::size_t> m_flush_index;
+
+    std::atomic<int> m_data_waiters;
+    std::atomic<int> m_space_waiters;
+
+    SDL_mutex* m_mutex;
+    SDL_cond* m_data_cond;
+    SDL_cond* m_space_cond;
+};
+} // namespace YAVE
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace YAVE
+{
+/**
+ * @brief A lock-free single-writer/single-reader triple buffer.
+ *
+ * The writer fills the back slot and publishes it, which swaps it with the middle slot.
+ * The reader swaps the middle slot with its front slot whenever something new was
+ * published. Both sides always own one slot exclusively, so the writer never waits for
+ * the reader, the reader always sees the latest complete slot, and nothing is copied.
+ * A slot that gets published again before the reader took the previous one overwrites
+ * it, which is counted as skipped.
+ *
+ * @tparam T The slot type. Slots are constructed once and reused.
+ */
+template <typename T> class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : m_slots{}
+        , m_state(MIDDLE_INDEX)
+        , m_back_index(BACK_INDEX)
+        , m_front_index(FRONT_INDEX)
+        , m_published_nb(0)
+        , m_consumed_nb(0)
+        , m_overwritten_nb(0)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+#pragma region Writer
+    /**
+     * @brief Get the slot the writer owns.
+     */
+    [[nodiscard]] inline T& back() noexcept
+    {
+        return m_slots[m_back_index];
+    }
+
+    /**
+     * @brief Hands the back slot to the reader and takes the middle slot as the new back.
+     * @return true if the reader never took the previously published slot.
+     */
+    bool publish() noexcept
+    {
+        const std::uint8_t previous_state =
+            m_state.exchange(static_cast<std::uint8_t>(m_back_index | IS_DIRTY),
+                std::memory_order_acq_rel);
+
+        m_back_index = previous_state & INDEX_MASK;
+        m_published_nb.fetch_add(1, std::memory_order_relaxed);
+
+        const bool is_overwritten = previous_state & IS_DIRTY;
+
+        if (is_overwritten) {
+            m_overwritten_nb.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return is_overwritten;
+    }
+#pragma endregion Writer
+
+#pragma region Reader
+    /**
+     * @brief Takes the latest published slot as the new front, if there is one.
+     * @return true if front() changed.
+     */
+    bool update() noexcept
+    {
+        if (!(m_state.load(std::memory_order_relaxed) & IS_DIRTY)) {
+            return false;
+        }
+
+        const std::uint8_t previous_state =
+            m_state.exchange(m_front_index, std::memory_order_acq_rel);
+
+        m_front_index = previous_state & INDEX_MASK;
+        m_consumed_nb.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Get the slot the reader owns.
+     */
+    [[nodiscard]] inline T& front() noexcept
+    {
+        return m_slots[m_front_index];
+    }
+#pragma endregion Reader
+
+    /**
+     * @brief The number of slots published, taken by the reader and overwritten unread.
+     */
+    [[nodiscard]] inline std::uint64_t get_published_nb() const noexcept
+    {
+        return m_published_nb.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline std::uint64_t get_consumed_nb() const noexcept
+    {
+        return m_consumed_nb.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] inline std::uint64_t get_overwritten_nb() const noexcept
+    {
+        return m_overwritten_nb.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Direct access to the slot storage for one-time setup and teardown,
+     *        only while neither side is running.
+     */
+    [[nodiscard]] inline std::array<T, 3>& slots() noexcept
+    {
+        return m_slots;
+    }
+
+private:
+    static constexpr std::uint8_t BACK_INDEX = 0;
+    static constexpr std::uint8_t MIDDLE_INDEX = 1;
+    static constexpr std::uint8_t FRONT_INDEX = 2;
+
+    // The middle index lives in the low bits, the flag says it holds an unread slot.
+    static constexpr std::uint8_t INDEX_MASK = 0x3;
+    static constexpr std::uint8_t IS_DIRTY = 0x4;
+
+    std::array<T, 3> m_slots;
+
+    std::atomic<std::uint8_t> m_state;
+    std::uint8_t m_back_index;  ///< Only touched by the writer.
+    std::uint8_t m_front_index; ///< Only touched by the reader.
+
+    std::atomic<std::uint64_t> m_published_nb;
+    std::atomic<std::uint64_t> m_consumed_nb;
+    std::atomic<std::uint64_t> m_overwritten_nb;
+};
+} // namespace YAVE
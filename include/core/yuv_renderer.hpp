@@ -0,0 +1,86 @@
+#pragma once
+
+#define NO_SDL_GLEXT
+#define GLEW_STATIC
+
+#include <GL/glew.h>
+
+#include "core/backend/color_conversion.hpp"
+
+namespace YAVE
+{
+/**
+ * @brief Converts decoded YUV frames to RGBA on the GPU.
+ *
+ * The planes are uploaded as they come out of the decoder (1.5 bytes per pixel for 4:2:0
+ * instead of 4 for RGBA) and a fragment shader writes the RGB result into the preview
+ * texture through a framebuffer object. The shader does the integer math of the CPU
+ * kernels, so both paths produce the same pixels. Only OpenGL 3.3 core features are used,
+ * so the path also runs on software implementations like Mesa llvmpipe.
+ *
+ * Every method has to be called on the thread that owns the GL context.
+ */
+class YUVRenderer
+{
+public:
+    YUVRenderer() = default;
+    ~YUVRenderer();
+
+    YUVRenderer(const YUVRenderer&) = delete;
+    YUVRenderer& operator=(const YUVRenderer&) = delete;
+
+    /**
+     * @brief Compiles the shaders and creates the plane textures.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    int init();
+
+    /**
+     * @brief Uploads the planes of a frame and draws the converted picture into a texture.
+     *        The texture is (re)allocated as RGBA8 when its size differs from the frame.
+     * @param frame A frame that ColorConverter::is_supported() accepts.
+     * @param dest_texture The texture that receives the RGBA picture.
+     * @return 0 <= for success, a negative integer for error.
+     */
+    int render(const AVFrame* frame, GLuint dest_texture);
+
+    /**
+     * @brief Whether the shaders were built, i.e. if the planar preview can be turned on.
+     */
+    [[nodiscard]] inline static bool is_available() noexcept
+    {
+        return s_IsAvailable;
+    }
+
+private:
+    enum PlaneIndex : int { LUMA_PLANE = 0, U_PLANE, V_PLANE, PLANES_NB };
+
+    [[nodiscard]] static GLuint compile_shader(GLenum type, const char* source);
+    [[nodiscard]] static GLuint link_program(GLuint vertex_shader, GLuint fragment_shader);
+
+    /**
+     * @brief Uploads one plane, reallocating the texture when the plane size changed.
+     */
+    void upload_plane(int index, const std::uint8_t* data, int linesize, int width, int height,
+        bool is_two_channels);
+
+    int attach_target(GLuint dest_texture, int width, int height);
+
+    void release();
+
+    GLuint m_program = 0;
+    GLuint m_vertex_array = 0;
+    GLuint m_framebuffer = 0;
+
+    GLuint m_plane_textures[PLANES_NB] = { 0, 0, 0 };
+    int m_plane_widths[PLANES_NB] = { 0, 0, 0 };
+    int m_plane_heights[PLANES_NB] = { 0, 0, 0 };
+    bool m_plane_is_two_channels[PLANES_NB] = { false, false, false };
+
+    GLint m_luma_range_location = -1;
+    GLint m_chroma_coefficients_location = -1;
+    GLint m_is_semi_planar_location = -1;
+
+    static bool s_IsAvailable;
+};
+} // namespace YAVE
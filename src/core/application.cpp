@@ -3,7 +3,9 @@
 #include "core/debugger.hpp"
 #include "core/importer.hpp"
 #include "core/scene_editor.hpp"
+#include "core/texture_uploader.hpp"
 #include "core/timeline.hpp"
+#include "core/yuv_renderer.hpp"
 
 namespace YAVE
 {
@@ -18,12 +20,20 @@ Application::Application()
     , m_style_config(UIStyleConfig(15.f, 1.0f))
     , m_waveform_loader(std::make_unique<WaveformLoader>())
     , m_current_subtitle_gizmo(std::make_unique<SubtitleGizmo>())
+    , m_yuv_renderer(std::make_unique<YUVRenderer>())
+    , m_texture_uploader(std::make_unique<TextureUploader>())
+    , m_planar_frame(nullptr)
     , m_video_loading_thread(nullptr)
 {
 }
 
 Application::~Application()
 {
+    // These own GL objects, they have to go before the context.
+    m_yuv_renderer.reset();
+    m_texture_uploader.reset();
+    av_frame_free(&m_planar_frame);
+
     ImGui_ImplSDL2_Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
 
@@ -211,6 +221,13 @@ int Application::init()
     glEnable(GL_TEXTURE_2D);
     glEnable(GL_DEPTH_TEST);
 
+    if (m_yuv_renderer->init() < 0) {
+        std::cerr << "The planar preview is unavailable, frames are converted on the CPU.\n";
+    }
+
+    // Falls back to the direct upload on its own.
+    m_texture_uploader->init();
+
     init_imgui(glsl_version);
     init_video_processor();
 
@@ -238,6 +255,7 @@ void Application::update()
         exporter->update();
 
         debugger->time_base = av_q2d(s_Timebase);
+        debugger->texture_upload = m_texture_uploader->get_stats();
     }
 
     last_time = time;
@@ -258,19 +276,6 @@ void Application::refresh_thumbnails()
     delete url;
 }
 
-void Application::seek_to_requested_timestamp()
-{
-    const auto* requested_timestamp = static_cast<float*>(m_event.user.data1);
-    bool result = m_video_processor->seek_frame(static_cast<float>(*requested_timestamp),
-        m_video_processor->get_flags() & VideoFlags::IS_PAUSED);
-
-    if (result != 0) {
-        std::cerr << "Failed to jump to timestamp: " << *requested_timestamp << "\n";
-    }
-
-    delete requested_timestamp;
-}
-
 void Application::refresh_timeline_waveform()
 {
     auto* waveform_data = static_cast<Waveform*>(m_event.user.data1);
@@ -282,31 +287,67 @@ void Application::refresh_timeline_waveform()
 
 void Application::update_texture()
 {
-    static int last_width = m_video_size.width;
-    static int last_height = m_video_size.height;
-
-    auto& framebuffer = m_video_processor->get_framebuffer();
+    auto& framebuffers = m_video_processor->get_framebuffers();
 
-    if (!framebuffer) {
+    // Several refresh events can be pending for one frame, only upload new frames. The
+    // follow-up event of the last upload still hands its pending frame to the texture.
+    if (!framebuffers.update() || !framebuffers.front().data) {
+        m_texture_uploader->flush();
         return;
     }
 
+    // The aspect ratio comes from the source, the preview frame may be smaller.
     auto video_state = m_video_processor->video_state();
     m_video_size.width = video_state->dimensions.x;
     m_video_size.height = video_state->dimensions.y;
 
-    if (m_video_size.width != last_width || m_video_size.height != last_height) {
-        glTexImage2D(GL_TEXTURE_2D, 0, s_PreferredImageFormat, m_video_size.width,
-            m_video_size.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, framebuffer);
+    const PreviewFramebuffer& framebuffer = framebuffers.front();
+
+    // Goes through the pixel buffer ring when it's available, the texture is reallocated
+    // on a size change.
+    m_texture_uploader->upload(framebuffer.data, framebuffer.dimensions.x,
+        framebuffer.dimensions.y, s_PreferredImageFormat);
 
-        last_width = m_video_size.width;
-        last_height = m_video_size.height;
+    // The frame only reaches the texture on the next refresh, one has to come even when the
+    // video is paused. It is handled after this frame is rendered, which leaves the transfer
+    // of the previous frame time to run.
+    if (m_texture_uploader->has_pending_frame()) {
+        VideoPlayer::refresh_texture();
+    }
+}
+
+void Application::update_planar_texture()
+{
+    if (!m_planar_frame) {
+        m_planar_frame = av_frame_alloc();
+    }
+
+    // Take the frame over so the presenter can share the next one during the upload.
+    SDL_LockMutex(VideoPlayer::s_Locks->preview_frame);
 
+    if (m_planar_frame && VideoPlayer::s_PreviewFrame) {
+        av_frame_unref(m_planar_frame);
+        av_frame_move_ref(m_planar_frame, VideoPlayer::s_PreviewFrame);
+    }
+
+    SDL_UnlockMutex(VideoPlayer::s_Locks->preview_frame);
+
+    // An older event already picked this frame up.
+    if (!m_planar_frame || !m_planar_frame->data[0]) {
         return;
     }
 
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_video_size.width, m_video_size.height, GL_RGBA,
-        GL_UNSIGNED_BYTE, framebuffer);
+    init_video_texture();
+
+    if (m_yuv_renderer->render(m_planar_frame, s_FrameTexID) < 0) {
+        std::cerr << "Failed to render the planar preview, switching back to RGBA.\n";
+        VideoPlayer::s_UsePlanarPreview = false;
+    } else {
+        m_video_size.width = m_planar_frame->width;
+        m_video_size.height = m_planar_frame->height;
+    }
+
+    av_frame_unref(m_planar_frame);
 }
 
 #pragma endregion Event Callbacks
@@ -318,8 +359,11 @@ void Application::enqueue_video_request(const std::string& filename, const float
     auto* video_preview_request = new VideoPreviewRequest();
     video_preview_request->path = filename.c_str();
     video_preview_request->presentation_timestamp = timestamp;
+
+    SDL_LockMutex(VideoPlayer::s_Locks->file_queue);
     VideoPlayer::s_VideoFileQueue.push_back(video_preview_request);
     SDL_CondSignal(m_video_processor->s_VideoAvailabilityCond);
+    SDL_UnlockMutex(VideoPlayer::s_Locks->file_queue);
 }
 
 [[nodiscard]] const std::int64_t Application::get_file_duration(const std::string& filename) const
@@ -489,20 +533,40 @@ int Application::file_loading_listener(void* userdata)
 {
     auto& video_processor = *static_cast<std::shared_ptr<VideoPlayer>*>(userdata);
 
+    auto& locks = *VideoPlayer::s_Locks;
+
     while (Application::s_IsRunning) {
-        SDL_LockMutex(PacketQueue::s_GlobalMutex);
+        SDL_LockMutex(locks.file_queue);
 
         if (VideoPlayer::s_VideoFileQueue.empty()) {
-            SDL_CondWait(VideoPlayer::s_VideoAvailabilityCond, PacketQueue::s_GlobalMutex);
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+            SDL_CondWait(VideoPlayer::s_VideoAvailabilityCond, locks.file_queue);
+            SDL_UnlockMutex(locks.file_queue);
             continue;
         }
 
         auto* latest_video = VideoPlayer::s_VideoFileQueue.front();
+        VideoPlayer::s_VideoFileQueue.pop_front();
+
+        SDL_UnlockMutex(locks.file_queue);
+
         auto current_video_state = video_processor->video_state();
 
+        // Switching the input touches every stream, so take the locks in their documented order.
+        SDL_LockMutex(locks.demuxer);
+        SDL_LockMutex(locks.video_codec);
+        SDL_LockMutex(locks.audio_codec);
+
         VideoPlayer::switch_input(&current_video_state->av_format_ctx, latest_video->path);
 
+        // The reverse decoder opens the file on its own.
+        video_processor->filename() = latest_video->path;
+
+        // The new file plays from its start, whatever the last seek was.
+        current_video_state->seek_target_pts = 0.0;
+
+        // The audio device comes last in the lock order, so it is restarted with the codec
+        // locks held. Closing it waits for the audio callback, which only drains the PCM ring
+        // and never takes a lock.
         if (video_processor->restart_audio_thread() < 0) {
             std::cout << "Failed to restart the audio thread.\n";
         };
@@ -511,14 +575,17 @@ int Application::file_loading_listener(void* userdata)
             std::cout << "Failed to initialize the codecs.\n";
         };
 
+        SDL_UnlockMutex(locks.audio_codec);
+        SDL_UnlockMutex(locks.video_codec);
+
         video_processor->get_duration() += current_video_state->av_format_ctx->duration;
         video_processor->update_video_dimensions();
 
-        VideoPlayer::s_VideoFileQueue.pop_front();
+        SDL_UnlockMutex(locks.demuxer);
 
         current_video_state->current_pts = 0.0;
 
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        delete latest_video;
     }
 
     return 0;
@@ -538,10 +605,32 @@ void Application::render_video_preview()
     const ImVec2& display_max = maintain_video_aspect_ratio(&display_min);
     const auto& tex_id_ptr = static_cast<uintptr_t>(s_FrameTexID);
 
+    // The presenter scales the frames down to what is actually visible (in real pixels).
+    const ImVec2& framebuffer_scale = ImGui::GetIO().DisplayFramebufferScale;
+    m_video_processor->set_preview_viewport(
+        static_cast<int>(display_max.x * framebuffer_scale.x),
+        static_cast<int>(display_max.y * framebuffer_scale.y));
+
     draw_list->AddImage(
         reinterpret_cast<ImTextureID>(tex_id_ptr), display_min, display_min + display_max);
     render_subtitles(display_min, display_max);
 
+    if (ImGui::BeginPopupContextWindow("Preview Quality")) {
+        constexpr std::array<PreviewQuality, 4> qualities = { PreviewQuality::FIT,
+            PreviewQuality::FULL, PreviewQuality::HALF, PreviewQuality::QUARTER };
+
+        const PreviewQuality current_quality = m_video_processor->get_preview_quality();
+
+        for (const auto quality : qualities) {
+            if (ImGui::MenuItem(VideoPlayer::preview_quality_to_string(quality), nullptr,
+                    quality == current_quality)) {
+                m_video_processor->set_preview_quality(quality);
+            }
+        }
+
+        ImGui::EndPopup();
+    }
+
     ImGui::End();
 }
 
@@ -605,6 +694,11 @@ bool Application::handle_custom_events()
 
     switch (m_event.type) {
     case CustomVideoEvents::FF_REFRESH_VIDEO_EVENT:
+        if (static_cast<FrameRefreshType>(m_event.user.code) == FrameRefreshType::PLANAR_FRAME) {
+            update_planar_texture();
+            break;
+        }
+
         glBindTexture(GL_TEXTURE_2D, s_FrameTexID);
         update_texture();
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -643,8 +737,12 @@ bool Application::handle_custom_events()
         m_video_processor->toggle_audio();
         break;
 
-    case CustomVideoEvents::FF_SEEK_TO_TIMESTAMP_EVENT:
-        seek_to_requested_timestamp();
+    case CustomVideoEvents::FF_SHUTTLE_EVENT:
+        m_video_processor->shuttle(static_cast<ShuttleCommand>(m_event.user.code));
+        break;
+
+    case CustomVideoEvents::FF_STEP_FRAME_EVENT:
+        m_video_processor->step_frame(static_cast<FrameStep>(m_event.user.code));
         break;
 
     default:
@@ -0,0 +1,193 @@
+#include "core/backend/audio_conversion.hpp"
+
+#include <cstring>
+
+namespace YAVE
+{
+namespace
+{
+[[nodiscard]] bool is_layout(std::uint64_t channel_layout, std::uint64_t expected_layout)
+{
+    return channel_layout == expected_layout;
+}
+
+[[nodiscard]] bool is_51_layout(std::uint64_t channel_layout)
+{
+    return is_layout(channel_layout, AV_CH_LAYOUT_5POINT1) ||
+        is_layout(channel_layout, AV_CH_LAYOUT_5POINT1_BACK);
+}
+
+template <typename Sample>
+void interleave_planar(const AudioConversionJob& job, float scale)
+{
+    for (int channel = 0; channel < job.channels_nb; ++channel) {
+        const auto* src = reinterpret_cast<const Sample*>(job.src[channel]);
+        float* dest = job.dest + channel;
+
+        for (int i = 0; i < job.samples_nb; ++i) {
+            dest[i * job.channels_nb] = static_cast<float>(src[i]) * scale;
+        }
+    }
+}
+
+template <typename Sample> void convert_packed(const AudioConversionJob& job, float scale)
+{
+    const auto* src = reinterpret_cast<const Sample*>(job.src[0]);
+    const int total_nb = job.samples_nb * job.channels_nb;
+
+    for (int i = 0; i < total_nb; ++i) {
+        job.dest[i] = static_cast<float>(src[i]) * scale;
+    }
+}
+} // namespace
+
+#pragma region Dispatch
+AudioKernel AudioConverter::get_kernel(const ResamplerKey& key)
+{
+    if (key.in_sample_rate != key.out_sample_rate || key.out_sample_format != AV_SAMPLE_FMT_FLT) {
+        return nullptr;
+    }
+
+    const ConversionISA isa = ColorConverter::get_active_isa();
+
+    if (key.in_channel_layout != key.out_channel_layout) {
+        const bool is_downmix = key.in_sample_format == AV_SAMPLE_FMT_FLTP &&
+            is_51_layout(key.in_channel_layout) &&
+            is_layout(key.out_channel_layout, AV_CH_LAYOUT_STEREO);
+
+        if (!is_downmix) {
+            return nullptr;
+        }
+
+        switch (isa) {
+#ifdef YAVE_ARCH_X86
+        case ConversionISA::AVX2:
+            return &AudioKernels::downmix_51_avx2;
+        case ConversionISA::SSE41:
+            return &AudioKernels::downmix_51_sse41;
+#endif
+        default:
+            return &AudioKernels::downmix_51_scalar;
+        }
+    }
+
+    switch (key.in_sample_format) {
+    case AV_SAMPLE_FMT_FLT:
+        return &AudioKernels::copy_flt;
+    case AV_SAMPLE_FMT_S16P:
+        return &AudioKernels::interleave_s16p_scalar;
+    case AV_SAMPLE_FMT_S32P:
+        return &AudioKernels::interleave_s32p_scalar;
+    default:
+        break;
+    }
+
+#ifdef YAVE_ARCH_X86
+    if (isa == ConversionISA::AVX2) {
+        switch (key.in_sample_format) {
+        case AV_SAMPLE_FMT_FLTP:
+            return &AudioKernels::interleave_fltp_avx2;
+        case AV_SAMPLE_FMT_S16:
+            return &AudioKernels::convert_s16_avx2;
+        case AV_SAMPLE_FMT_S32:
+            return &AudioKernels::convert_s32_avx2;
+        default:
+            return nullptr;
+        }
+    }
+
+    if (isa == ConversionISA::SSE41) {
+        switch (key.in_sample_format) {
+        case AV_SAMPLE_FMT_FLTP:
+            return &AudioKernels::interleave_fltp_sse41;
+        case AV_SAMPLE_FMT_S16:
+            return &AudioKernels::convert_s16_sse41;
+        case AV_SAMPLE_FMT_S32:
+            return &AudioKernels::convert_s32_sse41;
+        default:
+            return nullptr;
+        }
+    }
+#endif
+
+    switch (key.in_sample_format) {
+    case AV_SAMPLE_FMT_FLTP:
+        return &AudioKernels::interleave_fltp_scalar;
+    case AV_SAMPLE_FMT_S16:
+        return &AudioKernels::convert_s16_scalar;
+    case AV_SAMPLE_FMT_S32:
+        return &AudioKernels::convert_s32_scalar;
+    default:
+        return nullptr;
+    }
+}
+
+int AudioConverter::convert(const ResamplerKey& key, const AVFrame* av_frame, float* dest)
+{
+    const AudioKernel kernel = get_kernel(key);
+
+    if (!kernel || av_frame->nb_samples <= 0) {
+        return -1;
+    }
+
+    AudioConversionJob job;
+    job.src = av_frame->extended_data;
+    job.dest = dest;
+    job.samples_nb = av_frame->nb_samples;
+    job.channels_nb = av_frame->channels;
+
+    kernel(job);
+
+    return job.samples_nb;
+}
+
+std::uint64_t AudioConverter::get_stereo_downmix_layout(std::uint64_t channel_layout)
+{
+    return is_51_layout(channel_layout) ? AV_CH_LAYOUT_STEREO : channel_layout;
+}
+#pragma endregion Dispatch
+
+#pragma region Scalar Kernels
+void AudioKernels::copy_flt(const AudioConversionJob& job)
+{
+    std::memcpy(job.dest, job.src[0],
+        static_cast<std::size_t>(job.samples_nb) * job.channels_nb * sizeof(float));
+}
+
+void AudioKernels::interleave_fltp_scalar(const AudioConversionJob& job)
+{
+    // Mono is already interleaved.
+    if (job.channels_nb == 1) {
+        copy_flt(job);
+        return;
+    }
+
+    interleave_planar<float>(job, 1.0f);
+}
+
+void AudioKernels::convert_s16_scalar(const AudioConversionJob& job)
+{
+    convert_packed<std::int16_t>(job, S16_TO_FLOAT_SCALE);
+}
+
+void AudioKernels::convert_s32_scalar(const AudioConversionJob& job)
+{
+    convert_packed<std::int32_t>(job, S32_TO_FLOAT_SCALE);
+}
+
+void AudioKernels::interleave_s16p_scalar(const AudioConversionJob& job)
+{
+    interleave_planar<std::int16_t>(job, S16_TO_FLOAT_SCALE);
+}
+
+void AudioKernels::interleave_s32p_scalar(const AudioConversionJob& job)
+{
+    interleave_planar<std::int32_t>(job, S32_TO_FLOAT_SCALE);
+}
+
+void AudioKernels::downmix_51_scalar(const AudioConversionJob& job)
+{
+    downmix_51_tail(job, 0, job.samples_nb);
+}
+#pragma endregion Scalar Kernels
+} // namespace YAVE
@@ -0,0 +1,229 @@
+#include "core/backend/audio_conversion.hpp"
+
+#ifdef YAVE_ARCH_X86
+
+#include <immintrin.h>
+
+namespace YAVE
+{
+#pragma region SSE4.1
+YAVE_TARGET_SSE41 void AudioKernels::interleave_fltp_sse41(const AudioConversionJob& job)
+{
+    // Only stereo is worth a shuffle, mono is a copy and the rest is rare enough.
+    if (job.channels_nb != 2) {
+        interleave_fltp_scalar(job);
+        return;
+    }
+
+    constexpr int BLOCK_SIZE = 4;
+
+    const auto* left = reinterpret_cast<const float*>(job.src[0]);
+    const auto* right = reinterpret_cast<const float*>(job.src[1]);
+
+    int i = 0;
+
+    for (; i + BLOCK_SIZE <= job.samples_nb; i += BLOCK_SIZE) {
+        const __m128 l = _mm_loadu_ps(left + i);
+        const __m128 r = _mm_loadu_ps(right + i);
+
+        _mm_storeu_ps(job.dest + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(job.dest + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+
+    for (; i < job.samples_nb; ++i) {
+        job.dest[2 * i] = left[i];
+        job.dest[2 * i + 1] = right[i];
+    }
+}
+
+YAVE_TARGET_SSE41 void AudioKernels::convert_s16_sse41(const AudioConversionJob& job)
+{
+    constexpr int BLOCK_SIZE = 8;
+
+    const auto* src = reinterpret_cast<const std::int16_t*>(job.src[0]);
+    const int total_nb = job.samples_nb * job.channels_nb;
+    const __m128 scale = _mm_set1_ps(S16_TO_FLOAT_SCALE);
+
+    int i = 0;
+
+    for (; i + BLOCK_SIZE <= total_nb; i += BLOCK_SIZE) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i lo = _mm_cvtepi16_epi32(samples);
+        const __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(samples, 8));
+
+        _mm_storeu_ps(job.dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(job.dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+
+    for (; i < total_nb; ++i) {
+        job.dest[i] = static_cast<float>(src[i]) * S16_TO_FLOAT_SCALE;
+    }
+}
+
+YAVE_TARGET_SSE41 void AudioKernels::convert_s32_sse41(const AudioConversionJob& job)
+{
+    constexpr int BLOCK_SIZE = 4;
+
+    const auto* src = reinterpret_cast<const std::int32_t*>(job.src[0]);
+    const int total_nb = job.samples_nb * job.channels_nb;
+    const __m128 scale = _mm_set1_ps(S32_TO_FLOAT_SCALE);
+
+    int i = 0;
+
+    for (; i + BLOCK_SIZE <= total_nb; i += BLOCK_SIZE) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(job.dest + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+
+    for (; i < total_nb; ++i) {
+        job.dest[i] = static_cast<float>(src[i]) * S32_TO_FLOAT_SCALE;
+    }
+}
+
+YAVE_TARGET_SSE41 void AudioKernels::downmix_51_sse41(const AudioConversionJob& job)
+{
+    constexpr int BLOCK_SIZE = 4;
+
+    const auto* fl = reinterpret_cast<const float*>(job.src[0]);
+    const auto* fr = reinterpret_cast<const float*>(job.src[1]);
+    const auto* fc = reinterpret_cast<const float*>(job.src[2]);
+    const auto* sl = reinterpret_cast<const float*>(job.src[4]);
+    const auto* sr = reinterpret_cast<const float*>(job.src[5]);
+
+    const __m128 center_level = _mm_set1_ps(DOWNMIX_CENTER_LEVEL);
+    const __m128 surround_level = _mm_set1_ps(DOWNMIX_SURROUND_LEVEL);
+
+    int i = 0;
+
+    // Same order of operations as the scalar tail, so both give the same samples.
+    for (; i + BLOCK_SIZE <= job.samples_nb; i += BLOCK_SIZE) {
+        const __m128 center = _mm_mul_ps(_mm_loadu_ps(fc + i), center_level);
+
+        const __m128 left = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(fl + i), center),
+            _mm_mul_ps(_mm_loadu_ps(sl + i), surround_level));
+        const __m128 right = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(fr + i), center),
+            _mm_mul_ps(_mm_loadu_ps(sr + i), surround_level));
+
+        _mm_storeu_ps(job.dest + 2 * i, _mm_unpacklo_ps(left, right));
+        _mm_storeu_ps(job.dest + 2 * i + 4, _mm_unpackhi_ps(left, right));
+    }
+
+    downmix_51_tail(job, i, job.samples_nb);
+}
+#pragma endregion SSE4.1
+
+#pragma region AVX2
+YAVE_TARGET_AVX2 void AudioKernels::interleave_fltp_avx2(const AudioConversionJob& job)
+{
+    if (job.channels_nb != 2) {
+        interleave_fltp_scalar(job);
+        return;
+    }
+
+    constexpr int BLOCK_SIZE = 8;
+
+    const auto* left = reinterpret_cast<const float*>(job.src[0]);
+    const auto* right = reinterpret_cast<const float*>(job.src[1]);
+
+    int i = 0;
+
+    for (; i + BLOCK_SIZE <= job.samples_nb; i += BLOCK_SIZE) {
+        const __m256 l = _mm256_loadu_ps(left + i);
+        const __m256 r = _mm256_loadu_ps(right + i);
+
+        // The unpacks work per 128-bit lane, the permutes put the halves back in order.
+        const __m256 lo = _mm256_unpacklo_ps(l, r);
+        const __m256 hi = _mm256_unpackhi_ps(l, r);
+
+        _mm256_storeu_ps(job.dest + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(job.dest + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+
+    for (; i < job.samples_nb; ++i) {
+        job.dest[2 * i] = left[i];
+        job.dest[2 * i + 1] = right[i];
+    }
+}
+
+YAVE_TARGET_AVX2 void AudioKernels::convert_s16_avx2(const AudioConversionJob& job)
+{
+    constexpr int BLOCK_SIZE = 16;
+
+    const auto* src = reinterpret_cast<const std::int16_t*>(job.src[0]);
+    const int total_nb = job.samples_nb * job.channels_nb;
+    const __m256 scale = _mm256_set1_ps(S16_TO_FLOAT_SCALE);
+
+    int i = 0;
+
+    for (; i + BLOCK_SIZE <= total_nb; i += BLOCK_SIZE) {
+        const __m256i lo = _mm256_cvtepi16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        const __m256i hi = _mm256_cvtepi16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+
+        _mm256_storeu_ps(job.dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(job.dest + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+
+    for (; i < total_nb; ++i) {
+        job.dest[i] = static_cast<float>(src[i]) * S16_TO_FLOAT_SCALE;
+    }
+}
+
+YAVE_TARGET_AVX2 void AudioKernels::convert_s32_avx2(const AudioConversionJob& job)
+{
+    constexpr int BLOCK_SIZE = 8;
+
+    const auto* src = reinterpret_cast<const std::int32_t*>(job.src[0]);
+    const int total_nb = job.samples_nb * job.channels_nb;
+    const __m256 scale = _mm256_set1_ps(S32_TO_FLOAT_SCALE);
+
+    int i = 0;
+
+    for (; i + BLOCK_SIZE <= total_nb; i += BLOCK_SIZE) {
+        const __m256i samples =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_ps(job.dest + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+
+    for (; i < total_nb; ++i) {
+        job.dest[i] = static_cast<float>(src[i]) * S32_TO_FLOAT_SCALE;
+    }
+}
+
+YAVE_TARGET_AVX2 void AudioKernels::downmix_51_avx2(const AudioConversionJob& job)
+{
+    constexpr int BLOCK_SIZE = 8;
+
+    const auto* fl = reinterpret_cast<const float*>(job.src[0]);
+    const auto* fr = reinterpret_cast<const float*>(job.src[1]);
+    const auto* fc = reinterpret_cast<const float*>(job.src[2]);
+    const auto* sl = reinterpret_cast<const float*>(job.src[4]);
+    const auto* sr = reinterpret_cast<const float*>(job.src[5]);
+
+    const __m256 center_level = _mm256_set1_ps(DOWNMIX_CENTER_LEVEL);
+    const __m256 surround_level = _mm256_set1_ps(DOWNMIX_SURROUND_LEVEL);
+
+    int i = 0;
+
+    for (; i + BLOCK_SIZE <= job.samples_nb; i += BLOCK_SIZE) {
+        const __m256 center = _mm256_mul_ps(_mm256_loadu_ps(fc + i), center_level);
+
+        const __m256 left = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(fl + i), center),
+            _mm256_mul_ps(_mm256_loadu_ps(sl + i), surround_level));
+        const __m256 right = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(fr + i), center),
+            _mm256_mul_ps(_mm256_loadu_ps(sr + i), surround_level));
+
+        const __m256 lo = _mm256_unpacklo_ps(left, right);
+        const __m256 hi = _mm256_unpackhi_ps(left, right);
+
+        _mm256_storeu_ps(job.dest + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(job.dest + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+
+    downmix_51_tail(job, i, job.samples_nb);
+}
+#pragma endregion AVX2
+} // namespace YAVE
+
+#endif
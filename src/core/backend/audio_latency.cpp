@@ -0,0 +1,218 @@
+#include "core/backend/audio_latency.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace YAVE
+{
+namespace
+{
+// A callback this many periods after the previous one most likely left a gap. Backends
+// that mix in larger periods than ours call back in pairs, so twice the period is normal.
+constexpr double LATE_CALLBACK_RATIO = 3.0;
+
+// Longer gaps come from a paused or reopened device, not from a slow machine.
+constexpr double MAX_CALLBACK_GAP = 0.5;
+
+// How long the underruns after a seek, a pause or a reopened device are ignored.
+constexpr double HOLD_DURATION = 0.5;
+
+// The time a step is kept before the next step up, and how long the playback has to run
+// without an underrun before a step down.
+constexpr double GROW_COOLDOWN = 1.0;
+constexpr double SHRINK_STABLE_PERIOD = 15.0;
+
+constexpr std::array<int, static_cast<int>(AudioLatency::COUNT)> LATENCY_MS = { 5, 10, 20, 40,
+    80 };
+
+[[nodiscard]] AudioLatency step_latency(AudioLatency latency, int direction) noexcept
+{
+    const int step = std::clamp(static_cast<int>(latency) + direction, 0,
+        static_cast<int>(AudioLatency::COUNT) - 1);
+
+    return static_cast<AudioLatency>(step);
+}
+} // namespace
+
+void AudioLatencyController::record_callback(double current_time, bool is_underrun) noexcept
+{
+    const double gap = current_time - m_last_callback_time;
+    const double period = m_device_period.load(std::memory_order_relaxed);
+
+    const bool is_late = m_last_callback_time >= 0.0 && period > 0.0 &&
+        gap > period * LATE_CALLBACK_RATIO && gap < MAX_CALLBACK_GAP;
+
+    m_last_callback_time = current_time;
+
+    if ((!is_underrun && !is_late) ||
+        current_time < m_hold_until.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    if (is_underrun) {
+        m_underruns_nb.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_late_callbacks_nb.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const auto second = static_cast<std::int64_t>(std::floor(current_time));
+    const auto bin = static_cast<std::size_t>(second % UNDERRUN_HISTORY_SECONDS);
+
+    // The bin still counts a second of the previous minute.
+    if (m_history_seconds[bin].load(std::memory_order_relaxed) != second) {
+        m_history[bin].store(0, std::memory_order_relaxed);
+        m_history_seconds[bin].store(second, std::memory_order_relaxed);
+    }
+
+    m_history[bin].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool AudioLatencyController::update(double current_time) noexcept
+{
+    const AudioLatency requested = get_requested();
+    const AudioLatency effective = get_effective();
+
+    // A new setting applies right away, in either direction.
+    if (m_is_requested_changed.exchange(false, std::memory_order_relaxed)) {
+        m_last_underrun_time = current_time;
+
+        if (requested != effective) {
+            set_effective(requested, current_time);
+            return true;
+        }
+
+        return false;
+    }
+
+    const std::uint64_t underruns_nb = m_underruns_nb.load(std::memory_order_relaxed) +
+        m_late_callbacks_nb.load(std::memory_order_relaxed);
+
+    if (underruns_nb != m_seen_underruns_nb) {
+        m_seen_underruns_nb = underruns_nb;
+        m_last_underrun_time = current_time;
+
+        if (effective != step_latency(effective, 1) &&
+            current_time - m_last_change_time >= GROW_COOLDOWN) {
+            set_effective(step_latency(effective, 1), current_time);
+            m_grows_nb.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    const bool is_stable = current_time - m_last_underrun_time >= SHRINK_STABLE_PERIOD &&
+        current_time - m_last_change_time >= SHRINK_STABLE_PERIOD;
+
+    if (effective > requested && is_stable) {
+        set_effective(step_latency(effective, -1), current_time);
+        m_shrinks_nb.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+void AudioLatencyController::set_device_buffer(int samples, int sample_rate) noexcept
+{
+    m_device_samples.store(samples, std::memory_order_relaxed);
+    m_device_period.store(sample_rate > 0 ? static_cast<double>(samples) / sample_rate : 0.0,
+        std::memory_order_relaxed);
+}
+
+void AudioLatencyController::hold(double current_time) noexcept
+{
+    m_hold_until.store(current_time + HOLD_DURATION, std::memory_order_relaxed);
+}
+
+void AudioLatencyController::set_requested(AudioLatency latency) noexcept
+{
+    m_requested.store(std::min(latency, MAX_SELECTABLE_AUDIO_LATENCY), std::memory_order_relaxed);
+    m_is_requested_changed.store(true, std::memory_order_relaxed);
+}
+
+int AudioLatencyController::get_buffer_samples(int sample_rate) const noexcept
+{
+    const int wanted_samples =
+        std::max(latency_to_ms(get_effective()) * sample_rate / 1000, 1);
+
+    // Some SDL backends only take powers of two.
+    int samples = 1;
+
+    while (samples < wanted_samples) {
+        samples <<= 1;
+    }
+
+    return samples;
+}
+
+AudioLatencyStats AudioLatencyController::get_stats() const noexcept
+{
+    AudioLatencyStats stats;
+    stats.requested = get_requested();
+    stats.effective = get_effective();
+    stats.device_samples = m_device_samples.load(std::memory_order_relaxed);
+    stats.device_latency_ms = m_device_period.load(std::memory_order_relaxed) * 1000.0;
+    stats.underruns_nb = m_underruns_nb.load(std::memory_order_relaxed);
+    stats.late_callbacks_nb = m_late_callbacks_nb.load(std::memory_order_relaxed);
+    stats.grows_nb = m_grows_nb.load(std::memory_order_relaxed);
+    stats.shrinks_nb = m_shrinks_nb.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+std::array<float, UNDERRUN_HISTORY_SECONDS> AudioLatencyController::get_history(
+    double current_time) const noexcept
+{
+    std::array<float, UNDERRUN_HISTORY_SECONDS> history{};
+
+    const auto current_second = static_cast<std::int64_t>(std::floor(current_time));
+
+    for (int i = 0; i < UNDERRUN_HISTORY_SECONDS; ++i) {
+        const std::int64_t second = current_second - (UNDERRUN_HISTORY_SECONDS - 1) + i;
+
+        if (second < 0) {
+            continue;
+        }
+
+        const auto bin = static_cast<std::size_t>(second % UNDERRUN_HISTORY_SECONDS);
+
+        if (m_history_seconds[bin].load(std::memory_order_relaxed) == second) {
+            history[i] = static_cast<float>(m_history[bin].load(std::memory_order_relaxed));
+        }
+    }
+
+    return history;
+}
+
+int AudioLatencyController::latency_to_ms(AudioLatency latency) noexcept
+{
+    const int index =
+        std::clamp(static_cast<int>(latency), 0, static_cast<int>(AudioLatency::COUNT) - 1);
+
+    return LATENCY_MS[index];
+}
+
+const char* AudioLatencyController::latency_to_string(AudioLatency latency)
+{
+    switch (latency) {
+    case AudioLatency::MS_5:
+        return "5 ms";
+    case AudioLatency::MS_10:
+        return "10 ms";
+    case AudioLatency::MS_40:
+        return "40 ms";
+    case AudioLatency::MS_80:
+        return "80 ms";
+    case AudioLatency::MS_20:
+    default:
+        return "20 ms";
+    }
+}
+
+void AudioLatencyController::set_effective(AudioLatency latency, double current_time) noexcept
+{
+    m_effective.store(latency, std::memory_order_relaxed);
+    m_last_change_time = current_time;
+}
+} // namespace YAVE
@@ -1,16 +1,17 @@
 #include "core/backend/audio_player.hpp"
 #include "core/application.hpp"
+#include "core/backend/audio_conversion.hpp"
 #include "core/backend/packet_queue.hpp"
 
 namespace YAVE
 {
-SwrContext* AudioPlayer::s_Resampler_Context = nullptr;
 
 AVFrame* AudioPlayer::s_LatestFrame = nullptr;
 AVPacket* AudioPlayer::s_LatestPacket = nullptr;
 
 SDL_cond* AudioPlayer::s_FrameAvailabilityCond = nullptr;
 SDL_cond* AudioPlayer::s_VideoPausedCond = nullptr;
+SDL_cond* AudioPlayer::s_PresenterParkedCond = nullptr;
 SDL_cond* AudioPlayer::s_VideoAvailabilityCond = nullptr;
 
 StreamMap AudioPlayer::s_StreamList = {};
@@ -18,11 +19,21 @@ StreamMap AudioPlayer::s_StreamList = {};
 // Initialize the clock network.
 std::unique_ptr<ClockNetwork> AudioPlayer::s_ClockNetwork = std::make_unique<ClockNetwork>();
 
-std::unique_ptr<AudioBufferInfo> AudioPlayer::s_AudioBufferInfo =
-    std::make_unique<AudioBufferInfo>();
-
 std::unique_ptr<PacketQueue> AudioPlayer::s_AudioPacketQueue = std::make_unique<PacketQueue>();
 
+std::unique_ptr<PCMRing> AudioPlayer::s_PCMRing = std::make_unique<PCMRing>(
+    static_cast<std::size_t>(MAX_AUDIO_RING_MS) * MAX_AUDIO_SAMPLE_RATE / 1000 *
+    MAX_AUDIO_CHANNELS);
+
+SeqLock<PCMRingPosition> AudioPlayer::s_PCMRingPosition;
+std::atomic<int> AudioPlayer::s_AudioRingTargetMs = DEFAULT_AUDIO_RING_MS;
+std::atomic<std::uint64_t> AudioPlayer::s_AudioUnderrunsNb = 0;
+
+std::unique_ptr<AudioLatencyController> AudioPlayer::s_AudioLatency =
+    std::make_unique<AudioLatencyController>();
+
+std::unique_ptr<PlaybackLocks> AudioPlayer::s_Locks = std::make_unique<PlaybackLocks>();
+
 AudioPlayer::AudioPlayer()
     : m_audio_state(std::make_shared<AudioState>())
     , m_device_info(std::make_unique<AudioDeviceInfo>())
@@ -31,52 +42,10 @@ AudioPlayer::AudioPlayer()
 
 #pragma region Init Functions
 
-int AudioPlayer::init_swr_ctx(AVFrame* av_frame, SampleRate sample_rate)
-{
-    static bool is_sw_resample_ctx_initialized = false;
-
-    if (is_sw_resample_ctx_initialized) {
-        return 0;
-    }
-
-    const int64_t channel_layout = av_get_default_channel_layout(av_frame->channels);
-
-    s_Resampler_Context = swr_alloc();
-    if (!s_Resampler_Context) {
-        std::cerr << "Failed to allocate memory for the resampler context.\n";
-        return -1;
-    }
-
-    swr_alloc_set_opts(s_Resampler_Context, channel_layout, AV_SAMPLE_FMT_FLT, sample_rate.first,
-        channel_layout, AV_SAMPLE_FMT_FLTP, sample_rate.second, 0, nullptr);
-
-    int init_result = swr_init(s_Resampler_Context);
-
-    if (init_result >= 0) {
-        is_sw_resample_ctx_initialized = true;
-        return 0;
-    }
-
-    std::cout << "Failed to initialize the resampler context: " << av_error_to_string(init_result)
-              << "\n";
-
-    swr_free(&s_Resampler_Context);
-    return -1;
-}
-
-int AudioPlayer::guess_correct_buffer_size(const StreamInfoPtr& stream_info)
-{
-    if (~stream_info->av_codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) {
-        return stream_info->av_codec_ctx->frame_size;
-    }
-
-    return 0;
-}
-
-int AudioPlayer::init_sdl_mixer(int num_channels, int nb_samples)
+int AudioPlayer::init_sdl_mixer(int num_channels)
 {
     const auto& stream_info = s_StreamList.at("Audio");
-    auto& [device_id, spec, wanted_spec] = *m_device_info;
+    auto& wanted_spec = m_device_info->wanted_spec;
 
     SDL_memset(&wanted_spec, 0, sizeof(wanted_spec));
 
@@ -84,15 +53,6 @@ int AudioPlayer::init_sdl_mixer(int num_channels, int nb_samples)
     wanted_spec.format = AUDIO_F32;
     wanted_spec.channels = num_channels;
     wanted_spec.silence = 0;
-
-    const int fixed_buffer_size = guess_correct_buffer_size(stream_info);
-
-    if (fixed_buffer_size <= 0) {
-        wanted_spec.samples = nb_samples;
-    } else {
-        wanted_spec.samples = fixed_buffer_size;
-    }
-
     wanted_spec.callback = &audio_callback;
 
     m_audio_state->flags &= ~AudioFlags::IS_INPUT_CHANGED;
@@ -103,7 +63,23 @@ int AudioPlayer::init_sdl_mixer(int num_channels, int nb_samples)
         m_audio_state->latest_audio_packet = av_packet_alloc();
     }
 
+    // The audio stream decodes into its own frame so it never shares one with the video.
+    if (!m_audio_state->latest_audio_frame) {
+        m_audio_state->latest_audio_frame = av_frame_alloc();
+    }
+
     wanted_spec.userdata = m_audio_state.get();
+    m_audio_state->device_info = m_device_info.get();
+
+    return open_audio_device(m_audio_state.get(), false);
+}
+
+int AudioPlayer::open_audio_device(AudioState* userdata, bool should_pause)
+{
+    auto& [device_id, spec, wanted_spec] = *userdata->device_info;
+
+    // The buffer follows the latency setting, not the codec frame size.
+    wanted_spec.samples = static_cast<Uint16>(s_AudioLatency->get_buffer_samples(wanted_spec.freq));
 
     device_id = SDL_OpenAudioDevice(nullptr, 0, &wanted_spec, &spec, SDL_AUDIO_ALLOW_FORMAT_CHANGE);
 
@@ -112,97 +88,207 @@ int AudioPlayer::init_sdl_mixer(int num_channels, int nb_samples)
         return -1;
     }
 
-    SDL_PauseAudioDevice(device_id, 0);
+    s_AudioLatency->set_device_buffer(spec.samples, spec.freq);
+    s_AudioLatency->hold(FramePacer::now());
+
+    SDL_PauseAudioDevice(device_id, should_pause);
 
     return 0;
 }
 
+void AudioPlayer::reopen_audio_device(AudioState* userdata)
+{
+    SDL_LockMutex(s_Locks->audio_device);
+
+    // The player closed the device in the meantime, e.g. to switch the input.
+    if (userdata->device_info && userdata->device_info->device_id != 0) {
+        SDL_CloseAudioDevice(userdata->device_info->device_id);
+        userdata->device_info->device_id = 0;
+
+        // The ring keeps its samples, the callback picks up where the old device stopped.
+        open_audio_device(userdata, userdata->flags & AudioFlags::IS_PAUSED);
+    }
+
+    SDL_UnlockMutex(s_Locks->audio_device);
+}
+
 #pragma endregion Init Functions
 
 #pragma region Frame Processing
 
-int AudioPlayer::update_audio_stream(AudioState* userdata, Uint8* sdl_stream, int& len)
+int AudioPlayer::convert_audio_frame(AudioState* userdata)
 {
-    if (userdata->flags & AudioFlags::IS_MUTED) {
-        std::memset(sdl_stream, 0, len);
-        len = 0;
-        return 0;
+    AVFrame* audio_frame = userdata->latest_audio_frame;
+
+    const auto num_samples = audio_frame->nb_samples;
+    const auto num_channels = AUDIO_OUTPUT_CHANNELS_NB;
+
+    if (num_samples <= 0) {
+        return -1;
     }
 
-    const auto num_samples = s_LatestFrame->nb_samples;
-    const auto num_channels = s_LatestFrame->channels;
-    const auto out_samples = swr_get_out_samples(s_Resampler_Context, num_samples);
-    const AVSampleFormat sample_format = userdata->av_codec_ctx->sample_fmt;
+    // The device is opened at the rate of the stream, only the layout in memory and the
+    // channels change. The drift compensation needs the resampler, even when the rates match.
+    ResamplerKey key = ResamplerKey::from_frame(
+        audio_frame, AV_SAMPLE_FMT_FLT, audio_frame->sample_rate, SWR_FLAG_RESAMPLE);
+    key.out_channel_layout = AUDIO_OUTPUT_CHANNEL_LAYOUT;
 
-    auto buffer_size =
-        av_samples_get_buffer_size(nullptr, num_channels, num_samples, sample_format, 1);
+    userdata->resampler = userdata->resamplers.acquire(key);
 
-    if (buffer_size < 0) {
-        std::array<char, AV_ERROR_MAX_STRING_SIZE> err_buf = { 0 };
-        av_strerror(buffer_size, err_buf.data(), err_buf.size());
-        std::cerr << "Error obtaining audio buffer size: " << err_buf.data() << "\n";
+    if (!userdata->resampler) {
         return -1;
     }
 
-    if (!av_sample_fmt_is_planar(sample_format)) {
-        if (synchronize_audio(userdata, reinterpret_cast<float*>(s_LatestFrame->data[0]),
-                num_samples, &buffer_size) != 0) {
-            return -1;
-        };
+    // The compensation has to be set before the frame goes through the resampler.
+    const int sample_delta = synchronize_audio(userdata, num_samples);
+
+    // Without a stretch to apply, the frame only has to be interleaved.
+    if (sample_delta == 0) {
+        const int converted_samples = convert_without_resampler(userdata, key);
+
+        if (converted_samples >= 0) {
+            return converted_samples * num_channels * static_cast<int>(sizeof(float));
+        }
+    }
 
-        const int nonplanar_sample_size =
-            sizeof(decltype(*s_LatestFrame->data)) / AV_NUM_DATA_POINTERS;
+    // swr_get_out_samples() doesn't know about the compensation. The buffer only ever grows.
+    const int out_samples =
+        swr_get_out_samples(userdata->resampler.get(), num_samples) + std::abs(sample_delta);
+    const auto samples_nb = static_cast<std::size_t>(out_samples) * num_channels;
 
-        const int sample_per_ch_size = nonplanar_sample_size * userdata->av_codec_ctx->channels;
+    if (userdata->samples.size() < samples_nb) {
+        userdata->samples.resize(samples_nb);
+    }
 
-        const int bytes_per_sec = sample_per_ch_size * userdata->av_codec_ctx->sample_rate;
+    AudioResamplingState resampling_data = { &userdata->samples, num_samples, num_channels,
+        out_samples };
 
-        s_ClockNetwork->audio_internal_clock +=
-            static_cast<double>(buffer_size) / static_cast<double>(bytes_per_sec);
+    const int converted_samples =
+        resample_audio(userdata->resampler.get(), audio_frame, resampling_data);
 
-        userdata->pts = s_ClockNetwork->audio_internal_clock;
+    if (converted_samples < 0) {
+        return -1;
+    }
 
-        s_AudioBufferInfo->channel_nb = userdata->av_codec_ctx->channels;
-        s_AudioBufferInfo->buffer_size = buffer_size;
-        s_AudioBufferInfo->sample_rate = s_LatestFrame->sample_rate;
-        s_AudioBufferInfo->buffer_index = 0;
+    return converted_samples * num_channels * static_cast<int>(sizeof(float));
+}
 
-        std::memcpy(sdl_stream, s_LatestFrame->data[0], buffer_size);
-        len = 0;
+void AudioPlayer::stretch_audio_samples(
+    AudioState* userdata, int buffer_size, double playback_rate, unsigned int serial)
+{
+    const AVFrame* audio_frame = userdata->latest_audio_frame;
+    const int channels_nb = AUDIO_OUTPUT_CHANNELS_NB;
 
-        return 0;
+    if (audio_frame->sample_rate <= 0) {
+        return;
     }
 
-    std::vector<float> resampled_audio_buffer(out_samples * num_channels);
+    // What atempo still holds from before a seek doesn't belong to the new position.
+    if (userdata->stretcher_serial != serial) {
+        userdata->stretcher.reset();
+        userdata->stretcher_serial = serial;
+    }
 
-    AudioResamplingState resampling_data = { &resampled_audio_buffer, num_samples, num_channels,
-        out_samples };
+    const StretcherFormat format = { audio_frame->sample_rate, channels_nb, playback_rate };
+    const int response = userdata->stretcher.configure(format);
 
-    resample_audio(s_LatestFrame, resampling_data);
+    if (response < 0) {
+        return;
+    }
 
-    if (synchronize_audio(userdata, resampled_audio_buffer.data(), num_samples, &buffer_size) !=
-        0) {
-        return -1;
-    };
+    // A new graph starts the stretched timeline over at this frame.
+    if (response > 0) {
+        userdata->stretched_pts = userdata->next_pts;
+    }
 
-    static const auto bytes_per_sample = sizeof(decltype(resampled_audio_buffer)::value_type);
-    const int sample_per_ch_size = bytes_per_sample * userdata->av_codec_ctx->channels;
-    const int bytes_per_sec = sample_per_ch_size * userdata->av_codec_ctx->sample_rate;
+    const int frames_nb = buffer_size / (channels_nb * static_cast<int>(sizeof(float)));
+    const int stretched_nb = userdata->stretcher.process(
+        userdata->samples.data(), frames_nb, userdata->stretched_samples);
 
-    s_ClockNetwork->audio_internal_clock +=
-        static_cast<double>(buffer_size) / static_cast<double>(bytes_per_sec);
+    if (stretched_nb <= 0) {
+        return;
+    }
 
-    userdata->pts = s_ClockNetwork->audio_internal_clock;
+    const double duration =
+        static_cast<double>(stretched_nb) * playback_rate / audio_frame->sample_rate;
 
-    s_AudioBufferInfo->channel_nb = userdata->av_codec_ctx->channels;
-    s_AudioBufferInfo->buffer_size = buffer_size;
-    s_AudioBufferInfo->sample_rate = s_LatestFrame->sample_rate;
-    s_AudioBufferInfo->buffer_index = 0;
+    write_audio_samples(userdata, userdata->stretched_samples.data(),
+        userdata->stretched_samples.size(), userdata->stretched_pts, duration, serial);
 
-    std::memcpy(sdl_stream, resampled_audio_buffer.data(), buffer_size);
-    len = 0;
+    userdata->stretched_pts += duration;
+}
 
-    return 0;
+void AudioPlayer::write_audio_samples(AudioState* userdata, const float* samples,
+    std::size_t samples_nb, double start_pts, double duration, unsigned int serial)
+{
+    const AVFrame* audio_frame = userdata->latest_audio_frame;
+    const auto channels_nb = static_cast<std::size_t>(AUDIO_OUTPUT_CHANNELS_NB);
+    const double samples_per_sec = static_cast<double>(channels_nb) * audio_frame->sample_rate;
+
+    // The converters only produce whole frames, a trailing partial one couldn't be written.
+    samples_nb -= samples_nb % channels_nb;
+
+    if (samples_per_sec <= 0.0 || samples_nb == 0) {
+        return;
+    }
+
+    // The drift compensation and the playback rate stretch the samples, not the media time.
+    const double sample_duration = duration / static_cast<double>(samples_nb);
+
+    std::size_t written_nb = 0;
+
+    while (written_nb < samples_nb && Application::s_IsRunning) {
+        // The queue was cleared while this frame was decoded, e.g. by a seek.
+        if (s_AudioPacketQueue->getSerial() != serial) {
+            return;
+        }
+
+        // Whole sample frames, so the ring never holds a partial one.
+        auto target_nb = std::min(
+            static_cast<std::size_t>(samples_per_sec * s_AudioRingTargetMs / 1000.0),
+            s_PCMRing->capacity());
+        target_nb -= target_nb % channels_nb;
+
+        const std::size_t buffered_nb = s_PCMRing->size();
+
+        std::size_t count = buffered_nb < target_nb
+            ? std::min(samples_nb - written_nb, target_nb - buffered_nb)
+            : 0;
+        count -= count % channels_nb;
+
+        if (count == 0) {
+            SDL_Delay(AUDIO_RING_WAIT_MS);
+            continue;
+        }
+
+        // Published first, so the callback never reads samples without their timestamp.
+        s_PCMRingPosition.store(PCMRingPosition{ s_PCMRing->get_write_index() + count,
+            start_pts + static_cast<double>(written_nb + count) * sample_duration,
+            sample_duration, AUDIO_OUTPUT_CHANNELS_NB, audio_frame->sample_rate });
+
+        written_nb += s_PCMRing->write(samples + written_nb, count, channels_nb);
+    }
+}
+
+std::array<float, UNDERRUN_HISTORY_SECONDS> AudioPlayer::get_underrun_history()
+{
+    return s_AudioLatency->get_history(FramePacer::now());
+}
+
+PCMRingStats AudioPlayer::get_audio_ring_stats()
+{
+    PCMRingStats stats;
+    stats.target_ms = s_AudioRingTargetMs;
+    stats.underruns_nb = s_AudioUnderrunsNb.load(std::memory_order_relaxed);
+
+    const PCMRingPosition position = s_PCMRingPosition.load();
+    const double samples_per_ms = position.channel_nb * position.sample_rate / 1000.0;
+
+    if (samples_per_ms > 0.0) {
+        stats.buffered_ms = static_cast<double>(s_PCMRing->size()) / samples_per_ms;
+    }
+
+    return stats;
 }
 
 std::optional<AVFrame*> AudioPlayer::get_first_audio_frame(
@@ -242,111 +328,125 @@ std::optional<AVFrame*> AudioPlayer::get_first_audio_frame(
 
 #pragma region Sample Correction
 
-int AudioPlayer::add_dummy_samples(
-    float* samples, int* samples_size, int wanted_size, int max_size, const int total_sample_bytes)
+int AudioPlayer::synchronize_audio(struct AudioState* audio_state, int out_samples)
 {
-    // Check for sufficient buffer size before adding samples
-    int additional_samples = (*samples_size - wanted_size);
-    const int required_size = *samples_size + additional_samples;
-
-    if (required_size > max_size) {
-        std::cerr << "Error: Buffer size exceeds allocated memory" << std::endl;
-        return -1;
-    }
-
-    // Apply sample correction by replaying the last audio sample
-    auto* samples_uint8 = reinterpret_cast<uint8_t*>(samples);
+    const double delta_internal_clock =
+        s_ClockNetwork->get_audio_clock() - s_ClockNetwork->get_video_clock();
 
-    auto* last_sample_ptr = samples_uint8 + *samples_size - total_sample_bytes;
-    auto* next_sample_ptr = last_sample_ptr + total_sample_bytes;
+    const int sample_delta =
+        audio_state->drift_compensator.update(delta_internal_clock, out_samples);
 
-    while (additional_samples > 0) {
-        std::memcpy(next_sample_ptr, last_sample_ptr, total_sample_bytes);
-        next_sample_ptr += total_sample_bytes;
-        additional_samples -= total_sample_bytes;
+    // Also called without a delta, so the previous compensation doesn't carry over.
+    if (swr_set_compensation(audio_state->resampler.get(), sample_delta, out_samples) < 0) {
+        return 0;
     }
 
-    return 0;
+    return sample_delta;
 }
 
-int AudioPlayer::synchronize_audio(
-    struct AudioState* audio_state, float* samples, int num_samples, int* samples_size)
+#pragma endregion Sample Correction
+
+#pragma region Audio Callback
+void AudioPlayer::audio_callback(void* t_userdata, Uint8* stream, int len)
 {
-    const double delta_internal_clock =
-        s_ClockNetwork->audio_internal_clock - s_ClockNetwork->video_internal_clock;
+    auto* userdata = static_cast<AudioState*>(t_userdata);
+    auto* dest = reinterpret_cast<float*>(stream);
 
-    double avg_diff = 0.0;
+    const std::size_t wanted_nb = static_cast<std::size_t>(len) / sizeof(float);
 
-    const auto sample_rate = audio_state->av_codec_ctx->sample_rate;
-    const int num_channels = audio_state->av_codec_ctx->channels;
-    const int sample_size = sizeof(decltype(*samples));
+    // A short read on an underrun still ends on a whole frame of the device.
+    const std::size_t device_channels_nb =
+        userdata->device_info ? std::max<std::size_t>(userdata->device_info->spec.channels, 1) : 1;
+    const std::size_t read_nb = s_PCMRing->read(dest, wanted_nb, device_channels_nb);
 
-    if (delta_internal_clock >= 1.0) {
-        audio_state->audio_diff_avg_count = 0;
-        audio_state->delta_accum = 0;
-        return 0;
+    if (read_nb < wanted_nb) {
+        std::memset(dest + read_nb, 0, (wanted_nb - read_nb) * sizeof(float));
+
+        // Only running dry in the middle of playback counts, not waiting for the first samples.
+        if (userdata->is_ring_primed) {
+            s_AudioUnderrunsNb.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
-    audio_state->delta_accum =
-        delta_internal_clock + AV_DIFFERENCE_AVG_COEF * audio_state->delta_accum;
+    s_AudioLatency->record_callback(
+        FramePacer::now(), userdata->is_ring_primed && read_nb < wanted_nb);
 
-    if (audio_state->audio_diff_avg_count < AV_DIFFERENCE_COUNT) {
-        audio_state->audio_diff_avg_count++;
-        return 0;
-    }
+    userdata->is_ring_primed = read_nb == wanted_nb;
 
-    avg_diff = audio_state->delta_accum * (1.0 - AV_DIFFERENCE_AVG_COEF);
+    // The samples are still consumed, so the clock keeps running while muted.
+    if (userdata->flags & AudioFlags::IS_MUTED) {
+        std::memset(stream, 0, len);
+    }
 
-    // If the difference is small, don't adjust the samples.
-    if (std::abs(avg_diff) < SYNC_THRESHOLD) {
-        return 0;
+    if (read_nb == 0) {
+        return;
     }
 
-    // Calculate the ideal buffer size to successfully synchronize the audio.
-    const int total_sample_bytes = num_channels * sample_size;
+    const PCMRingPosition position = s_PCMRingPosition.load();
+    const double samples_per_sec = static_cast<double>(position.channel_nb) * position.sample_rate;
 
-    int wanted_size =
-        *samples_size + (static_cast<int>(delta_internal_clock * sample_rate) * total_sample_bytes);
+    // In media time, a sample covers more or less than its device time away from 1x.
+    const double sample_duration =
+        position.sample_duration > 0.0 ? position.sample_duration : 1.0 / samples_per_sec;
 
-    const int min_size = calculate_bounds(*samples_size, false);
-    const int max_size = calculate_bounds(*samples_size, true);
+    // The timestamp of the end of this buffer, counted back from the end of the ring.
+    const double pts = position.pts -
+        (static_cast<double>(position.write_index) -
+            static_cast<double>(s_PCMRing->get_read_index())) *
+            sample_duration;
 
-    wanted_size = std::clamp(wanted_size, min_size, max_size);
+    const AudioBufferInfo buffer_info = { position.channel_nb,
+        static_cast<int>(read_nb * sizeof(float)), position.sample_rate, 0 };
 
-    // Remove samples if the video is late
-    if (wanted_size < *samples_size) {
-        *samples_size = wanted_size;
-        return 0;
-    }
+    s_ClockNetwork->update_audio_clock(pts, static_cast<double>(read_nb) * sample_duration,
+        buffer_info, sample_duration * samples_per_sec);
 
-    add_dummy_samples(samples, samples_size, wanted_size, max_size, total_sample_bytes);
+    userdata->pts = pts;
+}
 
-    *samples_size = wanted_size;
+int AudioPlayer::decode_audio_ahead(void* data)
+{
+    auto* userdata = static_cast<AudioState*>(data);
 
-    return 0;
-}
+    while (Application::s_IsRunning) {
+        // Resizing the device buffer takes a few milliseconds, the ring covers them.
+        if (s_AudioLatency->update(FramePacer::now())) {
+            reopen_audio_device(userdata);
+        }
 
-#pragma endregion Sample Correction
+        // Taken before the packet, so a seek while the frame is decoded drops its samples.
+        const unsigned int serial = s_AudioPacketQueue->getSerial();
 
-#pragma region Audio Callback
-void AudioPlayer::audio_callback(void* t_userdata, Uint8* stream, int len)
-{
-    auto* userdata = static_cast<AudioState*>(t_userdata);
+        if (decode_audio_packet(userdata, userdata->latest_audio_packet) < 0) {
+            continue;
+        }
 
-    while (len > 0) {
-        int result = decode_audio_packet(userdata, userdata->latest_audio_packet);
+        const int buffer_size = convert_audio_frame(userdata);
 
-        if (result < 0) {
-            std::memset(stream, 0, len);
-            break;
+        if (buffer_size <= 0) {
+            continue;
         }
 
-        init_swr_ctx(s_LatestFrame, userdata->sample_rate);
+        const AVFrame* audio_frame = userdata->latest_audio_frame;
+        const double start_pts = userdata->next_pts;
+        const double frame_duration =
+            static_cast<double>(audio_frame->nb_samples) / audio_frame->sample_rate;
 
-        if (update_audio_stream(userdata, stream, len) != 0) {
-            break;
+        const double playback_rate = s_ClockNetwork->get_playback_rate();
+
+        if (playback_rate == 1.0) {
+            userdata->stretcher.reset();
+            write_audio_samples(userdata, userdata->samples.data(),
+                static_cast<std::size_t>(buffer_size) / sizeof(float), start_pts,
+                frame_duration, serial);
+        } else {
+            stretch_audio_samples(userdata, buffer_size, playback_rate, serial);
         }
+
+        userdata->next_pts = start_pts + frame_duration;
     }
+
+    return 0;
 }
 #pragma endregion Audio Callback
 
@@ -354,55 +454,49 @@ void AudioPlayer::audio_callback(void* t_userdata, Uint8* stream, int len)
 
 int AudioPlayer::decode_audio_packet(struct AudioState* userdata, AVPacket* audio_packet)
 {
-    SDL_LockMutex(PacketQueue::s_GlobalMutex);
-
-    const auto& stream_info = s_StreamList.at("Audio");
-
-    if (s_AudioPacketQueue->dequeue(audio_packet) != 0) {
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
-        av_packet_unref(audio_packet);
+    // Waits a little for the demuxer, the ring covers the callback in the meantime.
+    if (!audio_packet || s_AudioPacketQueue->dequeue(audio_packet) != 0) {
         return -1;
     }
 
-    if (!audio_packet) {
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
-        av_packet_unref(audio_packet);
-        return -1;
-    }
+    SDL_LockMutex(s_Locks->audio_codec);
+
+    const auto& stream_info = s_StreamList.at("Audio");
 
     int response = avcodec_send_packet(stream_info->av_codec_ctx, audio_packet);
 
     if (response == AVERROR(EAGAIN)) {
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        SDL_UnlockMutex(s_Locks->audio_codec);
         av_packet_unref(audio_packet);
         return -1;
     }
 
     if (response < 0 || response == AVERROR_EOF) {
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        SDL_UnlockMutex(s_Locks->audio_codec);
         av_packet_unref(audio_packet);
         return -1;
     }
 
+    // Packets without a timestamp continue from the end of the previous frame.
     if (audio_packet->pts != AV_NOPTS_VALUE) {
-        s_ClockNetwork->audio_internal_clock = av_q2d(stream_info->timebase) * audio_packet->pts;
+        userdata->next_pts = av_q2d(stream_info->timebase) * audio_packet->pts;
     }
 
-    response = avcodec_receive_frame(stream_info->av_codec_ctx, s_LatestFrame);
+    response = avcodec_receive_frame(stream_info->av_codec_ctx, userdata->latest_audio_frame);
 
     if (response == AVERROR(EAGAIN)) {
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        SDL_UnlockMutex(s_Locks->audio_codec);
         av_packet_unref(audio_packet);
         return -1;
     }
 
     if (response < 0 || response == AVERROR_EOF) {
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        SDL_UnlockMutex(s_Locks->audio_codec);
         av_packet_unref(audio_packet);
         return -1;
     }
 
-    SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+    SDL_UnlockMutex(s_Locks->audio_codec);
     av_packet_unref(audio_packet);
     return 0;
 }
@@ -415,40 +509,88 @@ void AudioPlayer::toggle_audio()
     m_audio_state->flags ^= AudioFlags::IS_MUTED;
 }
 
-void AudioPlayer::resample_audio(AVFrame* frame, struct AudioResamplingState data)
+int AudioPlayer::resample_audio(
+    SwrContext* resampler, AVFrame* frame, struct AudioResamplingState data)
 {
-    if (!s_Resampler_Context) {
+    if (!resampler) {
         std::cerr << "Resampler context is not initialized.\n";
-        return;
+        return -1;
     }
 
     std::array<float*, 1> out_data = { data.audio_buffer->data() };
     auto extended_data_ptr = const_cast<const uint8_t**>(frame->extended_data);
 
-    int ret = swr_convert(s_Resampler_Context, reinterpret_cast<uint8_t**>(out_data.data()),
+    int ret = swr_convert(resampler, reinterpret_cast<uint8_t**>(out_data.data()),
         data.out_samples, extended_data_ptr, data.num_samples);
 
     if (ret < 0) {
         std::array<char, AV_ERROR_MAX_STRING_SIZE> err_buf = { 0 };
         av_strerror(ret, err_buf.data(), err_buf.size());
 
-        std::cerr << "Failed to convert the audio data from planar to interleaved: "
-                  << err_buf.data() << "\n";
+        std::cerr << "Failed to convert the audio data to interleaved: " << err_buf.data()
+                  << "\n";
 
-        return;
+        return -1;
+    }
+
+    return ret;
+}
+int AudioPlayer::convert_without_resampler(AudioState* userdata, const ResamplerKey& key)
+{
+    const AVFrame* audio_frame = userdata->latest_audio_frame;
+    SwrContext* resampler = userdata->resampler.get();
+
+    if (!AudioConverter::get_kernel(key)) {
+        return -1;
+    }
+
+    const auto num_channels = AUDIO_OUTPUT_CHANNELS_NB;
+
+    // The resampler may still hold the end of the last corrected frame, it goes out first.
+    const int flushed_nb = drain_resampler(resampler, key, userdata->samples);
+
+    if (flushed_nb < 0) {
+        return -1;
+    }
+
+    const auto samples_nb =
+        static_cast<std::size_t>(flushed_nb + audio_frame->nb_samples) * num_channels;
+
+    if (userdata->samples.size() < samples_nb) {
+        userdata->samples.resize(samples_nb);
     }
+
+    float* dest = userdata->samples.data() + static_cast<std::size_t>(flushed_nb) * num_channels;
+    const int converted_nb = AudioConverter::convert(key, audio_frame, dest);
+
+    if (converted_nb < 0) {
+        return -1;
+    }
+
+    return flushed_nb + converted_nb;
 }
 #pragma endregion Helper Functions
 
 #pragma region Deallocation
 void AudioPlayer::free_sdl_mixer()
 {
+    SDL_LockMutex(s_Locks->audio_device);
     SDL_CloseAudioDevice(m_device_info->device_id);
-    SDL_DestroyMutex(PacketQueue::s_GlobalMutex);
+    m_device_info->device_id = 0;
+    SDL_UnlockMutex(s_Locks->audio_device);
+
+    SDL_DestroyMutex(s_Locks->file_queue);
+    SDL_DestroyMutex(s_Locks->demuxer);
+    SDL_DestroyMutex(s_Locks->video_codec);
+    SDL_DestroyMutex(s_Locks->audio_codec);
+    SDL_DestroyMutex(s_Locks->playback_state);
+    SDL_DestroyMutex(s_Locks->preview_frame);
+    SDL_DestroyMutex(s_Locks->audio_device);
+
     SDL_DestroyCond(s_VideoPausedCond);
+    SDL_DestroyCond(s_PresenterParkedCond);
     SDL_DestroyCond(s_VideoAvailabilityCond);
     SDL_DestroyCond(s_FrameAvailabilityCond);
-    SDL_DestroyCond(PacketQueue::s_PacketAvailabilityCond);
 }
 #pragma endregion Deallocation
 
@@ -0,0 +1,206 @@
+#include "core/backend/audio_stretcher.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace YAVE
+{
+AudioStretcher::~AudioStretcher()
+{
+    reset();
+    av_frame_free(&m_in_frame);
+    av_frame_free(&m_out_frame);
+}
+
+int AudioStretcher::configure(const StretcherFormat& format)
+{
+    if (m_graph && format == m_format) {
+        return 0;
+    }
+
+    reset();
+    m_format = format;
+
+    if (build_graph() < 0) {
+        reset();
+        return -1;
+    }
+
+    return 1;
+}
+
+int AudioStretcher::process(const float* samples, int frames_nb, std::vector<float>& dest)
+{
+    dest.clear();
+
+    if (!m_graph || frames_nb <= 0) {
+        return -1;
+    }
+
+    if (!m_in_frame) {
+        m_in_frame = av_frame_alloc();
+    }
+
+    if (!m_out_frame) {
+        m_out_frame = av_frame_alloc();
+    }
+
+    if (!m_in_frame || !m_out_frame) {
+        return -1;
+    }
+
+    m_in_frame->format = AV_SAMPLE_FMT_FLT;
+    m_in_frame->sample_rate = m_format.sample_rate;
+    m_in_frame->channels = m_format.channels_nb;
+    m_in_frame->channel_layout = av_get_default_channel_layout(m_format.channels_nb);
+    m_in_frame->nb_samples = frames_nb;
+    m_in_frame->pts = m_next_pts;
+
+    if (av_frame_get_buffer(m_in_frame, 0) < 0) {
+        return -1;
+    }
+
+    const std::size_t samples_nb = static_cast<std::size_t>(frames_nb) * m_format.channels_nb;
+    std::memcpy(m_in_frame->data[0], samples, samples_nb * sizeof(float));
+
+    m_next_pts += frames_nb;
+
+    // The source takes the reference, the frame is empty again afterwards.
+    int response = av_buffersrc_add_frame(m_source, m_in_frame);
+
+    if (response < 0) {
+        av_frame_unref(m_in_frame);
+        std::cerr << "[Audio Stretcher]: Failed to feed the filter graph: "
+                  << av_error_to_string(response) << "\n";
+        return -1;
+    }
+
+    int written_nb = 0;
+
+    while ((response = av_buffersink_get_frame(m_sink, m_out_frame)) >= 0) {
+        const std::size_t out_nb =
+            static_cast<std::size_t>(m_out_frame->nb_samples) * m_format.channels_nb;
+        const auto* out_samples = reinterpret_cast<const float*>(m_out_frame->data[0]);
+
+        dest.insert(dest.end(), out_samples, out_samples + out_nb);
+        written_nb += m_out_frame->nb_samples;
+
+        av_frame_unref(m_out_frame);
+    }
+
+    if (response != AVERROR(EAGAIN) && response != AVERROR_EOF) {
+        return -1;
+    }
+
+    return written_nb;
+}
+
+void AudioStretcher::reset()
+{
+    // Freeing the graph frees every filter in it.
+    avfilter_graph_free(&m_graph);
+
+    m_source = nullptr;
+    m_sink = nullptr;
+    m_next_pts = 0;
+}
+
+std::vector<double> AudioStretcher::split_tempo(double tempo)
+{
+    std::vector<double> factors;
+
+    while (tempo > MAX_ATEMPO_FACTOR) {
+        factors.push_back(MAX_ATEMPO_FACTOR);
+        tempo /= MAX_ATEMPO_FACTOR;
+    }
+
+    while (tempo < MIN_ATEMPO_FACTOR) {
+        factors.push_back(MIN_ATEMPO_FACTOR);
+        tempo /= MIN_ATEMPO_FACTOR;
+    }
+
+    if (std::abs(tempo - 1.0) > 1e-6 || factors.empty()) {
+        factors.push_back(tempo);
+    }
+
+    return factors;
+}
+
+int AudioStretcher::build_graph()
+{
+    m_graph = avfilter_graph_alloc();
+
+    if (!m_graph) {
+        return -1;
+    }
+
+    const std::string source_args = "time_base=1/" + std::to_string(m_format.sample_rate) +
+        ":sample_rate=" + std::to_string(m_format.sample_rate) +
+        ":sample_fmt=flt:channel_layout=" +
+        std::to_string(av_get_default_channel_layout(m_format.channels_nb));
+
+    int response = avfilter_graph_create_filter(&m_source, avfilter_get_by_name("abuffer"),
+        "in", source_args.c_str(), nullptr, m_graph);
+
+    if (response < 0) {
+        std::cerr << "[Audio Stretcher]: Failed to create the source: "
+                  << av_error_to_string(response) << "\n";
+        return -1;
+    }
+
+    response = avfilter_graph_create_filter(
+        &m_sink, avfilter_get_by_name("abuffersink"), "out", nullptr, nullptr, m_graph);
+
+    if (response < 0) {
+        std::cerr << "[Audio Stretcher]: Failed to create the sink: "
+                  << av_error_to_string(response) << "\n";
+        return -1;
+    }
+
+    // The ring only takes interleaved floats, so no conversion may slip in after atempo.
+    const AVSampleFormat sample_formats[] = { AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_NONE };
+
+    response = av_opt_set_int_list(
+        m_sink, "sample_fmts", sample_formats, AV_SAMPLE_FMT_NONE, AV_OPT_SEARCH_CHILDREN);
+
+    if (response < 0) {
+        return -1;
+    }
+
+    AVFilterContext* previous = m_source;
+    const std::vector<double> factors = split_tempo(m_format.tempo);
+
+    for (std::size_t i = 0; i < factors.size(); ++i) {
+        AVFilterContext* atempo = nullptr;
+
+        const std::string name = "atempo" + std::to_string(i);
+        const std::string args = "tempo=" + std::to_string(factors[i]);
+
+        response = avfilter_graph_create_filter(&atempo, avfilter_get_by_name("atempo"),
+            name.c_str(), args.c_str(), nullptr, m_graph);
+
+        if (response < 0 || avfilter_link(previous, 0, atempo, 0) < 0) {
+            std::cerr << "[Audio Stretcher]: Failed to create atempo: "
+                      << av_error_to_string(response) << "\n";
+            return -1;
+        }
+
+        previous = atempo;
+    }
+
+    if (avfilter_link(previous, 0, m_sink, 0) < 0) {
+        return -1;
+    }
+
+    response = avfilter_graph_config(m_graph, nullptr);
+
+    if (response < 0) {
+        std::cerr << "[Audio Stretcher]: Failed to configure the filter graph: "
+                  << av_error_to_string(response) << "\n";
+        return -1;
+    }
+
+    return 0;
+}
+} // namespace YAVE
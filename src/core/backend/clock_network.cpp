@@ -0,0 +1,109 @@
+#include "core/backend/clock_network.hpp"
+
+#include <algorithm>
+
+#include "core/backend/frame_pacer.hpp"
+
+namespace YAVE
+{
+namespace
+{
+/**
+ * @brief The position the device is playing, extrapolated from the wall time.
+ */
+[[nodiscard]] double extrapolate_clock(const AudioClockSnapshot& snapshot, double current_time)
+{
+    if (snapshot.is_paused) {
+        return snapshot.paused_clock;
+    }
+
+    const double buffer_start = snapshot.pts - snapshot.buffered_time;
+
+    // Nothing was handed over yet, there is no time to extrapolate from.
+    if (snapshot.capture_time <= 0.0) {
+        return buffer_start;
+    }
+
+    // Never run past the audio the device actually has, e.g. when the callback starves.
+    const double elapsed_time = std::clamp(
+        (current_time - snapshot.capture_time) * snapshot.playback_rate, 0.0,
+        snapshot.buffered_time);
+
+    return buffer_start + elapsed_time;
+}
+} // namespace
+
+void ClockNetwork::update_audio_clock(double pts, double duration,
+    const AudioBufferInfo& buffer_info, double playback_rate) noexcept
+{
+    const double current_time = FramePacer::now();
+
+    m_audio.update([&](AudioClockSnapshot& snapshot) {
+        snapshot.pts = pts;
+        snapshot.buffered_time = duration;
+        snapshot.capture_time = current_time;
+        snapshot.playback_rate = playback_rate;
+        snapshot.buffer_info = buffer_info;
+    });
+}
+
+void ClockNetwork::set_audio_paused(bool is_paused) noexcept
+{
+    const double current_time = FramePacer::now();
+
+    if (is_paused) {
+        m_pause_start_time.store(current_time, std::memory_order_release);
+    } else {
+        const double pause_start_time = m_pause_start_time.exchange(0.0, std::memory_order_acq_rel);
+
+        if (pause_start_time > 0.0) {
+            m_paused_time.fetch_add(current_time - pause_start_time, std::memory_order_acq_rel);
+        }
+    }
+
+    m_audio.update([&](AudioClockSnapshot& snapshot) {
+        if (snapshot.is_paused == is_paused) {
+            return;
+        }
+
+        if (is_paused) {
+            snapshot.paused_clock = extrapolate_clock(snapshot, current_time);
+        } else {
+            // The device resumes with what was left of the buffer when it was paused.
+            snapshot.buffered_time = std::max(snapshot.pts - snapshot.paused_clock, 0.0);
+            snapshot.capture_time = current_time;
+        }
+
+        snapshot.is_paused = is_paused;
+    });
+}
+
+double ClockNetwork::get_audio_clock() const noexcept
+{
+    return m_audio.load().pts;
+}
+
+double ClockNetwork::get_reference_clock() const noexcept
+{
+    return extrapolate_clock(m_audio.load(), FramePacer::now());
+}
+
+void ClockNetwork::reset_audio_buffer_info() noexcept
+{
+    m_audio.update([](AudioClockSnapshot& snapshot) {
+        snapshot.buffered_time = 0.0;
+        snapshot.buffer_info = AudioBufferInfo{};
+    });
+}
+
+void ClockNetwork::reset(double seconds) noexcept
+{
+    m_audio.update([seconds](AudioClockSnapshot& snapshot) {
+        snapshot.pts = seconds;
+        snapshot.buffered_time = 0.0;
+        snapshot.paused_clock = seconds;
+    });
+
+    m_video_clock.store(seconds, std::memory_order_release);
+}
+} // namespace YAVE
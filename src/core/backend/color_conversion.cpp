@@ -0,0 +1,323 @@
+#include "core/backend/color_conversion.hpp"
+
+#if defined(YAVE_ARCH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace YAVE
+{
+std::atomic<ConversionISA> ColorConverter::s_MaxISA = ConversionISA::AVX2;
+
+namespace
+{
+/**
+ * @brief Same as swscale's roundToInt16(), turns a Q16 coefficient into Q13.
+ */
+[[nodiscard]] std::int16_t to_q13(std::int64_t coefficient)
+{
+    const std::int64_t rounded = (coefficient * (1 << 13) + (1 << 15)) >> 16;
+    return static_cast<std::int16_t>(std::clamp<std::int64_t>(rounded, -0x7FFF, 0x7FFF));
+}
+
+#ifdef YAVE_ARCH_X86
+void cpuid(int leaf, int subleaf, unsigned int registers[4])
+{
+#if defined(_MSC_VER)
+    int values[4];
+    __cpuidex(values, leaf, subleaf);
+
+    for (int i = 0; i < 4; ++i) {
+        registers[i] = static_cast<unsigned int>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+[[nodiscard]] std::uint64_t read_xcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax = 0;
+    unsigned int edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+} // namespace
+
+#pragma region Dispatch
+ConversionISA ColorConverter::detect_isa()
+{
+#ifdef YAVE_ARCH_X86
+    unsigned int registers[4] = { 0, 0, 0, 0 };
+
+    cpuid(0, 0, registers);
+    const unsigned int max_leaf = registers[0];
+
+    cpuid(1, 0, registers);
+
+    const bool has_sse41 = registers[2] & (1u << 19);
+    const bool has_osxsave = registers[2] & (1u << 27);
+    const bool has_avx = registers[2] & (1u << 28);
+
+    // The OS also has to save the YMM registers on context switches.
+    const bool is_avx_enabled = has_osxsave && has_avx && (read_xcr0() & 0x6) == 0x6;
+
+    bool has_avx2 = false;
+
+    if (max_leaf >= 7 && is_avx_enabled) {
+        cpuid(7, 0, registers);
+        has_avx2 = registers[1] & (1u << 5);
+    }
+
+    if (has_avx2) {
+        return ConversionISA::AVX2;
+    }
+
+    if (has_sse41) {
+        return ConversionISA::SSE41;
+    }
+#endif
+
+    return ConversionISA::SCALAR;
+}
+
+ConversionISA ColorConverter::get_active_isa()
+{
+    static const ConversionISA detected_isa = detect_isa();
+    return std::min(detected_isa, s_MaxISA.load());
+}
+
+ConversionKernel ColorConverter::get_kernel()
+{
+    switch (get_active_isa()) {
+#ifdef YAVE_ARCH_X86
+    case ConversionISA::AVX2:
+        return &ColorKernels::convert_rows_avx2;
+    case ConversionISA::SSE41:
+        return &ColorKernels::convert_rows_sse41;
+#endif
+    default:
+        return &ColorKernels::convert_rows_scalar;
+    }
+}
+
+void ColorConverter::set_max_isa(ConversionISA isa)
+{
+    s_MaxISA = isa;
+}
+
+const char* ColorConverter::isa_to_string(ConversionISA isa)
+{
+    switch (isa) {
+    case ConversionISA::AVX2:
+        return "AVX2";
+    case ConversionISA::SSE41:
+        return "SSE4.1";
+    case ConversionISA::SCALAR:
+    default:
+        return "Scalar";
+    }
+}
+#pragma endregion Dispatch
+
+YUVMatrix ColorConverter::get_matrix(AVColorSpace colorspace, bool is_full_range)
+{
+    const YUVCoefficients coefficients = get_coefficients(colorspace, is_full_range);
+
+    constexpr float Q13 = 1.0f / (1 << 13);
+
+    YUVMatrix matrix;
+    matrix.y_offset = coefficients.y_offset;
+    matrix.y_gain = coefficients.y_gain * Q13;
+    matrix.rv = coefficients.rv * Q13;
+    matrix.gu = coefficients.gu * Q13;
+    matrix.gv = coefficients.gv * Q13;
+    matrix.bu = coefficients.bu * Q13;
+
+    return matrix;
+}
+
+bool ColorConverter::is_full_range(const AVFrame* frame)
+{
+    const auto pix_fmt = static_cast<AVPixelFormat>(frame->format);
+
+    return frame->color_range == AVCOL_RANGE_JPEG || pix_fmt == AV_PIX_FMT_YUVJ420P ||
+        pix_fmt == AV_PIX_FMT_YUVJ422P;
+}
+
+YUVCoefficients ColorConverter::get_coefficients(AVColorSpace colorspace, bool is_full_range)
+{
+    // The same steps as swscale's ff_yuv2rgb_c_init_tables() for a full range RGB output at
+    // the default brightness, contrast and saturation. Untagged streams get BT.601 there too.
+    const int* table = sws_getCoefficients(colorspace);
+
+    std::int64_t rv = table[0];
+    std::int64_t bu = table[1];
+    std::int64_t gu = -table[2];
+    std::int64_t gv = -table[3];
+    std::int64_t y_gain = 1 << 16;
+
+    if (is_full_range) {
+        rv = rv * 224 / 255;
+        bu = bu * 224 / 255;
+        gu = gu * 224 / 255;
+        gv = gv * 224 / 255;
+    } else {
+        y_gain = y_gain * 255 / 219;
+    }
+
+    YUVCoefficients coefficients;
+    coefficients.y_offset = is_full_range ? 0 : 16;
+    coefficients.y_gain = to_q13(y_gain);
+    coefficients.rv = to_q13(rv);
+    coefficients.gu = to_q13(gu);
+    coefficients.gv = to_q13(gv);
+    coefficients.bu = to_q13(bu);
+
+    return coefficients;
+}
+
+void ColorConverter::set_sws_colorspace(SwsContext* sws_ctx, const AVFrame* frame)
+{
+    const int* table = sws_getCoefficients(frame->colorspace);
+    const int src_range = is_full_range(frame) ? 1 : 0;
+
+    // Brightness 0, contrast and saturation 1.0 in Q16, into full range RGB.
+    sws_setColorspaceDetails(sws_ctx, table, src_range, sws_getCoefficients(SWS_CS_DEFAULT), 1,
+        0, 1 << 16, 1 << 16);
+}
+
+bool ColorConverter::is_supported(const AVFrame* frame)
+{
+    if (!frame || frame->width <= 0 || frame->height <= 0 || !frame->data[0]) {
+        return false;
+    }
+
+    // At odd sizes swscale steps the chroma by slightly less than half a sample, which the
+    // kernels don't reproduce.
+    if (frame->width % 2 != 0 || frame->height % 2 != 0) {
+        return false;
+    }
+
+    switch (static_cast<AVPixelFormat>(frame->format)) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_YUV422P:
+    case AV_PIX_FMT_YUVJ422P:
+    case AV_PIX_FMT_NV12:
+        break;
+    default:
+        return false;
+    }
+
+    switch (frame->colorspace) {
+    case AVCOL_SPC_BT709:
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+    case AVCOL_SPC_UNSPECIFIED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int ColorConverter::prepare_job(
+    const AVFrame* frame, std::uint8_t* dest, int dest_linesize, ConversionJob* job)
+{
+    if (!dest || !job || !is_supported(frame)) {
+        return -1;
+    }
+
+    const auto pix_fmt = static_cast<AVPixelFormat>(frame->format);
+
+    job->is_semi_planar = pix_fmt == AV_PIX_FMT_NV12;
+    job->chroma_shift_y = (pix_fmt == AV_PIX_FMT_YUV422P || pix_fmt == AV_PIX_FMT_YUVJ422P) ? 0 : 1;
+
+    for (int i = 0; i < 3; ++i) {
+        job->src[i] = frame->data[i];
+        job->src_linesize[i] = frame->linesize[i];
+    }
+
+    job->dest = dest;
+    job->dest_linesize = dest_linesize;
+    job->width = frame->width;
+    job->height = frame->height;
+    job->coefficients = get_coefficients(frame->colorspace, is_full_range(frame));
+
+    return 0;
+}
+
+int ColorConverter::convert(const AVFrame* frame, std::uint8_t* dest, int dest_linesize)
+{
+    ConversionJob job;
+
+    if (prepare_job(frame, dest, dest_linesize, &job) < 0) {
+        return -1;
+    }
+
+    get_kernel()(job, 0, job.height);
+
+    return 0;
+}
+
+int ColorConverter::convert_parallel(const AVFrame* frame, std::uint8_t* dest,
+    int dest_linesize, WorkerPool& pool, int* slices_nb)
+{
+    ConversionJob job;
+
+    if (prepare_job(frame, dest, dest_linesize, &job) < 0) {
+        return -1;
+    }
+
+    const ConversionKernel kernel = get_kernel();
+    const auto slices = split_into_slices(job.width, job.height, pool.get_workers_nb() + 1);
+
+    pool.parallel_for(static_cast<int>(slices.size()), [&](int index) {
+        kernel(job, slices[index].row_begin, slices[index].row_end);
+    });
+
+    if (slices_nb) {
+        *slices_nb = static_cast<int>(slices.size());
+    }
+
+    return 0;
+}
+
+std::vector<FrameSlice> split_into_slices(
+    int width, int height, int max_slices_nb, int row_alignment)
+{
+    const std::int64_t pixels_nb = static_cast<std::int64_t>(width) * height;
+
+    int slices_nb = static_cast<int>(pixels_nb / MIN_PIXELS_PER_SLICE);
+    slices_nb = std::clamp(slices_nb, 1, std::max(max_slices_nb, 1));
+    slices_nb = std::min(slices_nb, std::max(height / MIN_ROWS_PER_SLICE, 1));
+
+    // Round the band height up so every boundary lands on an aligned row.
+    int rows_per_slice = (height + slices_nb - 1) / slices_nb;
+    rows_per_slice = (rows_per_slice + row_alignment - 1) / row_alignment * row_alignment;
+
+    std::vector<FrameSlice> slices;
+    slices.reserve(slices_nb);
+
+    for (int row = 0; row < height; row += rows_per_slice) {
+        slices.push_back({ row, std::min(row + rows_per_slice, height) });
+    }
+
+    return slices;
+}
+
+void ColorKernels::convert_rows_scalar(const ConversionJob& job, int row_begin, int row_end)
+{
+    for (int row = row_begin; row < row_end; ++row) {
+        convert_row_tail(job, row, 0);
+    }
+}
+} // namespace YAVE
@@ -0,0 +1,288 @@
+#include "core/backend/color_conversion.hpp"
+
+#ifdef YAVE_ARCH_X86
+
+#include <immintrin.h>
+
+namespace YAVE
+{
+namespace
+{
+/**
+ * @brief Puts two 16-bit values in a 32-bit lane the way pmaddwd reads them, first one low.
+ */
+constexpr int make_pair(int first, int second)
+{
+    return static_cast<int>(
+        (static_cast<unsigned int>(second) << 16) | static_cast<std::uint16_t>(first));
+}
+
+#pragma region SSE4.1
+/**
+ * @brief The coefficients as the 16-bit pairs pmaddwd multiplies with (luma, 1) and (U', V').
+ */
+struct CoefficientsSSE {
+    __m128i y_offset, luma_pair;
+    __m128i r_pair, g_pair, b_pair;
+    __m128i chroma_bias, one, alpha;
+};
+
+YAVE_TARGET_SSE41 CoefficientsSSE load_coefficients_sse(const YUVCoefficients& c)
+{
+    return { _mm_set1_epi16(c.y_offset),
+        _mm_set1_epi32(make_pair(c.y_gain, ColorKernels::COEFFICIENT_ROUNDING)),
+        _mm_set1_epi32(make_pair(0, c.rv)), _mm_set1_epi32(make_pair(c.gu, c.gv)),
+        _mm_set1_epi32(make_pair(c.bu, 0)), _mm_set1_epi16(128), _mm_set1_epi16(1),
+        _mm_set1_epi8(static_cast<char>(0xFF)) };
+}
+
+/**
+ * @brief Same as ColorKernels::pack_channel() for 4 sums.
+ */
+YAVE_TARGET_SSE41 inline __m128i scale_sum_sse(__m128i sum)
+{
+    return _mm_srai_epi32(_mm_slli_epi32(sum, 9), 22);
+}
+
+/**
+ * @brief Adds the chroma term of 4 chroma samples to the luma terms of their 8 pixels.
+ */
+YAVE_TARGET_SSE41 inline __m128i pack_half_sse(
+    __m128i luma_0, __m128i luma_1, __m128i chroma)
+{
+    // Every chroma sample covers two neighbouring pixels.
+    const __m128i sum_0 = _mm_add_epi32(luma_0, _mm_unpacklo_epi32(chroma, chroma));
+    const __m128i sum_1 = _mm_add_epi32(luma_1, _mm_unpackhi_epi32(chroma, chroma));
+    return _mm_packs_epi32(scale_sum_sse(sum_0), scale_sum_sse(sum_1));
+}
+
+/**
+ * @brief Converts one channel of a block from the luma terms of its pixels and the (U', V')
+ *        pairs of its chroma samples.
+ */
+YAVE_TARGET_SSE41 inline __m128i pack_channel_sse(const __m128i (&luma)[4], __m128i chroma_lo,
+    __m128i chroma_hi, __m128i chroma_pair)
+{
+    return _mm_packus_epi16(
+        pack_half_sse(luma[0], luma[1], _mm_madd_epi16(chroma_lo, chroma_pair)),
+        pack_half_sse(luma[2], luma[3], _mm_madd_epi16(chroma_hi, chroma_pair)));
+}
+
+/**
+ * @brief Converts 16 pixels that share 8 chroma samples (already widened to 16 bits).
+ */
+YAVE_TARGET_SSE41 inline void convert_block_sse(const std::uint8_t* y_src, __m128i u, __m128i v,
+    std::uint8_t* dest, const CoefficientsSSE& c)
+{
+    const __m128i cb = _mm_sub_epi16(u, c.chroma_bias);
+    const __m128i cr = _mm_sub_epi16(v, c.chroma_bias);
+    const __m128i chroma_lo = _mm_unpacklo_epi16(cb, cr);
+    const __m128i chroma_hi = _mm_unpackhi_epi16(cb, cr);
+
+    const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_src));
+    const __m128i luma_lo = _mm_sub_epi16(_mm_cvtepu8_epi16(luma), c.y_offset);
+    const __m128i luma_hi =
+        _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(luma, 8)), c.y_offset);
+
+    // The luma terms of the pixels [0, 4), [4, 8), [8, 12) and [12, 16), rounding included.
+    const __m128i luma_terms[4] = {
+        _mm_madd_epi16(_mm_unpacklo_epi16(luma_lo, c.one), c.luma_pair),
+        _mm_madd_epi16(_mm_unpackhi_epi16(luma_lo, c.one), c.luma_pair),
+        _mm_madd_epi16(_mm_unpacklo_epi16(luma_hi, c.one), c.luma_pair),
+        _mm_madd_epi16(_mm_unpackhi_epi16(luma_hi, c.one), c.luma_pair),
+    };
+
+    const __m128i r = pack_channel_sse(luma_terms, chroma_lo, chroma_hi, c.r_pair);
+    const __m128i g = pack_channel_sse(luma_terms, chroma_lo, chroma_hi, c.g_pair);
+    const __m128i b = pack_channel_sse(luma_terms, chroma_lo, chroma_hi, c.b_pair);
+
+    const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+    const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+    const __m128i ba_lo = _mm_unpacklo_epi8(b, c.alpha);
+    const __m128i ba_hi = _mm_unpackhi_epi8(b, c.alpha);
+
+    auto* out = reinterpret_cast<__m128i*>(dest);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rg_hi, ba_hi));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rg_hi, ba_hi));
+}
+#pragma endregion SSE4.1
+
+#pragma region AVX2
+struct CoefficientsAVX {
+    __m256i y_offset, luma_pair;
+    __m256i r_pair, g_pair, b_pair;
+    __m256i chroma_bias, one, alpha;
+};
+
+YAVE_TARGET_AVX2 CoefficientsAVX load_coefficients_avx(const YUVCoefficients& c)
+{
+    return { _mm256_set1_epi16(c.y_offset),
+        _mm256_set1_epi32(make_pair(c.y_gain, ColorKernels::COEFFICIENT_ROUNDING)),
+        _mm256_set1_epi32(make_pair(0, c.rv)), _mm256_set1_epi32(make_pair(c.gu, c.gv)),
+        _mm256_set1_epi32(make_pair(c.bu, 0)), _mm256_set1_epi16(128), _mm256_set1_epi16(1),
+        _mm256_set1_epi8(static_cast<char>(0xFF)) };
+}
+
+YAVE_TARGET_AVX2 inline __m256i scale_sum_avx(__m256i sum)
+{
+    return _mm256_srai_epi32(_mm256_slli_epi32(sum, 9), 22);
+}
+
+YAVE_TARGET_AVX2 inline __m256i pack_half_avx(
+    __m256i luma_0, __m256i luma_1, __m256i chroma)
+{
+    const __m256i sum_0 = _mm256_add_epi32(luma_0, _mm256_unpacklo_epi32(chroma, chroma));
+    const __m256i sum_1 = _mm256_add_epi32(luma_1, _mm256_unpackhi_epi32(chroma, chroma));
+    return _mm256_packs_epi32(scale_sum_avx(sum_0), scale_sum_avx(sum_1));
+}
+
+YAVE_TARGET_AVX2 inline __m256i pack_channel_avx(const __m256i (&luma)[4], __m256i chroma_a,
+    __m256i chroma_b, __m256i chroma_pair)
+{
+    return _mm256_packus_epi16(
+        pack_half_avx(luma[0], luma[1], _mm256_madd_epi16(chroma_a, chroma_pair)),
+        pack_half_avx(luma[2], luma[3], _mm256_madd_epi16(chroma_b, chroma_pair)));
+}
+
+/**
+ * @brief Converts 32 pixels that share 16 chroma samples (already widened to 16 bits).
+ *
+ * The unpack and pack instructions work on each 128-bit lane separately, so the "a" half
+ * holds the pixels [0, 8) and [16, 24) while the "b" half holds [8, 16) and [24, 32), and
+ * the chroma samples line up with them the same way. The pack brings them back in order
+ * and only the final RGBA stores cross the lanes.
+ */
+YAVE_TARGET_AVX2 inline void convert_block_avx(const std::uint8_t* y_src, __m256i u, __m256i v,
+    std::uint8_t* dest, const CoefficientsAVX& c)
+{
+    const __m256i cb = _mm256_sub_epi16(u, c.chroma_bias);
+    const __m256i cr = _mm256_sub_epi16(v, c.chroma_bias);
+    const __m256i chroma_a = _mm256_unpacklo_epi16(cb, cr);
+    const __m256i chroma_b = _mm256_unpackhi_epi16(cb, cr);
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i luma = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y_src));
+    const __m256i luma_a = _mm256_sub_epi16(_mm256_unpacklo_epi8(luma, zero), c.y_offset);
+    const __m256i luma_b = _mm256_sub_epi16(_mm256_unpackhi_epi8(luma, zero), c.y_offset);
+
+    const __m256i luma_terms[4] = {
+        _mm256_madd_epi16(_mm256_unpacklo_epi16(luma_a, c.one), c.luma_pair),
+        _mm256_madd_epi16(_mm256_unpackhi_epi16(luma_a, c.one), c.luma_pair),
+        _mm256_madd_epi16(_mm256_unpacklo_epi16(luma_b, c.one), c.luma_pair),
+        _mm256_madd_epi16(_mm256_unpackhi_epi16(luma_b, c.one), c.luma_pair),
+    };
+
+    const __m256i r = pack_channel_avx(luma_terms, chroma_a, chroma_b, c.r_pair);
+    const __m256i g = pack_channel_avx(luma_terms, chroma_a, chroma_b, c.g_pair);
+    const __m256i b = pack_channel_avx(luma_terms, chroma_a, chroma_b, c.b_pair);
+
+    const __m256i rg_lo = _mm256_unpacklo_epi8(r, g);
+    const __m256i rg_hi = _mm256_unpackhi_epi8(r, g);
+    const __m256i ba_lo = _mm256_unpacklo_epi8(b, c.alpha);
+    const __m256i ba_hi = _mm256_unpackhi_epi8(b, c.alpha);
+
+    const __m256i rgba_0 = _mm256_unpacklo_epi16(rg_lo, ba_lo); // [0, 4) and [16, 20)
+    const __m256i rgba_1 = _mm256_unpackhi_epi16(rg_lo, ba_lo); // [4, 8) and [20, 24)
+    const __m256i rgba_2 = _mm256_unpacklo_epi16(rg_hi, ba_hi); // [8, 12) and [24, 28)
+    const __m256i rgba_3 = _mm256_unpackhi_epi16(rg_hi, ba_hi); // [12, 16) and [28, 32)
+
+    auto* out = reinterpret_cast<__m256i*>(dest);
+    _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(rgba_0, rgba_1, 0x20));
+    _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(rgba_2, rgba_3, 0x20));
+    _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(rgba_0, rgba_1, 0x31));
+    _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(rgba_2, rgba_3, 0x31));
+}
+#pragma endregion AVX2
+} // namespace
+
+YAVE_TARGET_SSE41 void ColorKernels::convert_rows_sse41(
+    const ConversionJob& job, int row_begin, int row_end)
+{
+    constexpr int BLOCK_SIZE = 16;
+
+    const CoefficientsSSE c = load_coefficients_sse(job.coefficients);
+    const __m128i low_byte_mask = _mm_set1_epi16(0x00FF);
+
+    for (int row = row_begin; row < row_end; ++row) {
+        const std::uint8_t* y_row = job.src[0] + row * job.src_linesize[0];
+        const int chroma_row = row >> job.chroma_shift_y;
+
+        std::uint8_t* dest_row = job.dest + row * job.dest_linesize;
+
+        int x = 0;
+
+        if (job.is_semi_planar) {
+            const std::uint8_t* uv_row = job.src[1] + chroma_row * job.src_linesize[1];
+
+            for (; x + BLOCK_SIZE <= job.width; x += BLOCK_SIZE) {
+                const __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv_row + x));
+
+                convert_block_sse(y_row + x, _mm_and_si128(uv, low_byte_mask),
+                    _mm_srli_epi16(uv, 8), dest_row + x * 4, c);
+            }
+        } else {
+            const std::uint8_t* u_row = job.src[1] + chroma_row * job.src_linesize[1];
+            const std::uint8_t* v_row = job.src[2] + chroma_row * job.src_linesize[2];
+
+            for (; x + BLOCK_SIZE <= job.width; x += BLOCK_SIZE) {
+                const __m128i u = _mm_cvtepu8_epi16(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_row + x / 2)));
+                const __m128i v = _mm_cvtepu8_epi16(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v_row + x / 2)));
+
+                convert_block_sse(y_row + x, u, v, dest_row + x * 4, c);
+            }
+        }
+
+        convert_row_tail(job, row, x);
+    }
+}
+
+YAVE_TARGET_AVX2 void ColorKernels::convert_rows_avx2(
+    const ConversionJob& job, int row_begin, int row_end)
+{
+    constexpr int BLOCK_SIZE = 32;
+
+    const CoefficientsAVX c = load_coefficients_avx(job.coefficients);
+    const __m256i low_byte_mask = _mm256_set1_epi16(0x00FF);
+
+    for (int row = row_begin; row < row_end; ++row) {
+        const std::uint8_t* y_row = job.src[0] + row * job.src_linesize[0];
+        const int chroma_row = row >> job.chroma_shift_y;
+
+        std::uint8_t* dest_row = job.dest + row * job.dest_linesize;
+
+        int x = 0;
+
+        if (job.is_semi_planar) {
+            const std::uint8_t* uv_row = job.src[1] + chroma_row * job.src_linesize[1];
+
+            for (; x + BLOCK_SIZE <= job.width; x += BLOCK_SIZE) {
+                const __m256i uv =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uv_row + x));
+
+                convert_block_avx(y_row + x, _mm256_and_si256(uv, low_byte_mask),
+                    _mm256_srli_epi16(uv, 8), dest_row + x * 4, c);
+            }
+        } else {
+            const std::uint8_t* u_row = job.src[1] + chroma_row * job.src_linesize[1];
+            const std::uint8_t* v_row = job.src[2] + chroma_row * job.src_linesize[2];
+
+            for (; x + BLOCK_SIZE <= job.width; x += BLOCK_SIZE) {
+                const __m256i u = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(u_row + x / 2)));
+                const __m256i v = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(v_row + x / 2)));
+
+                convert_block_avx(y_row + x, u, v, dest_row + x * 4, c);
+            }
+        }
+
+        convert_row_tail(job, row, x);
+    }
+}
+} // namespace YAVE
+
+#endif
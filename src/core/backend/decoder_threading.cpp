@@ -0,0 +1,173 @@
+#include "core/backend/decoder_threading.hpp"
+
+namespace YAVE
+{
+std::array<DecoderThreading::UseCaseState, static_cast<std::size_t>(DecoderUseCase::COUNT)>
+    DecoderThreading::s_States = {};
+
+SDL_mutex* DecoderThreading::s_Mutex = SDL_CreateMutex();
+
+namespace
+{
+[[nodiscard]] inline std::size_t to_index(DecoderUseCase use_case)
+{
+    return static_cast<std::size_t>(use_case);
+}
+} // namespace
+
+int DecoderThreading::get_auto_thread_count(DecoderUseCase use_case)
+{
+    const int cores_nb = std::max(SDL_GetCPUCount(), 1);
+
+    switch (use_case) {
+    case DecoderUseCase::PLAYER:
+    case DecoderUseCase::REVERSE:
+    case DecoderUseCase::STEP:
+        // Leave one core for the UI thread and one for audio and presentation. They never
+        // decode at the same time, the forward decoder idles while reversing or stepping.
+        return std::clamp(cores_nb - 2, 1, MAX_DECODER_THREADS);
+    case DecoderUseCase::THUMBNAIL:
+        return std::clamp(cores_nb / 4, 1, 2);
+    case DecoderUseCase::WAVEFORM:
+    default:
+        // Audio decoders barely scale, don't steal cores from the video decoder.
+        return 1;
+    }
+}
+
+int DecoderThreading::get_default_thread_type(DecoderUseCase use_case)
+{
+    // Thumbnails and waveforms seek and flush a lot, frame threading would delay every
+    // first frame by a whole batch of frames. Slice threading has no such latency.
+    // Reverse playback and frame stepping seek once per GOP and then decode most of it, the
+    // throughput matters more than the latency.
+    if (use_case == DecoderUseCase::PLAYER || use_case == DecoderUseCase::REVERSE ||
+        use_case == DecoderUseCase::STEP) {
+        return FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+
+    return FF_THREAD_SLICE;
+}
+
+void DecoderThreading::apply(AVCodecContext* av_codec_ctx, DecoderUseCase use_case)
+{
+    if (!av_codec_ctx) {
+        return;
+    }
+
+    const DecoderThreadingConfig config = get_config(use_case);
+
+    av_codec_ctx->thread_count =
+        config.thread_count > 0 ? config.thread_count : get_auto_thread_count(use_case);
+    av_codec_ctx->thread_type =
+        config.thread_type != 0 ? config.thread_type : get_default_thread_type(use_case);
+}
+
+void DecoderThreading::on_codec_opened(const AVCodecContext* av_codec_ctx, DecoderUseCase use_case)
+{
+    if (!av_codec_ctx) {
+        return;
+    }
+
+    const std::string setting =
+        describe_setting(av_codec_ctx->thread_count, av_codec_ctx->active_thread_type);
+
+    SDL_LockMutex(s_Mutex);
+    s_States[to_index(use_case)].active_setting = setting;
+    SDL_UnlockMutex(s_Mutex);
+}
+
+void DecoderThreading::set_config(DecoderUseCase use_case, const DecoderThreadingConfig& config)
+{
+    SDL_LockMutex(s_Mutex);
+
+    auto& state = s_States[to_index(use_case)];
+    state.config.thread_count = std::clamp(config.thread_count, 0, MAX_DECODER_THREADS);
+    state.config.thread_type = config.thread_type;
+
+    SDL_UnlockMutex(s_Mutex);
+}
+
+DecoderThreadingConfig DecoderThreading::get_config(DecoderUseCase use_case)
+{
+    SDL_LockMutex(s_Mutex);
+    const DecoderThreadingConfig config = s_States[to_index(use_case)].config;
+    SDL_UnlockMutex(s_Mutex);
+
+    return config;
+}
+
+void DecoderThreading::record_decode(
+    DecoderUseCase use_case, int frames_nb, std::int64_t elapsed_us)
+{
+    if (frames_nb <= 0 && elapsed_us <= 0) {
+        return;
+    }
+
+    SDL_LockMutex(s_Mutex);
+
+    auto& state = s_States[to_index(use_case)];
+    auto& throughput = state.throughput[state.active_setting];
+
+    throughput.frames_nb += static_cast<std::uint64_t>(std::max(frames_nb, 0));
+    throughput.decode_time_us += std::max<std::int64_t>(elapsed_us, 0);
+
+    SDL_UnlockMutex(s_Mutex);
+}
+
+std::map<std::string, DecoderThroughput> DecoderThreading::get_throughput(DecoderUseCase use_case)
+{
+    SDL_LockMutex(s_Mutex);
+    auto throughput = s_States[to_index(use_case)].throughput;
+    SDL_UnlockMutex(s_Mutex);
+
+    return throughput;
+}
+
+std::string DecoderThreading::get_active_setting(DecoderUseCase use_case)
+{
+    SDL_LockMutex(s_Mutex);
+    std::string setting = s_States[to_index(use_case)].active_setting;
+    SDL_UnlockMutex(s_Mutex);
+
+    return setting;
+}
+
+const char* DecoderThreading::use_case_to_string(DecoderUseCase use_case)
+{
+    switch (use_case) {
+    case DecoderUseCase::PLAYER:
+        return "Player";
+    case DecoderUseCase::REVERSE:
+        return "Reverse";
+    case DecoderUseCase::STEP:
+        return "Frame Step";
+    case DecoderUseCase::THUMBNAIL:
+        return "Thumbnail";
+    case DecoderUseCase::WAVEFORM:
+        return "Waveform";
+    default:
+        return "Unknown";
+    }
+}
+
+std::string DecoderThreading::describe_setting(int thread_count, int thread_type)
+{
+    std::string type_str;
+
+    if (thread_type & FF_THREAD_FRAME) {
+        type_str = "frame";
+    }
+
+    if (thread_type & FF_THREAD_SLICE) {
+        type_str += type_str.empty() ? "slice" : "+slice";
+    }
+
+    if (type_str.empty()) {
+        type_str = "single";
+    }
+
+    return std::to_string(thread_count) + (thread_count == 1 ? " thread (" : " threads (") +
+        type_str + ")";
+}
+} // namespace YAVE
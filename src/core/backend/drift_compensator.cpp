@@ -0,0 +1,39 @@
+#include "core/backend/drift_compensator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace YAVE
+{
+int DriftCompensator::update(double diff, int out_samples)
+{
+    // Too far apart to be drift, e.g. right after a seek.
+    if (std::abs(diff) >= NOSYNC_THRESHOLD) {
+        reset();
+        return 0;
+    }
+
+    m_diff_accum = diff + AV_DIFFERENCE_AVG_COEF * m_diff_accum;
+
+    if (m_diffs_nb < AV_DIFFERENCE_COUNT) {
+        m_diffs_nb++;
+        return 0;
+    }
+
+    return calculate_compensation(m_diff_accum * (1.0 - AV_DIFFERENCE_AVG_COEF), out_samples);
+}
+
+void DriftCompensator::reset() noexcept
+{
+    m_diff_accum = 0.0;
+    m_diffs_nb = 0;
+}
+
+int DriftCompensator::calculate_compensation(double avg_diff, int out_samples)
+{
+    const double ratio = std::clamp(avg_diff / AUDIO_DRIFT_CORRECTION_TIME,
+        -MAX_AUDIO_DRIFT_CORRECTION, MAX_AUDIO_DRIFT_CORRECTION);
+
+    return static_cast<int>(std::lround(ratio * out_samples));
+}
+} // namespace YAVE
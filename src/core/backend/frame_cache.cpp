@@ -0,0 +1,218 @@
+#include "core/backend/frame_cache.hpp"
+
+namespace YAVE
+{
+std::unordered_map<std::string, FrameCache::FileFrames> FrameCache::s_Files;
+FrameCache::LRUList FrameCache::s_LRU;
+
+FrameCacheStats FrameCache::s_Stats = {};
+std::size_t FrameCache::s_BudgetBytes = DEFAULT_FRAME_CACHE_BUDGET_MIB * 1024 * 1024;
+
+SDL_mutex* FrameCache::s_Mutex = SDL_CreateMutex();
+
+void FrameCache::insert(const std::string& path, const AVFrame* frame, std::int64_t timestamp,
+    std::int64_t previous_timestamp)
+{
+    if (!frame || !frame->buf[0]) {
+        return;
+    }
+
+    const std::size_t bytes = calculate_frame_bytes(frame);
+
+    SDL_LockMutex(s_Mutex);
+
+    if (bytes > s_BudgetBytes) {
+        SDL_UnlockMutex(s_Mutex);
+        return;
+    }
+
+    FileFrames& frames = s_Files[path];
+
+    if (const auto it = frames.find(timestamp); it != frames.end()) {
+        // A later decode may know what came before the frame.
+        if (previous_timestamp != UNKNOWN_PREVIOUS_TIMESTAMP) {
+            it->second.previous_timestamp = previous_timestamp;
+        }
+
+        s_LRU.splice(s_LRU.begin(), s_LRU, it->second.lru_it);
+        SDL_UnlockMutex(s_Mutex);
+
+        return;
+    }
+
+    AVFrame* cached_frame = av_frame_alloc();
+
+    if (!cached_frame || av_frame_ref(cached_frame, frame) < 0) {
+        av_frame_free(&cached_frame);
+
+        if (frames.empty()) {
+            s_Files.erase(path);
+        }
+
+        SDL_UnlockMutex(s_Mutex);
+        return;
+    }
+
+    s_LRU.emplace_front(path, timestamp);
+    frames.emplace(
+        timestamp, CachedFrame{ cached_frame, previous_timestamp, bytes, s_LRU.begin() });
+
+    s_Stats.bytes_used += bytes;
+    ++s_Stats.frames_nb;
+
+    evict_locked(s_BudgetBytes);
+
+    SDL_UnlockMutex(s_Mutex);
+}
+
+int FrameCache::find_from(const std::string& path, std::int64_t timestamp, AVFrame* dest_frame,
+    std::int64_t* dest_timestamp)
+{
+    SDL_LockMutex(s_Mutex);
+
+    const auto file_it = s_Files.find(path);
+    const auto* entry =
+        file_it != s_Files.end() ? find_locked(file_it->second, timestamp) : nullptr;
+
+    const int response = hand_out_locked(entry, dest_frame, dest_timestamp);
+
+    SDL_UnlockMutex(s_Mutex);
+
+    return response;
+}
+
+int FrameCache::find_before(const std::string& path, std::int64_t timestamp, AVFrame* dest_frame,
+    std::int64_t* dest_timestamp)
+{
+    SDL_LockMutex(s_Mutex);
+
+    const FileFrames::value_type* entry = nullptr;
+
+    if (const auto file_it = s_Files.find(path); file_it != s_Files.end()) {
+        // The frame at the timestamp knows which frame came right before it.
+        const auto* next_entry = find_locked(file_it->second, timestamp);
+
+        if (next_entry && next_entry->second.previous_timestamp != UNKNOWN_PREVIOUS_TIMESTAMP) {
+            const auto it = file_it->second.find(next_entry->second.previous_timestamp);
+            entry = it != file_it->second.end() ? &*it : nullptr;
+        }
+    }
+
+    const int response = hand_out_locked(entry, dest_frame, dest_timestamp);
+
+    SDL_UnlockMutex(s_Mutex);
+
+    return response;
+}
+
+void FrameCache::set_budget(std::size_t budget_bytes)
+{
+    SDL_LockMutex(s_Mutex);
+
+    s_BudgetBytes = budget_bytes;
+    evict_locked(s_BudgetBytes);
+
+    SDL_UnlockMutex(s_Mutex);
+}
+
+FrameCacheStats FrameCache::get_stats()
+{
+    SDL_LockMutex(s_Mutex);
+
+    FrameCacheStats stats = s_Stats;
+    stats.budget_bytes = s_BudgetBytes;
+
+    SDL_UnlockMutex(s_Mutex);
+
+    return stats;
+}
+
+void FrameCache::clear()
+{
+    SDL_LockMutex(s_Mutex);
+    evict_locked(0);
+    SDL_UnlockMutex(s_Mutex);
+}
+
+const FrameCache::FileFrames::value_type* FrameCache::find_locked(
+    const FileFrames& frames, std::int64_t timestamp)
+{
+    const auto it = frames.lower_bound(timestamp);
+
+    if (it == frames.end()) {
+        return nullptr;
+    }
+
+    if (it->first == timestamp) {
+        return &*it;
+    }
+
+    // An uncached frame may sit between the timestamp and the first cached one after it.
+    const std::int64_t previous_timestamp = it->second.previous_timestamp;
+
+    return previous_timestamp != UNKNOWN_PREVIOUS_TIMESTAMP && previous_timestamp < timestamp
+        ? &*it
+        : nullptr;
+}
+
+int FrameCache::hand_out_locked(
+    const FileFrames::value_type* entry, AVFrame* dest_frame, std::int64_t* dest_timestamp)
+{
+    if (!entry) {
+        ++s_Stats.misses_nb;
+        return -1;
+    }
+
+    av_frame_unref(dest_frame);
+
+    if (av_frame_ref(dest_frame, entry->second.frame) < 0) {
+        ++s_Stats.misses_nb;
+        return -1;
+    }
+
+    s_LRU.splice(s_LRU.begin(), s_LRU, entry->second.lru_it);
+
+    *dest_timestamp = entry->first;
+    ++s_Stats.hits_nb;
+
+    return 0;
+}
+
+void FrameCache::evict_locked(std::size_t budget_bytes)
+{
+    while (s_Stats.bytes_used > budget_bytes && !s_LRU.empty()) {
+        const auto& [path, timestamp] = s_LRU.back();
+
+        const auto file_it = s_Files.find(path);
+        const auto frame_it = file_it->second.find(timestamp);
+
+        s_Stats.bytes_used -= frame_it->second.bytes;
+        --s_Stats.frames_nb;
+
+        av_frame_free(&frame_it->second.frame);
+        file_it->second.erase(frame_it);
+
+        if (file_it->second.empty()) {
+            s_Files.erase(file_it);
+        }
+
+        s_LRU.pop_back();
+    }
+}
+
+std::size_t FrameCache::calculate_frame_bytes(const AVFrame* frame)
+{
+    std::size_t bytes = 0;
+
+    // The planes may share a buffer or come in one per plane, either way every buffer counts.
+    for (const AVBufferRef* buffer : frame->buf) {
+        bytes += buffer ? buffer->size : 0;
+    }
+
+    for (int i = 0; i < frame->nb_extended_buf; ++i) {
+        bytes += frame->extended_buf[i]->size;
+    }
+
+    return bytes;
+}
+} // namespace YAVE
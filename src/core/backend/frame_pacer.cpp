@@ -0,0 +1,178 @@
+#include "core/backend/frame_pacer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace YAVE
+{
+namespace
+{
+// The spin threshold starts here and stays within these bounds. Spinning any longer than
+// the upper bound costs more CPU than the precision is worth.
+constexpr double MIN_SPIN_THRESHOLD = 0.5e-3;
+constexpr double MAX_SPIN_THRESHOLD = 4e-3;
+
+// How slowly a large oversleep is forgotten, so one bad sleep keeps the margin for a while.
+constexpr double OVERSHOOT_DECAY = 0.98;
+} // namespace
+
+FramePacer::FramePacer()
+    : m_spin_threshold(MIN_SPIN_THRESHOLD)
+    , m_mutex(SDL_CreateMutex())
+{
+}
+
+FramePacer::~FramePacer()
+{
+    SDL_DestroyMutex(m_mutex);
+}
+
+double FramePacer::now() noexcept
+{
+    using Seconds = std::chrono::duration<double>;
+    return std::chrono::duration_cast<Seconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+double FramePacer::wait_until(double deadline)
+{
+    double current_time = now();
+
+    // The frame is already due, this isn't an error of the pacer.
+    if (current_time >= deadline) {
+        return current_time - deadline;
+    }
+
+    while (deadline - current_time > m_spin_threshold.load()) {
+        const double requested = deadline - current_time - m_spin_threshold.load();
+        std::this_thread::sleep_for(std::chrono::duration<double>(requested));
+
+        const double woken_time = now();
+        update_spin_threshold(woken_time - current_time - requested);
+        current_time = woken_time;
+    }
+
+    while (current_time < deadline) {
+        std::this_thread::yield();
+        current_time = now();
+    }
+
+    const double error = current_time - deadline;
+    record_error(error);
+
+    return error;
+}
+
+void FramePacer::update_spin_threshold(double oversleep) noexcept
+{
+    m_sleep_overshoot = std::max(oversleep, m_sleep_overshoot * OVERSHOOT_DECAY);
+
+    // Leave room for an overshoot a bit larger than the worst one seen recently.
+    m_spin_threshold =
+        std::clamp(m_sleep_overshoot * 1.5, MIN_SPIN_THRESHOLD, MAX_SPIN_THRESHOLD);
+}
+
+int FramePacer::get_bin(double error) noexcept
+{
+    if (error >= PACING_RANGE) {
+        return PACING_OVERFLOW_BIN;
+    }
+
+    return std::clamp(static_cast<int>(error / PACING_BIN_WIDTH), 0, PACING_BINS_NB - 1);
+}
+
+void FramePacer::record_error(double error)
+{
+    SDL_LockMutex(m_mutex);
+
+    // The window is full, the oldest frame leaves the histogram.
+    if (m_frames_nb == PACING_WINDOW_SIZE) {
+        m_bins[get_bin(m_window[m_window_index])]--;
+    } else {
+        m_frames_nb++;
+    }
+
+    m_window[m_window_index] = error;
+    m_window_index = (m_window_index + 1) % PACING_WINDOW_SIZE;
+    m_bins[get_bin(error)]++;
+
+    SDL_UnlockMutex(m_mutex);
+}
+
+double FramePacer::get_percentile(double percentile, bool& is_overflow) const
+{
+    is_overflow = false;
+
+    if (m_frames_nb == 0) {
+        return 0.0;
+    }
+
+    const auto target = static_cast<std::uint32_t>(std::ceil(m_frames_nb * percentile));
+    std::uint32_t frames_nb = 0;
+
+    for (int bin = 0; bin < PACING_BINS_NB; bin++) {
+        frames_nb += m_bins[bin];
+
+        // Report the upper edge of the bin, never less than the real error.
+        if (frames_nb >= target) {
+            return (bin + 1) * PACING_BIN_WIDTH;
+        }
+    }
+
+    // Past the range, only the lower edge of the overflow bin is known.
+    is_overflow = true;
+
+    return PACING_RANGE;
+}
+
+PacingStats FramePacer::get_stats() const
+{
+    PacingStats stats;
+
+    SDL_LockMutex(m_mutex);
+
+    stats.frames_nb = m_frames_nb;
+    stats.overflow_nb = static_cast<int>(m_bins[PACING_OVERFLOW_BIN]);
+    stats.p50_error_ms = get_percentile(0.50, stats.is_p50_overflow) * 1000.0;
+    stats.p99_error_ms = get_percentile(0.99, stats.is_p99_overflow) * 1000.0;
+
+    // The window is filled from its start, until it's full only the first frames are set.
+    const auto window_end = m_window.begin() + m_frames_nb;
+    stats.max_error_ms =
+        m_frames_nb > 0 ? *std::max_element(m_window.begin(), window_end) * 1000.0 : 0.0;
+
+    SDL_UnlockMutex(m_mutex);
+
+    stats.spin_threshold_ms = m_spin_threshold.load() * 1000.0;
+
+    return stats;
+}
+
+std::array<float, PACING_BINS_NB + 1> FramePacer::get_histogram() const
+{
+    std::array<float, PACING_BINS_NB + 1> histogram{};
+
+    SDL_LockMutex(m_mutex);
+
+    std::copy(m_bins.begin(), m_bins.end(), histogram.begin());
+
+    SDL_UnlockMutex(m_mutex);
+
+    return histogram;
+}
+
+void FramePacer::reset()
+{
+    SDL_LockMutex(m_mutex);
+
+    m_bins.fill(0);
+    m_window.fill(0.0);
+    m_window_index = 0;
+    m_frames_nb = 0;
+
+    SDL_UnlockMutex(m_mutex);
+}
+} // namespace YAVE
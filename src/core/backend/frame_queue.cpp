@@ -0,0 +1,72 @@
+#include "core/backend/frame_queue.hpp"
+
+namespace YAVE
+{
+FrameQueue::FrameQueue(std::size_t capacity)
+    : m_ring(std::clamp(capacity, MIN_PICTURE_QUEUE_SIZE, MAX_PICTURE_QUEUE_SIZE))
+{
+    for (auto& slot : m_ring.slots()) {
+        slot.frame = av_frame_alloc();
+    }
+}
+
+FrameQueue::~FrameQueue()
+{
+    for (auto& slot : m_ring.slots()) {
+        av_frame_free(&slot.frame);
+    }
+}
+
+int FrameQueue::enqueue(AVFrame* src_frame, double pts, int timeout_ms)
+{
+    DecodedFrame* slot = m_ring.back();
+
+    if (!slot && m_ring.wait_for_space(timeout_ms)) {
+        slot = m_ring.back();
+    }
+
+    if (!slot) {
+        return AVERROR(EAGAIN);
+    }
+
+    av_frame_move_ref(slot->frame, src_frame);
+    slot->pts = pts;
+
+    m_ring.commit();
+
+    return 0;
+}
+
+void FrameQueue::drop_stale_frames()
+{
+    while (m_ring.is_front_stale()) {
+        av_frame_unref(m_ring.front()->frame);
+        m_ring.pop();
+    }
+}
+
+DecodedFrame* FrameQueue::peek(int timeout_ms)
+{
+    drop_stale_frames();
+
+    if (m_ring.empty() && !m_ring.wait_for_data(timeout_ms)) {
+        return nullptr;
+    }
+
+    drop_stale_frames();
+
+    return m_ring.front();
+}
+
+void FrameQueue::pop()
+{
+    DecodedFrame* slot = m_ring.front();
+
+    if (!slot) {
+        return;
+    }
+
+    av_frame_unref(slot->frame);
+    m_ring.pop();
+}
+} // namespace YAVE
@@ -0,0 +1,235 @@
+#include "core/backend/frame_stepper.hpp"
+
+#include <limits>
+
+namespace YAVE
+{
+namespace
+{
+// The window reaches the last frame of the stream.
+constexpr std::int64_t END_OF_STREAM = std::numeric_limits<std::int64_t>::max();
+} // namespace
+
+FrameStepper::FrameStepper()
+    : m_decoder(DecoderUseCase::STEP)
+{
+}
+
+FrameStepper::~FrameStepper()
+{
+    clear();
+}
+
+int FrameStepper::step(const std::string& path, double pts, FrameStep direction,
+    AVFrame* dest_frame, double* dest_pts)
+{
+    if (path != m_decoder.get_path()) {
+        clear();
+    }
+
+    if (m_decoder.open(path) < 0) {
+        return -1;
+    }
+
+    const std::int64_t timestamp = m_decoder.to_timestamp(pts);
+    const WindowFrame* window_frame = find(timestamp, direction);
+
+    if (!window_frame) {
+        // The last frame of the stream is already on screen.
+        if (direction == FrameStep::NEXT && m_covered_until == END_OF_STREAM &&
+            !m_window.empty() && m_window.front().timestamp <= timestamp) {
+            return AVERROR_EOF;
+        }
+
+        std::int64_t cached_timestamp = 0;
+
+        // Seeks and earlier steps may have decoded the frame already.
+        const int cache_response = direction == FrameStep::PREVIOUS
+            ? FrameCache::find_before(path, timestamp, dest_frame, &cached_timestamp)
+            : FrameCache::find_from(path, timestamp + 1, dest_frame, &cached_timestamp);
+
+        if (cache_response >= 0) {
+            *dest_pts = m_decoder.to_seconds(cached_timestamp);
+            return 0;
+        }
+
+        const int response =
+            direction == FrameStep::PREVIOUS ? fill_before(timestamp) : fill_from(timestamp);
+
+        if (response < 0) {
+            return response;
+        }
+
+        window_frame = find(timestamp, direction);
+    }
+
+    // Nothing before the first frame of the stream or after the last one.
+    if (!window_frame) {
+        return AVERROR_EOF;
+    }
+
+    av_frame_unref(dest_frame);
+
+    if (av_frame_ref(dest_frame, window_frame->frame) < 0) {
+        return -1;
+    }
+
+    *dest_pts = m_decoder.to_seconds(window_frame->timestamp);
+
+    return 0;
+}
+
+void FrameStepper::clear()
+{
+    for (auto& window_frame : m_window) {
+        av_frame_free(&window_frame.frame);
+    }
+
+    m_window.clear();
+    m_covered_until = 0;
+}
+
+const FrameStepper::WindowFrame* FrameStepper::find(
+    std::int64_t timestamp, FrameStep direction) const
+{
+    if (m_window.empty()) {
+        return nullptr;
+    }
+
+    if (direction == FrameStep::PREVIOUS) {
+        // Frames the window doesn't know about may sit between its end and the timestamp.
+        if (m_window.front().timestamp >= timestamp || timestamp - 1 > m_covered_until) {
+            return nullptr;
+        }
+
+        for (auto it = m_window.rbegin(); it != m_window.rend(); ++it) {
+            if (it->timestamp < timestamp) {
+                return &*it;
+            }
+        }
+
+        return nullptr;
+    }
+
+    if (m_window.front().timestamp > timestamp) {
+        return nullptr;
+    }
+
+    for (const auto& window_frame : m_window) {
+        if (window_frame.timestamp > timestamp) {
+            return &window_frame;
+        }
+    }
+
+    return nullptr;
+}
+
+int FrameStepper::fill_before(std::int64_t end_timestamp)
+{
+    std::deque<WindowFrame> frames;
+    std::int64_t previous_timestamp = UNKNOWN_PREVIOUS_TIMESTAMP;
+
+    const int frames_nb =
+        m_decoder.decode_before(end_timestamp, [&](AVFrame* frame, std::int64_t timestamp) {
+            // The whole GOP is decoded, the cache keeps what the window can't.
+            FrameCache::insert(m_decoder.get_path(), frame, timestamp, previous_timestamp);
+            previous_timestamp = timestamp;
+
+            if (frames.size() >= FRAME_STEP_WINDOW_CAPACITY) {
+                av_frame_free(&frames.front().frame);
+                frames.pop_front();
+            }
+
+            AVFrame* window_frame = av_frame_alloc();
+
+            if (!window_frame) {
+                return false;
+            }
+
+            av_frame_move_ref(window_frame, frame);
+            frames.push_back({ window_frame, timestamp });
+
+            return true;
+        });
+
+    if (frames_nb < 0) {
+        for (auto& window_frame : frames) {
+            av_frame_free(&window_frame.frame);
+        }
+
+        return -1;
+    }
+
+    // Stepping back from the first frame of the window, the new frames lead right into it.
+    if (!m_window.empty() && m_window.front().timestamp == end_timestamp) {
+        for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+            m_window.push_front(*it);
+        }
+
+        while (m_window.size() > FRAME_STEP_WINDOW_CAPACITY) {
+            av_frame_free(&m_window.back().frame);
+            m_window.pop_back();
+            m_covered_until = m_window.back().timestamp;
+        }
+
+        return 0;
+    }
+
+    clear();
+
+    m_window = std::move(frames);
+    m_covered_until = end_timestamp - 1;
+
+    return 0;
+}
+
+int FrameStepper::fill_from(std::int64_t timestamp)
+{
+    clear();
+
+    std::size_t next_frames_nb = 0;
+    std::int64_t previous_timestamp = UNKNOWN_PREVIOUS_TIMESTAMP;
+
+    const int response =
+        m_decoder.decode_from(timestamp, [&](AVFrame* frame, std::int64_t frame_timestamp) {
+            FrameCache::insert(m_decoder.get_path(), frame, frame_timestamp, previous_timestamp);
+            previous_timestamp = frame_timestamp;
+
+            // Only the frame on screen is kept from before the timestamp, the window has to
+            // start at or before it.
+            if (frame_timestamp <= timestamp) {
+                clear();
+            } else {
+                ++next_frames_nb;
+            }
+
+            return push_frame(frame, frame_timestamp) &&
+                next_frames_nb + 1 < FRAME_STEP_WINDOW_CAPACITY;
+        });
+
+    if (response < 0 && response != AVERROR_EOF) {
+        clear();
+        return response;
+    }
+
+    if (!m_window.empty()) {
+        m_covered_until = response == AVERROR_EOF ? END_OF_STREAM : m_window.back().timestamp;
+    }
+
+    return 0;
+}
+
+bool FrameStepper::push_frame(AVFrame* frame, std::int64_t timestamp)
+{
+    AVFrame* window_frame = av_frame_alloc();
+
+    if (!window_frame) {
+        return false;
+    }
+
+    av_frame_move_ref(window_frame, frame);
+    m_window.push_back({ window_frame, timestamp });
+
+    return true;
+}
+} // namespace YAVE
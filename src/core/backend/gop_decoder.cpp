@@ -0,0 +1,220 @@
+#include "core/backend/gop_decoder.hpp"
+
+namespace YAVE
+{
+GopDecoder::GopDecoder(DecoderUseCase use_case)
+    : m_use_case(use_case)
+{
+}
+
+GopDecoder::~GopDecoder()
+{
+    close();
+}
+
+int GopDecoder::open(const std::string& path)
+{
+    if (is_open() && path == m_path) {
+        return 0;
+    }
+
+    close();
+
+    if (avformat_open_input(&m_format_ctx, path.c_str(), nullptr, nullptr) < 0 ||
+        avformat_find_stream_info(m_format_ctx, nullptr) < 0) {
+        std::cerr << "[GOP Decoder]: Failed to open " << path << ".\n";
+        close();
+        return -1;
+    }
+
+    m_stream_index = av_find_best_stream(m_format_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+
+    if (m_stream_index < 0) {
+        close();
+        return -1;
+    }
+
+    const AVStream* stream = m_format_ctx->streams[m_stream_index];
+    const AVCodec* av_codec = avcodec_find_decoder(stream->codecpar->codec_id);
+
+    m_codec_ctx = avcodec_alloc_context3(av_codec);
+
+    if (!av_codec || !m_codec_ctx ||
+        avcodec_parameters_to_context(m_codec_ctx, stream->codecpar) < 0) {
+        close();
+        return -1;
+    }
+
+    DecoderThreading::apply(m_codec_ctx, m_use_case);
+
+    if (avcodec_open2(m_codec_ctx, av_codec, nullptr) < 0) {
+        std::cerr << "[GOP Decoder]: Failed to open the video decoder.\n";
+        close();
+        return -1;
+    }
+
+    DecoderThreading::on_codec_opened(m_codec_ctx, m_use_case);
+
+    // Only the video is decoded, the demuxer doesn't even have to read the other streams.
+    for (unsigned int i = 0; i < m_format_ctx->nb_streams; ++i) {
+        if (static_cast<int>(i) != m_stream_index) {
+            m_format_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    m_packet = av_packet_alloc();
+    m_frame = av_frame_alloc();
+
+    if (!m_packet || !m_frame) {
+        close();
+        return -1;
+    }
+
+    m_timebase = stream->time_base;
+    m_first_timestamp = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    m_path = path;
+
+    return 0;
+}
+
+void GopDecoder::close()
+{
+    avcodec_free_context(&m_codec_ctx);
+    avformat_close_input(&m_format_ctx);
+    av_packet_free(&m_packet);
+    av_frame_free(&m_frame);
+
+    m_path.clear();
+    m_stream_index = -1;
+    m_keyframe_index.reset();
+}
+
+int GopDecoder::decode_from(std::int64_t timestamp, const GopFrameCallback& on_frame)
+{
+    if (!is_open()) {
+        return -1;
+    }
+
+    // A second in the stream timebase.
+    const std::int64_t step =
+        std::max<std::int64_t>(av_rescale_q(AV_TIME_BASE, AV_TIME_BASE_Q, m_timebase), 1);
+
+    std::int64_t seek_timestamp = timestamp;
+
+    // The index may have been built by the thumbnail loader since the file was opened.
+    if (!m_keyframe_index) {
+        m_keyframe_index = KeyframeIndex::get(m_path);
+    }
+
+    while (true) {
+        bool is_landed_late = false;
+        int seek_response = -1;
+
+        if (m_keyframe_index && seek_timestamp == timestamp) {
+            seek_response = m_keyframe_index->seek(m_format_ctx, m_stream_index, timestamp);
+        }
+
+        if (seek_response < 0) {
+            seek_response =
+                av_seek_frame(m_format_ctx, m_stream_index, seek_timestamp, AVSEEK_FLAG_BACKWARD);
+        }
+
+        if (seek_response >= 0) {
+            avcodec_flush_buffers(m_codec_ctx);
+
+            bool is_first_frame = true;
+
+            const int response = decode_frames([&](AVFrame* frame, std::int64_t frame_timestamp) {
+                // The keyframe the index pointed to is already past the target.
+                if (is_first_frame && frame_timestamp > timestamp &&
+                    seek_timestamp > m_first_timestamp) {
+                    is_landed_late = true;
+                    return false;
+                }
+
+                is_first_frame = false;
+                return on_frame(frame, frame_timestamp);
+            });
+
+            if (!is_landed_late) {
+                return response;
+            }
+        }
+
+        if (seek_timestamp <= m_first_timestamp) {
+            return AVERROR_EOF;
+        }
+
+        seek_timestamp = std::max(seek_timestamp - step, m_first_timestamp);
+    }
+}
+
+int GopDecoder::decode_before(std::int64_t end_timestamp, const GopFrameCallback& on_frame)
+{
+    int frames_nb = 0;
+    bool is_stopped = false;
+
+    decode_from(end_timestamp - 1, [&](AVFrame* frame, std::int64_t timestamp) {
+        // The decoder outputs in presentation order, the first frame past the end ends it.
+        if (timestamp >= end_timestamp) {
+            return false;
+        }
+
+        ++frames_nb;
+        is_stopped = !on_frame(frame, timestamp);
+
+        return !is_stopped;
+    });
+
+    return is_stopped ? -1 : frames_nb;
+}
+
+int GopDecoder::decode_frames(const GopFrameCallback& on_frame)
+{
+    bool is_draining = false;
+
+    while (true) {
+        if (!is_draining && av_read_frame(m_format_ctx, m_packet) < 0) {
+            is_draining = true;
+        } else if (!is_draining && m_packet->stream_index != m_stream_index) {
+            av_packet_unref(m_packet);
+            continue;
+        }
+
+        const DecodeTimer decode_timer(m_use_case);
+
+        // A broken packet only costs its own frames, the rest of the GOP still decodes.
+        avcodec_send_packet(m_codec_ctx, is_draining ? nullptr : m_packet);
+        av_packet_unref(m_packet);
+
+        int frames_nb = 0;
+        int response = 0;
+
+        while ((response = avcodec_receive_frame(m_codec_ctx, m_frame)) == 0) {
+            const std::int64_t timestamp = m_frame->best_effort_timestamp;
+
+            if (timestamp == AV_NOPTS_VALUE) {
+                av_frame_unref(m_frame);
+                continue;
+            }
+
+            ++frames_nb;
+
+            const bool should_continue = on_frame(m_frame, timestamp);
+            av_frame_unref(m_frame);
+
+            if (!should_continue) {
+                decode_timer.record(frames_nb);
+                return 0;
+            }
+        }
+
+        decode_timer.record(frames_nb);
+
+        // A decoding error ends the GOP like the end of the stream does.
+        if (response != AVERROR(EAGAIN)) {
+            return AVERROR_EOF;
+        }
+    }
+}
+} // namespace YAVE
@@ -0,0 +1,156 @@
+#include "core/backend/keyframe_index.hpp"
+
+namespace YAVE
+{
+std::unordered_map<std::string, std::shared_ptr<const KeyframeIndex>> KeyframeIndex::s_Indexes;
+std::set<std::string> KeyframeIndex::s_PendingPaths;
+
+SDL_mutex* KeyframeIndex::s_Mutex = SDL_CreateMutex();
+SDL_cond* KeyframeIndex::s_BuiltCond = SDL_CreateCond();
+
+KeyframeIndex::KeyframeIndex(std::vector<KeyframeEntry> entries, std::int64_t frames_nb)
+    : m_entries(std::move(entries)), m_frames_nb(frames_nb)
+{
+}
+
+std::shared_ptr<const KeyframeIndex> KeyframeIndex::build(const std::string& path)
+{
+    SDL_LockMutex(s_Mutex);
+
+    while (s_PendingPaths.count(path) != 0) {
+        SDL_CondWait(s_BuiltCond, s_Mutex);
+    }
+
+    if (const auto it = s_Indexes.find(path); it != s_Indexes.end()) {
+        auto index = it->second;
+        SDL_UnlockMutex(s_Mutex);
+
+        return index;
+    }
+
+    s_PendingPaths.insert(path);
+    SDL_UnlockMutex(s_Mutex);
+
+    std::shared_ptr<const KeyframeIndex> index = scan(path);
+
+    SDL_LockMutex(s_Mutex);
+
+    s_PendingPaths.erase(path);
+
+    // A failed scan isn't cached, the next build reads the file again.
+    if (index) {
+        s_Indexes[path] = index;
+    }
+
+    SDL_CondBroadcast(s_BuiltCond);
+    SDL_UnlockMutex(s_Mutex);
+
+    return index;
+}
+
+std::shared_ptr<const KeyframeIndex> KeyframeIndex::get(const std::string& path)
+{
+    SDL_LockMutex(s_Mutex);
+
+    const auto it = s_Indexes.find(path);
+    auto index = it != s_Indexes.end() ? it->second : nullptr;
+
+    SDL_UnlockMutex(s_Mutex);
+
+    return index;
+}
+
+const KeyframeEntry* KeyframeIndex::find(std::int64_t timestamp) const
+{
+    if (m_entries.empty()) {
+        return nullptr;
+    }
+
+    const auto it = std::upper_bound(m_entries.begin(), m_entries.end(), timestamp,
+        [](std::int64_t target, const KeyframeEntry& entry) { return target < entry.pts; });
+
+    return it == m_entries.begin() ? &m_entries.front() : &*std::prev(it);
+}
+
+int KeyframeIndex::seek(
+    AVFormatContext* av_format_ctx, int stream_index, std::int64_t timestamp) const
+{
+    if (stream_index != m_stream_index) {
+        return -1;
+    }
+
+    const KeyframeEntry* keyframe = find(timestamp);
+
+    if (!keyframe) {
+        return -1;
+    }
+
+    const bool can_seek_bytes = !(av_format_ctx->iformat->flags & AVFMT_NO_BYTE_SEEK);
+
+    if (can_seek_bytes && keyframe->position >= 0 &&
+        av_seek_frame(av_format_ctx, stream_index, keyframe->position, AVSEEK_FLAG_BYTE) >= 0) {
+        return 0;
+    }
+
+    // MP4 and MOV can't seek by bytes, but their own index is exact at a keyframe.
+    return av_seek_frame(av_format_ctx, stream_index, keyframe->pts, AVSEEK_FLAG_BACKWARD);
+}
+
+std::shared_ptr<KeyframeIndex> KeyframeIndex::scan(const std::string& path)
+{
+    AVFormatContext* av_format_ctx = nullptr;
+
+    if (avformat_open_input(&av_format_ctx, path.c_str(), nullptr, nullptr) < 0 ||
+        avformat_find_stream_info(av_format_ctx, nullptr) < 0) {
+        std::cerr << "[Keyframe Index]: Failed to open " << path << ".\n";
+        avformat_close_input(&av_format_ctx);
+        return nullptr;
+    }
+
+    const int stream_index =
+        av_find_best_stream(av_format_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+
+    AVPacket* packet = av_packet_alloc();
+
+    if (stream_index < 0 || !packet) {
+        av_packet_free(&packet);
+        avformat_close_input(&av_format_ctx);
+        return nullptr;
+    }
+
+    // The packets of the other streams are still read from the file, but never returned.
+    for (unsigned int i = 0; i < av_format_ctx->nb_streams; ++i) {
+        if (static_cast<int>(i) != stream_index) {
+            av_format_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    auto index = std::make_shared<KeyframeIndex>();
+    index->m_stream_index = stream_index;
+
+    while (av_read_frame(av_format_ctx, packet) >= 0) {
+        if (packet->stream_index != stream_index) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        const std::int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+
+        if ((packet->flags & AV_PKT_FLAG_KEY) && pts != AV_NOPTS_VALUE) {
+            index->m_entries.push_back({ pts, packet->dts, packet->pos, index->m_frames_nb });
+        }
+
+        ++index->m_frames_nb;
+        av_packet_unref(packet);
+    }
+
+    av_packet_free(&packet);
+    avformat_close_input(&av_format_ctx);
+
+    // The packets arrive in decode order, the keyframes are looked up in presentation order.
+    std::stable_sort(index->m_entries.begin(), index->m_entries.end(),
+        [](const KeyframeEntry& a, const KeyframeEntry& b) { return a.pts < b.pts; });
+
+    return index;
+}
+} // namespace YAVE
@@ -2,53 +2,112 @@
 
 namespace YAVE
 {
-PacketQueue::PacketQueue()
-    : m_nb_packets(0)
+PacketQueue::PacketQueue(std::size_t capacity)
+    : m_ring(capacity)
 {
+    // Allocate every packet up front so the demuxer never allocates on the hot path.
+    for (auto& slot : m_ring.slots()) {
+        slot.av_packet = av_packet_alloc();
+    }
 }
 
-SDL_mutex* PacketQueue::s_GlobalMutex = nullptr;
-SDL_cond* PacketQueue::s_PacketAvailabilityCond = nullptr;
-
-bool PacketQueue::start_audio_dequeue = false;
-
-int PacketQueue::enqueue(const AVPacket* src_packet)
+PacketQueue::~PacketQueue()
 {
-    constexpr int ENQUEUE_DELAY_MS = 100;
+    for (auto& slot : m_ring.slots()) {
+        av_packet_free(&slot.av_packet);
+    }
+}
 
-    if (isFull()) {
-        SDL_Delay(ENQUEUE_DELAY_MS);
+int PacketQueue::try_enqueue(const AVPacket* src_packet, unsigned int serial)
+{
+    // Cleared already, no need to take a slot. A clear after this check is caught on dequeue.
+    if (serial != m_serial.load()) {
+        return 0;
     }
 
-    AVPacket dest_packet;
+    PacketSlot* slot = m_ring.back();
 
-    if (av_packet_ref(&dest_packet, src_packet) < 0) {
-        return -1;
+    if (!slot) {
+        return AVERROR(EAGAIN);
     }
 
-    m_packet_deque.push_back(dest_packet);
-    m_nb_packets++;
+    if (!src_packet || av_packet_ref(slot->av_packet, src_packet) < 0) {
+        return -1;
+    }
 
-    SDL_CondBroadcast(s_PacketAvailabilityCond);
+    slot->serial = serial;
+    m_ring.commit();
 
     return 0;
 }
 
-int PacketQueue::dequeue(AVPacket* dest_packet)
+bool PacketQueue::is_front_stale()
 {
-    if (m_packet_deque.empty() || !dest_packet) {
-        return -1;
+    if (m_ring.is_front_stale()) {
+        return true;
     }
 
-    // Create a copy of the packet and delete the first element
-    if (av_packet_ref(dest_packet, &m_packet_deque.front()) < 0) {
+    // Published after the flush, but read by the demuxer before the clear.
+    const PacketSlot* slot = m_ring.front();
+    return slot && slot->serial != m_serial.load();
+}
+
+void PacketQueue::drop_stale_packets()
+{
+    while (is_front_stale()) {
+        av_packet_unref(m_ring.front()->av_packet);
+        m_ring.pop();
+    }
+}
+
+int PacketQueue::try_dequeue(AVPacket* dest_packet)
+{
+    if (!dest_packet) {
         return -1;
     }
 
-    av_packet_unref(&m_packet_deque.front());
-    m_packet_deque.pop_front();
-    m_nb_packets--;
+    drop_stale_packets();
+
+    PacketSlot* slot = m_ring.front();
+
+    if (!slot) {
+        return AVERROR(EAGAIN);
+    }
+
+    // Hand the payload over to the caller, this leaves the slot blank.
+    av_packet_move_ref(dest_packet, slot->av_packet);
+    m_ring.pop();
 
     return 0;
 }
-} // namespace YAVE
\ No newline at end of file
+
+int PacketQueue::enqueue(const AVPacket* src_packet, unsigned int serial, int timeout_ms)
+{
+    int response = try_enqueue(src_packet, serial);
+
+    if (response != AVERROR(EAGAIN)) {
+        return response;
+    }
+
+    if (!m_ring.wait_for_space(timeout_ms)) {
+        return AVERROR(EAGAIN);
+    }
+
+    return try_enqueue(src_packet, serial);
+}
+
+int PacketQueue::dequeue(AVPacket* dest_packet, int timeout_ms)
+{
+    int response = try_dequeue(dest_packet);
+
+    if (response != AVERROR(EAGAIN)) {
+        return response;
+    }
+
+    if (!m_ring.wait_for_data(timeout_ms)) {
+        return AVERROR(EAGAIN);
+    }
+
+    return try_dequeue(dest_packet);
+}
+} // namespace YAVE
@@ -0,0 +1,163 @@
+#include "core/backend/quality_governor.hpp"
+
+#include <cmath>
+
+#include "core/backend/audio_player.hpp"
+
+namespace YAVE
+{
+namespace
+{
+// How fast the measured lateness follows new frames.
+constexpr double LATENESS_AVG_COEF = 0.9;
+
+// The time a level is kept before the next step down, and before any step up.
+constexpr double STEP_DOWN_COOLDOWN = 1.0;
+constexpr double STEP_UP_COOLDOWN = 5.0;
+
+// Below this fraction of a frame of lateness the playback counts as on time.
+constexpr double ON_TIME_RATIO = 0.25;
+constexpr double HEADROOM_QUEUE_FILL = 0.5;
+} // namespace
+
+void QualityGovernor::record_lateness(double diff, double frame_duration, double queue_fill)
+{
+    const double current_time = av_gettime_relative() / static_cast<double>(AV_TIME_BASE);
+
+    if (m_needs_reset.exchange(false, std::memory_order_relaxed)) {
+        m_average_lateness.store(0.0, std::memory_order_relaxed);
+        m_last_change_time = current_time;
+        m_on_time_since = -1.0;
+    }
+
+    // Past this threshold the clocks are being resynchronized (seek, new input), not late.
+    if (std::abs(diff) >= NOSYNC_THRESHOLD || frame_duration <= 0.0) {
+        return;
+    }
+
+    const double lateness = std::max(-diff, 0.0);
+    const double average_lateness = m_average_lateness.load(std::memory_order_relaxed) *
+            LATENESS_AVG_COEF +
+        lateness * (1.0 - LATENESS_AVG_COEF);
+
+    m_average_lateness.store(average_lateness, std::memory_order_relaxed);
+
+    if (!is_enabled()) {
+        return;
+    }
+
+    const DecodeQuality level = get_level();
+    const double time_since_change = current_time - m_last_change_time;
+
+    if (average_lateness > frame_duration) {
+        m_on_time_since = -1.0;
+
+        if (level != DecodeQuality::PREVIEW_DOWNSCALE && time_since_change >= STEP_DOWN_COOLDOWN) {
+            set_level(next_level(level, 1), current_time);
+        }
+
+        return;
+    }
+
+    const bool has_headroom = average_lateness < frame_duration * ON_TIME_RATIO &&
+        queue_fill >= HEADROOM_QUEUE_FILL;
+
+    if (!has_headroom) {
+        m_on_time_since = -1.0;
+        return;
+    }
+
+    if (m_on_time_since < 0.0) {
+        m_on_time_since = current_time;
+    }
+
+    const bool is_stable = current_time - m_on_time_since >= STEP_UP_COOLDOWN &&
+        time_since_change >= STEP_UP_COOLDOWN;
+
+    if (level != DecodeQuality::FULL && is_stable) {
+        set_level(next_level(level, -1), current_time);
+        m_on_time_since = current_time;
+    }
+}
+
+void QualityGovernor::apply(AVCodecContext* av_codec_ctx)
+{
+    if (!av_codec_ctx) {
+        return;
+    }
+
+    m_max_lowres.store(av_codec_ctx->codec ? av_codec_ctx->codec->max_lowres : 0,
+        std::memory_order_relaxed);
+
+    const DecodeQuality level = get_level();
+    const bool should_skip_nonref = level >= DecodeQuality::SKIP_NONREF_FRAMES ||
+        m_playback_rate.load(std::memory_order_relaxed) >= SKIP_NONREF_PLAYBACK_RATE;
+
+    // Both options are read for every frame, so they can change between packets.
+    av_codec_ctx->skip_loop_filter =
+        level >= DecodeQuality::SKIP_LOOP_FILTER ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    av_codec_ctx->skip_frame = should_skip_nonref ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+}
+
+int QualityGovernor::get_lowres() const noexcept
+{
+    if (get_level() < DecodeQuality::LOWRES) {
+        return 0;
+    }
+
+    return std::min(m_max_lowres.load(std::memory_order_relaxed), 1);
+}
+
+void QualityGovernor::set_enabled(bool is_enabled) noexcept
+{
+    m_is_enabled.store(is_enabled, std::memory_order_relaxed);
+
+    if (!is_enabled) {
+        m_level.store(DecodeQuality::FULL, std::memory_order_relaxed);
+    }
+}
+
+void QualityGovernor::reset(bool reset_level) noexcept
+{
+    if (reset_level) {
+        m_level.store(DecodeQuality::FULL, std::memory_order_relaxed);
+    }
+
+    m_needs_reset.store(true, std::memory_order_relaxed);
+}
+
+const char* QualityGovernor::quality_to_string(DecodeQuality quality)
+{
+    switch (quality) {
+    case DecodeQuality::SKIP_LOOP_FILTER:
+        return "Skip Loop Filter";
+    case DecodeQuality::SKIP_NONREF_FRAMES:
+        return "Skip Non-Reference Frames";
+    case DecodeQuality::LOWRES:
+        return "Low Resolution Decode";
+    case DecodeQuality::PREVIEW_DOWNSCALE:
+        return "Downscaled Preview";
+    case DecodeQuality::FULL:
+    default:
+        return "Full";
+    }
+}
+
+DecodeQuality QualityGovernor::next_level(DecodeQuality level, int direction) const noexcept
+{
+    auto next = static_cast<DecodeQuality>(static_cast<int>(level) + direction);
+
+    // H.264 and HEVC can't decode at a lower resolution, go straight past that step.
+    if (next == DecodeQuality::LOWRES && m_max_lowres.load(std::memory_order_relaxed) == 0) {
+        next = static_cast<DecodeQuality>(static_cast<int>(next) + direction);
+    }
+
+    return next;
+}
+
+void QualityGovernor::set_level(DecodeQuality level, double current_time)
+{
+    m_level.store(level, std::memory_order_relaxed);
+    m_last_change_time = current_time;
+}
+} // namespace YAVE
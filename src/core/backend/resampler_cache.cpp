@@ -0,0 +1,145 @@
+#include "core/backend/resampler_cache.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "core/utils/scoped_lock.hpp"
+
+namespace YAVE
+{
+ResamplerKey ResamplerKey::from_frame(
+    const AVFrame* av_frame, AVSampleFormat out_sample_format, int out_sample_rate, int flags)
+{
+    // Decoders don't always fill in the layout, only the channel count.
+    const std::uint64_t channel_layout = av_frame->channel_layout != 0
+        ? av_frame->channel_layout
+        : static_cast<std::uint64_t>(av_get_default_channel_layout(av_frame->channels));
+
+    ResamplerKey key;
+    key.in_channel_layout = channel_layout;
+    key.in_sample_format = static_cast<AVSampleFormat>(av_frame->format);
+    key.in_sample_rate = av_frame->sample_rate;
+    key.out_channel_layout = channel_layout;
+    key.out_sample_format = out_sample_format;
+    key.out_sample_rate = out_sample_rate;
+    key.flags = flags;
+
+    return key;
+}
+
+int drain_resampler(SwrContext* resampler, const ResamplerKey& key, std::vector<float>& dest)
+{
+    if (!resampler || swr_get_delay(resampler, key.in_sample_rate) <= 0) {
+        return 0;
+    }
+
+    const int pending_nb = swr_get_out_samples(resampler, 0);
+    const int channels_nb = av_get_channel_layout_nb_channels(key.out_channel_layout);
+
+    const auto samples_nb = static_cast<std::size_t>(std::max(pending_nb, 0)) * channels_nb;
+
+    if (dest.size() < samples_nb) {
+        dest.resize(samples_nb);
+    }
+
+    int drained_nb = 0;
+
+    if (pending_nb > 0) {
+        std::array<float*, 1> out_data = { dest.data() };
+
+        drained_nb = swr_convert(
+            resampler, reinterpret_cast<std::uint8_t**>(out_data.data()), pending_nb, nullptr, 0);
+    }
+
+    // Starts the next correction from a clean state, like a freshly built resampler.
+    if (drained_nb < 0 || swr_init(resampler) < 0) {
+        return -1;
+    }
+
+    return drained_nb;
+}
+
+ResamplerCache::ResamplerCache(std::size_t capacity)
+    : m_capacity(std::max<std::size_t>(capacity, 1))
+    , m_mutex(SDL_CreateMutex())
+{
+    m_entries.reserve(m_capacity);
+}
+
+ResamplerCache::~ResamplerCache()
+{
+    m_entries.clear();
+    SDL_DestroyMutex(m_mutex);
+}
+
+ResamplerPtr ResamplerCache::acquire(const ResamplerKey& key)
+{
+    const SDLScopedLock lock(m_mutex);
+
+    m_use_counter++;
+
+    const auto entry = std::find_if(m_entries.begin(), m_entries.end(),
+        [&key](const Entry& cached) { return cached.key == key; });
+
+    if (entry != m_entries.end()) {
+        entry->last_use = m_use_counter;
+        return entry->resampler;
+    }
+
+    ResamplerPtr resampler = create_resampler(key);
+
+    if (!resampler) {
+        return nullptr;
+    }
+
+    if (m_entries.size() >= m_capacity) {
+        const auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+            [](const Entry& lhs, const Entry& rhs) { return lhs.last_use < rhs.last_use; });
+
+        m_entries.erase(oldest);
+    }
+
+    m_entries.push_back(Entry{ key, resampler, m_use_counter });
+
+    return resampler;
+}
+
+void ResamplerCache::clear()
+{
+    const SDLScopedLock lock(m_mutex);
+    m_entries.clear();
+}
+
+std::size_t ResamplerCache::size() const
+{
+    const SDLScopedLock lock(m_mutex);
+    return m_entries.size();
+}
+
+ResamplerPtr ResamplerCache::create_resampler(const ResamplerKey& key)
+{
+    SwrContext* swr_ctx = swr_alloc_set_opts(nullptr,
+        static_cast<std::int64_t>(key.out_channel_layout), key.out_sample_format,
+        key.out_sample_rate, static_cast<std::int64_t>(key.in_channel_layout),
+        key.in_sample_format, key.in_sample_rate, 0, nullptr);
+
+    if (!swr_ctx) {
+        std::cerr << "[Resampler]: Failed to allocate the resampler context.\n";
+        return nullptr;
+    }
+
+    av_opt_set_int(swr_ctx, "flags", key.flags, 0);
+
+    const int init_result = swr_init(swr_ctx);
+
+    if (init_result < 0) {
+        std::cerr << "[Resampler]: Failed to initialize the resampler context: "
+                  << av_error_to_string(init_result) << "\n";
+
+        swr_free(&swr_ctx);
+        return nullptr;
+    }
+
+    return ResamplerPtr(swr_ctx, [](SwrContext* resampler) { swr_free(&resampler); });
+}
+} // namespace YAVE
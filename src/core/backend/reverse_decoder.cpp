@@ -0,0 +1,230 @@
+#include "core/backend/reverse_decoder.hpp"
+
+#include <algorithm>
+
+#include "core/backend/frame_cache.hpp"
+#include "core/backend/packet_queue.hpp"
+
+namespace YAVE
+{
+ReverseDecoder::ReverseDecoder()
+    : m_segments(REVERSE_SEGMENTS_NB)
+    , m_decoder(DecoderUseCase::REVERSE)
+{
+    for (auto& segment : m_segments.slots()) {
+        for (auto& decoded_frame : segment.frames) {
+            decoded_frame.frame = av_frame_alloc();
+        }
+    }
+}
+
+ReverseDecoder::~ReverseDecoder()
+{
+    stop();
+
+    for (auto& segment : m_segments.slots()) {
+        for (auto& decoded_frame : segment.frames) {
+            av_frame_free(&decoded_frame.frame);
+        }
+    }
+}
+
+int ReverseDecoder::start(const std::string& path, double seconds)
+{
+    stop();
+
+    if (m_decoder.open(path) < 0) {
+        return -1;
+    }
+
+    m_start_timestamp = m_decoder.to_timestamp(seconds);
+    m_is_stopping = false;
+    m_has_reached_start = false;
+
+    m_thread = SDL_CreateThread(&decode_backward, "Reverse Decode Thread", this);
+
+    if (!m_thread) {
+        std::cerr << "[Reverse Decoder]: Failed to create the thread: " << SDL_GetError() << "\n";
+        return -1;
+    }
+
+    return 0;
+}
+
+void ReverseDecoder::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    m_is_stopping = true;
+    m_segments.wake_all();
+
+    SDL_WaitThread(m_thread, nullptr);
+    m_thread = nullptr;
+
+    // The thread may have stopped halfway through a segment it never handed over.
+    if (ReverseSegment* segment = m_segments.back()) {
+        release_segment(*segment);
+    }
+
+    // The consumer may be presenting the front segment, it releases the frames itself.
+    m_segments.flush();
+}
+
+DecodedFrame* ReverseDecoder::peek(int timeout_ms)
+{
+    drop_stale_segments();
+
+    if (m_segments.empty() && !m_segments.wait_for_data(timeout_ms)) {
+        return nullptr;
+    }
+
+    drop_stale_segments();
+
+    ReverseSegment* segment = m_segments.front();
+
+    if (!segment) {
+        return nullptr;
+    }
+
+    if (segment->is_start_of_stream || segment->presented_nb >= segment->frames_nb) {
+        if (segment->is_start_of_stream) {
+            m_has_reached_start = true;
+        }
+
+        release_segment(*segment);
+        m_segments.pop();
+        return nullptr;
+    }
+
+    const std::size_t position = segment->frames_nb - 1 - segment->presented_nb;
+
+    return &segment->frames[segment->index_of(position)];
+}
+
+void ReverseDecoder::pop()
+{
+    ReverseSegment* segment = m_segments.front();
+
+    if (!segment) {
+        return;
+    }
+
+    const std::size_t position = segment->frames_nb - 1 - segment->presented_nb;
+    av_frame_unref(segment->frames[segment->index_of(position)].frame);
+
+    // The slot goes back to the decoder once every frame of the segment was presented.
+    if (++segment->presented_nb >= segment->frames_nb) {
+        m_segments.pop();
+    }
+}
+
+void ReverseDecoder::drop_stale_segments()
+{
+    while (m_segments.is_front_stale()) {
+        release_segment(*m_segments.front());
+        m_segments.pop();
+    }
+}
+
+int ReverseDecoder::decode_backward(void* data)
+{
+    auto* decoder = static_cast<ReverseDecoder*>(data);
+
+    std::int64_t end_timestamp = decoder->m_start_timestamp;
+
+    while (!decoder->m_is_stopping) {
+        ReverseSegment* segment = decoder->m_segments.back();
+
+        // Both slots are taken, one is being presented and the other one is prefetched.
+        if (!segment) {
+            decoder->m_segments.wait_for_space(PACKET_QUEUE_WAIT_MS);
+            continue;
+        }
+
+        release_segment(*segment);
+
+        if (decoder->decode_segment(end_timestamp, *segment) < 0) {
+            break;
+        }
+
+        const bool is_start_of_stream = segment->is_start_of_stream;
+
+        if (!is_start_of_stream) {
+            end_timestamp = segment->timestamps[segment->first_index];
+        }
+
+        decoder->m_segments.commit();
+
+        if (is_start_of_stream) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int ReverseDecoder::decode_segment(std::int64_t end_timestamp, ReverseSegment& segment)
+{
+    const int frames_nb =
+        m_decoder.decode_before(end_timestamp, [&](AVFrame* frame, std::int64_t timestamp) {
+            if (m_is_stopping) {
+                return false;
+            }
+
+            keep_frame(segment, frame, timestamp, m_decoder.to_seconds(timestamp));
+            return true;
+        });
+
+    if (frames_nb < 0) {
+        return -1;
+    }
+
+    segment.is_start_of_stream = frames_nb == 0;
+
+    return 0;
+}
+
+void ReverseDecoder::keep_frame(
+    ReverseSegment& segment, AVFrame* frame, std::int64_t timestamp, double pts)
+{
+    if (segment.frames_nb == 0) {
+        constexpr std::size_t BUDGET_BYTES = REVERSE_SEGMENT_BUDGET_MIB * 1024 * 1024;
+        const std::size_t frame_bytes = std::max<std::size_t>(
+            FrameCache::calculate_frame_bytes(frame), 1);
+
+        segment.capacity = std::clamp<std::size_t>(
+            BUDGET_BYTES / frame_bytes, 1, REVERSE_SEGMENT_MAX_FRAMES);
+    }
+
+    std::size_t index = 0;
+
+    if (segment.frames_nb < segment.capacity) {
+        index = segment.index_of(segment.frames_nb);
+        ++segment.frames_nb;
+    } else {
+        // The oldest frame is decoded again with the next segment.
+        index = segment.first_index;
+        segment.first_index = (segment.first_index + 1) % segment.capacity;
+        av_frame_unref(segment.frames[index].frame);
+    }
+
+    av_frame_move_ref(segment.frames[index].frame, frame);
+    segment.frames[index].pts = pts;
+    segment.timestamps[index] = timestamp;
+}
+
+void ReverseDecoder::release_segment(ReverseSegment& segment)
+{
+    for (auto& decoded_frame : segment.frames) {
+        av_frame_unref(decoded_frame.frame);
+    }
+
+    segment.capacity = REVERSE_SEGMENT_MAX_FRAMES;
+    segment.first_index = 0;
+    segment.frames_nb = 0;
+    segment.presented_nb = 0;
+    segment.is_start_of_stream = false;
+}
+} // namespace YAVE
@@ -0,0 +1,188 @@
+#include "core/backend/seek_worker.hpp"
+
+#include <iostream>
+
+namespace YAVE
+{
+SeekWorker::SeekWorker(SeekFunction seek, StepFunction step)
+    : m_seek(std::move(seek))
+    , m_step(std::move(step))
+    , m_mutex(SDL_CreateMutex())
+    , m_request_cond(SDL_CreateCond())
+{
+}
+
+SeekWorker::~SeekWorker()
+{
+    stop();
+
+    SDL_DestroyCond(m_request_cond);
+    SDL_DestroyMutex(m_mutex);
+}
+
+void SeekWorker::request_seek(float seconds)
+{
+    SDL_LockMutex(m_mutex);
+
+    drop_requests_locked(RequestType::SEEK);
+    drop_requests_locked(RequestType::STEP);
+
+    m_requests.push_back({ RequestType::SEEK, seconds, 0, nullptr });
+    ++m_generation;
+
+    if (start_locked() == 0) {
+        SDL_CondSignal(m_request_cond);
+    }
+
+    SDL_UnlockMutex(m_mutex);
+}
+
+void SeekWorker::request_step(FrameStep direction)
+{
+    SDL_LockMutex(m_mutex);
+
+    // The steps in a row are counted in one request, opposite steps cancel each other out.
+    if (!m_requests.empty() && m_requests.back().type == RequestType::STEP) {
+        m_requests.back().steps_nb += static_cast<int>(direction);
+
+        if (m_requests.back().steps_nb == 0) {
+            m_requests.pop_back();
+        }
+    } else {
+        m_requests.push_back({ RequestType::STEP, 0.0f, static_cast<int>(direction), nullptr });
+    }
+
+    if (start_locked() == 0) {
+        SDL_CondSignal(m_request_cond);
+    }
+
+    SDL_UnlockMutex(m_mutex);
+}
+
+void SeekWorker::request_transport(TransportFunction command)
+{
+    SDL_LockMutex(m_mutex);
+
+    // Pressing pause or a shuttle key while holding an arrow key drops the steps behind.
+    drop_requests_locked(RequestType::STEP);
+
+    m_requests.push_back({ RequestType::TRANSPORT, 0.0f, 0, std::move(command) });
+
+    if (start_locked() == 0) {
+        SDL_CondSignal(m_request_cond);
+    }
+
+    SDL_UnlockMutex(m_mutex);
+}
+
+bool SeekWorker::is_stale() const noexcept
+{
+    if (!m_thread || SDL_ThreadID() != m_thread_id) {
+        return false;
+    }
+
+    return m_generation.load() != m_running_generation;
+}
+
+void SeekWorker::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    SDL_LockMutex(m_mutex);
+
+    m_is_stopping = true;
+    m_requests.clear();
+    ++m_generation;
+
+    SDL_CondSignal(m_request_cond);
+    SDL_UnlockMutex(m_mutex);
+
+    SDL_WaitThread(m_thread, nullptr);
+
+    m_thread = nullptr;
+    m_thread_id = 0;
+    m_is_stopping = false;
+}
+
+int SeekWorker::start_locked()
+{
+    if (m_thread) {
+        return 0;
+    }
+
+    m_thread = SDL_CreateThread(&run, "Seek Thread", this);
+
+    if (!m_thread) {
+        std::cerr << "[Seek Worker]: Failed to create the thread: " << SDL_GetError() << "\n";
+        m_requests.clear();
+        return -1;
+    }
+
+    m_thread_id = SDL_GetThreadID(m_thread);
+
+    return 0;
+}
+
+void SeekWorker::drop_requests_locked(RequestType type)
+{
+    std::erase_if(m_requests, [type](const Request& request) { return request.type == type; });
+}
+
+int SeekWorker::run(void* data)
+{
+    auto* worker = static_cast<SeekWorker*>(data);
+
+    SDL_LockMutex(worker->m_mutex);
+
+    while (true) {
+        while (!worker->m_is_stopping && worker->m_requests.empty()) {
+            SDL_CondWait(worker->m_request_cond, worker->m_mutex);
+        }
+
+        if (worker->m_is_stopping) {
+            break;
+        }
+
+        Request& front = worker->m_requests.front();
+        Request request{ front.type, 0.0f, 0, nullptr };
+
+        // The steps are taken one by one, so a new seek drops the ones that are left.
+        if (front.type == RequestType::STEP) {
+            request.steps_nb = front.steps_nb < 0 ? -1 : 1;
+            front.steps_nb -= request.steps_nb;
+
+            if (front.steps_nb == 0) {
+                worker->m_requests.pop_front();
+            }
+        } else {
+            request = std::move(front);
+            worker->m_requests.pop_front();
+        }
+
+        worker->m_running_generation = worker->m_generation.load();
+
+        SDL_UnlockMutex(worker->m_mutex);
+
+        switch (request.type) {
+        case RequestType::SEEK:
+            worker->m_seek(request.seconds);
+            break;
+        case RequestType::STEP:
+            worker->m_step(static_cast<FrameStep>(request.steps_nb));
+            break;
+        case RequestType::TRANSPORT:
+        default:
+            request.command();
+            break;
+        }
+
+        SDL_LockMutex(worker->m_mutex);
+    }
+
+    SDL_UnlockMutex(worker->m_mutex);
+
+    return 0;
+}
+} // namespace YAVE
@@ -4,15 +4,17 @@ namespace YAVE
 {
 std::shared_ptr<VideoPlayer> SubtitlePlayer::video_processor = nullptr;
 decltype(SubtitlePlayer::s_SubtitleGizmos) SubtitlePlayer::s_SubtitleGizmos = {};
+SDL_mutex* SubtitlePlayer::s_SubtitleMutex = nullptr;
 SDL_cond* SubtitlePlayer::s_SubtitleAvailabilityCond = nullptr;
 
 SubtitlePlayer::SubtitlePlayer()
     : m_decoding_thread(nullptr)
     , m_is_thread_active(false)
 {
+    s_SubtitleMutex = SDL_CreateMutex();
     s_SubtitleAvailabilityCond = SDL_CreateCond();
 
-    if (!s_SubtitleAvailabilityCond) {
+    if (!s_SubtitleMutex || !s_SubtitleAvailabilityCond) {
         std::cerr << "[Subtitle Player]: Failed to create a conditional variable.\n";
     }
 }
@@ -22,11 +24,12 @@ SubtitlePlayer::SubtitlePlayer(const std::string& input_file_path)
     , m_decoding_thread(nullptr)
     , m_is_thread_active(false)
 {
-    open_srt_file(input_file_path);
-
+    s_SubtitleMutex = SDL_CreateMutex();
     s_SubtitleAvailabilityCond = SDL_CreateCond();
 
-    if (!s_SubtitleAvailabilityCond) {
+    open_srt_file(input_file_path);
+
+    if (!s_SubtitleMutex || !s_SubtitleAvailabilityCond) {
         std::cerr << "[Subtitle Player]: Failed to create a conditional variable.\n";
     }
 }
@@ -34,6 +37,7 @@ SubtitlePlayer::SubtitlePlayer(const std::string& input_file_path)
 SubtitlePlayer::~SubtitlePlayer()
 {
     SDL_DestroyCond(s_SubtitleAvailabilityCond);
+    SDL_DestroyMutex(s_SubtitleMutex);
 };
 
 void SubtitlePlayer::update_subtitles(const std::string& input_file_path)
@@ -54,6 +58,8 @@ void SubtitlePlayer::update_subtitles(const std::string& input_file_path)
 
     request_srt_editor_load(subtitle_editor_ptr.release());
 
+    SDL_LockMutex(s_SubtitleMutex);
+
     s_SubtitleGizmos.clear();
     s_SubtitleGizmos.reserve(m_subtitles.size());
 
@@ -67,6 +73,7 @@ void SubtitlePlayer::update_subtitles(const std::string& input_file_path)
     });
 
     SDL_CondBroadcast(s_SubtitleAvailabilityCond);
+    SDL_UnlockMutex(s_SubtitleMutex);
 }
 
 void SubtitlePlayer::open_srt_file(const std::string& input_file_path)
@@ -107,16 +114,14 @@ int SubtitlePlayer::callback(void* userdata)
 
     // Synchronize the video and the subtitles.
     for (int n = 0; Application::s_IsRunning;) {
-        SDL_LockMutex(PacketQueue::s_GlobalMutex);
+        SDL_LockMutex(s_SubtitleMutex);
 
         if (s_SubtitleGizmos.empty()) {
-            SDL_CondWait(s_SubtitleAvailabilityCond, PacketQueue::s_GlobalMutex);
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+            SDL_CondWait(s_SubtitleAvailabilityCond, s_SubtitleMutex);
+            SDL_UnlockMutex(s_SubtitleMutex);
             continue;
         }
 
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
-
         const double master_clock = AudioPlayer::get_video_internal_clock();
         bool is_subtitle_present = false;
 
@@ -144,6 +149,8 @@ int SubtitlePlayer::callback(void* userdata)
             });
 
 
+        SDL_UnlockMutex(s_SubtitleMutex);
+
         if (!is_subtitle_present) {
             request_subtitle_gizmo_refresh(empty_subtitles);
         }
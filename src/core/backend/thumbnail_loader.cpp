@@ -115,6 +115,8 @@ int ThumbnailLoader::pick_best_thumbnail(Thumbnail* data, bool use_middle_frame)
             continue;
         }
 
+        const DecodeTimer decode_timer(DecoderUseCase::THUMBNAIL);
+
         response = avcodec_send_packet(av_codec_ctx, packet);
 
         if (response == AVERROR(EAGAIN)) {
@@ -128,6 +130,7 @@ int ThumbnailLoader::pick_best_thumbnail(Thumbnail* data, bool use_middle_frame)
         }
 
         response = avcodec_receive_frame(av_codec_ctx, current_frame);
+        decode_timer.record(response == 0 ? 1 : 0);
 
         if (response == AVERROR(EAGAIN)) {
             av_packet_unref(packet);
@@ -189,6 +192,16 @@ int ThumbnailLoader::update_framebuffer(Thumbnail* data)
     const int width = data->stream_info.width;
     const int height = data->stream_info.height;
 
+    const bool is_same_size = m_av_frame->width == width && m_av_frame->height == height;
+
+    if (is_same_size &&
+        ColorConverter::convert_parallel(m_av_frame, data->framebuffer, width * COLOR_CHANNELS_NB,
+            WorkerPool::shared()) == 0) {
+        data->dimension.x = m_av_frame->width;
+        data->dimension.y = m_av_frame->height;
+        return 0;
+    }
+
     SwsContext* sws_scaler_ctx =
         sws_getContext(width, height, data->stream_info.av_codec_ctx->pix_fmt, width, height,
             AV_PIX_FMT_RGB0, SWS_BILINEAR, nullptr, nullptr, nullptr);
@@ -197,6 +210,8 @@ int ThumbnailLoader::update_framebuffer(Thumbnail* data)
         return -1;
     }
 
+    ColorConverter::set_sws_colorspace(sws_scaler_ctx, m_av_frame);
+
     std::array<std::uint8_t*, COLOR_CHANNELS_NB> dest = { data->framebuffer, nullptr, nullptr,
         nullptr };
 
@@ -221,6 +236,8 @@ int ThumbnailLoader::send_packet(Thumbnail* data, int retry_nb)
         return send_packet(data, ++retry_nb);
     };
 
+    const DecodeTimer decode_timer(DecoderUseCase::THUMBNAIL);
+
     int send_pkt_err = avcodec_send_packet(data->stream_info.av_codec_ctx, m_av_packet);
 
     if (send_pkt_err == AVERROR_EOF) {
@@ -239,6 +256,7 @@ int ThumbnailLoader::send_packet(Thumbnail* data, int retry_nb)
     }
 
     int recieve_frame_errcode = avcodec_receive_frame(data->stream_info.av_codec_ctx, m_av_frame);
+    decode_timer.record(recieve_frame_errcode == 0 ? 1 : 0);
 
     if (recieve_frame_errcode == AVERROR_EOF) {
         av_packet_unref(m_av_packet);
@@ -278,8 +296,18 @@ int ThumbnailLoader::peek_video_frame_by_timestamp(const int64_t seconds, Thumbn
     const auto target_timestamp =
         static_cast<int64_t>(seconds / av_q2d(data->stream_info.timebase));
 
-    int seek_ret = av_seek_frame(data->av_format_context, data->stream_info.stream_index,
-        target_timestamp, AVSEEK_FLAG_BACKWARD);
+    int seek_ret = -1;
+
+    // Lands on the keyframe packet itself, even in containers with a sparse index.
+    if (m_keyframe_index) {
+        seek_ret = m_keyframe_index->seek(
+            data->av_format_context, data->stream_info.stream_index, target_timestamp);
+    }
+
+    if (seek_ret < 0) {
+        seek_ret = av_seek_frame(data->av_format_context, data->stream_info.stream_index,
+            target_timestamp, AVSEEK_FLAG_BACKWARD);
+    }
 
     avcodec_flush_buffers(data->stream_info.av_codec_ctx);
 
@@ -335,11 +363,16 @@ int ThumbnailLoader::open_file(std::string filename, Thumbnail* userdata)
         return -1;
     }
 
+    DecoderThreading::apply(userdata->stream_info.av_codec_ctx, DecoderUseCase::THUMBNAIL);
+
     if (avcodec_open2(
             userdata->stream_info.av_codec_ctx, userdata->stream_info.av_codec, nullptr)) {
         return -1;
     }
 
+    DecoderThreading::on_codec_opened(
+        userdata->stream_info.av_codec_ctx, DecoderUseCase::THUMBNAIL);
+
     if (userdata->stream_info.width <= 0 || userdata->stream_info.height <= 0) {
         return -1;
     }
@@ -357,6 +390,10 @@ std::optional<Thumbnail*> ThumbnailLoader::load_video_thumbnail(const std::strin
 {
     auto* data = new Thumbnail();
 
+    // Every imported file passes through here first, so the player finds the index ready
+    // by the time the file is opened. Only the packets are read, nothing is decoded.
+    m_keyframe_index = KeyframeIndex::build(path);
+
     if (open_file(path, reinterpret_cast<Thumbnail*>(data)) < 0) {
         return std::nullopt;
     }
@@ -4,13 +4,49 @@
 namespace YAVE
 {
 std::unique_ptr<PacketQueue> VideoPlayer::s_VideoPacketQueue = std::make_unique<PacketQueue>();
+std::unique_ptr<FrameQueue> VideoPlayer::s_PictureQueue = nullptr;
 VideoQueue VideoPlayer::s_VideoFileQueue = {};
+AVFrame* VideoPlayer::s_PreviewFrame = nullptr;
+std::atomic<bool> VideoPlayer::s_UsePlanarPreview = false;
+std::unique_ptr<ReverseDecoder> VideoPlayer::s_ReverseDecoder = std::make_unique<ReverseDecoder>();
+
+namespace
+{
+/**
+ * @brief The next shuttle speed above a rate, the fastest one is kept.
+ */
+[[nodiscard]] double next_shuttle_rate(double playback_rate) noexcept
+{
+    for (const double rate : SHUTTLE_RATES) {
+        if (rate > playback_rate + 1e-6) {
+            return rate;
+        }
+    }
+
+    return SHUTTLE_RATES.back();
+}
+} // namespace
 
 VideoPlayer::VideoPlayer(SampleRate t_sample_rate)
     : m_video_state(std::make_shared<VideoState>())
+    , m_decoding_tid(nullptr)
+    , m_audio_decode_tid(nullptr)
+    , m_video_tid(nullptr)
+    , m_presentation_tid(nullptr)
 {
+    m_seek_worker = std::make_unique<SeekWorker>(
+        [this](float seconds) {
+            if (seek_frame(seconds, m_video_state->flags & VideoFlags::IS_PAUSED) < 0) {
+                std::cerr << "Failed to jump to timestamp: " << seconds << "\n";
+            }
+        },
+        [this](FrameStep direction) { apply_frame_step(direction); });
+
     m_audio_state->sample_rate = t_sample_rate;
     SDL_RegisterEvents(8);
+
+    // Other threads (e.g the file loading listener) wait on these before a video is opened.
+    init_mutex();
 }
 
 VideoPlayer::~VideoPlayer()
@@ -19,8 +55,7 @@ VideoPlayer::~VideoPlayer()
         stop_threads();
         free_ffmpeg();
         free_sdl_mixer();
-
-        av_freep(&m_video_state->buffer);
+        free_frame_buffers();
     }
 }
 #pragma region Stream Setup
@@ -75,61 +110,81 @@ int VideoPlayer::create_context_for_stream(StreamInfoPtr& stream_info)
         return -1;
     }
 
+    // Audio decoders don't scale with threads, only the video decoder follows the policy.
+    const bool is_video_stream = stream_info->av_codec_params->codec_type == AVMEDIA_TYPE_VIDEO;
+
+    if (is_video_stream) {
+        DecoderThreading::apply(stream_info->av_codec_ctx, DecoderUseCase::PLAYER);
+    }
+
     if (avcodec_open2(stream_info->av_codec_ctx, stream_info->av_codec, nullptr) < 0) {
         std::cout << "Failed to open the codec using avcodec_open2.\n";
         return -1;
     }
 
+    if (is_video_stream) {
+        DecoderThreading::on_codec_opened(stream_info->av_codec_ctx, DecoderUseCase::PLAYER);
+    }
+
     return 0;
 }
 
 #pragma endregion Stream Setup
 
 #pragma region Init Functions
-int VideoPlayer::init_sws_scaler_ctx(VideoState* video_state)
+int VideoPlayer::init_sws_scaler_ctx(VideoState* video_state, VideoDimension dest_dimensions)
 {
-    if (video_state->flags & VideoFlags::IS_SWS_INITIALIZED) {
-        return 0;
-    }
-
     auto& sws_scaler_ctx = video_state->sws_scaler_ctx;
 
-    const auto& stream_info = s_StreamList.at("Video");
+    const AVFrame* frame = s_LatestFrame;
 
-    auto& width = video_state->dimensions.x;
-    auto& height = video_state->dimensions.y;
-
-    // Convert planar YUV 4:2:0 pixel format to packed RGB 8:8:8 pixel format
+    // Convert the decoded pixel format to packed RGB 8:8:8 at the preview size
     // with bilinear rescaling algorithm.
-    sws_scaler_ctx = sws_getContext(width, height, stream_info->av_codec_ctx->pix_fmt, width,
-        height, AV_PIX_FMT_RGB0, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    sws_scaler_ctx = sws_getCachedContext(sws_scaler_ctx, frame->width, frame->height,
+        static_cast<AVPixelFormat>(frame->format), dest_dimensions.x, dest_dimensions.y,
+        AV_PIX_FMT_RGB0, SWS_BILINEAR, nullptr, nullptr, nullptr);
 
     if (!sws_scaler_ctx) {
         std::cout << "Failed to initialize the sw scaler.\n";
         return -1;
     }
 
+    ColorConverter::set_sws_colorspace(sws_scaler_ctx, frame);
+
     video_state->flags |= VideoFlags::IS_SWS_INITIALIZED;
 
     return 0;
 }
 
-int VideoPlayer::allocate_frame_buffer(AVPixelFormat pix_fmt, VideoDimension dimensions)
+int VideoPlayer::allocate_frame_buffer(PreviewFramebuffer& framebuffer, VideoDimension dimensions)
 {
     constexpr int LINESIZE_ALIGNMENT = 32;
 
     const auto buffer_size =
         av_image_get_buffer_size(AV_PIX_FMT_RGBA, dimensions.x, dimensions.y, LINESIZE_ALIGNMENT);
 
-    const auto total_buffer_size = buffer_size * sizeof(std::uint8_t);
+    if (buffer_size < 0) {
+        return -1;
+    }
 
-    m_video_state->buffer = static_cast<std::uint8_t*>(av_malloc(total_buffer_size));
+    const auto total_buffer_size = static_cast<std::size_t>(buffer_size) * sizeof(std::uint8_t);
 
-    if (!m_video_state->buffer) {
-        std::cout << "Failed to allocate memory for the framebuffer.\n";
-        return -1;
+    if (framebuffer.capacity < total_buffer_size) {
+        av_freep(&framebuffer.data);
+        framebuffer.capacity = 0;
+
+        framebuffer.data = static_cast<std::uint8_t*>(av_malloc(total_buffer_size));
+
+        if (!framebuffer.data) {
+            std::cout << "Failed to allocate memory for the framebuffer.\n";
+            return -1;
+        }
+
+        framebuffer.capacity = total_buffer_size;
     }
 
+    framebuffer.dimensions = dimensions;
+
     return 0;
 }
 
@@ -143,22 +198,32 @@ int VideoPlayer::init_mutex()
 
     is_initialized = true;
 
-    PacketQueue::s_GlobalMutex = SDL_CreateMutex();
-    if (!PacketQueue::s_GlobalMutex) {
+    auto& [file_queue, demuxer, video_codec, audio_codec, playback_state, preview_frame,
+        audio_device] = *s_Locks;
+
+    file_queue = SDL_CreateMutex();
+    demuxer = SDL_CreateMutex();
+    video_codec = SDL_CreateMutex();
+    audio_codec = SDL_CreateMutex();
+    playback_state = SDL_CreateMutex();
+    preview_frame = SDL_CreateMutex();
+    audio_device = SDL_CreateMutex();
+
+    if (!file_queue || !demuxer || !video_codec || !audio_codec || !playback_state ||
+        !preview_frame || !audio_device) {
         std::cerr << "Failed to create a mutex: " << SDL_GetError() << "\n";
         return -1;
     }
 
     s_VideoPausedCond = SDL_CreateCond();
+    s_PresenterParkedCond = SDL_CreateCond();
     s_FrameAvailabilityCond = SDL_CreateCond();
-    PacketQueue::s_PacketAvailabilityCond = SDL_CreateCond();
 
-    if (!s_VideoPausedCond || !PacketQueue::s_PacketAvailabilityCond || !s_FrameAvailabilityCond) {
+    if (!s_VideoPausedCond || !s_PresenterParkedCond || !s_FrameAvailabilityCond) {
         std::cerr << "Failed to create a condition variable: " << SDL_GetError() << "\n";
-        SDL_DestroyMutex(PacketQueue::s_GlobalMutex);
         SDL_DestroyCond(s_VideoPausedCond);
+        SDL_DestroyCond(s_PresenterParkedCond);
         SDL_DestroyCond(s_FrameAvailabilityCond);
-        SDL_DestroyCond(PacketQueue::s_PacketAvailabilityCond);
 
         return -1;
     }
@@ -168,21 +233,6 @@ int VideoPlayer::init_mutex()
 
 #pragma endregion Init Functions
 
-#pragma region Helper Functions
-[[nodiscard]] int VideoPlayer::nb_samples_per_frame(AVPacket* packet, AVFrame* frame)
-{
-    std::optional<AVFrame*> first_audio_frame =
-        get_first_audio_frame(m_video_state->av_format_ctx, packet, frame);
-
-    seek_frame(0.0);
-
-    if (first_audio_frame.has_value()) {
-        return first_audio_frame.value()->nb_samples;
-    }
-
-    return DEFAULT_SAMPLES_BUFFER_SIZE;
-}
-
 #pragma region Video Reader
 
 int VideoPlayer::init_codecs()
@@ -197,17 +247,20 @@ int VideoPlayer::init_codecs()
         }
     }
 
+    // A new input starts at the full quality, its decoder may be a lot faster.
+    m_video_state->quality_governor.reset(true);
+
     return 0;
 }
 
 int VideoPlayer::allocate_video(const char* filename)
 {
-    SDL_LockMutex(PacketQueue::s_GlobalMutex);
+    SDL_LockMutex(s_Locks->demuxer);
 
     auto& av_format_ctx = m_video_state->av_format_ctx;
 
     if (m_video_state->flags & VideoFlags::IS_INITIALIZED) {
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        SDL_UnlockMutex(s_Locks->demuxer);
         return 0;
     }
 
@@ -219,6 +272,7 @@ int VideoPlayer::allocate_video(const char* filename)
 
         if (!av_format_ctx) {
             std::cout << "Failed to allocate memory for the format context.\n";
+            SDL_UnlockMutex(s_Locks->demuxer);
             return -1;
         };
 
@@ -227,6 +281,7 @@ int VideoPlayer::allocate_video(const char* filename)
 
     if (avformat_open_input(&av_format_ctx, filename, nullptr, nullptr) < 0) {
         std::cout << "[Video Player]: Failed to open the specified input.\n";
+        SDL_UnlockMutex(s_Locks->demuxer);
         return -1;
     };
 
@@ -236,6 +291,7 @@ int VideoPlayer::allocate_video(const char* filename)
 
     if (init_codecs() < 0) {
         std::cout << "[Video Player]: Failed to find a valid codec.\n";
+        SDL_UnlockMutex(s_Locks->demuxer);
         return -1;
     };
 
@@ -244,9 +300,17 @@ int VideoPlayer::allocate_video(const char* filename)
         s_LatestPacket = av_packet_alloc();
     }
 
+    SDL_LockMutex(s_Locks->preview_frame);
+
+    if (!s_PreviewFrame) {
+        s_PreviewFrame = av_frame_alloc();
+    }
+
+    SDL_UnlockMutex(s_Locks->preview_frame);
+
     m_video_state->flags |= VideoFlags::IS_INITIALIZED;
 
-    SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+    SDL_UnlockMutex(s_Locks->demuxer);
     return 0;
 }
 
@@ -267,12 +331,8 @@ int VideoPlayer::init_threads(AVRational* timebase)
 
     update_video_dimensions();
 
-    int ret = this->allocate_frame_buffer(
-        video_stream_info->av_codec_ctx->pix_fmt, m_video_state->dimensions);
-
-    if (ret != 0) {
-        return -1;
-    }
+    // The presenter allocates the framebuffers at the preview size with the first frame.
+    free_frame_buffers();
 
     if (timebase != nullptr) {
         *timebase = video_stream_info->timebase;
@@ -291,8 +351,23 @@ int VideoPlayer::init_threads(AVRational* timebase)
         return 0;
     }
 
+    if (!s_PictureQueue) {
+        s_PictureQueue = std::make_unique<FrameQueue>(m_video_state->picture_queue_size);
+    }
+
     m_video_tid = SDL_CreateThread(&video_callback, "Video Thread", m_video_state.get());
+    m_presentation_tid =
+        SDL_CreateThread(&present_frames, "Presentation Thread", m_video_state.get());
     m_decoding_tid = SDL_CreateThread(&enqueue_packets, "Decoding Thread", m_video_state.get());
+
+    // Files without an audio stream have nothing to decode ahead.
+    const auto audio_stream = s_StreamList.find("Audio");
+
+    if (audio_stream != s_StreamList.end() && audio_stream->second->stream_index >= 0) {
+        m_audio_decode_tid =
+            SDL_CreateThread(&decode_audio_ahead, "Audio Decode Thread", m_audio_state.get());
+    }
+
     m_video_state->flags |= VideoFlags::IS_DECODING_THREAD_ACTIVE;
 
     return 0;
@@ -302,10 +377,11 @@ int VideoPlayer::init_threads(AVRational* timebase)
 
 #pragma region Frame Processing
 
-int VideoPlayer::refresh_texture()
+int VideoPlayer::refresh_texture(FrameRefreshType type)
 {
-    SDL_Event event;
+    SDL_Event event{};
     event.type = static_cast<std::uint32_t>(CustomVideoEvents::FF_REFRESH_VIDEO_EVENT);
+    event.user.code = static_cast<Sint32>(type);
 
     if (SDL_PushEvent(&event) == 0) {
         return -1;
@@ -330,47 +406,278 @@ void VideoPlayer::apply_filters(VideoState* video_state, AVFrame* av_frame)
     }
 }
 
+int VideoPlayer::share_preview_frame(VideoState* video_state)
+{
+    const bool is_same_size = s_LatestFrame->width == video_state->dimensions.x &&
+        s_LatestFrame->height == video_state->dimensions.y;
+
+    // The RGBA path sizes the preview texture from the video dimensions, keep them in sync.
+    if (!is_same_size || !ColorConverter::is_supported(s_LatestFrame)) {
+        return -1;
+    }
+
+    int ret = -1;
+
+    SDL_LockMutex(s_Locks->preview_frame);
+
+    // A frame the UI thread hasn't picked up yet is simply replaced.
+    if (s_PreviewFrame) {
+        av_frame_unref(s_PreviewFrame);
+        ret = av_frame_ref(s_PreviewFrame, s_LatestFrame);
+    }
+
+    SDL_UnlockMutex(s_Locks->preview_frame);
+
+    if (ret < 0) {
+        return -1;
+    }
+
+    return refresh_texture(FrameRefreshType::PLANAR_FRAME);
+}
+
+const char* VideoPlayer::preview_quality_to_string(PreviewQuality quality)
+{
+    switch (quality) {
+    case PreviewQuality::FULL:
+        return "Full";
+    case PreviewQuality::HALF:
+        return "Half";
+    case PreviewQuality::QUARTER:
+        return "Quarter";
+    case PreviewQuality::FIT:
+    default:
+        return "Fit to Panel";
+    }
+}
+
+const char* VideoPlayer::frame_drop_policy_to_string(FrameDropPolicy policy)
+{
+    switch (policy) {
+    case FrameDropPolicy::NEVER:
+        return "Never Drop";
+    case FrameDropPolicy::DROP_TO_KEYFRAME:
+        return "Drop to Keyframe";
+    case FrameDropPolicy::DROP_LATE:
+    default:
+        return "Drop Late Frames";
+    }
+}
+
+VideoDimension VideoPlayer::calculate_preview_dimensions(
+    const VideoState* video_state, VideoDimension source)
+{
+    double scale = 1.0;
+
+    switch (video_state->preview_quality.load()) {
+    case PreviewQuality::HALF:
+        scale = 0.5;
+        break;
+    case PreviewQuality::QUARTER:
+        scale = 0.25;
+        break;
+    case PreviewQuality::FIT: {
+        const int viewport_width = video_state->viewport_width;
+        const int viewport_height = video_state->viewport_height;
+
+        // The panel hasn't been drawn yet, start at the full size.
+        if (viewport_width <= 0 || viewport_height <= 0) {
+            break;
+        }
+
+        // Whichever side of the panel limits the picture, the size only changes in steps.
+        const double fitted_width = std::min(static_cast<double>(viewport_width),
+            static_cast<double>(viewport_height) * source.x / source.y);
+
+        const int stepped_width = static_cast<int>(std::ceil(fitted_width / PREVIEW_WIDTH_STEP)) *
+            PREVIEW_WIDTH_STEP;
+
+        scale = static_cast<double>(stepped_width) / source.x;
+    } break;
+    case PreviewQuality::FULL:
+    default:
+        break;
+    }
+
+    // The last step of the quality governor, when even the decoder shortcuts weren't enough.
+    if (video_state->quality_governor.is_preview_downscaled()) {
+        scale = std::min(scale, 1.0) * 0.5;
+    }
+
+    if (scale >= 1.0) {
+        return source;
+    }
+
+    // Even sizes keep the chroma of 4:2:0 sources aligned in swscale.
+    VideoDimension preview;
+    preview.x = std::max(2, static_cast<int>(std::lround(source.x * scale)) & ~1);
+    preview.y = std::max(2, static_cast<int>(std::lround(source.y * scale)) & ~1);
+
+    return preview;
+}
+
 unsigned int VideoPlayer::update_framebuffer(Uint32 interval, void* user_data)
 {
     auto* data = static_cast<VideoState*>(user_data);
     auto& sws_scaler_ctx = data->sws_scaler_ctx;
 
-    if (init_sws_scaler_ctx(data) < 0) {
+    const std::int64_t start_time = av_gettime_relative();
+
+    const bool is_same_size = s_LatestFrame->width == data->dimensions.x &&
+        s_LatestFrame->height == data->dimensions.y;
+
+    int slices_nb = 1;
+
+    // The planes only get referenced here, the upload and the conversion run on the GPU.
+    data->is_using_planar_upload = s_UsePlanarPreview && share_preview_frame(data) == 0;
+
+    // The presenter owns the back buffer, the UI thread may be uploading the front one.
+    PreviewFramebuffer& framebuffer = data->framebuffers.back();
+
+    // Sized from the stream, so frames decoded at a lower resolution get scaled back up.
+    const VideoDimension preview_dimensions = calculate_preview_dimensions(data, data->dimensions);
+
+    const bool is_full_size = is_same_size && preview_dimensions.x == s_LatestFrame->width &&
+        preview_dimensions.y == s_LatestFrame->height;
+
+    if (!data->is_using_planar_upload &&
+        allocate_frame_buffer(framebuffer, preview_dimensions) < 0) {
         return -1;
     }
 
-    std::array<std::uint8_t*, COLOR_CHANNELS_NB> dest = { data->buffer, nullptr, nullptr, nullptr };
+    std::uint8_t* dest_buffer = framebuffer.data;
+    const int dest_stride = preview_dimensions.x * COLOR_CHANNELS_NB;
 
-    std::array<int, COLOR_CHANNELS_NB> dest_linesize = { 0, 0, 0, 0 };
-    dest_linesize[0] = data->dimensions.x * COLOR_CHANNELS_NB;
+    // Full-size 8-bit YUV is converted by the SIMD kernels, everything else goes to swscale.
+    data->is_using_fast_conversion = !data->is_using_planar_upload && is_full_size &&
+        ColorConverter::convert_parallel(
+            s_LatestFrame, dest_buffer, dest_stride, WorkerPool::shared(), &slices_nb) == 0;
 
-    sws_scale(sws_scaler_ctx, s_LatestFrame->data, s_LatestFrame->linesize, 0, data->dimensions.y,
-        dest.data(), dest_linesize.data());
+    const bool needs_swscale = !data->is_using_planar_upload && !data->is_using_fast_conversion;
+
+    if (data->is_using_planar_upload) {
+        slices_nb = 0;
+    } else if (needs_swscale && is_full_size) {
+        if (scale_frame_sliced(data, dest_buffer, dest_stride, &slices_nb) < 0) {
+            return -1;
+        }
+    } else if (needs_swscale) {
+        if (init_sws_scaler_ctx(data, preview_dimensions) < 0) {
+            return -1;
+        }
 
-    refresh_texture();
+        std::array<std::uint8_t*, COLOR_CHANNELS_NB> dest = { dest_buffer, nullptr, nullptr,
+            nullptr };
+
+        std::array<int, COLOR_CHANNELS_NB> dest_linesize = { 0, 0, 0, 0 };
+        dest_linesize[0] = dest_stride;
+
+        sws_scale(sws_scaler_ctx, s_LatestFrame->data, s_LatestFrame->linesize, 0,
+            s_LatestFrame->height, dest.data(), dest_linesize.data());
+    }
+
+    // The shader path always draws the planes at their full size.
+    data->preview_dimensions = data->is_using_planar_upload
+        ? VideoDimension{ s_LatestFrame->width, s_LatestFrame->height }
+        : preview_dimensions;
+
+    constexpr double CONVERSION_TIME_AVG_COEF = 0.9;
+
+    data->conversion_slices_nb = slices_nb;
+    data->conversion_time_ms = static_cast<double>(av_gettime_relative() - start_time) / 1000.0;
+    data->average_conversion_time_ms =
+        data->average_conversion_time_ms * CONVERSION_TIME_AVG_COEF +
+        data->conversion_time_ms * (1.0 - CONVERSION_TIME_AVG_COEF);
+
+    // Every slice has joined at this point, the frame can be handed to the UI thread.
+    if (!data->is_using_planar_upload) {
+        data->framebuffers.publish();
+        refresh_texture();
+    }
 
     return 0;
 }
 
-#pragma endregion Frame Processing
+int VideoPlayer::scale_frame_sliced(
+    VideoState* video_state, std::uint8_t* dest_buffer, int dest_stride, int* slices_nb)
+{
+    const AVFrame* frame = s_LatestFrame;
+    const auto pix_fmt = static_cast<AVPixelFormat>(frame->format);
+    const AVPixFmtDescriptor* descriptor = av_pix_fmt_desc_get(pix_fmt);
 
-#pragma region Video Synchronization
+    constexpr auto UNSLICEABLE_FORMATS =
+        AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_HWACCEL;
 
-double VideoPlayer::calculate_reference_clock()
-{
-    double ref_clock = s_ClockNetwork->audio_internal_clock;
+    if (!descriptor || (descriptor->flags & UNSLICEABLE_FORMATS)) {
+        return -1;
+    }
+
+    // Slices have to start on a chroma row, or the chroma planes can't be offset.
+    const auto slices = split_into_slices(frame->width, frame->height,
+        WorkerPool::shared().get_workers_nb() + 1, 1 << descriptor->log2_chroma_h);
+
+    auto& slice_contexts = video_state->sws_slice_ctxs;
+
+    if (slice_contexts.size() < slices.size()) {
+        slice_contexts.resize(slices.size(), nullptr);
+    }
+
+    // The contexts are only rebuilt when the size or the format of a slice changes.
+    for (std::size_t i = 0; i < slices.size(); ++i) {
+        const int slice_height = slices[i].row_end - slices[i].row_begin;
 
-    const auto& [channel_nb, buffer_size, sample_rate, buffer_index] = *s_AudioBufferInfo;
+        slice_contexts[i] = sws_getCachedContext(slice_contexts[i], frame->width, slice_height,
+            pix_fmt, frame->width, slice_height, AV_PIX_FMT_RGB0, SWS_BILINEAR, nullptr, nullptr,
+            nullptr);
 
-    int hw_buf_size = buffer_size - buffer_index;
-    int sample_bytes = channel_nb * sizeof(float);
-    int bytes_per_sec = sample_rate * sample_bytes;
+        if (!slice_contexts[i]) {
+            std::cout << "Failed to initialize the sw scaler of a slice.\n";
+            return -1;
+        }
 
-    if (bytes_per_sec > 0) {
-        ref_clock -= static_cast<double>(hw_buf_size) / static_cast<double>(bytes_per_sec);
+        ColorConverter::set_sws_colorspace(slice_contexts[i], frame);
     }
 
-    return ref_clock;
+    WorkerPool::shared().parallel_for(static_cast<int>(slices.size()), [&](int index) {
+        const FrameSlice& slice = slices[index];
+
+        std::array<const std::uint8_t*, COLOR_CHANNELS_NB> src = { nullptr, nullptr, nullptr,
+            nullptr };
+
+        for (int plane = 0; plane < COLOR_CHANNELS_NB; ++plane) {
+            if (!frame->data[plane]) {
+                continue;
+            }
+
+            const bool is_chroma_plane = plane == 1 || plane == 2;
+            const int plane_row =
+                slice.row_begin >> (is_chroma_plane ? descriptor->log2_chroma_h : 0);
+
+            src[plane] = frame->data[plane] + plane_row * frame->linesize[plane];
+        }
+
+        std::array<std::uint8_t*, COLOR_CHANNELS_NB> dest = {
+            dest_buffer + slice.row_begin * dest_stride, nullptr, nullptr, nullptr
+        };
+
+        std::array<int, COLOR_CHANNELS_NB> dest_linesize = { dest_stride, 0, 0, 0 };
+
+        sws_scale(slice_contexts[index], src.data(), frame->linesize, 0,
+            slice.row_end - slice.row_begin, dest.data(), dest_linesize.data());
+    });
+
+    *slices_nb = static_cast<int>(slices.size());
+
+    return 0;
+}
+
+#pragma endregion Frame Processing
+
+#pragma region Video Synchronization
+
+double VideoPlayer::calculate_reference_clock()
+{
+    // The audio clock minus what is still buffered, extrapolated to the current time.
+    return s_ClockNetwork->get_reference_clock();
 }
 
 double VideoPlayer::calculate_actual_delay(VideoState* video_state, double& frame_timer)
@@ -382,16 +689,28 @@ double VideoPlayer::calculate_actual_delay(VideoState* video_state, double& fram
     }
 
     video_state->previous_delay = delay;
-    video_state->previous_pts = video_state->current_pts;
+    video_state->previous_pts = video_state->current_pts.load();
 
-    const double current_time = av_gettime() / static_cast<double>(AV_TIME_BASE);
+    const double current_time = FramePacer::now();
 
     const double ref_clock = calculate_reference_clock();
     const double diff = video_state->current_pts - ref_clock;
 
-    const double sync_threshold = std::max(delay, SYNC_THRESHOLD);
+    video_state->frame_diff = diff;
 
-    if (std::abs(diff) < NOSYNC_THRESHOLD) {
+    // The pts are in media time, the deadlines in wall time.
+    const double playback_rate = s_ClockNetwork->get_playback_rate();
+
+    const double queue_fill = s_PictureQueue
+        ? static_cast<double>(s_PictureQueue->getCount()) / s_PictureQueue->getCapacity()
+        : 0.0;
+
+    video_state->quality_governor.record_lateness(
+        diff / playback_rate, delay / playback_rate, queue_fill);
+
+    const double sync_threshold = std::max(delay, SYNC_THRESHOLD * playback_rate);
+
+    if (std::abs(diff) < NOSYNC_THRESHOLD * playback_rate) {
         if (diff <= -sync_threshold) {
             delay = 0;
         } else if (diff >= sync_threshold) {
@@ -399,58 +718,118 @@ double VideoPlayer::calculate_actual_delay(VideoState* video_state, double& fram
         }
     }
 
-    frame_timer += delay;
+    // After a stall, start over from now instead of rushing through the missed deadlines.
+    if (current_time - frame_timer > SYNC_THRESHOLD_MAX) {
+        frame_timer = current_time;
+    }
+
+    frame_timer += delay / playback_rate;
 
-    return std::max(frame_timer - current_time, 0.010);
+    return std::max(frame_timer - current_time, 0.0);
 }
 
-void VideoPlayer::synchronize_video(VideoState* video_state)
+bool VideoPlayer::should_drop_frame(VideoState* video_state, bool is_late)
+{
+    const double frame_duration = video_state->previous_delay;
+    const double sync_threshold =
+        std::max(frame_duration, SYNC_THRESHOLD * s_ClockNetwork->get_playback_rate());
+
+    // Late even for the slot of the next frame, showing it can't bring playback back in sync.
+    const bool is_hopeless = is_late && video_state->frame_diff + frame_duration <= -sync_threshold;
+
+    // Never drop the last frame the decoder has ready, the picture would only freeze.
+    const bool has_next_frame = s_PictureQueue->getCount() > 0;
+
+    switch (video_state->frame_drop_policy.load()) {
+    case FrameDropPolicy::DROP_TO_KEYFRAME:
+        if (s_LatestFrame->key_frame) {
+            video_state->is_dropping_to_keyframe = false;
+        } else if (is_hopeless && has_next_frame) {
+            video_state->is_dropping_to_keyframe = true;
+        }
+
+        // The keyframe that ends a run is still dropped when it is too late itself.
+        return video_state->is_dropping_to_keyframe || (is_hopeless && has_next_frame);
+    case FrameDropPolicy::DROP_LATE:
+        video_state->is_dropping_to_keyframe = false;
+        return is_hopeless && has_next_frame;
+    case FrameDropPolicy::NEVER:
+    default:
+        video_state->is_dropping_to_keyframe = false;
+        return false;
+    }
+}
+
+bool VideoPlayer::synchronize_video(VideoState* video_state)
 {
-    static double actual_delay = 0.0;
     const auto& timebase = s_StreamList.at("Video")->timebase;
-    double& video_clock = s_ClockNetwork->video_internal_clock;
     double frame_delay = av_q2d(timebase);
 
     if (video_state->is_first_frame) {
         // When the input is changed, update the frame timer.
-        video_state->frame_timer = av_gettime() / static_cast<double>(AV_TIME_BASE);
+        video_state->frame_timer = FramePacer::now();
         video_state->is_first_frame = false;
     }
 
-    // Adjust frame_timer if video is paused
-    const double pause_elapsed_time =
-        s_ClockNetwork->pause_end_time - s_ClockNetwork->pause_start_time;
-
-    video_state->frame_timer -= pause_elapsed_time;
-
-    s_ClockNetwork->pause_start_time = 0.0;
-    s_ClockNetwork->pause_end_time = 0.0;
+    // The deadlines move by the time playback was paused.
+    video_state->frame_timer += s_ClockNetwork->take_paused_time();
 
     frame_delay += s_LatestFrame->repeat_pict * (frame_delay * 0.5);
 
     if (video_state->current_pts != 0) {
-        video_clock = video_state->current_pts;
+        s_ClockNetwork->set_video_clock(video_state->current_pts);
     } else {
-        video_state->current_pts = video_clock;
+        video_state->current_pts = s_ClockNetwork->get_video_clock();
     }
 
-    s_ClockNetwork->video_internal_clock += frame_delay;
+    s_ClockNetwork->advance_video_clock(frame_delay);
+
+    const double actual_delay = calculate_actual_delay(video_state, video_state->frame_timer);
 
-    actual_delay = calculate_actual_delay(video_state, video_state->frame_timer);
-    SDL_Delay(static_cast<Uint32>(actual_delay * 1000 + 0.5));
+    // Same window as the delay correction: past NOSYNC_THRESHOLD the clocks aren't comparable.
+    const double diff = video_state->frame_diff;
+    const double playback_rate = s_ClockNetwork->get_playback_rate();
+    const bool is_late = std::abs(diff) < NOSYNC_THRESHOLD * playback_rate &&
+        diff <= -std::max(video_state->previous_delay, SYNC_THRESHOLD * playback_rate);
+
+    FrameTimingStats& frame_timing = video_state->frame_timing;
+
+    // A dropped frame already missed its slot, there is nothing to wait for.
+    if (should_drop_frame(video_state, is_late)) {
+        frame_timing.dropped_nb.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (is_late) {
+        frame_timing.late_nb.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        frame_timing.on_time_nb.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The frame timer is the absolute deadline of this frame, a frame that is due isn't held.
+    if (actual_delay > 0.0) {
+        video_state->frame_pacer.wait_until(video_state->frame_timer);
+    }
+
+    return true;
 }
 
-void VideoPlayer::update_pts(VideoState* state, AVPacket* packet)
+double VideoPlayer::calculate_frame_pts(const AVFrame* frame)
 {
     const auto& time_base = s_StreamList.at("Video")->timebase;
-    bool is_dts_available = packet->dts != AV_NOPTS_VALUE;
 
-    // Get the PTS of the current video frame.
-    state->current_pts = (is_dts_available ? static_cast<double>(s_LatestFrame->pts) : 0);
+    // Get the PTS of the decoded frame, 0 lets synchronize_video use the video clock.
+    const std::int64_t timestamp = frame->best_effort_timestamp;
+
+    if (timestamp == AV_NOPTS_VALUE) {
+        return 0.0;
+    }
 
-    if (is_rational_valid(time_base)) {
-        state->current_pts *= av_q2d(time_base);
+    if (!is_rational_valid(time_base)) {
+        return static_cast<double>(timestamp);
     }
+
+    return static_cast<double>(timestamp) * av_q2d(time_base);
 }
 
 [[nodiscard]] std::string VideoPlayer::current_timestamp_str()
@@ -473,6 +852,59 @@ void VideoPlayer::update_pts(VideoState* state, AVPacket* packet)
     return result.str();
 }
 
+void VideoPlayer::wait_while_paused(VideoState* video_state, VideoFlags wait_flags)
+{
+    SDL_LockMutex(s_Locks->playback_state);
+
+    while (Application::s_IsRunning && (video_state->flags & wait_flags)) {
+        SDL_CondWait(s_VideoPausedCond, s_Locks->playback_state);
+    }
+
+    SDL_UnlockMutex(s_Locks->playback_state);
+}
+
+void VideoPlayer::park_presenter(VideoState* video_state)
+{
+    SDL_LockMutex(s_Locks->playback_state);
+
+    // The frame in flight was presented, nothing is held until the playback resumes.
+    if (Application::s_IsRunning && (video_state->flags & VideoFlags::IS_PAUSED)) {
+        video_state->is_presenter_parked = true;
+        SDL_CondBroadcast(s_PresenterParkedCond);
+    }
+
+    while (Application::s_IsRunning && (video_state->flags & VideoFlags::IS_PAUSED)) {
+        SDL_CondWait(s_VideoPausedCond, s_Locks->playback_state);
+    }
+
+    video_state->is_presenter_parked = false;
+
+    SDL_UnlockMutex(s_Locks->playback_state);
+}
+
+bool VideoPlayer::wait_for_presenter_to_park()
+{
+    // Without a presenter, nothing else touches the latest frame.
+    if (!m_presentation_tid) {
+        return m_video_state->flags & VideoFlags::IS_PAUSED;
+    }
+
+    SDL_LockMutex(s_Locks->playback_state);
+
+    // The timeout only covers the shutdown, when the presenter may exit without parking.
+    while (Application::s_IsRunning && (m_video_state->flags & VideoFlags::IS_PAUSED) &&
+        !m_video_state->is_presenter_parked) {
+        SDL_CondWaitTimeout(
+            s_PresenterParkedCond, s_Locks->playback_state, PACKET_QUEUE_WAIT_MS);
+    }
+
+    const bool is_parked = m_video_state->is_presenter_parked;
+
+    SDL_UnlockMutex(s_Locks->playback_state);
+
+    return is_parked;
+}
+
 int VideoPlayer::video_callback(void* data)
 {
     auto* video_state = static_cast<VideoState*>(data);
@@ -480,69 +912,248 @@ int VideoPlayer::video_callback(void* data)
     AVPacket video_packet;
     av_init_packet(&video_packet);
 
+    AVFrame* decoded_frame = av_frame_alloc();
+
     while (Application::s_IsRunning) {
-        SDL_LockMutex(PacketQueue::s_GlobalMutex);
+        // The packet queue is lock-free, only block until the demuxer catches up.
+        if (s_VideoPacketQueue->dequeue(&video_packet) != 0) {
+            continue;
+        }
 
-        bool is_packet_avail = s_VideoPacketQueue->dequeue(&video_packet) == 0;
+        wait_while_paused(video_state, VideoFlags::IS_PAUSED | VideoFlags::IS_REVERSE);
 
-        if (!is_packet_avail) {
-            SDL_CondWait(PacketQueue::s_PacketAvailabilityCond, PacketQueue::s_GlobalMutex);
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
-            continue;
+        // Frames decoded from packets that were queued before a seek are dropped.
+        const unsigned int serial = s_PictureQueue->getSerial();
+
+        const DecodeTimer decode_timer(DecoderUseCase::PLAYER);
+
+        int response = decode_video_frame(video_state, &video_packet, decoded_frame);
+        av_packet_unref(&video_packet);
+
+        decode_timer.record(response == 0 ? 1 : 0);
+
+        // One packet may produce several frames, hand each of them to the presenter.
+        while (response == 0) {
+            const double pts = calculate_frame_pts(decoded_frame);
+
+            // The frames between the keyframe and the target of a seek only feed the decoder.
+            const bool is_before_seek_target =
+                pts + SEEK_TARGET_TOLERANCE < video_state->seek_target_pts.load();
+
+            while (!is_before_seek_target && Application::s_IsRunning &&
+                s_PictureQueue->getSerial() == serial) {
+                if (s_PictureQueue->enqueue(decoded_frame, pts, PACKET_QUEUE_WAIT_MS) == 0) {
+                    break;
+                }
+            }
+
+            av_frame_unref(decoded_frame);
+
+            // Only the time spent inside the decoder counts towards the throughput.
+            const DecodeTimer receive_timer(DecoderUseCase::PLAYER);
+            response = receive_video_frame(decoded_frame);
+            receive_timer.record(response == 0 ? 1 : 0);
         }
+    }
+
+    av_frame_free(&decoded_frame);
 
-        if (video_state->flags & VideoFlags::IS_PAUSED) {
-            SDL_CondWait(s_VideoPausedCond, PacketQueue::s_GlobalMutex);
+    return 0;
+}
+
+int VideoPlayer::present_frames(void* data)
+{
+    auto* video_state = static_cast<VideoState*>(data);
+
+    while (Application::s_IsRunning) {
+        park_presenter(video_state);
+
+        if (video_state->flags & VideoFlags::IS_REVERSE) {
+            present_reverse_frame(video_state);
+            continue;
         }
 
-        video_state->current_pts = 0;
+        // A reverse playback leaves up to two segments of frames behind.
+        s_ReverseDecoder->drop_stale_segments();
 
-        if (decode_video_frame(video_state, &video_packet) != 0) {
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
-            av_packet_unref(&video_packet);
+        DecodedFrame* decoded_frame = s_PictureQueue->peek(PACKET_QUEUE_WAIT_MS);
+
+        if (!decoded_frame) {
             continue;
-        };
+        }
 
-        av_packet_unref(&video_packet);
+        video_state->current_pts = decoded_frame->pts;
 
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        // Release the slot right away so the decoder can keep running ahead.
+        av_frame_unref(s_LatestFrame);
+        av_frame_move_ref(s_LatestFrame, decoded_frame->frame);
+        s_PictureQueue->pop();
 
-        update_pts(video_state, s_LatestPacket);
-        synchronize_video(video_state);
+        // Dropped frames were decoded all the same, only the conversion and upload are saved.
+        if (synchronize_video(video_state)) {
+            VideoPlayer::update_framebuffer(0, video_state);
+        }
     }
 
     return 0;
 }
 
+void VideoPlayer::present_reverse_frame(VideoState* video_state)
+{
+    DecodedFrame* decoded_frame = s_ReverseDecoder->peek(PACKET_QUEUE_WAIT_MS);
+
+    if (!decoded_frame) {
+        // Playback stops on the first frame, like the shuttle key K.
+        if (s_ReverseDecoder->take_start_of_stream()) {
+            SDL_Event shuttle_event{};
+            shuttle_event.type = CustomVideoEvents::FF_SHUTTLE_EVENT;
+            shuttle_event.user.code = static_cast<Sint32>(ShuttleCommand::PAUSE);
+            SDL_PushEvent(&shuttle_event);
+        }
+
+        return;
+    }
+
+    const double current_time = FramePacer::now();
+    double& frame_timer = video_state->reverse_frame_timer;
+
+    if (video_state->is_first_reverse_frame) {
+        frame_timer = current_time;
+        video_state->is_first_reverse_frame = false;
+    }
+
+    // The pts go down, the distance to the frame shown before is still the frame duration.
+    double delay = video_state->current_pts - decoded_frame->pts;
+
+    if (delay <= 0 || delay >= 1.0) {
+        delay = video_state->previous_delay;
+    }
+
+    video_state->previous_delay = delay;
+    video_state->previous_pts = decoded_frame->pts;
+    video_state->current_pts = decoded_frame->pts;
+
+    av_frame_unref(s_LatestFrame);
+    av_frame_move_ref(s_LatestFrame, decoded_frame->frame);
+    s_ReverseDecoder->pop();
+
+    // There is no audio to follow backward, the clocks only move the playhead.
+    s_ClockNetwork->reset(video_state->current_pts);
+
+    // After a stall, start over from now instead of rushing through the missed deadlines.
+    if (current_time - frame_timer > SYNC_THRESHOLD_MAX) {
+        frame_timer = current_time;
+    }
+
+    frame_timer += delay / s_ClockNetwork->get_playback_rate();
+
+    // Nothing is dropped, a late frame here means the decoder is behind and the conversion
+    // isn't what holds it back.
+    FrameTimingStats& frame_timing = video_state->frame_timing;
+
+    if (current_time > frame_timer) {
+        frame_timing.late_nb.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        frame_timing.on_time_nb.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    video_state->frame_pacer.wait_until(frame_timer);
+    VideoPlayer::update_framebuffer(0, video_state);
+}
+
 int VideoPlayer::decode_video_frame(
     VideoState* video_state, AVPacket* video_packet, AVFrame* dummy_frame)
 {
-    const auto& video_stream_info = s_StreamList.at("Video");
-
     if (!video_packet) {
         return -1;
     }
 
+    // Only the video codec is locked, so the audio callback never waits on a video decode.
+    SDL_LockMutex(s_Locks->video_codec);
+
+    const auto& video_stream_info = s_StreamList.at("Video");
+    QualityGovernor& quality_governor = video_state->quality_governor;
+
+    // The decoder only restarts cleanly on a keyframe, lowres waits for the next one.
+    const int lowres = quality_governor.get_lowres();
+
+    if (lowres != video_stream_info->av_codec_ctx->lowres &&
+        (video_packet->flags & AV_PKT_FLAG_KEY)) {
+        reopen_video_decoder(lowres);
+    }
+
+    quality_governor.apply(video_stream_info->av_codec_ctx);
+
     // Send the packet to the decoder
     int send_pkt_errcode = avcodec_send_packet(video_stream_info->av_codec_ctx, video_packet);
 
+    SDL_UnlockMutex(s_Locks->video_codec);
+
     if (send_pkt_errcode < 0) {
         return -1;
     }
 
     // After sending the packet, receive the frame data from the decoder
-    int receive_frame_errcode = avcodec_receive_frame(
-        video_stream_info->av_codec_ctx, !dummy_frame ? s_LatestFrame : dummy_frame);
+    return receive_video_frame(!dummy_frame ? s_LatestFrame : dummy_frame);
+}
+
+int VideoPlayer::receive_video_frame(AVFrame* dest_frame)
+{
+    SDL_LockMutex(s_Locks->video_codec);
+
+    const auto& video_stream_info = s_StreamList.at("Video");
+    const int receive_frame_errcode =
+        avcodec_receive_frame(video_stream_info->av_codec_ctx, dest_frame);
 
-    if (receive_frame_errcode < 0) {
+    SDL_UnlockMutex(s_Locks->video_codec);
+
+    return receive_frame_errcode < 0 ? receive_frame_errcode : 0;
+}
+
+int VideoPlayer::reopen_video_decoder(int lowres)
+{
+    const auto& video_stream_info = s_StreamList.at("Video");
+    AVCodecContext* av_codec_ctx = avcodec_alloc_context3(video_stream_info->av_codec);
+
+    if (!av_codec_ctx ||
+        avcodec_parameters_to_context(av_codec_ctx, video_stream_info->av_codec_params) < 0) {
+        avcodec_free_context(&av_codec_ctx);
         return -1;
     }
 
-    VideoPlayer::update_framebuffer(0, video_state);
+    // lowres is only read when the decoder is opened, the current one has to be replaced.
+    av_codec_ctx->lowres = lowres;
+    DecoderThreading::apply(av_codec_ctx, DecoderUseCase::PLAYER);
+
+    if (avcodec_open2(av_codec_ctx, video_stream_info->av_codec, nullptr) < 0) {
+        std::cout << "[Video Preview]: Failed to reopen the decoder with lowres " << lowres
+                  << ".\n";
+        avcodec_free_context(&av_codec_ctx);
+        return -1;
+    }
+
+    DecoderThreading::on_codec_opened(av_codec_ctx, DecoderUseCase::PLAYER);
+
+    avcodec_free_context(&video_stream_info->av_codec_ctx);
+    video_stream_info->av_codec_ctx = av_codec_ctx;
 
     return 0;
 }
 
+int VideoPlayer::push_packet(PacketQueue* queue, const AVPacket* packet, unsigned int serial)
+{
+    // Apply backpressure: wait for the consumer instead of growing the queue.
+    while (Application::s_IsRunning && queue->getSerial() == serial) {
+        const int response = queue->enqueue(packet, serial);
+
+        if (response != AVERROR(EAGAIN)) {
+            return response;
+        }
+    }
+
+    return AVERROR(EAGAIN);
+}
+
 int VideoPlayer::enqueue_packets(void* data)
 {
     auto* video_state = static_cast<VideoState*>(data);
@@ -550,45 +1161,54 @@ int VideoPlayer::enqueue_packets(void* data)
     const auto& video_stream_info = s_StreamList.at("Video");
     const auto& audio_stream_info = s_StreamList.at("Audio");
 
-    auto& sws_scaler_ctx = video_state->sws_scaler_ctx;
     auto& av_format_ctx = video_state->av_format_ctx;
 
+    // The demuxer owns its packet, s_LatestPacket is shared with the seek operation.
+    AVPacket* packet = av_packet_alloc();
+
+    if (!packet) {
+        std::cerr << "[Video Player]: Failed to allocate the demuxer packet.\n";
+        return -1;
+    }
+
     while (Application::s_IsRunning) {
-        SDL_LockMutex(PacketQueue::s_GlobalMutex);
+        wait_while_paused(video_state, VideoFlags::IS_PAUSED | VideoFlags::IS_REVERSE);
 
-        if (video_state->flags & VideoFlags::IS_PAUSED) {
-            SDL_CondWait(s_VideoPausedCond, PacketQueue::s_GlobalMutex);
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
-            continue;
-        }
+        SDL_LockMutex(s_Locks->demuxer);
 
-        const int& response = av_read_frame(av_format_ctx, s_LatestPacket);
+        const int& response = av_read_frame(av_format_ctx, packet);
 
         if (response == AVERROR_EOF) {
-            SDL_CondWait(s_FrameAvailabilityCond, PacketQueue::s_GlobalMutex);
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+            SDL_CondWait(s_FrameAvailabilityCond, s_Locks->demuxer);
+            SDL_UnlockMutex(s_Locks->demuxer);
             continue;
         }
 
-        SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+        // A seek flushes the queues, packets read before it must not be enqueued after it.
+        const unsigned int video_serial = s_VideoPacketQueue->getSerial();
+        const unsigned int audio_serial = s_AudioPacketQueue->getSerial();
+
+        SDL_UnlockMutex(s_Locks->demuxer);
 
         if (response < 0) {
             std::cerr << "Failed to decode the frames: " << av_error_to_string(response) << "\n";
-            av_packet_unref(s_LatestPacket);
+            av_packet_unref(packet);
             break;
         }
 
-        const std::uint32_t& packet_index = s_LatestPacket->stream_index;
+        const std::uint32_t& packet_index = packet->stream_index;
 
         if (video_stream_info->stream_index == packet_index) {
-            s_VideoPacketQueue->enqueue(s_LatestPacket);
+            push_packet(s_VideoPacketQueue.get(), packet, video_serial);
         } else if (audio_stream_info->stream_index == packet_index) {
-            s_AudioPacketQueue->enqueue(s_LatestPacket);
+            push_packet(s_AudioPacketQueue.get(), packet, audio_serial);
         }
 
-        av_packet_unref(s_LatestPacket);
+        av_packet_unref(packet);
     }
 
+    av_packet_free(&packet);
+
     return 0;
 }
 
@@ -600,101 +1220,226 @@ int VideoPlayer::seek_frame(float seconds, bool should_update_framebuffer)
         return -1;
     }
 
-    SDL_LockMutex(PacketQueue::s_GlobalMutex);
+    // Playing backward, only the reverse decoder moves. The forward pipeline follows once
+    // the reverse playback stops.
+    if (s_ReverseDecoder->is_running()) {
+        m_video_state->is_first_reverse_frame = true;
+        s_ClockNetwork->reset(seconds);
+
+        return s_ReverseDecoder->start(m_opened_file, seconds);
+    }
+
+    m_has_stepped = false;
+
+    auto& [file_queue, demuxer, video_codec, audio_codec, playback_state, preview_frame,
+        audio_device] = *s_Locks;
+
+    const auto& video_stream_info = s_StreamList.at("Video");
+
+    if (!is_rational_valid(video_stream_info->timebase)) {
+        return -1;
+    }
+
+    // The frame is only replaced once the presenter let go of it.
+    const bool should_show_frame = should_update_framebuffer && wait_for_presenter_to_park();
+
+    const auto video_target_timestamp = static_cast<int64_t>(
+        (seconds - SEEK_TARGET_TOLERANCE) / av_q2d(video_stream_info->timebase));
+
+    bool is_cache_hit = false;
+
+    // Scrubbing keeps coming back to the frames an earlier seek decoded. The hit is shown
+    // right away and the demuxer is only positioned, the video thread drops the frames
+    // before the target once the playback resumes.
+    if (should_show_frame) {
+        std::int64_t cached_timestamp = 0;
+
+        is_cache_hit = FrameCache::find_from(m_opened_file, video_target_timestamp,
+                           s_LatestFrame, &cached_timestamp) >= 0;
+
+        if (is_cache_hit) {
+            m_video_state->current_pts = calculate_frame_pts(s_LatestFrame);
+            m_video_state->previous_pts = m_video_state->current_pts.load();
+
+            VideoPlayer::update_framebuffer(0, m_video_state.get());
+        }
+    }
+
+    SDL_LockMutex(demuxer);
 
-    auto& sws_scaler = m_video_state->sws_scaler_ctx;
     auto& av_format_ctx = m_video_state->av_format_ctx;
 
+    // Built by the thumbnail loader, until then the container's own index is used.
+    const auto keyframe_index = KeyframeIndex::get(m_opened_file);
+
     for (const std::string& key : { "Audio", "Video" }) {
         const auto& stream_info = s_StreamList.at(key);
 
         if (!is_rational_valid(stream_info->timebase)) {
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+            SDL_UnlockMutex(demuxer);
             return -1;
         }
 
         const auto target_timestamp = static_cast<int64_t>(seconds / av_q2d(stream_info->timebase));
 
-        int response = av_seek_frame(
-            av_format_ctx, stream_info->stream_index, target_timestamp, AVSEEK_FLAG_BACKWARD);
+        int response = -1;
+
+        // Both streams share the demuxer, the video seek is the one that positions it.
+        if (key == "Video" && keyframe_index) {
+            response =
+                keyframe_index->seek(av_format_ctx, stream_info->stream_index, target_timestamp);
+        }
+
+        if (response < 0) {
+            response = av_seek_frame(
+                av_format_ctx, stream_info->stream_index, target_timestamp, AVSEEK_FLAG_BACKWARD);
+        }
 
         if (response < 0) {
-            SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+            SDL_UnlockMutex(demuxer);
             return -1;
         }
 
+        SDL_mutex* codec_lock = key == "Video" ? video_codec : audio_codec;
+
+        SDL_LockMutex(codec_lock);
         avcodec_flush_buffers(stream_info->av_codec_ctx);
+        SDL_UnlockMutex(codec_lock);
     }
 
-    if (m_video_state->flags & VideoFlags::IS_PAUSED) {
-        const auto& stream_info = s_StreamList.at("Video");
+    bool is_frame_decoded = false;
+
+    // On a miss the decoder goes through the frames from the keyframe up to the target, and
+    // caches them for the next seeks around here.
+    if (should_show_frame && !is_cache_hit) {
+        AVFrame* decoded_frame = av_frame_alloc();
+        AVFrame* target_frame = av_frame_alloc();
+
+        bool is_target_reached = !decoded_frame || !target_frame;
+        bool is_stale = false;
 
-        while (av_read_frame(m_video_state->av_format_ctx, s_LatestPacket) >= 0) {
-            if (s_LatestPacket->stream_index != stream_info->stream_index) {
+        // Only frames at full quality are cached, the governor may be lowering it. Skipped
+        // frames would also break the chain of previous timestamps.
+        const AVCodecContext* av_codec_ctx = video_stream_info->av_codec_ctx;
+        const bool should_cache = av_codec_ctx->lowres == 0 &&
+            av_codec_ctx->skip_loop_filter <= AVDISCARD_DEFAULT &&
+            av_codec_ctx->skip_frame <= AVDISCARD_DEFAULT;
+        std::int64_t previous_timestamp = UNKNOWN_PREVIOUS_TIMESTAMP;
+
+        SDL_LockMutex(video_codec);
+
+        while (!is_target_reached &&
+            av_read_frame(m_video_state->av_format_ctx, s_LatestPacket) >= 0) {
+            if (s_LatestPacket->stream_index != video_stream_info->stream_index) {
                 av_packet_unref(s_LatestPacket);
                 continue;
             }
 
-            int response = avcodec_send_packet(stream_info->av_codec_ctx, s_LatestPacket);
+            int response = avcodec_send_packet(video_stream_info->av_codec_ctx, s_LatestPacket);
+            av_packet_unref(s_LatestPacket);
+
+            // Scrubbing moved on, the next seek positions the decoder again.
+            if (m_seek_worker->is_stale()) {
+                is_stale = true;
+                break;
+            }
 
             if (response == AVERROR_EOF) {
-                av_packet_unref(s_LatestPacket);
                 break;
             }
 
             if (response == AVERROR(EAGAIN) || response < 0) {
-                av_packet_unref(s_LatestPacket);
                 continue;
             }
 
-            response = avcodec_receive_frame(stream_info->av_codec_ctx, s_LatestFrame);
+            // Only the last frame is kept. The forward playback picks up right after it.
+            while (avcodec_receive_frame(video_stream_info->av_codec_ctx, decoded_frame) == 0) {
+                av_frame_unref(target_frame);
+                av_frame_move_ref(target_frame, decoded_frame);
 
-            if (response == AVERROR(EAGAIN) || response < 0) {
-                av_packet_unref(s_LatestPacket);
-                continue;
+                const std::int64_t timestamp = target_frame->best_effort_timestamp;
+
+                if (should_cache && timestamp != AV_NOPTS_VALUE) {
+                    FrameCache::insert(m_opened_file, target_frame, timestamp, previous_timestamp);
+                    previous_timestamp = timestamp;
+                }
+
+                if (timestamp == AV_NOPTS_VALUE || timestamp >= video_target_timestamp) {
+                    is_target_reached = true;
+                    break;
+                }
             }
+        }
 
-            VideoPlayer::update_framebuffer(0, m_video_state.get());
-            break;
+        SDL_UnlockMutex(video_codec);
+
+        // A stale seek leaves the latest frame alone, it still matches the framebuffers.
+        if (!is_stale && target_frame && target_frame->buf[0]) {
+            av_frame_unref(s_LatestFrame);
+            av_frame_move_ref(s_LatestFrame, target_frame);
+            is_frame_decoded = true;
         }
+
+        av_frame_free(&target_frame);
+        av_frame_free(&decoded_frame);
     }
 
+    if (is_frame_decoded) {
+        m_video_state->current_pts = calculate_frame_pts(s_LatestFrame);
+        m_video_state->previous_pts = m_video_state->current_pts.load();
+    }
+
+    m_video_state->seek_target_pts = seconds;
+
     SDL_CondBroadcast(s_FrameAvailabilityCond);
 
-    s_ClockNetwork->video_internal_clock = seconds;
-    s_ClockNetwork->audio_internal_clock = seconds;
+    s_ClockNetwork->reset(seconds);
 
     s_VideoPacketQueue->clear();
     s_AudioPacketQueue->clear();
+    s_PCMRing->flush();
 
-    SDL_UnlockMutex(PacketQueue::s_GlobalMutex);
+    // The ring runs dry until the new audio is decoded, the device isn't too small for it.
+    s_AudioLatency->hold(FramePacer::now());
+
+    if (s_PictureQueue) {
+        s_PictureQueue->clear();
+    }
+
+    // The frames around a seek are late by design, they say nothing about the decoder.
+    m_video_state->quality_governor.reset(false);
+
+    SDL_UnlockMutex(demuxer);
+
+    // The video thread is paused, so the frame can be converted outside of the locks.
+    if (is_frame_decoded) {
+        VideoPlayer::update_framebuffer(0, m_video_state.get());
+    }
 
     return 0;
 }
 
+void VideoPlayer::request_seek(float seconds)
+{
+    m_seek_worker->request_seek(seconds);
+}
+
 #pragma endregion Seek Operation
 
 #pragma region Switch Input
 int VideoPlayer::restart_audio_thread()
 {
-    AVPacket* packet_for_first_frame = av_packet_alloc();
-    AVFrame* first_frame = av_frame_alloc();
-
-    const int samples_per_frame = nb_samples_per_frame(packet_for_first_frame, first_frame);
-    const int AV_STEREO_CHANNEL_NB = av_get_channel_layout_nb_channels(AV_CH_LAYOUT_STEREO);
+    SDL_LockMutex(s_Locks->audio_device);
 
     if (m_video_state->flags & VideoFlags::IS_DECODING_THREAD_ACTIVE) {
         SDL_CloseAudioDevice(m_device_info->device_id);
     }
 
-    av_packet_free(&packet_for_first_frame);
-    av_frame_free(&first_frame);
+    const int result = init_sdl_mixer(AUDIO_OUTPUT_CHANNELS_NB);
 
-    if (init_sdl_mixer(AV_STEREO_CHANNEL_NB, samples_per_frame) != 0) {
-        return -1;
-    };
+    SDL_UnlockMutex(s_Locks->audio_device);
 
-    return 0;
+    return result < 0 ? -1 : 0;
 }
 
 int VideoPlayer::switch_input(AVFormatContext** av_format_context, const std::string& url)
@@ -709,7 +1454,16 @@ int VideoPlayer::switch_input(AVFormatContext** av_format_context, const std::st
     reset_internal_clocks();
     reset_audio_buffer_info();
 
-    (s_VideoPacketQueue, s_AudioPacketQueue)->clear();
+    s_VideoPacketQueue->clear();
+    s_AudioPacketQueue->clear();
+    s_PCMRing->flush();
+
+    // The ring runs dry until the new audio is decoded, the device isn't too small for it.
+    s_AudioLatency->hold(FramePacer::now());
+
+    if (s_PictureQueue) {
+        s_PictureQueue->clear();
+    }
 
     // Signal the packet enqueuer thread that a frame might be available.
     SDL_CondBroadcast(s_FrameAvailabilityCond);
@@ -720,12 +1474,190 @@ int VideoPlayer::switch_input(AVFormatContext** av_format_context, const std::st
 
 void VideoPlayer::pause_video()
 {
+    m_seek_worker->request_transport([this] { toggle_pause(); });
+}
+
+void VideoPlayer::toggle_pause()
+{
+    // The audio is already paused during reverse playback, it stays paused with the video.
+    if (m_video_state->flags & VideoFlags::IS_REVERSE) {
+        stop_reverse_playback(true);
+        return;
+    }
+
+    // The steps only moved the frame on screen, the forward pipeline catches up with it
+    // before it resumes. Nothing is decoded, the playback replaces the frame soon enough.
+    if (m_has_stepped && (m_video_state->flags & VideoFlags::IS_PAUSED)) {
+        seek_frame(static_cast<float>(m_video_state->current_pts));
+    }
+
+    SDL_LockMutex(s_Locks->playback_state);
+
     m_video_state->flags ^= VideoFlags::IS_PAUSED;
-    pause_audio();
 
     if (s_VideoPausedCond) {
         SDL_CondBroadcast(s_VideoPausedCond);
     }
+
+    SDL_UnlockMutex(s_Locks->playback_state);
+
+    pause_audio();
+
+    // Paused means the presenter is done with its frame, not only that it was asked to stop.
+    wait_for_presenter_to_park();
+}
+
+void VideoPlayer::set_playback_rate(double playback_rate) noexcept
+{
+    s_ClockNetwork->set_playback_rate(playback_rate);
+    m_video_state->quality_governor.set_playback_rate(s_ClockNetwork->get_playback_rate());
+}
+
+void VideoPlayer::shuttle(ShuttleCommand command)
+{
+    m_seek_worker->request_transport([this, command] { apply_shuttle(command); });
+}
+
+void VideoPlayer::apply_shuttle(ShuttleCommand command)
+{
+    const bool is_reverse = m_video_state->flags & VideoFlags::IS_REVERSE;
+    const bool is_paused = m_video_state->flags & VideoFlags::IS_PAUSED;
+    const double playback_rate = get_playback_rate();
+
+    switch (command) {
+    case ShuttleCommand::REVERSE:
+        if (is_reverse) {
+            set_playback_rate(next_shuttle_rate(playback_rate));
+        } else {
+            set_playback_rate(SHUTTLE_RATES.front());
+            start_reverse_playback();
+        }
+        break;
+    case ShuttleCommand::FORWARD:
+        if (is_reverse) {
+            set_playback_rate(SHUTTLE_RATES.front());
+            stop_reverse_playback(false);
+        } else if (is_paused) {
+            set_playback_rate(SHUTTLE_RATES.front());
+            toggle_pause();
+        } else {
+            set_playback_rate(next_shuttle_rate(playback_rate));
+        }
+        break;
+    case ShuttleCommand::PAUSE:
+    default:
+        if (is_reverse) {
+            stop_reverse_playback(true);
+        } else if (!is_paused) {
+            toggle_pause();
+        }
+        break;
+    }
+}
+
+int VideoPlayer::step_frame(FrameStep direction)
+{
+    if (!(m_video_state->flags & VideoFlags::IS_DECODING_THREAD_ACTIVE)) {
+        return -1;
+    }
+
+    // A step decodes a whole GOP when it misses, the key repeat keeps the steps coming.
+    m_seek_worker->request_step(direction);
+
+    return 0;
+}
+
+int VideoPlayer::apply_frame_step(FrameStep direction)
+{
+    // Every step lands paused, on a neighbour of the frame that was on screen.
+    if (m_video_state->flags & VideoFlags::IS_REVERSE) {
+        stop_reverse_playback(true);
+    } else if (!(m_video_state->flags & VideoFlags::IS_PAUSED)) {
+        toggle_pause();
+    }
+
+    if (!wait_for_presenter_to_park()) {
+        return -1;
+    }
+
+    double pts = 0.0;
+
+    const int response = m_frame_stepper.step(
+        m_opened_file, m_video_state->current_pts, direction, s_LatestFrame, &pts);
+
+    if (response < 0) {
+        return response;
+    }
+
+    m_video_state->previous_pts = pts;
+    m_video_state->current_pts = pts;
+    m_has_stepped = true;
+
+    s_ClockNetwork->reset(pts);
+
+    VideoPlayer::update_framebuffer(0, m_video_state.get());
+
+    return 0;
+}
+
+int VideoPlayer::start_reverse_playback()
+{
+    if (!(m_video_state->flags & VideoFlags::IS_DECODING_THREAD_ACTIVE)) {
+        return -1;
+    }
+
+    if (s_ReverseDecoder->start(m_opened_file, m_video_state->current_pts) < 0) {
+        std::cout << "[Video Player]: Failed to start the reverse playback.\n";
+        return -1;
+    }
+
+    // The audio isn't played backward, the device pauses like it does for a pause.
+    if (!(m_audio_state->flags & AudioFlags::IS_PAUSED)) {
+        pause_audio();
+    }
+
+    m_video_state->is_first_reverse_frame = true;
+
+    SDL_LockMutex(s_Locks->playback_state);
+
+    m_video_state->flags |= VideoFlags::IS_REVERSE;
+    m_video_state->flags &= ~VideoFlags::IS_PAUSED;
+
+    SDL_CondBroadcast(s_VideoPausedCond);
+    SDL_UnlockMutex(s_Locks->playback_state);
+
+    return 0;
+}
+
+void VideoPlayer::stop_reverse_playback(bool should_pause)
+{
+    // Paused first, the presenter parks before the reverse decoder stops under it. The
+    // forward pipeline stays paused all the same while the reverse flag is still set.
+    if (should_pause) {
+        SDL_LockMutex(s_Locks->playback_state);
+        m_video_state->flags |= VideoFlags::IS_PAUSED;
+        SDL_UnlockMutex(s_Locks->playback_state);
+
+        wait_for_presenter_to_park();
+    }
+
+    s_ReverseDecoder->stop();
+
+    // The forward pipeline is still where the reverse playback started. The seek doesn't
+    // decode a frame, the one on screen stays until the forward playback replaces it.
+    seek_frame(static_cast<float>(m_video_state->current_pts));
+
+    // The paused time covers the reverse playback, so the forward deadlines pick up from now.
+    if (!should_pause && (m_audio_state->flags & AudioFlags::IS_PAUSED)) {
+        pause_audio();
+    }
+
+    SDL_LockMutex(s_Locks->playback_state);
+
+    m_video_state->flags &= ~VideoFlags::IS_REVERSE;
+
+    SDL_CondBroadcast(s_VideoPausedCond);
+    SDL_UnlockMutex(s_Locks->playback_state);
 }
 
 #pragma endregion Frame Reader
@@ -734,6 +1666,13 @@ void VideoPlayer::pause_video()
 void VideoPlayer::free_ffmpeg()
 {
     sws_freeContext(m_video_state->sws_scaler_ctx);
+
+    for (auto* slice_ctx : m_video_state->sws_slice_ctxs) {
+        sws_freeContext(slice_ctx);
+    }
+
+    m_video_state->sws_slice_ctxs.clear();
+
     free_resampler_ctx();
 
     avformat_close_input(&m_video_state->av_format_ctx);
@@ -741,31 +1680,68 @@ void VideoPlayer::free_ffmpeg()
 
     av_frame_free(&s_LatestFrame);
     av_packet_free(&s_LatestPacket);
+
+    SDL_LockMutex(s_Locks->preview_frame);
+    av_frame_free(&s_PreviewFrame);
+    SDL_UnlockMutex(s_Locks->preview_frame);
     av_packet_free(&m_audio_state->latest_audio_packet);
+    av_frame_free(&m_audio_state->latest_audio_frame);
 
     for (const auto& pair : s_StreamList) {
         avcodec_free_context(&pair.second->av_codec_ctx);
     }
 }
 
+void VideoPlayer::free_frame_buffers()
+{
+    for (auto& framebuffer : m_video_state->framebuffers.slots()) {
+        av_freep(&framebuffer.data);
+        framebuffer = PreviewFramebuffer{};
+    }
+}
+
 void VideoPlayer::stop_threads()
 {
+    m_seek_worker->stop();
+    s_ReverseDecoder->stop();
+
+    SDL_LockMutex(s_Locks->playback_state);
     m_video_state->flags &= ~VideoFlags::IS_PAUSED;
 
     // Signal every conditional variable to stop threads.
     SDL_CondBroadcast(s_VideoPausedCond);
+    SDL_UnlockMutex(s_Locks->playback_state);
+
+    SDL_LockMutex(s_Locks->demuxer);
     SDL_CondBroadcast(s_FrameAvailabilityCond);
-    SDL_CondBroadcast(PacketQueue::s_PacketAvailabilityCond);
+    SDL_UnlockMutex(s_Locks->demuxer);
+
+    s_VideoPacketQueue->wake_all();
+    s_AudioPacketQueue->wake_all();
+
+    if (s_PictureQueue) {
+        s_PictureQueue->wake_all();
+    }
 
     if (m_video_tid) {
         SDL_WaitThread(m_video_tid, nullptr);
         m_video_tid = nullptr;
     }
 
+    if (m_presentation_tid) {
+        SDL_WaitThread(m_presentation_tid, nullptr);
+        m_presentation_tid = nullptr;
+    }
+
     if (m_decoding_tid) {
         SDL_WaitThread(m_decoding_tid, nullptr);
         m_decoding_tid = nullptr;
     }
+
+    if (m_audio_decode_tid) {
+        SDL_WaitThread(m_audio_decode_tid, nullptr);
+        m_audio_decode_tid = nullptr;
+    }
 }
 #pragma endregion Deallocation
 
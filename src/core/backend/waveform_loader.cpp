@@ -1,4 +1,5 @@
 #include "core/backend/waveform_loader.hpp"
+#include "core/backend/audio_conversion.hpp"
 #include "core/backend/video_loader.hpp"
 
 namespace YAVE
@@ -6,7 +7,6 @@ namespace YAVE
 SDL_mutex* WaveformLoader::mutex = nullptr;
 SDL_cond* WaveformLoader::cond = nullptr;
 
-SwrContext* WaveformLoader::s_ResamplerContext = nullptr;
 WaveformCache WaveformLoader::s_LoadedWaveforms = {};
 
 std::unique_ptr<VideoLoader> WaveformLoader::s_VideoLoader = std::make_unique<VideoLoader>();
@@ -43,83 +43,60 @@ void WaveformLoader::normalize_audio_data(
         [&](const float& sample) { return sample / (loudest_sample * factor); });
 }
 
-int WaveformLoader::init_swr_resampler_context(Waveform* waveform)
+int WaveformLoader::populate_audio_data(Waveform* waveform, ResamplerCache& resamplers)
 {
-    const unsigned int sample_rate = waveform->state->av_frame->sample_rate;
-    static bool is_resampler_context_initalized = false;
-
-    if (is_resampler_context_initalized) {
-        return 0;
-    }
-
-    s_ResamplerContext = swr_alloc();
-
-    if (!s_ResamplerContext) {
-        swr_free(&s_ResamplerContext);
-        std::cout << "[Waveform] Failed to allocate memory for the resampler "
-                     "context.\n";
-        return -1;
-    }
-
-    const int64_t channel_layout =
-        av_get_default_channel_layout(waveform->state->av_frame->channels);
+    constexpr int DOWNSAMPLE_FACTOR = 512;
 
-    swr_alloc_set_opts(s_ResamplerContext, channel_layout, AV_SAMPLE_FMT_FLT, sample_rate,
-        channel_layout, AV_SAMPLE_FMT_FLTP, sample_rate, 0, nullptr);
+    const AVFrame* av_frame = waveform->state->av_frame;
 
-    int init_result = swr_init(s_ResamplerContext);
+    // The waveform only shows the mix, so 5.1 is mixed down to stereo.
+    ResamplerKey key = ResamplerKey::from_frame(av_frame, AV_SAMPLE_FMT_FLT, av_frame->sample_rate);
+    key.out_channel_layout = AudioConverter::get_stereo_downmix_layout(key.in_channel_layout);
 
-    if (init_result < 0) {
-        return -1;
-    }
-
-    is_resampler_context_initalized = true;
-
-    return 0;
-}
+    const auto nb_channels = av_get_channel_layout_nb_channels(key.out_channel_layout);
+    const auto nb_samples = av_frame->nb_samples;
 
-int WaveformLoader::populate_audio_data(Waveform* waveform)
-{
-    constexpr int DOWNSAMPLE_FACTOR = 512;
+    std::vector<float> resampled_audio_buffer;
+    int ret = -1;
 
-    if (init_swr_resampler_context(waveform) < 0) {
-        return -1;
+    // The rate never changes here, so the kernels cover nearly every source.
+    if (AudioConverter::get_kernel(key)) {
+        resampled_audio_buffer.resize(static_cast<std::size_t>(nb_channels) * nb_samples);
+        ret = AudioConverter::convert(key, av_frame, resampled_audio_buffer.data());
     }
 
-    const auto nb_channels = waveform->state->av_frame->channels;
-    const auto nb_samples = waveform->state->av_frame->nb_samples;
-    const auto sample_format = waveform->state->stream_info->av_codec_ctx->sample_fmt;
-    bool is_audio_planar = av_sample_fmt_is_planar(sample_format);
-
-    const auto out_samples_nb = swr_get_out_samples(s_ResamplerContext, nb_samples);
+    if (ret < 0) {
+        // Anything without a kernel goes through the resampler of this frame's parameters.
+        const ResamplerPtr resampler = resamplers.acquire(key);
 
-    // If the audio data is not planar, there's no need to resample.
-    if (!is_audio_planar) {
-        for (int i = 0; i < nb_samples; i += DOWNSAMPLE_FACTOR) {
-            waveform->audio_data.push_back(*waveform->state->av_frame->data[0]);
+        if (!resampler) {
+            return -1;
         }
 
-        return 0;
-    }
+        const auto out_samples_nb = swr_get_out_samples(resampler.get(), nb_samples);
 
-    std::vector<float> resampled_audio_buffer(nb_channels * nb_samples);
-    std::array<float*, 1> out_data = { resampled_audio_buffer.data() };
+        resampled_audio_buffer.resize(
+            static_cast<std::size_t>(nb_channels) * std::max(out_samples_nb, 0));
+        std::array<float*, 1> out_data = { resampled_audio_buffer.data() };
 
-    auto extended_data_ptr = const_cast<const uint8_t**>(waveform->state->av_frame->extended_data);
+        auto extended_data_ptr = const_cast<const uint8_t**>(av_frame->extended_data);
 
-    int ret = swr_convert(s_ResamplerContext, reinterpret_cast<uint8_t**>(out_data.data()),
-        out_samples_nb, extended_data_ptr, nb_samples);
+        ret = swr_convert(resampler.get(), reinterpret_cast<uint8_t**>(out_data.data()),
+            out_samples_nb, extended_data_ptr, nb_samples);
 
-    if (ret < 0) {
-        std::array<char, AV_ERROR_MAX_STRING_SIZE> err_buf = { 0 };
-        av_strerror(ret, err_buf.data(), err_buf.size());
+        if (ret < 0) {
+            std::array<char, AV_ERROR_MAX_STRING_SIZE> err_buf = { 0 };
+            av_strerror(ret, err_buf.data(), err_buf.size());
 
-        std::cerr << "Failed to convert the audio data from planar to interleaved: "
-                  << err_buf.data() << "\n";
+            std::cerr << "Failed to convert the audio data to interleaved: " << err_buf.data()
+                      << "\n";
 
-        return -1;
+            return -1;
+        }
     }
 
+    resampled_audio_buffer.resize(static_cast<std::size_t>(ret) * nb_channels);
+
     for (int i = 0; i < resampled_audio_buffer.size(); i += DOWNSAMPLE_FACTOR) {
         if (i >= resampled_audio_buffer.size()) {
             break;
@@ -133,7 +110,8 @@ int WaveformLoader::populate_audio_data(Waveform* waveform)
 
 int WaveformLoader::start(void* data)
 {
-    auto userdata = static_cast<FileQueue*>(data);
+    auto* loader = static_cast<WaveformLoader*>(data);
+    auto userdata = loader->m_file_queue;
 
     while (Application::s_IsRunning) {
         SDL_LockMutex(mutex);
@@ -180,6 +158,8 @@ int WaveformLoader::start(void* data)
                 continue;
             }
 
+            const DecodeTimer decode_timer(DecoderUseCase::WAVEFORM);
+
             result = avcodec_send_packet(av_codec_ctx, av_packet);
 
             if (result == AVERROR(EAGAIN)) {
@@ -191,6 +171,7 @@ int WaveformLoader::start(void* data)
             }
 
             result = avcodec_receive_frame(av_codec_ctx, av_frame);
+            decode_timer.record(result == 0 ? 1 : 0);
 
             if (result == AVERROR(EAGAIN)) {
                 av_packet_unref(av_packet);
@@ -200,7 +181,7 @@ int WaveformLoader::start(void* data)
                 break;
             }
 
-            populate_audio_data(waveform);
+            populate_audio_data(waveform, loader->m_resamplers);
             av_packet_unref(av_packet);
         }
 
@@ -233,7 +214,7 @@ WaveformLoader::WaveformLoader()
     m_file_queue->nb_files = 0;
 
     m_waveform_loader_thread = SDL_CreateThread(
-        &WaveformLoader::start, "Waveform Loader Thread", reinterpret_cast<void*>(m_file_queue));
+        &WaveformLoader::start, "Waveform Loader Thread", reinterpret_cast<void*>(this));
 }
 
 void WaveformLoader::free_waveform(Waveform* waveform)
@@ -312,11 +293,15 @@ int WaveformLoader::open_file(std::string filename, Waveform* waveform, int* str
         return -1;
     }
 
+    DecoderThreading::apply(av_codec_ctx, DecoderUseCase::WAVEFORM);
+
     if (avcodec_open2(av_codec_ctx, av_codec, nullptr) < 0) {
         std::cout << "[Waveform] Failed to open the audio stream.\n";
         return -1;
     }
 
+    DecoderThreading::on_codec_opened(av_codec_ctx, DecoderUseCase::WAVEFORM);
+
     s_LoadedWaveforms.insert({ filename, std::move(waveform) });
     return 0;
 }
@@ -0,0 +1,135 @@
+#include "core/backend/worker_pool.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace YAVE
+{
+WorkerPool::WorkerPool(int workers_nb)
+    : m_mutex(SDL_CreateMutex())
+    , m_work_cond(SDL_CreateCond())
+    , m_done_cond(SDL_CreateCond())
+    , m_is_running(true)
+{
+    for (int i = 0; i < workers_nb; ++i) {
+        const std::string name = "Worker Thread " + std::to_string(i);
+        SDL_Thread* worker = SDL_CreateThread(&worker_loop, name.c_str(), this);
+
+        if (worker) {
+            m_workers.push_back(worker);
+        }
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    SDL_LockMutex(m_mutex);
+    m_is_running = false;
+    SDL_CondBroadcast(m_work_cond);
+    SDL_UnlockMutex(m_mutex);
+
+    for (auto* worker : m_workers) {
+        SDL_WaitThread(worker, nullptr);
+    }
+
+    SDL_DestroyCond(m_done_cond);
+    SDL_DestroyCond(m_work_cond);
+    SDL_DestroyMutex(m_mutex);
+}
+
+WorkerPool& WorkerPool::shared()
+{
+    // Half of the cores, the rest belongs to the decoders and the UI thread.
+    static WorkerPool pool(std::clamp(SDL_GetCPUCount() / 2, 1, 8));
+    return pool;
+}
+
+void WorkerPool::parallel_for(int tasks_nb, const std::function<void(int)>& task)
+{
+    if (tasks_nb <= 0) {
+        return;
+    }
+
+    if (tasks_nb == 1 || m_workers.empty()) {
+        for (int i = 0; i < tasks_nb; ++i) {
+            task(i);
+        }
+
+        return;
+    }
+
+    Batch batch;
+    batch.task = &task;
+    batch.tasks_nb = tasks_nb;
+    batch.remaining = tasks_nb;
+
+    SDL_LockMutex(m_mutex);
+    m_batches.push_back(&batch);
+    SDL_CondBroadcast(m_work_cond);
+    SDL_UnlockMutex(m_mutex);
+
+    // Don't just wait, the calling thread is one more worker.
+    run_tasks(&batch);
+
+    SDL_LockMutex(m_mutex);
+
+    // The batch can't go out of scope while a worker still holds it.
+    m_batches.erase(std::remove(m_batches.begin(), m_batches.end(), &batch), m_batches.end());
+
+    while (batch.remaining.load() > 0 || batch.workers_nb > 0) {
+        SDL_CondWait(m_done_cond, m_mutex);
+    }
+
+    SDL_UnlockMutex(m_mutex);
+}
+
+void WorkerPool::run_tasks(Batch* batch)
+{
+    for (int index = batch->next_index.fetch_add(1); index < batch->tasks_nb;
+         index = batch->next_index.fetch_add(1)) {
+        (*batch->task)(index);
+
+        if (batch->remaining.fetch_sub(1) == 1) {
+            SDL_LockMutex(m_mutex);
+            SDL_CondBroadcast(m_done_cond);
+            SDL_UnlockMutex(m_mutex);
+        }
+    }
+}
+
+int WorkerPool::worker_loop(void* data)
+{
+    auto* pool = static_cast<WorkerPool*>(data);
+
+    SDL_LockMutex(pool->m_mutex);
+
+    while (pool->m_is_running) {
+        if (pool->m_batches.empty()) {
+            SDL_CondWait(pool->m_work_cond, pool->m_mutex);
+            continue;
+        }
+
+        Batch* batch = pool->m_batches.front();
+
+        // Every task of the front batch is claimed, move on to the next one.
+        if (batch->next_index.load() >= batch->tasks_nb) {
+            pool->m_batches.pop_front();
+            continue;
+        }
+
+        batch->workers_nb++;
+
+        SDL_UnlockMutex(pool->m_mutex);
+        pool->run_tasks(batch);
+        SDL_LockMutex(pool->m_mutex);
+
+        if (--batch->workers_nb == 0) {
+            SDL_CondBroadcast(pool->m_done_cond);
+        }
+    }
+
+    SDL_UnlockMutex(pool->m_mutex);
+
+    return 0;
+}
+} // namespace YAVE
@@ -1,5 +1,9 @@
 #include "core/debugger.hpp"
 
+#include <cfloat>
+
+#include "core/yuv_renderer.hpp"
+
 namespace YAVE
 {
 Debugger::Debugger()
@@ -11,12 +15,79 @@ void Debugger::init() {}
 
 void Debugger::update() {}
 
+void Debugger::render_decoder_threading()
+{
+    ImGui::Text("Decoder Threading");
+
+    constexpr std::array<DecoderUseCase, 5> use_cases = { DecoderUseCase::PLAYER,
+        DecoderUseCase::REVERSE, DecoderUseCase::STEP, DecoderUseCase::THUMBNAIL,
+        DecoderUseCase::WAVEFORM };
+
+    for (const auto use_case : use_cases) {
+        const std::string setting_str = std::string(DecoderThreading::use_case_to_string(use_case)) +
+            ": " + DecoderThreading::get_active_setting(use_case);
+
+        ImGui::Text(setting_str.c_str());
+
+        // The override is used the next time a decoder of this kind is opened.
+        DecoderThreadingConfig config = DecoderThreading::get_config(use_case);
+        const std::string input_id =
+            std::string("##decoder_threads_") + DecoderThreading::use_case_to_string(use_case);
+
+        ImGui::Text("    Threads (0 = auto): ");
+        ImGui::SameLine();
+
+        if (ImGui::InputInt(input_id.c_str(), &config.thread_count)) {
+            DecoderThreading::set_config(use_case, config);
+        }
+
+        // Every setting the decoder has run with, so the throughput can be compared.
+        for (const auto& [setting, throughput] : DecoderThreading::get_throughput(use_case)) {
+            const std::string throughput_str = "    " + setting + ": " +
+                std::to_string(throughput.frames_per_second()) + " frames/sec (" +
+                std::to_string(throughput.frames_nb) + " frames)";
+
+            ImGui::Text(throughput_str.c_str());
+        }
+    }
+}
+
+void Debugger::render_frame_cache()
+{
+    constexpr std::size_t BYTES_PER_MIB = 1024 * 1024;
+
+    const FrameCacheStats frame_cache = FrameCache::get_stats();
+
+    const std::string frame_cache_str = "Frame Cache: " + std::to_string(frame_cache.frames_nb) +
+        " frames, " + std::to_string(frame_cache.bytes_used / BYTES_PER_MIB) + " of " +
+        std::to_string(frame_cache.budget_bytes / BYTES_PER_MIB) + " MiB";
+
+    const std::string frame_cache_hits_str = "Frame Cache Hit Rate: " +
+        std::to_string(frame_cache.hit_rate() * 100.0) + "% (" +
+        std::to_string(frame_cache.hits_nb) + " hits, " + std::to_string(frame_cache.misses_nb) +
+        " misses)";
+
+    ImGui::Text("Frame Cache (Seeking and Stepping)");
+
+    ImGui::Text(frame_cache_str.c_str());
+    ImGui::Text(frame_cache_hits_str.c_str());
+
+    int budget_mib = static_cast<int>(frame_cache.budget_bytes / BYTES_PER_MIB);
+
+    ImGui::Text("    Budget (MiB): ");
+    ImGui::SameLine();
+
+    if (ImGui::InputInt("##frame_cache_budget", &budget_mib, 64, 256)) {
+        FrameCache::set_budget(static_cast<std::size_t>(std::max(budget_mib, 0)) * BYTES_PER_MIB);
+    }
+}
+
 void Debugger::render()
 {
     ImGui::Begin("Stats for Nerds");
 
     // Clock Network Information
-    const std::string video_pts = "Current Video PTS: " + std::to_string(video_state->current_pts) + " sec";
+    const std::string video_pts = "Current Video PTS: " + std::to_string(video_state->current_pts.load()) + " sec";
 
     const std::string video_internal_clock =
         "Video Internal Clock: " + std::to_string(AudioPlayer::get_video_internal_clock()) + " sec";
@@ -44,12 +115,98 @@ void Debugger::render()
     const std::string width_str = "Width: " + std::to_string(video_state->dimensions.x) + "px";
     const std::string height_str = "Height: " + std::to_string(video_state->dimensions.y) + "px";
 
+    const VideoDimension preview_dimensions = video_state->preview_dimensions;
+
+    const std::string preview_str = "Preview: " + std::to_string(preview_dimensions.x) + "x" +
+        std::to_string(preview_dimensions.y) + "px (" +
+        VideoPlayer::preview_quality_to_string(video_state->preview_quality) + ")";
+
+    const auto& picture_queue = VideoPlayer::s_PictureQueue;
+
+    const std::string picture_queue_str = "Decoded Picture Queue: " +
+        std::to_string(picture_queue ? picture_queue->getCount() : 0) + " / " +
+        std::to_string(picture_queue ? picture_queue->getCapacity() : 0) + " frames";
+
+    std::string color_conversion_str = "Color Conversion: swscale";
+
+    if (video_state->is_using_planar_upload) {
+        color_conversion_str = "Color Conversion: GPU shader (YUV planes)";
+    } else if (video_state->is_using_fast_conversion) {
+        color_conversion_str = std::string("Color Conversion: ") +
+            ColorConverter::isa_to_string(ColorConverter::get_active_isa());
+    }
+
+    const std::string conversion_latency_str = "Frame Conversion: " +
+        std::to_string(video_state->conversion_time_ms) + " ms (avg " +
+        std::to_string(video_state->average_conversion_time_ms) + " ms, " +
+        std::to_string(video_state->conversion_slices_nb) + " slices)";
+
+    const std::string texture_upload_str = "Texture Upload: " +
+        std::to_string(texture_upload.upload_time_ms) + " ms (avg " +
+        std::to_string(texture_upload.average_upload_time_ms) + " ms, " +
+        (texture_upload.is_using_pixel_buffers
+                ? std::to_string(PIXEL_BUFFERS_NB) + " pixel buffers)"
+                : std::string("direct)"));
+
+    const auto& framebuffers = video_state->framebuffers;
+
+    const std::string frame_handoff_str =
+        "Frames: " + std::to_string(framebuffers.get_published_nb()) + " produced, " +
+        std::to_string(framebuffers.get_consumed_nb()) + " displayed, " +
+        std::to_string(framebuffers.get_overwritten_nb()) + " skipped";
+
+    const FrameTimingStats& frame_timing = video_state->frame_timing;
+
+    const std::string frame_timing_str = "Frame Timing: " +
+        std::to_string(frame_timing.on_time_nb.load()) + " on time, " +
+        std::to_string(frame_timing.late_nb.load()) + " late, " +
+        std::to_string(frame_timing.dropped_nb.load()) + " dropped";
+
+    const PacingStats pacing = video_state->frame_pacer.get_stats();
+
+    // A percentile in the overflow bin is only a lower bound.
+    const auto pacing_error_to_string = [](double error_ms, bool is_overflow) {
+        return (is_overflow ? ">=" : "") + std::to_string(error_ms) + " ms";
+    };
+
+    const std::string frame_pacing_str = "Frame Pacing Error: p50 " +
+        pacing_error_to_string(pacing.p50_error_ms, pacing.is_p50_overflow) + ", p99 " +
+        pacing_error_to_string(pacing.p99_error_ms, pacing.is_p99_overflow) + ", max " +
+        std::to_string(pacing.max_error_ms) + " ms, " + std::to_string(pacing.overflow_nb) +
+        " over " + std::to_string(PACING_RANGE * 1000.0) + " ms (spin " +
+        std::to_string(pacing.spin_threshold_ms) + " ms)";
+
+    const QualityGovernor& quality_governor = video_state->quality_governor;
+
+    const std::string decode_quality_str = std::string("Decode Quality: ") +
+        QualityGovernor::quality_to_string(quality_governor.get_level()) + " (avg lateness " +
+        std::to_string(quality_governor.get_average_lateness() * 1000.0) + " ms)";
+
     // Audio Information
     const float sample_rate =
-        static_cast<float>(AudioPlayer::s_AudioBufferInfo->sample_rate) / 1000.0f;
+        static_cast<float>(AudioPlayer::get_audio_buffer_info().sample_rate) / 1000.0f;
 
     const std::string sample_rate_str = "Sample Rate: " + std::to_string(sample_rate) + " kHz";
 
+    const PCMRingStats audio_ring = AudioPlayer::get_audio_ring_stats();
+
+    const std::string audio_ring_str = "Audio Ring: " + std::to_string(audio_ring.buffered_ms) +
+        " ms buffered (target " + std::to_string(audio_ring.target_ms) + " ms), " +
+        std::to_string(audio_ring.underruns_nb) + " underruns";
+
+    const AudioLatencyStats audio_latency = AudioPlayer::get_audio_latency_stats();
+
+    const std::string audio_latency_str = "Audio Latency: " +
+        std::to_string(audio_latency.device_latency_ms) + " ms (" +
+        std::to_string(audio_latency.device_samples) + " samples, step " +
+        AudioLatencyController::latency_to_string(audio_latency.effective) + ", grown " +
+        std::to_string(audio_latency.grows_nb) + "x, shrunk " +
+        std::to_string(audio_latency.shrinks_nb) + "x)";
+
+    const std::string audio_underruns_str = "Audio Underruns: " +
+        std::to_string(audio_latency.underruns_nb) + " empty ring, " +
+        std::to_string(audio_latency.late_callbacks_nb) + " late callbacks";
+
     ImGui::Text("Clock Network (For A/V Synchronization)");
 
     ImGui::Text(video_pts.c_str());
@@ -63,6 +220,57 @@ void Debugger::render()
 
     ImGui::Text(width_str.c_str());
     ImGui::Text(height_str.c_str());
+    ImGui::Text(preview_str.c_str());
+    ImGui::Text(picture_queue_str.c_str());
+    ImGui::Text(color_conversion_str.c_str());
+    ImGui::Text(conversion_latency_str.c_str());
+    ImGui::Text(texture_upload_str.c_str());
+    ImGui::Text(frame_handoff_str.c_str());
+    ImGui::Text(frame_timing_str.c_str());
+    ImGui::Text(frame_pacing_str.c_str());
+
+    // One bar per 25 us of error over the last frames, the last bar holds everything above.
+    const auto pacing_histogram = video_state->frame_pacer.get_histogram();
+    ImGui::PlotHistogram("##frame_pacing", pacing_histogram.data(),
+        static_cast<int>(pacing_histogram.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+
+    const FrameDropPolicy frame_drop_policy = video_state->frame_drop_policy;
+
+    if (ImGui::BeginCombo("Frame Drop Policy",
+            VideoPlayer::frame_drop_policy_to_string(frame_drop_policy))) {
+        for (const auto policy : { FrameDropPolicy::NEVER, FrameDropPolicy::DROP_LATE,
+                 FrameDropPolicy::DROP_TO_KEYFRAME }) {
+            const bool is_selected = policy == frame_drop_policy;
+
+            if (ImGui::Selectable(VideoPlayer::frame_drop_policy_to_string(policy), is_selected)) {
+                video_state->frame_drop_policy = policy;
+            }
+
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+
+        ImGui::EndCombo();
+    }
+
+    ImGui::Text(decode_quality_str.c_str());
+
+    bool is_governor_enabled = quality_governor.is_enabled();
+
+    if (ImGui::Checkbox("Lower the decode quality when playback falls behind",
+            &is_governor_enabled)) {
+        video_state->quality_governor.set_enabled(is_governor_enabled);
+    }
+
+    // Only offered when the shaders were built for this GL context.
+    if (YUVRenderer::is_available()) {
+        bool use_planar_preview = VideoPlayer::s_UsePlanarPreview;
+
+        if (ImGui::Checkbox("Upload YUV planes (shader conversion)", &use_planar_preview)) {
+            VideoPlayer::s_UsePlanarPreview = use_planar_preview;
+        }
+    }
 
     ImGui::Dummy(ImVec2(0, 10));
 
@@ -70,6 +278,42 @@ void Debugger::render()
 
     ImGui::Text(sample_rate_str.c_str());
     ImGui::Text(kilobytes_per_second_str.c_str());
+    ImGui::Text(audio_ring_str.c_str());
+    ImGui::Text(audio_latency_str.c_str());
+    ImGui::Text(audio_underruns_str.c_str());
+
+    // One bar per second over the last minute, the newest on the right.
+    const auto underrun_history = AudioPlayer::get_underrun_history();
+    ImGui::PlotHistogram("##audio_underruns", underrun_history.data(), UNDERRUN_HISTORY_SECONDS,
+        0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+
+    // The device is reopened by the audio decode thread, it may still grow after underruns.
+    if (ImGui::BeginCombo("Audio Latency",
+            AudioLatencyController::latency_to_string(audio_latency.requested))) {
+        for (int i = 0; i <= static_cast<int>(MAX_SELECTABLE_AUDIO_LATENCY); ++i) {
+            const auto latency = static_cast<AudioLatency>(i);
+            const char* latency_str = AudioLatencyController::latency_to_string(latency);
+            const bool is_selected = latency == audio_latency.requested;
+
+            if (ImGui::Selectable(latency_str, is_selected)) {
+                AudioPlayer::set_audio_latency(latency);
+            }
+
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+
+        ImGui::EndCombo();
+    }
+
+    ImGui::Dummy(ImVec2(0, 10));
+
+    render_frame_cache();
+
+    ImGui::Dummy(ImVec2(0, 10));
+
+    render_decoder_threading();
 
     ImGui::End();
 }
@@ -0,0 +1,186 @@
+#include "core/texture_uploader.hpp"
+
+#include <cstring>
+#include <iostream>
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
+namespace YAVE
+{
+TextureUploader::~TextureUploader()
+{
+    release();
+}
+
+int TextureUploader::init()
+{
+    if (m_stats.is_using_pixel_buffers) {
+        return 0;
+    }
+
+    // Pixel buffers and glMapBufferRange are both core in OpenGL 3.0.
+    if (!GLEW_VERSION_3_0) {
+        std::cerr << "[Texture Uploader]: Pixel buffers are unavailable, uploading directly.\n";
+        return -1;
+    }
+
+    glGenBuffers(PIXEL_BUFFERS_NB, m_pixel_buffers.data());
+
+    if (m_pixel_buffers[0] == 0) {
+        std::cerr << "[Texture Uploader]: Failed to create the pixel buffers.\n";
+        return -1;
+    }
+
+    m_stats.is_using_pixel_buffers = true;
+
+    return 0;
+}
+
+void TextureUploader::resize_texture(int width, int height, GLint internal_format)
+{
+    // The shader path can reallocate the texture too, so ask GL instead of remembering it.
+    GLint texture_width = 0;
+    GLint texture_height = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &texture_width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &texture_height);
+
+    if (texture_width != width || texture_height != height) {
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, GL_RGBA,
+            GL_UNSIGNED_BYTE, nullptr);
+    }
+}
+
+void TextureUploader::resize_pixel_buffers(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_buffer_size = static_cast<std::size_t>(width) * height * 4;
+
+    if (!m_stats.is_using_pixel_buffers) {
+        return;
+    }
+
+    for (const GLuint pixel_buffer : m_pixel_buffers) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(m_buffer_size), nullptr,
+            GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+int TextureUploader::write_pixel_buffer(const std::uint8_t* pixels)
+{
+    const std::int64_t start_time = av_gettime_relative();
+
+    m_buffer_index = (m_buffer_index + 1) % PIXEL_BUFFERS_NB;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixel_buffers[m_buffer_index]);
+
+    // The old content is never read again, invalidating it lets the driver skip a sync.
+    void* dest = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+        static_cast<GLsizeiptr>(m_buffer_size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+    if (!dest) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return -1;
+    }
+
+    std::memcpy(dest, pixels, m_buffer_size);
+
+    const bool is_unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!is_unmapped) {
+        return -1;
+    }
+
+    m_pending_index = m_buffer_index;
+    m_pending_write_time_ms = static_cast<double>(av_gettime_relative() - start_time) / 1000.0;
+
+    return 0;
+}
+
+void TextureUploader::transfer_pending_buffer()
+{
+    if (m_pending_index < 0) {
+        return;
+    }
+
+    const std::int64_t start_time = av_gettime_relative();
+
+    // With a bound unpack buffer the data pointer is an offset into it.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixel_buffers[m_pending_index]);
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    m_pending_index = -1;
+
+    record_upload_time(m_pending_write_time_ms +
+        static_cast<double>(av_gettime_relative() - start_time) / 1000.0);
+}
+
+void TextureUploader::record_upload_time(double upload_time_ms)
+{
+    constexpr double UPLOAD_TIME_AVG_COEF = 0.9;
+
+    m_stats.upload_time_ms = upload_time_ms;
+    m_stats.average_upload_time_ms = m_stats.average_upload_time_ms * UPLOAD_TIME_AVG_COEF +
+        upload_time_ms * (1.0 - UPLOAD_TIME_AVG_COEF);
+}
+
+int TextureUploader::upload(
+    const std::uint8_t* pixels, int width, int height, GLint internal_format)
+{
+    if (!pixels || width <= 0 || height <= 0) {
+        return -1;
+    }
+
+    // A pending frame of the old size is superseded by this one.
+    if (width != m_width || height != m_height) {
+        m_pending_index = -1;
+        resize_pixel_buffers(width, height);
+    }
+
+    resize_texture(width, height, internal_format);
+
+    if (m_stats.is_using_pixel_buffers) {
+        // The previous frame goes out first, so the copy below overlaps its transfer.
+        transfer_pending_buffer();
+
+        if (write_pixel_buffer(pixels) == 0) {
+            return 0;
+        }
+    }
+
+    const std::int64_t start_time = av_gettime_relative();
+
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    record_upload_time(static_cast<double>(av_gettime_relative() - start_time) / 1000.0);
+
+    return 0;
+}
+
+void TextureUploader::flush()
+{
+    transfer_pending_buffer();
+}
+
+void TextureUploader::release()
+{
+    // Nothing was created, there might not even be a GL context.
+    if (!m_stats.is_using_pixel_buffers) {
+        return;
+    }
+
+    glDeleteBuffers(PIXEL_BUFFERS_NB, m_pixel_buffers.data());
+    m_pixel_buffers.fill(0);
+    m_pending_index = -1;
+
+    m_stats.is_using_pixel_buffers = false;
+}
+} // namespace YAVE
@@ -1,6 +1,8 @@
 #include "core/timeline.hpp"
 #include "core/backend/audio_player.hpp"
 
+#include <cstdio>
+
 namespace YAVE
 {
 #pragma region Init Functions
@@ -49,6 +51,8 @@ void Timeline::render()
     auto& video_flags = video_processor->get_flags();
     auto video_state = video_processor->video_state();
 
+    handle_transport_keys();
+
     if (ImGui::Button(~video_flags & VideoFlags::IS_PAUSED ? "Pause" : "Resume")) {
         SDL_Event pause_event;
         pause_event.type = CustomVideoEvents::FF_TOGGLE_PAUSE_EVENT;
@@ -65,6 +69,33 @@ void Timeline::render()
 
     ImGui::SameLine();
 
+    ImGui::Text("Speed: ");
+
+    ImGui::SameLine();
+
+    ImGui::SetNextItemWidth(80.0f);
+
+    const double playback_rate = VideoPlayer::get_playback_rate();
+    const std::string playback_rate_str = format_playback_rate(playback_rate);
+
+    if (ImGui::BeginCombo("##playback_rate", playback_rate_str.c_str())) {
+        for (const double rate : PLAYBACK_RATE_PRESETS) {
+            const bool is_selected = rate == playback_rate;
+
+            if (ImGui::Selectable(format_playback_rate(rate).c_str(), is_selected)) {
+                video_processor->set_playback_rate(rate);
+            }
+
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+
+        ImGui::EndCombo();
+    }
+
+    ImGui::SameLine();
+
     ImGui::Text("Magnify: ");
 
     ImGui::SameLine();
@@ -295,6 +326,14 @@ void Timeline::render_tracks()
 
 #pragma region Timestamp
 
+std::string Timeline::format_playback_rate(double playback_rate)
+{
+    std::array<char, 16> buffer = { 0 };
+    std::snprintf(buffer.data(), buffer.size(), "%gx", playback_rate);
+
+    return buffer.data();
+}
+
 void Timeline::render_timestamp()
 {
     m_draw_list->ChannelsSetCurrent(TimelineLayers::TIMESTAMP_LAYER);
@@ -363,14 +402,57 @@ void Timeline::render_waveform(
 
 #pragma endregion Waveform
 
+void Timeline::handle_transport_keys()
+{
+    if (ImGui::GetIO().WantTextInput) {
+        return;
+    }
+
+    constexpr std::array<std::pair<ImGuiKey, ShuttleCommand>, 3> shuttle_keys = { {
+        { ImGuiKey_J, ShuttleCommand::REVERSE },
+        { ImGuiKey_K, ShuttleCommand::PAUSE },
+        { ImGuiKey_L, ShuttleCommand::FORWARD },
+    } };
+
+    for (const auto& [key, command] : shuttle_keys) {
+        if (!ImGui::IsKeyPressed(key, false)) {
+            continue;
+        }
+
+        SDL_Event shuttle_event{};
+        shuttle_event.type = CustomVideoEvents::FF_SHUTTLE_EVENT;
+        shuttle_event.user.code = static_cast<Sint32>(command);
+        SDL_PushEvent(&shuttle_event);
+    }
+
+    // Held down, the arrows keep stepping at the key repeat rate.
+    constexpr std::array<std::pair<ImGuiKey, FrameStep>, 2> step_keys = { {
+        { ImGuiKey_LeftArrow, FrameStep::PREVIOUS },
+        { ImGuiKey_RightArrow, FrameStep::NEXT },
+    } };
+
+    for (const auto& [key, direction] : step_keys) {
+        if (!ImGui::IsKeyPressed(key, true)) {
+            continue;
+        }
+
+        SDL_Event step_event{};
+        step_event.type = CustomVideoEvents::FF_STEP_FRAME_EVENT;
+        step_event.user.code = static_cast<Sint32>(direction);
+        SDL_PushEvent(&step_event);
+    }
+}
+
 #pragma region Timeline Ruler
 
-int Timeline::request_seek_frame(std::unique_ptr<float> mouse_pos)
+int Timeline::request_seek_frame(float seconds)
 {
-    SDL_Event seek_event;
-    seek_event.type = CustomVideoEvents::FF_SEEK_TO_TIMESTAMP_EVENT;
-    seek_event.user.data1 = reinterpret_cast<void*>(mouse_pos.release());
-    return SDL_PushEvent(&seek_event) == 1;
+    if (!video_processor) {
+        return 0;
+    }
+
+    video_processor->request_seek(seconds);
+    return 1;
 }
 
 int Timeline::handle_ruler_events(const ImVec2& ruler_min)
@@ -384,8 +466,7 @@ int Timeline::handle_ruler_events(const ImVec2& ruler_min)
 
     const float mouse_delta = (ImGui::GetMousePos().x - ruler_min.x) / m_segment_style.scale;
 
-    auto mouse_pos = std::make_unique<float>(mouse_delta);
-    return request_seek_frame(std::move(mouse_pos));
+    return request_seek_frame(mouse_delta);
 }
 
 void Timeline::render_ruler(const ImVec2& timestamp_max)
@@ -446,9 +527,7 @@ int Timeline::handle_playhead_events(const ImVec2& min, const ImVec2& max)
 
     float mouse_delta = ImGui::GetMousePos().x - min.x;
 
-    auto final_mouse_pos = std::make_unique<float>(mouse_delta / m_segment_style.scale);
-
-    return request_seek_frame(std::move(final_mouse_pos));
+    return request_seek_frame(mouse_delta / m_segment_style.scale);
 }
 
 void Timeline::render_playhead()
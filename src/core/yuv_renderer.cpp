@@ -0,0 +1,395 @@
+#include "core/yuv_renderer.hpp"
+
+#include <string>
+
+namespace YAVE
+{
+bool YUVRenderer::s_IsAvailable = false;
+
+namespace
+{
+// A single triangle that covers the whole viewport, the positions come from gl_VertexID
+// so no vertex buffer is needed.
+constexpr const char* VERTEX_SHADER_SOURCE = R"(#version 330 core
+const vec2 positions[3] = vec2[3](vec2(-1.0, -1.0), vec2(3.0, -1.0), vec2(-1.0, 3.0));
+
+out vec2 v_texcoord;
+
+void main()
+{
+    vec2 position = positions[gl_VertexID];
+    v_texcoord = position * 0.5 + 0.5;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+// Same integer math as the CPU kernels, so both paths give the same pixels. The samples are
+// turned back into integers and each 0-255 channel is stored exactly by the RGBA8 target.
+// Row 0 of the planes is written to row 0 of the target, just like the RGBA upload.
+constexpr const char* FRAGMENT_SHADER_SOURCE = R"(#version 330 core
+in vec2 v_texcoord;
+out vec4 out_color;
+
+uniform sampler2D u_luma;
+uniform sampler2D u_chroma_u;
+uniform sampler2D u_chroma_v;
+
+uniform ivec2 u_luma_range;           // (offset, gain), the gain in Q13
+uniform ivec4 u_chroma_coefficients;  // (rv, gu, gv, bu) in Q13
+uniform int u_is_semi_planar;
+
+// The 32-bit wraparound of ColorKernels::pack_channel().
+float pack_channel(int sum)
+{
+    int scaled = int(uint(sum) << 9u) >> 22;
+    return float(clamp(scaled, 0, 255)) / 255.0;
+}
+
+void main()
+{
+    int luma = int(texture(u_luma, v_texcoord).r * 255.0 + 0.5);
+    luma = (luma - u_luma_range.x) * u_luma_range.y + 4096;
+
+    vec2 chroma;
+
+    if (u_is_semi_planar != 0) {
+        chroma = texture(u_chroma_u, v_texcoord).rg;
+    } else {
+        chroma = vec2(texture(u_chroma_u, v_texcoord).r, texture(u_chroma_v, v_texcoord).r);
+    }
+
+    ivec2 centered = ivec2(chroma * 255.0 + 0.5) - 128;
+
+    out_color = vec4(pack_channel(luma + u_chroma_coefficients.x * centered.y),
+        pack_channel(luma + u_chroma_coefficients.y * centered.x +
+            u_chroma_coefficients.z * centered.y),
+        pack_channel(luma + u_chroma_coefficients.w * centered.x), 1.0);
+}
+)";
+
+/**
+ * @brief The GL state that render() touches, restored afterwards so the UI renderer
+ *        doesn't see any difference.
+ */
+struct SavedGLState {
+    GLint framebuffer = 0;
+    GLint program = 0;
+    GLint vertex_array = 0;
+    GLint active_texture = GL_TEXTURE0;
+    GLint texture_bindings[3] = { 0, 0, 0 };
+    GLint viewport[4] = { 0, 0, 0, 0 };
+    GLint unpack_alignment = 4;
+    GLint unpack_row_length = 0;
+    GLboolean is_depth_test_enabled = GL_FALSE;
+    GLboolean is_blend_enabled = GL_FALSE;
+    GLboolean is_scissor_test_enabled = GL_FALSE;
+
+    SavedGLState()
+    {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array);
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+        glGetIntegerv(GL_UNPACK_ROW_LENGTH, &unpack_row_length);
+
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture_bindings[i]);
+        }
+
+        is_depth_test_enabled = glIsEnabled(GL_DEPTH_TEST);
+        is_blend_enabled = glIsEnabled(GL_BLEND);
+        is_scissor_test_enabled = glIsEnabled(GL_SCISSOR_TEST);
+    }
+
+    ~SavedGLState()
+    {
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, texture_bindings[i]);
+        }
+
+        glActiveTexture(active_texture);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glUseProgram(program);
+        glBindVertexArray(vertex_array);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, unpack_row_length);
+
+        set_capability(GL_DEPTH_TEST, is_depth_test_enabled);
+        set_capability(GL_BLEND, is_blend_enabled);
+        set_capability(GL_SCISSOR_TEST, is_scissor_test_enabled);
+    }
+
+    static void set_capability(GLenum capability, GLboolean is_enabled)
+    {
+        if (is_enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+    }
+};
+} // namespace
+
+YUVRenderer::~YUVRenderer()
+{
+    release();
+}
+
+#pragma region Init Functions
+GLuint YUVRenderer::compile_shader(GLenum type, const char* source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint is_compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &is_compiled);
+
+    if (is_compiled != GL_TRUE) {
+        std::string log(1024, '\0');
+        glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "[YUV Renderer]: Failed to compile a shader: " << log.c_str() << "\n";
+
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+GLuint YUVRenderer::link_program(GLuint vertex_shader, GLuint fragment_shader)
+{
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+
+    GLint is_linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+
+    glDetachShader(program, vertex_shader);
+    glDetachShader(program, fragment_shader);
+
+    if (is_linked != GL_TRUE) {
+        std::string log(1024, '\0');
+        glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "[YUV Renderer]: Failed to link the program: " << log.c_str() << "\n";
+
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+int YUVRenderer::init()
+{
+    if (s_IsAvailable) {
+        return 0;
+    }
+
+    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, VERTEX_SHADER_SOURCE);
+    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER_SOURCE);
+
+    if (vertex_shader != 0 && fragment_shader != 0) {
+        m_program = link_program(vertex_shader, fragment_shader);
+    }
+
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    if (m_program == 0) {
+        return -1;
+    }
+
+    GLint previous_program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+
+    glUseProgram(m_program);
+    glUniform1i(glGetUniformLocation(m_program, "u_luma"), LUMA_PLANE);
+    glUniform1i(glGetUniformLocation(m_program, "u_chroma_u"), U_PLANE);
+    glUniform1i(glGetUniformLocation(m_program, "u_chroma_v"), V_PLANE);
+    glUseProgram(previous_program);
+
+    m_luma_range_location = glGetUniformLocation(m_program, "u_luma_range");
+    m_chroma_coefficients_location = glGetUniformLocation(m_program, "u_chroma_coefficients");
+    m_is_semi_planar_location = glGetUniformLocation(m_program, "u_is_semi_planar");
+
+    // Core profiles refuse to draw without a bound vertex array, even an empty one.
+    glGenVertexArrays(1, &m_vertex_array);
+    glGenFramebuffers(1, &m_framebuffer);
+    glGenTextures(PLANES_NB, m_plane_textures);
+
+    if (m_vertex_array == 0 || m_framebuffer == 0 || m_plane_textures[LUMA_PLANE] == 0) {
+        std::cerr << "[YUV Renderer]: Failed to create the GL objects.\n";
+        release();
+        return -1;
+    }
+
+    s_IsAvailable = true;
+
+    return 0;
+}
+#pragma endregion Init Functions
+
+#pragma region Rendering
+void YUVRenderer::upload_plane(int index, const std::uint8_t* data, int linesize, int width,
+    int height, bool is_two_channels)
+{
+    glActiveTexture(GL_TEXTURE0 + index);
+    glBindTexture(GL_TEXTURE_2D, m_plane_textures[index]);
+
+    const GLenum format = is_two_channels ? GL_RG : GL_RED;
+
+    // The decoder pads its lines, let GL skip the padding instead of repacking the plane.
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, is_two_channels ? linesize / 2 : linesize);
+
+    const bool is_same_size = m_plane_widths[index] == width &&
+        m_plane_heights[index] == height && m_plane_is_two_channels[index] == is_two_channels;
+
+    if (is_same_size) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+        return;
+    }
+
+    // Luma is sampled 1:1 and every chroma sample covers its 2 pixels, like the CPU kernels.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, is_two_channels ? GL_RG8 : GL_R8, width, height, 0, format,
+        GL_UNSIGNED_BYTE, data);
+
+    m_plane_widths[index] = width;
+    m_plane_heights[index] = height;
+    m_plane_is_two_channels[index] = is_two_channels;
+}
+
+int YUVRenderer::attach_target(GLuint dest_texture, int width, int height)
+{
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, dest_texture);
+
+    GLint texture_width = 0;
+    GLint texture_height = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &texture_width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &texture_height);
+
+    if (texture_width != width || texture_height != height) {
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dest_texture, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "[YUV Renderer]: The preview texture can't be rendered to.\n";
+        return -1;
+    }
+
+    return 0;
+}
+
+int YUVRenderer::render(const AVFrame* frame, GLuint dest_texture)
+{
+    if (!s_IsAvailable || dest_texture == 0 || !ColorConverter::is_supported(frame)) {
+        return -1;
+    }
+
+    // Bottom-up frames would need a flipped texcoord, they never come out of the decoders.
+    for (int i = 0; i < PLANES_NB && frame->data[i]; ++i) {
+        if (frame->linesize[i] <= 0) {
+            return -1;
+        }
+    }
+
+    const auto pix_fmt = static_cast<AVPixelFormat>(frame->format);
+
+    const bool is_semi_planar = pix_fmt == AV_PIX_FMT_NV12;
+    const bool is_422 = pix_fmt == AV_PIX_FMT_YUV422P || pix_fmt == AV_PIX_FMT_YUVJ422P;
+
+    const int chroma_width = (frame->width + 1) >> 1;
+    const int chroma_height = is_422 ? frame->height : (frame->height + 1) >> 1;
+
+    SavedGLState saved_state;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    upload_plane(
+        LUMA_PLANE, frame->data[0], frame->linesize[0], frame->width, frame->height, false);
+    upload_plane(
+        U_PLANE, frame->data[1], frame->linesize[1], chroma_width, chroma_height, is_semi_planar);
+
+    if (!is_semi_planar) {
+        upload_plane(
+            V_PLANE, frame->data[2], frame->linesize[2], chroma_width, chroma_height, false);
+    }
+
+    if (attach_target(dest_texture, frame->width, frame->height) < 0) {
+        return -1;
+    }
+
+    const YUVCoefficients coefficients =
+        ColorConverter::get_coefficients(frame->colorspace, ColorConverter::is_full_range(frame));
+
+    glUseProgram(m_program);
+    glUniform2i(m_luma_range_location, coefficients.y_offset, coefficients.y_gain);
+    glUniform4i(m_chroma_coefficients_location, coefficients.rv, coefficients.gu,
+        coefficients.gv, coefficients.bu);
+    glUniform1i(m_is_semi_planar_location, is_semi_planar ? 1 : 0);
+
+    for (int i = 0; i < PLANES_NB; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, m_plane_textures[i]);
+    }
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_SCISSOR_TEST);
+
+    glViewport(0, 0, frame->width, frame->height);
+    glBindVertexArray(m_vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // Keep the texture free of a dangling attachment for the glTexImage2D of the RGBA path.
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+
+    return 0;
+}
+#pragma endregion Rendering
+
+#pragma region Deallocation
+void YUVRenderer::release()
+{
+    // Nothing was created, there might not even be a GL context.
+    if (m_program == 0) {
+        return;
+    }
+
+    glDeleteTextures(PLANES_NB, m_plane_textures);
+    glDeleteFramebuffers(1, &m_framebuffer);
+    glDeleteVertexArrays(1, &m_vertex_array);
+    glDeleteProgram(m_program);
+
+    for (int i = 0; i < PLANES_NB; ++i) {
+        m_plane_textures[i] = 0;
+        m_plane_widths[i] = 0;
+        m_plane_heights[i] = 0;
+    }
+
+    m_framebuffer = 0;
+    m_vertex_array = 0;
+    m_program = 0;
+
+    s_IsAvailable = false;
+}
+#pragma endregion Deallocation
+} // namespace YAVE
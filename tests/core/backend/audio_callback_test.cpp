@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "core/backend/audio_player.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48000;
+constexpr int CHANNELS_NB = AUDIO_OUTPUT_CHANNELS_NB;
+
+// A 10 ms device buffer, the smallest the latency controller picks after 5 ms.
+constexpr int DEVICE_SAMPLES_NB = 512;
+constexpr double DEVICE_PERIOD = static_cast<double>(DEVICE_SAMPLES_NB) / SAMPLE_RATE;
+
+constexpr int CALLBACKS_NB = 300;
+
+// A slow keyframe, far longer than a device buffer. The video decoder holds the codec lock
+// for all of it, like a blocking avcodec_send_packet.
+constexpr auto VIDEO_DECODE_DURATION = std::chrono::milliseconds(50);
+
+// A callback that waited on the decode would take tens of milliseconds. This leaves room
+// for the scheduler of a busy test machine.
+constexpr double MAX_CALLBACK_LATENCY = 5e-3;
+
+constexpr int AUDIO_FRAME_SAMPLES_NB = 1024;
+
+/**
+ * @brief The locks and the shared state the player threads use, without the player.
+ */
+struct PlaybackFixture {
+    PlaybackFixture()
+    {
+        locks.video_codec = SDL_CreateMutex();
+        locks.audio_codec = SDL_CreateMutex();
+    }
+
+    ~PlaybackFixture()
+    {
+        SDL_DestroyMutex(locks.audio_codec);
+        SDL_DestroyMutex(locks.video_codec);
+    }
+
+    PlaybackLocks locks;
+
+    PCMRing ring{ static_cast<std::size_t>(SAMPLE_RATE) * CHANNELS_NB / 4 };
+    SeqLock<PCMRingPosition> ring_position;
+    ClockNetwork clocks;
+    AudioLatencyController latency;
+
+    std::atomic<bool> is_stopped = false;
+    std::atomic<bool> is_video_decoding = false;
+};
+
+/**
+ * @brief The steps of AudioPlayer::audio_callback: read the ring, report the buffer and
+ *        publish the clock.
+ * @return The number of samples read.
+ */
+std::size_t run_audio_callback(PlaybackFixture& fixture, float* dest, std::size_t wanted_nb)
+{
+    const std::size_t read_nb = fixture.ring.read(dest, wanted_nb, CHANNELS_NB);
+
+    std::fill(dest + read_nb, dest + wanted_nb, 0.0f);
+    fixture.latency.record_callback(FramePacer::now(), read_nb < wanted_nb);
+
+    if (read_nb == 0) {
+        return 0;
+    }
+
+    const PCMRingPosition position = fixture.ring_position.load();
+    const double sample_duration = 1.0 / (static_cast<double>(CHANNELS_NB) * SAMPLE_RATE);
+
+    const double pts = position.pts -
+        (static_cast<double>(position.write_index) -
+            static_cast<double>(fixture.ring.get_read_index())) *
+            sample_duration;
+
+    const AudioBufferInfo buffer_info = { CHANNELS_NB,
+        static_cast<int>(read_nb * sizeof(float)), SAMPLE_RATE, 0 };
+
+    fixture.clocks.update_audio_clock(
+        pts, static_cast<double>(read_nb) * sample_duration, buffer_info);
+
+    return read_nb;
+}
+
+/**
+ * @brief Keeps the ring full like AudioPlayer::decode_audio_ahead, with the audio codec
+ *        lock taken around each "decode".
+ */
+void run_audio_decoder(PlaybackFixture& fixture)
+{
+    std::vector<float> samples(static_cast<std::size_t>(AUDIO_FRAME_SAMPLES_NB) * CHANNELS_NB);
+    double next_pts = 0.0;
+
+    while (!fixture.is_stopped) {
+        if (fixture.ring.capacity() - fixture.ring.size() < samples.size()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(AUDIO_RING_WAIT_MS));
+            continue;
+        }
+
+        SDL_LockMutex(fixture.locks.audio_codec);
+
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = 0.25f * std::sin(static_cast<float>(i) * 0.01f);
+        }
+
+        SDL_UnlockMutex(fixture.locks.audio_codec);
+
+        const double frame_duration = static_cast<double>(AUDIO_FRAME_SAMPLES_NB) / SAMPLE_RATE;
+        const std::size_t written_nb = fixture.ring.write(samples.data(), samples.size());
+
+        next_pts += frame_duration;
+        fixture.ring_position.store(
+            PCMRingPosition{ fixture.ring.get_write_index(), next_pts, 0.0, CHANNELS_NB,
+                SAMPLE_RATE });
+
+        EXPECT_EQ(written_nb, samples.size());
+    }
+}
+
+/**
+ * @brief A video decoder stuck on slow frames, holding its codec lock the whole time.
+ */
+void run_video_decoder(PlaybackFixture& fixture)
+{
+    while (!fixture.is_stopped) {
+        SDL_LockMutex(fixture.locks.video_codec);
+        fixture.is_video_decoding = true;
+
+        std::this_thread::sleep_for(VIDEO_DECODE_DURATION);
+
+        fixture.is_video_decoding = false;
+        SDL_UnlockMutex(fixture.locks.video_codec);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+} // namespace
+
+/**
+ * The audio callback must never wait on the video decoder. The callback runs at the device
+ * period while the video decoder keeps its codec lock for several periods at a time, and
+ * every callback has to return well within one period.
+ */
+TEST(AudioCallbackTest, NeverWaitsOnVideoDecode)
+{
+    PlaybackFixture fixture;
+
+    std::thread audio_decoder(run_audio_decoder, std::ref(fixture));
+
+    // Let the ring fill up before the device starts, like the player does on open.
+    while (fixture.ring.size() < static_cast<std::size_t>(DEVICE_SAMPLES_NB) * CHANNELS_NB * 4) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::thread video_decoder(run_video_decoder, std::ref(fixture));
+
+    std::vector<float> buffer(static_cast<std::size_t>(DEVICE_SAMPLES_NB) * CHANNELS_NB);
+
+    double max_latency = 0.0;
+    int callbacks_during_decode_nb = 0;
+    int short_reads_nb = 0;
+    double last_clock = 0.0;
+    int clock_regressions_nb = 0;
+
+    // The device asks on a steady period, however long the previous callback took.
+    FramePacer device_timer;
+    double next_deadline = FramePacer::now();
+
+    for (int i = 0; i < CALLBACKS_NB; ++i) {
+        next_deadline += DEVICE_PERIOD;
+
+        const bool is_during_decode = fixture.is_video_decoding;
+        const double start = FramePacer::now();
+
+        const std::size_t read_nb = run_audio_callback(fixture, buffer.data(), buffer.size());
+
+        max_latency = std::max(max_latency, FramePacer::now() - start);
+
+        callbacks_during_decode_nb += is_during_decode ? 1 : 0;
+        short_reads_nb += read_nb < buffer.size() ? 1 : 0;
+
+        const double clock = fixture.clocks.get_audio_clock();
+        clock_regressions_nb += clock < last_clock ? 1 : 0;
+        last_clock = clock;
+
+        device_timer.wait_until(next_deadline);
+    }
+
+    fixture.is_stopped = true;
+
+    video_decoder.join();
+    audio_decoder.join();
+
+    // Most of the callbacks ran while the video decoder held its lock.
+    EXPECT_GT(callbacks_during_decode_nb, CALLBACKS_NB / 2);
+
+    EXPECT_LT(max_latency, MAX_CALLBACK_LATENCY)
+        << "A callback took " << max_latency * 1e3 << " ms";
+
+    EXPECT_EQ(short_reads_nb, 0);
+    EXPECT_EQ(clock_regressions_nb, 0);
+}
@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "core/backend/audio_conversion.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr int TEST_SAMPLE_RATE = 48000;
+
+// Lengths around the 4, 8 and 16 sample blocks, so every kernel runs its tail, and a
+// typical AAC frame.
+constexpr std::array<int, 10> TEST_SAMPLES_NBS = { 1, 3, 4, 7, 8, 15, 16, 17, 33, 1024 };
+
+// Samples after the destination that no kernel may write.
+constexpr int DEST_PADDING = 16;
+constexpr float DEST_SENTINEL = -1234.5f;
+
+struct TestFormat {
+    AVSampleFormat sample_format = AV_SAMPLE_FMT_NONE;
+    std::uint64_t channel_layout = 0;
+    const char* name = "";
+};
+
+const std::array<TestFormat, 9> TEST_FORMATS = { {
+    { AV_SAMPLE_FMT_FLTP, AV_CH_LAYOUT_STEREO, "FLTP_Stereo" },
+    { AV_SAMPLE_FMT_FLTP, AV_CH_LAYOUT_MONO, "FLTP_Mono" },
+    { AV_SAMPLE_FMT_FLTP, AV_CH_LAYOUT_5POINT1, "FLTP_51_Downmix" },
+    { AV_SAMPLE_FMT_FLTP, AV_CH_LAYOUT_5POINT1_BACK, "FLTP_51Back_Downmix" },
+    { AV_SAMPLE_FMT_S16, AV_CH_LAYOUT_STEREO, "S16_Stereo" },
+    { AV_SAMPLE_FMT_S32, AV_CH_LAYOUT_STEREO, "S32_Stereo" },
+    { AV_SAMPLE_FMT_S16P, AV_CH_LAYOUT_STEREO, "S16P_Stereo" },
+    { AV_SAMPLE_FMT_S32P, AV_CH_LAYOUT_STEREO, "S32P_Stereo" },
+    { AV_SAMPLE_FMT_FLT, AV_CH_LAYOUT_STEREO, "FLT_Stereo" },
+} };
+
+struct FrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+struct KernelInfo {
+    ConversionISA isa = ConversionISA::SCALAR;
+    AudioKernel kernel = nullptr;
+};
+
+template <typename Sample>
+void fill_random(std::uint8_t* data, int samples_nb, std::mt19937& generator)
+{
+    auto* samples = reinterpret_cast<Sample*>(data);
+
+    if constexpr (std::is_floating_point_v<Sample>) {
+        // Past full scale too, neither path clips floats.
+        std::uniform_real_distribution<Sample> distribution(-1.5f, 1.5f);
+
+        for (int i = 0; i < samples_nb; ++i) {
+            samples[i] = distribution(generator);
+        }
+    } else {
+        std::uniform_int_distribution<Sample> distribution(
+            std::numeric_limits<Sample>::min(), std::numeric_limits<Sample>::max());
+
+        for (int i = 0; i < samples_nb; ++i) {
+            samples[i] = distribution(generator);
+        }
+
+        // The extremes, where a wrong scale or a saturating conversion would show.
+        samples[0] = std::numeric_limits<Sample>::min();
+        samples[samples_nb - 1] = std::numeric_limits<Sample>::max();
+    }
+}
+
+/**
+ * @brief A frame of random samples, different on every channel.
+ */
+[[nodiscard]] FramePtr make_frame(const TestFormat& format, int samples_nb)
+{
+    FramePtr av_frame(av_frame_alloc());
+
+    av_frame->format = format.sample_format;
+    av_frame->channel_layout = format.channel_layout;
+    av_frame->channels = av_get_channel_layout_nb_channels(format.channel_layout);
+    av_frame->sample_rate = TEST_SAMPLE_RATE;
+    av_frame->nb_samples = samples_nb;
+
+    if (av_frame_get_buffer(av_frame.get(), 0) < 0) {
+        return nullptr;
+    }
+
+    std::mt19937 generator(static_cast<unsigned int>(samples_nb * 100 + format.sample_format));
+
+    const bool is_planar = av_sample_fmt_is_planar(format.sample_format);
+    const int planes_nb = is_planar ? av_frame->channels : 1;
+    const int plane_samples_nb = is_planar ? samples_nb : samples_nb * av_frame->channels;
+
+    for (int plane = 0; plane < planes_nb; ++plane) {
+        std::uint8_t* data = av_frame->extended_data[plane];
+
+        switch (av_get_packed_sample_fmt(format.sample_format)) {
+        case AV_SAMPLE_FMT_S16:
+            fill_random<std::int16_t>(data, plane_samples_nb, generator);
+            break;
+        case AV_SAMPLE_FMT_S32:
+            fill_random<std::int32_t>(data, plane_samples_nb, generator);
+            break;
+        default:
+            fill_random<float>(data, plane_samples_nb, generator);
+            break;
+        }
+    }
+
+    return av_frame;
+}
+
+/**
+ * @brief The key the player converts a frame with, 5.1 is mixed down to stereo.
+ */
+[[nodiscard]] ResamplerKey make_key(const AVFrame* av_frame)
+{
+    ResamplerKey key =
+        ResamplerKey::from_frame(av_frame, AV_SAMPLE_FMT_FLT, av_frame->sample_rate);
+    key.out_channel_layout = AudioConverter::get_stereo_downmix_layout(key.in_channel_layout);
+
+    return key;
+}
+
+[[nodiscard]] std::size_t get_output_size(const ResamplerKey& key, int samples_nb)
+{
+    return static_cast<std::size_t>(samples_nb) *
+        av_get_channel_layout_nb_channels(key.out_channel_layout);
+}
+
+/**
+ * @brief The kernel the dispatch picks for the key at every instruction set this CPU has.
+ */
+[[nodiscard]] std::vector<KernelInfo> get_supported_kernels(const ResamplerKey& key)
+{
+    std::vector<KernelInfo> kernels;
+
+    for (const auto isa : { ConversionISA::SCALAR, ConversionISA::SSE41, ConversionISA::AVX2 }) {
+        ColorConverter::set_max_isa(isa);
+
+        if (ColorConverter::get_active_isa() == isa) {
+            kernels.push_back({ isa, AudioConverter::get_kernel(key) });
+        }
+    }
+
+    ColorConverter::set_max_isa(ConversionISA::AVX2);
+
+    return kernels;
+}
+
+[[nodiscard]] std::vector<float> convert_with_kernel(
+    const AVFrame* av_frame, const ResamplerKey& key, AudioKernel kernel)
+{
+    std::vector<float> samples(get_output_size(key, av_frame->nb_samples) + DEST_PADDING,
+        DEST_SENTINEL);
+
+    AudioConversionJob job;
+    job.src = av_frame->extended_data;
+    job.dest = samples.data();
+    job.samples_nb = av_frame->nb_samples;
+    job.channels_nb = av_frame->channels;
+
+    kernel(job);
+
+    return samples;
+}
+
+/**
+ * @brief The same conversion through swresample, what the kernels replace.
+ */
+[[nodiscard]] std::vector<float> convert_with_swr(
+    const AVFrame* av_frame, const ResamplerKey& key)
+{
+    ResamplerCache resamplers;
+    const ResamplerPtr resampler = resamplers.acquire(key);
+
+    if (!resampler) {
+        return {};
+    }
+
+    std::vector<float> samples(get_output_size(key, av_frame->nb_samples));
+    std::array<std::uint8_t*, 1> out_data = { reinterpret_cast<std::uint8_t*>(samples.data()) };
+
+    // Without a rate change, swresample holds nothing back.
+    const int converted_nb = swr_convert(resampler.get(), out_data.data(), av_frame->nb_samples,
+        const_cast<const std::uint8_t**>(av_frame->extended_data), av_frame->nb_samples);
+
+    return converted_nb == av_frame->nb_samples ? samples : std::vector<float>{};
+}
+
+class AudioConversionTest : public testing::TestWithParam<TestFormat>
+{
+};
+} // namespace
+
+TEST_P(AudioConversionTest, KernelsMatchSwr)
+{
+    for (const int samples_nb : TEST_SAMPLES_NBS) {
+        const FramePtr av_frame = make_frame(GetParam(), samples_nb);
+        ASSERT_NE(av_frame, nullptr);
+
+        const ResamplerKey key = make_key(av_frame.get());
+
+        const std::vector<float> expected = convert_with_swr(av_frame.get(), key);
+        ASSERT_EQ(expected.size(), get_output_size(key, samples_nb));
+
+        for (const KernelInfo& kernel : get_supported_kernels(key)) {
+            SCOPED_TRACE(std::string(ColorConverter::isa_to_string(kernel.isa)) + " " +
+                std::to_string(samples_nb) + " samples");
+
+            ASSERT_NE(kernel.kernel, nullptr);
+
+            const std::vector<float> samples =
+                convert_with_kernel(av_frame.get(), key, kernel.kernel);
+
+            // Only count, a failed assertion per sample would flood the output.
+            std::size_t mismatches_nb = 0;
+            std::size_t first_mismatch = 0;
+
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                if (samples[i] != expected[i] && mismatches_nb++ == 0) {
+                    first_mismatch = i;
+                }
+            }
+
+            // The kernels do the same math in the same order, the output is identical.
+            EXPECT_EQ(mismatches_nb, 0u) << "First at " << first_mismatch << ": "
+                                         << samples[first_mismatch] << " instead of "
+                                         << expected[first_mismatch];
+
+            for (std::size_t i = expected.size(); i < samples.size(); ++i) {
+                EXPECT_EQ(samples[i], DEST_SENTINEL) << "Padding sample " << i - expected.size();
+            }
+        }
+    }
+}
+
+TEST(AudioConverterTest, ConversionsThatNeedSwrHaveNoKernel)
+{
+    const FramePtr av_frame = make_frame(TEST_FORMATS[0], 64);
+    ASSERT_NE(av_frame, nullptr);
+
+    ResamplerKey key = make_key(av_frame.get());
+    ASSERT_NE(AudioConverter::get_kernel(key), nullptr);
+
+    std::vector<float> samples(get_output_size(key, 64));
+    EXPECT_EQ(AudioConverter::convert(key, av_frame.get(), samples.data()), 64);
+
+    // A rate change needs a real resampler.
+    key.out_sample_rate = 44100;
+    EXPECT_EQ(AudioConverter::get_kernel(key), nullptr);
+    EXPECT_LT(AudioConverter::convert(key, av_frame.get(), samples.data()), 0);
+
+    key = make_key(av_frame.get());
+    key.out_sample_format = AV_SAMPLE_FMT_S16;
+    EXPECT_EQ(AudioConverter::get_kernel(key), nullptr);
+
+    // Only planar float 5.1 is mixed down by a kernel.
+    key = make_key(av_frame.get());
+    key.in_sample_format = AV_SAMPLE_FMT_S16;
+    key.in_channel_layout = AV_CH_LAYOUT_5POINT1;
+    EXPECT_EQ(AudioConverter::get_kernel(key), nullptr);
+}
+
+TEST(AudioConverterTest, OnlyFivePointOneIsMixedDown)
+{
+    EXPECT_EQ(
+        AudioConverter::get_stereo_downmix_layout(AV_CH_LAYOUT_5POINT1), AV_CH_LAYOUT_STEREO);
+    EXPECT_EQ(AudioConverter::get_stereo_downmix_layout(AV_CH_LAYOUT_5POINT1_BACK),
+        AV_CH_LAYOUT_STEREO);
+
+    EXPECT_EQ(AudioConverter::get_stereo_downmix_layout(AV_CH_LAYOUT_MONO), AV_CH_LAYOUT_MONO);
+    EXPECT_EQ(
+        AudioConverter::get_stereo_downmix_layout(AV_CH_LAYOUT_SURROUND), AV_CH_LAYOUT_SURROUND);
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, AudioConversionTest, testing::ValuesIn(TEST_FORMATS),
+    [](const testing::TestParamInfo<TestFormat>& info) { return info.param.name; });
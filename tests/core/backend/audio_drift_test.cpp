@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/backend/drift_compensator.hpp"
+#include "core/backend/resampler_cache.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// AAC frames at the rate the player opens the device with.
+constexpr int FRAME_SAMPLES_NB = 1024;
+constexpr int SAMPLE_RATE = 48000;
+constexpr double FRAME_DURATION = static_cast<double>(FRAME_SAMPLES_NB) / SAMPLE_RATE;
+
+constexpr double SYNC_TOLERANCE = 5e-3;
+
+/**
+ * @brief A device clock running off by a fixed ppm from the video clock, with the audio
+ *        stretched by the compensation of every frame.
+ *
+ * A frame always covers FRAME_DURATION of media time, but the device plays its stretched
+ * samples at its own rate, so the audio clock gains or loses against the video clock.
+ */
+class DriftSimulation
+{
+public:
+    DriftSimulation(double drift_ppm, double initial_diff)
+        : m_device_rate(SAMPLE_RATE * (1.0 + drift_ppm * 1e-6))
+        , m_diff(initial_diff)
+    {
+    }
+
+    /**
+     * @return The compensation applied to the frame, in samples.
+     */
+    int run_frame()
+    {
+        const int sample_delta = m_compensator.update(m_diff, FRAME_SAMPLES_NB);
+
+        m_diff += FRAME_DURATION - (FRAME_SAMPLES_NB + sample_delta) / m_device_rate;
+        m_time += FRAME_DURATION;
+
+        return sample_delta;
+    }
+
+    /**
+     * @return The largest difference seen over the run, in seconds.
+     */
+    double run_for(double seconds)
+    {
+        const double end_time = m_time + seconds;
+        double max_diff = 0.0;
+
+        while (m_time < end_time) {
+            run_frame();
+            max_diff = std::max(max_diff, std::abs(m_diff));
+        }
+
+        return max_diff;
+    }
+
+    [[nodiscard]] double get_diff() const noexcept
+    {
+        return m_diff;
+    }
+
+private:
+    DriftCompensator m_compensator;
+
+    double m_device_rate;
+    double m_diff;
+    double m_time = 0.0;
+};
+
+struct FrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+[[nodiscard]] FramePtr make_stereo_frame(int index)
+{
+    FramePtr av_frame(av_frame_alloc());
+
+    av_frame->format = AV_SAMPLE_FMT_FLTP;
+    av_frame->channel_layout = AV_CH_LAYOUT_STEREO;
+    av_frame->channels = 2;
+    av_frame->sample_rate = SAMPLE_RATE;
+    av_frame->nb_samples = FRAME_SAMPLES_NB;
+
+    if (av_frame_get_buffer(av_frame.get(), 0) < 0) {
+        return nullptr;
+    }
+
+    for (int channel = 0; channel < 2; ++channel) {
+        auto* samples = reinterpret_cast<float*>(av_frame->extended_data[channel]);
+
+        for (int i = 0; i < FRAME_SAMPLES_NB; ++i) {
+            const int position = index * FRAME_SAMPLES_NB + i;
+            samples[i] = 0.5f * std::sin(0.03f * static_cast<float>(position * (channel + 1)));
+        }
+    }
+
+    return av_frame;
+}
+
+[[nodiscard]] ResamplerKey make_player_key()
+{
+    ResamplerKey key;
+    key.in_channel_layout = AV_CH_LAYOUT_STEREO;
+    key.in_sample_format = AV_SAMPLE_FMT_FLTP;
+    key.in_sample_rate = SAMPLE_RATE;
+    key.out_channel_layout = AV_CH_LAYOUT_STEREO;
+    key.out_sample_format = AV_SAMPLE_FMT_FLT;
+    key.out_sample_rate = SAMPLE_RATE;
+    key.flags = SWR_FLAG_RESAMPLE;
+
+    return key;
+}
+
+/**
+ * @brief Runs frames through the resampler with a stretch on each, like the player does
+ *        while it corrects a drift.
+ * @return The number of samples per channel that came out.
+ */
+int run_corrected_frames(SwrContext* resampler, int frames_nb, int sample_delta)
+{
+    std::vector<float> samples(static_cast<std::size_t>(FRAME_SAMPLES_NB * 2) * 2);
+    std::array<float*, 1> out_data = { samples.data() };
+
+    int out_nb = 0;
+
+    for (int i = 0; i < frames_nb; ++i) {
+        const FramePtr av_frame = make_stereo_frame(i);
+
+        if (!av_frame || swr_set_compensation(resampler, sample_delta, FRAME_SAMPLES_NB) < 0) {
+            return -1;
+        }
+
+        const int converted_nb = swr_convert(resampler,
+            reinterpret_cast<std::uint8_t**>(out_data.data()), FRAME_SAMPLES_NB * 2,
+            const_cast<const std::uint8_t**>(av_frame->extended_data), FRAME_SAMPLES_NB);
+
+        if (converted_nb < 0) {
+            return -1;
+        }
+
+        out_nb += converted_nb;
+    }
+
+    return out_nb;
+}
+} // namespace
+
+TEST(DriftCompensatorTest, WaitsForTheAverageToFill)
+{
+    DriftCompensator compensator;
+
+    for (int i = 0; i < AV_DIFFERENCE_COUNT; ++i) {
+        EXPECT_EQ(compensator.update(0.5, FRAME_SAMPLES_NB), 0);
+    }
+
+    EXPECT_GT(compensator.update(0.5, FRAME_SAMPLES_NB), 0);
+}
+
+TEST(DriftCompensatorTest, RestartsAfterALargeDifference)
+{
+    DriftCompensator compensator;
+
+    for (int i = 0; i <= AV_DIFFERENCE_COUNT; ++i) {
+        compensator.update(0.5, FRAME_SAMPLES_NB);
+    }
+
+    // A seek, the difference before it says nothing about the drift after it.
+    EXPECT_EQ(compensator.update(NOSYNC_THRESHOLD, FRAME_SAMPLES_NB), 0);
+    EXPECT_EQ(compensator.update(0.5, FRAME_SAMPLES_NB), 0);
+}
+
+TEST(DriftCompensatorTest, StretchIsCapped)
+{
+    const int max_delta =
+        static_cast<int>(std::lround(MAX_AUDIO_DRIFT_CORRECTION * FRAME_SAMPLES_NB));
+
+    EXPECT_EQ(DriftCompensator::calculate_compensation(0.9, FRAME_SAMPLES_NB), max_delta);
+    EXPECT_EQ(DriftCompensator::calculate_compensation(-0.9, FRAME_SAMPLES_NB), -max_delta);
+}
+
+TEST(DriftCompensatorTest, RemovesAnOffset)
+{
+    DriftSimulation simulation(0.0, 0.1);
+
+    simulation.run_for(20.0);
+    EXPECT_LT(std::abs(simulation.get_diff()), SYNC_TOLERANCE);
+
+    // Without overshooting into the other direction later on.
+    EXPECT_LT(simulation.run_for(30.0), SYNC_TOLERANCE);
+}
+
+TEST(DriftCompensatorTest, HoldsAConstantDrift)
+{
+    for (const double drift_ppm : { -1000.0, -100.0, 100.0, 1000.0 }) {
+        SCOPED_TRACE(std::to_string(drift_ppm) + " ppm");
+
+        // Uncorrected, 1000 ppm would be 60 ms apart after a minute.
+        DriftSimulation simulation(drift_ppm, 0.0);
+
+        EXPECT_LT(simulation.run_for(60.0), SYNC_TOLERANCE);
+    }
+}
+
+TEST(DriftCompensatorTest, CorrectionEndsOnceInSync)
+{
+    DriftSimulation simulation(0.0, 0.05);
+    simulation.run_for(30.0);
+
+    // In sync the frames go back to the kernels, which needs a compensation of 0.
+    for (int i = 0; i < 500; ++i) {
+        ASSERT_EQ(simulation.run_frame(), 0) << "Frame " << i;
+    }
+}
+
+TEST(DrainResamplerTest, FlushesTheDelayedSamplesOfACorrection)
+{
+    const ResamplerKey key = make_player_key();
+
+    // Two resamplers that go through the same correction. One is drained, the other one
+    // is flushed by hand until it's empty to count what it held.
+    ResamplerCache resamplers(1);
+    const ResamplerPtr resampler = resamplers.acquire(key);
+    ASSERT_NE(resampler, nullptr);
+
+    ResamplerCache reference_resamplers(1);
+    const ResamplerPtr reference = reference_resamplers.acquire(key);
+    ASSERT_NE(reference, nullptr);
+
+    constexpr int CORRECTED_FRAMES_NB = 50;
+    constexpr int SAMPLE_DELTA = 10;
+
+    ASSERT_GE(run_corrected_frames(resampler.get(), CORRECTED_FRAMES_NB, SAMPLE_DELTA), 0);
+    ASSERT_GE(run_corrected_frames(reference.get(), CORRECTED_FRAMES_NB, SAMPLE_DELTA), 0);
+
+    // The correction ends, the player sets a compensation of 0 before draining.
+    ASSERT_GE(swr_set_compensation(resampler.get(), 0, FRAME_SAMPLES_NB), 0);
+    ASSERT_GE(swr_set_compensation(reference.get(), 0, FRAME_SAMPLES_NB), 0);
+
+    std::vector<float> samples;
+    std::vector<float> reference_samples(static_cast<std::size_t>(FRAME_SAMPLES_NB) * 2);
+    std::array<float*, 1> out_data = { reference_samples.data() };
+
+    int held_nb = 0;
+    int flushed_nb = 0;
+
+    do {
+        flushed_nb = swr_convert(reference.get(), reinterpret_cast<std::uint8_t**>(out_data.data()),
+            FRAME_SAMPLES_NB, nullptr, 0);
+        held_nb += std::max(flushed_nb, 0);
+    } while (flushed_nb > 0);
+
+    ASSERT_GT(held_nb, 0) << "The resampler didn't hold anything back";
+
+    const int drained_nb = drain_resampler(resampler.get(), key, samples);
+
+    EXPECT_EQ(drained_nb, held_nb);
+    EXPECT_GE(samples.size(), static_cast<std::size_t>(drained_nb) * 2);
+
+    // Reset for the next correction, nothing left to drain.
+    EXPECT_EQ(swr_get_delay(resampler.get(), SAMPLE_RATE), 0);
+    EXPECT_EQ(drain_resampler(resampler.get(), key, samples), 0);
+}
+
+TEST(DrainResamplerTest, LeavesAnIdleResamplerAlone)
+{
+    const ResamplerKey key = make_player_key();
+
+    ResamplerCache resamplers(1);
+    const ResamplerPtr resampler = resamplers.acquire(key);
+    ASSERT_NE(resampler, nullptr);
+
+    std::vector<float> samples;
+
+    EXPECT_EQ(drain_resampler(resampler.get(), key, samples), 0);
+    EXPECT_TRUE(samples.empty());
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include "core/backend/audio_latency.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48000;
+
+// Far from 0, so nothing depends on the controller starting with no change yet.
+constexpr double START_TIME = 100.0;
+
+/**
+ * @brief Reports an underrun and lets the decode thread look at it.
+ * @return Whether the device has to be reopened.
+ */
+bool underrun_at(AudioLatencyController& controller, double current_time)
+{
+    controller.record_callback(current_time, true);
+    return controller.update(current_time);
+}
+} // namespace
+
+TEST(AudioLatencyTest, UnderrunGrowsTheBufferOneStep)
+{
+    AudioLatencyController controller;
+
+    EXPECT_FALSE(controller.update(START_TIME));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_20);
+
+    EXPECT_TRUE(underrun_at(controller, START_TIME));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_40);
+
+    const AudioLatencyStats stats = controller.get_stats();
+    EXPECT_EQ(stats.underruns_nb, 1u);
+    EXPECT_EQ(stats.grows_nb, 1);
+    EXPECT_EQ(stats.requested, AudioLatency::MS_20);
+}
+
+TEST(AudioLatencyTest, GrowsAreSpacedByTheCooldown)
+{
+    AudioLatencyController controller;
+
+    ASSERT_TRUE(underrun_at(controller, START_TIME));
+
+    // The reopened device hasn't had a chance yet.
+    EXPECT_FALSE(underrun_at(controller, START_TIME + 0.9));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_40);
+
+    EXPECT_TRUE(underrun_at(controller, START_TIME + 1.0));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_80);
+
+    // The largest step is a ceiling.
+    EXPECT_FALSE(underrun_at(controller, START_TIME + 5.0));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_80);
+    EXPECT_EQ(controller.get_stats().grows_nb, 2);
+}
+
+TEST(AudioLatencyTest, ShrinksBackAfterAStablePeriod)
+{
+    AudioLatencyController controller;
+
+    ASSERT_TRUE(underrun_at(controller, START_TIME));
+
+    // Within the cooldown, it doesn't grow but the stable period starts over.
+    ASSERT_FALSE(underrun_at(controller, START_TIME + 0.5));
+
+    EXPECT_FALSE(controller.update(START_TIME + 15.0));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_40);
+
+    EXPECT_TRUE(controller.update(START_TIME + 15.5));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_20);
+    EXPECT_EQ(controller.get_stats().shrinks_nb, 1);
+
+    // Never below what the user asked for.
+    EXPECT_FALSE(controller.update(START_TIME + 60.0));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_20);
+}
+
+TEST(AudioLatencyTest, ShrinksOneStepPerStablePeriod)
+{
+    AudioLatencyController controller;
+
+    ASSERT_TRUE(underrun_at(controller, START_TIME));
+    ASSERT_TRUE(underrun_at(controller, START_TIME + 1.0));
+    ASSERT_EQ(controller.get_effective(), AudioLatency::MS_80);
+
+    EXPECT_TRUE(controller.update(START_TIME + 16.0));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_40);
+
+    // The step down starts a new period.
+    EXPECT_FALSE(controller.update(START_TIME + 30.0));
+    EXPECT_TRUE(controller.update(START_TIME + 31.0));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_20);
+}
+
+TEST(AudioLatencyTest, HoldIgnoresTheUnderrunsThatFollow)
+{
+    AudioLatencyController controller;
+
+    controller.hold(START_TIME);
+
+    EXPECT_FALSE(underrun_at(controller, START_TIME + 0.4));
+    EXPECT_EQ(controller.get_stats().underruns_nb, 0u);
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_20);
+
+    EXPECT_TRUE(underrun_at(controller, START_TIME + 0.5));
+    EXPECT_EQ(controller.get_stats().underruns_nb, 1u);
+}
+
+TEST(AudioLatencyTest, LateCallbacksCountAsUnderruns)
+{
+    AudioLatencyController controller;
+
+    // A 21 ms period.
+    controller.set_device_buffer(1024, SAMPLE_RATE);
+
+    controller.record_callback(START_TIME, false);
+    controller.record_callback(START_TIME + 0.04, false);
+    EXPECT_EQ(controller.get_stats().late_callbacks_nb, 0u);
+
+    // More than 3 periods, the device most likely played silence.
+    controller.record_callback(START_TIME + 0.11, false);
+    EXPECT_EQ(controller.get_stats().late_callbacks_nb, 1u);
+
+    // A gap this long comes from a pause, not from a slow machine.
+    controller.record_callback(START_TIME + 0.7, false);
+    EXPECT_EQ(controller.get_stats().late_callbacks_nb, 1u);
+
+    EXPECT_TRUE(controller.update(START_TIME + 0.7));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_40);
+}
+
+TEST(AudioLatencyTest, RequestedLatencyAppliesRightAway)
+{
+    AudioLatencyController controller;
+
+    controller.set_requested(AudioLatency::MS_5);
+    EXPECT_TRUE(controller.update(START_TIME));
+    EXPECT_EQ(controller.get_effective(), AudioLatency::MS_5);
+
+    // The same setting again doesn't reopen the device.
+    controller.set_requested(AudioLatency::MS_5);
+    EXPECT_FALSE(controller.update(START_TIME + 1.0));
+
+    // The last step is only reached by growing.
+    controller.set_requested(AudioLatency::MS_80);
+    EXPECT_EQ(controller.get_requested(), MAX_SELECTABLE_AUDIO_LATENCY);
+}
+
+TEST(AudioLatencyTest, BufferSamplesAreRoundedToAPowerOfTwo)
+{
+    AudioLatencyController controller;
+
+    // 20 ms at 48 kHz is 960 samples.
+    EXPECT_EQ(controller.get_buffer_samples(SAMPLE_RATE), 1024);
+
+    controller.set_requested(AudioLatency::MS_5);
+    ASSERT_TRUE(controller.update(START_TIME));
+
+    EXPECT_EQ(controller.get_buffer_samples(SAMPLE_RATE), 256);
+    EXPECT_EQ(controller.get_buffer_samples(44100), 256);
+}
+
+TEST(AudioLatencyTest, HistoryCountsTheUnderrunsOfEachSecond)
+{
+    AudioLatencyController controller;
+
+    controller.record_callback(START_TIME + 0.2, true);
+    controller.record_callback(START_TIME + 0.7, true);
+    controller.record_callback(START_TIME + 2.5, true);
+
+    const auto history = controller.get_history(START_TIME + 2.9);
+
+    EXPECT_EQ(history[UNDERRUN_HISTORY_SECONDS - 1], 1.0f);
+    EXPECT_EQ(history[UNDERRUN_HISTORY_SECONDS - 2], 0.0f);
+    EXPECT_EQ(history[UNDERRUN_HISTORY_SECONDS - 3], 2.0f);
+
+    // A minute later the bins count the new seconds only.
+    const auto later_history = controller.get_history(START_TIME + 62.9);
+
+    for (const float count : later_history) {
+        EXPECT_EQ(count, 0.0f);
+    }
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "core/backend/audio_stretcher.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+/**
+ * @brief Common rates, the values around the atempo limits, and chains of three factors.
+ */
+const std::vector<double> TEST_TEMPOS = { 0.25, 0.3, 0.5, 0.75, 1.0, 1.5, 2.0, 2.5, 3.0,
+    4.0, 0.49, 2.01, 0.1, 6.0, 8.0 };
+} // namespace
+
+TEST(AudioStretcherTest, TempoInRangeIsASingleFactor)
+{
+    EXPECT_EQ(AudioStretcher::split_tempo(1.5), std::vector<double>{ 1.5 });
+    EXPECT_EQ(AudioStretcher::split_tempo(0.75), std::vector<double>{ 0.75 });
+
+    // The limits themselves are accepted.
+    EXPECT_EQ(AudioStretcher::split_tempo(MAX_ATEMPO_FACTOR),
+        std::vector<double>{ MAX_ATEMPO_FACTOR });
+    EXPECT_EQ(AudioStretcher::split_tempo(MIN_ATEMPO_FACTOR),
+        std::vector<double>{ MIN_ATEMPO_FACTOR });
+}
+
+TEST(AudioStretcherTest, UnitTempoKeepsOneFactor)
+{
+    // The graph always has an atempo, even when it changes nothing.
+    EXPECT_EQ(AudioStretcher::split_tempo(1.0), std::vector<double>{ 1.0 });
+}
+
+TEST(AudioStretcherTest, LargeChangesAreChained)
+{
+    EXPECT_EQ(AudioStretcher::split_tempo(4.0), (std::vector<double>{ 2.0, 2.0 }));
+    EXPECT_EQ(AudioStretcher::split_tempo(0.25), (std::vector<double>{ 0.5, 0.5 }));
+
+    const std::vector<double> factors = AudioStretcher::split_tempo(3.0);
+
+    ASSERT_EQ(factors.size(), 2u);
+    EXPECT_DOUBLE_EQ(factors[0], 2.0);
+    EXPECT_DOUBLE_EQ(factors[1], 1.5);
+
+    // The remainder of a slow tempo is above the lower limit.
+    const std::vector<double> slow_factors = AudioStretcher::split_tempo(0.3);
+
+    ASSERT_EQ(slow_factors.size(), 2u);
+    EXPECT_DOUBLE_EQ(slow_factors[0], 0.5);
+    EXPECT_DOUBLE_EQ(slow_factors[1], 0.6);
+}
+
+TEST(AudioStretcherTest, FactorsStayInRangeAndMultiplyToTheTempo)
+{
+    for (const double tempo : TEST_TEMPOS) {
+        SCOPED_TRACE("Tempo " + std::to_string(tempo));
+
+        const std::vector<double> factors = AudioStretcher::split_tempo(tempo);
+        ASSERT_FALSE(factors.empty());
+
+        double product = 1.0;
+
+        for (const double factor : factors) {
+            EXPECT_GE(factor, MIN_ATEMPO_FACTOR);
+            EXPECT_LE(factor, MAX_ATEMPO_FACTOR);
+            product *= factor;
+        }
+
+        EXPECT_NEAR(product, tempo, 1e-9);
+    }
+}
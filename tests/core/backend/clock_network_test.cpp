@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "core/backend/clock_network.hpp"
+#include "core/backend/frame_pacer.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// A power of two, so the start of a buffer is exactly the end of the one before.
+constexpr double CALLBACK_PERIOD = 1.0 / 512.0;
+constexpr int CALLBACKS_NB = 400;
+
+constexpr auto SHORT_SLEEP = std::chrono::milliseconds(20);
+
+// The scheduler of a busy test machine may oversleep, the upper bounds leave room for it.
+constexpr double TIMING_TOLERANCE = 50e-3;
+
+[[nodiscard]] AudioBufferInfo make_buffer_info(int buffer_index)
+{
+    AudioBufferInfo buffer_info;
+    buffer_info.buffer_index = buffer_index;
+    return buffer_info;
+}
+} // namespace
+
+TEST(ClockNetworkTest, ReferenceClockStartsAtTheBufferStart)
+{
+    ClockNetwork clocks;
+    clocks.reset(10.0);
+
+    clocks.update_audio_clock(10.5, 0.5, make_buffer_info(0));
+
+    EXPECT_DOUBLE_EQ(clocks.get_audio_clock(), 10.5);
+    EXPECT_GE(clocks.get_reference_clock(), 10.0);
+    EXPECT_LT(clocks.get_reference_clock(), 10.0 + TIMING_TOLERANCE);
+}
+
+TEST(ClockNetworkTest, ReferenceClockNeverRunsPastTheBufferedAudio)
+{
+    ClockNetwork clocks;
+    clocks.reset(0.0);
+
+    // The device starves, no callback comes after this short buffer.
+    clocks.update_audio_clock(0.005, 0.005, make_buffer_info(0));
+    std::this_thread::sleep_for(SHORT_SLEEP);
+
+    EXPECT_DOUBLE_EQ(clocks.get_reference_clock(), 0.005);
+}
+
+TEST(ClockNetworkTest, ExtrapolationFollowsThePlaybackRate)
+{
+    ClockNetwork clocks;
+    clocks.reset(0.0);
+
+    const double start_time = FramePacer::now();
+    clocks.update_audio_clock(1.0, 1.0, make_buffer_info(0), 2.0);
+
+    std::this_thread::sleep_for(SHORT_SLEEP);
+
+    const double reference_clock = clocks.get_reference_clock();
+    const double elapsed_time = FramePacer::now() - start_time;
+
+    const double min_elapsed = std::chrono::duration<double>(SHORT_SLEEP).count();
+
+    EXPECT_GE(reference_clock, 2.0 * min_elapsed);
+    EXPECT_LE(reference_clock, 2.0 * elapsed_time);
+}
+
+TEST(ClockNetworkTest, PauseFreezesTheReferenceClock)
+{
+    ClockNetwork clocks;
+    clocks.reset(0.0);
+
+    clocks.update_audio_clock(1.0, 1.0, make_buffer_info(0));
+    std::this_thread::sleep_for(SHORT_SLEEP);
+
+    clocks.set_audio_paused(true);
+    const double paused_clock = clocks.get_reference_clock();
+
+    std::this_thread::sleep_for(SHORT_SLEEP);
+    EXPECT_DOUBLE_EQ(clocks.get_reference_clock(), paused_clock);
+
+    // The device resumes with the rest of the buffer, from where it was paused.
+    clocks.set_audio_paused(false);
+
+    const double resumed_clock = clocks.get_reference_clock();
+    EXPECT_GE(resumed_clock, paused_clock);
+    EXPECT_LT(resumed_clock, paused_clock + TIMING_TOLERANCE);
+
+    EXPECT_GE(clocks.take_paused_time(), std::chrono::duration<double>(SHORT_SLEEP).count());
+    EXPECT_DOUBLE_EQ(clocks.take_paused_time(), 0.0);
+}
+
+TEST(ClockNetworkTest, ConcurrentReadersSeeConsistentMonotonicClocks)
+{
+    ClockNetwork clocks;
+    clocks.reset(0.0);
+
+    std::atomic<bool> is_stopped = false;
+
+    // Hands contiguous buffers over at the rate of a device, like the audio callback.
+    std::thread callback([&clocks, &is_stopped] {
+        for (int i = 1; i <= CALLBACKS_NB; ++i) {
+            clocks.update_audio_clock(i * CALLBACK_PERIOD, CALLBACK_PERIOD, make_buffer_info(i));
+            std::this_thread::sleep_for(std::chrono::duration<double>(CALLBACK_PERIOD));
+        }
+
+        is_stopped = true;
+    });
+
+    double last_reference_clock = 0.0;
+    std::uint64_t torn_nb = 0;
+    std::uint64_t backward_nb = 0;
+    std::uint64_t reads_nb = 0;
+
+    // Only count, a failed assertion per read would flood the output.
+    while (!is_stopped) {
+        const AudioClockSnapshot snapshot = clocks.get_audio_snapshot();
+        torn_nb += snapshot.pts != snapshot.buffer_info.buffer_index * CALLBACK_PERIOD ? 1 : 0;
+
+        const double reference_clock = clocks.get_reference_clock();
+        backward_nb += reference_clock < last_reference_clock ? 1 : 0;
+        last_reference_clock = reference_clock;
+
+        reads_nb++;
+    }
+
+    callback.join();
+
+    EXPECT_GT(reads_nb, 0u);
+    EXPECT_EQ(torn_nb, 0u);
+    EXPECT_EQ(backward_nb, 0u);
+    EXPECT_DOUBLE_EQ(clocks.get_audio_clock(), CALLBACKS_NB * CALLBACK_PERIOD);
+}
@@ -0,0 +1,355 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/backend/color_conversion.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// Sizes around the 16 and 32 pixel blocks, so every kernel runs its tail. The kernels only
+// take even sizes, like swscale's full chroma path they reproduce.
+constexpr std::array<std::pair<int, int>, 10> TEST_SIZES = { { { 2, 2 }, { 4, 6 }, { 14, 4 },
+    { 16, 2 }, { 18, 10 }, { 30, 4 }, { 34, 8 }, { 64, 4 }, { 66, 12 }, { 126, 30 } } };
+
+// Bytes after each row of the destination that no kernel may write.
+constexpr int DEST_PADDING = 16;
+constexpr std::uint8_t DEST_SENTINEL = 0xCD;
+
+// The fixed-point kernels stay within 1 LSB of the same matrix in floating point.
+constexpr int FLOAT_TOLERANCE = 1;
+
+struct TestFormat {
+    AVPixelFormat pix_fmt = AV_PIX_FMT_NONE;
+    AVColorSpace colorspace = AVCOL_SPC_UNSPECIFIED;
+    AVColorRange color_range = AVCOL_RANGE_UNSPECIFIED;
+    const char* name = "";
+};
+
+const std::array<TestFormat, 6> TEST_FORMATS = { {
+    { AV_PIX_FMT_YUV420P, AVCOL_SPC_UNSPECIFIED, AVCOL_RANGE_MPEG, "YUV420P_BT601" },
+    { AV_PIX_FMT_YUV420P, AVCOL_SPC_BT709, AVCOL_RANGE_MPEG, "YUV420P_BT709" },
+    { AV_PIX_FMT_YUVJ420P, AVCOL_SPC_BT470BG, AVCOL_RANGE_JPEG, "YUVJ420P_BT601" },
+    { AV_PIX_FMT_NV12, AVCOL_SPC_BT709, AVCOL_RANGE_MPEG, "NV12_BT709" },
+    { AV_PIX_FMT_YUV422P, AVCOL_SPC_SMPTE170M, AVCOL_RANGE_MPEG, "YUV422P_BT601" },
+    { AV_PIX_FMT_YUVJ422P, AVCOL_SPC_BT709, AVCOL_RANGE_JPEG, "YUVJ422P_BT709" },
+} };
+
+struct FrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+[[nodiscard]] bool is_422(AVPixelFormat pix_fmt)
+{
+    return pix_fmt == AV_PIX_FMT_YUV422P || pix_fmt == AV_PIX_FMT_YUVJ422P;
+}
+
+/**
+ * @brief A frame of random samples, including the ones past the range of limited range.
+ */
+[[nodiscard]] FramePtr make_frame(const TestFormat& format, int width, int height)
+{
+    FramePtr av_frame(av_frame_alloc());
+
+    av_frame->format = format.pix_fmt;
+    av_frame->width = width;
+    av_frame->height = height;
+    av_frame->colorspace = format.colorspace;
+    av_frame->color_range = format.color_range;
+
+    if (av_frame_get_buffer(av_frame.get(), 0) < 0) {
+        return nullptr;
+    }
+
+    std::mt19937 generator(static_cast<unsigned int>(width * 1000 + height));
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    const int chroma_height = is_422(format.pix_fmt) ? height : (height + 1) / 2;
+    const int chroma_width = (width + 1) / 2;
+
+    const int planes_nb = format.pix_fmt == AV_PIX_FMT_NV12 ? 2 : 3;
+
+    for (int plane = 0; plane < planes_nb; ++plane) {
+        const int rows_nb = plane == 0 ? height : chroma_height;
+        int row_size = plane == 0 ? width : chroma_width;
+
+        if (plane == 1 && format.pix_fmt == AV_PIX_FMT_NV12) {
+            row_size = chroma_width * 2;
+        }
+
+        for (int row = 0; row < rows_nb; ++row) {
+            std::uint8_t* samples = av_frame->data[plane] + row * av_frame->linesize[plane];
+
+            for (int i = 0; i < row_size; ++i) {
+                samples[i] = static_cast<std::uint8_t>(distribution(generator));
+            }
+        }
+    }
+
+    return av_frame;
+}
+
+struct RGBAImage {
+    std::vector<std::uint8_t> pixels;
+    int linesize = 0;
+};
+
+[[nodiscard]] RGBAImage make_image(int width, int height)
+{
+    RGBAImage image;
+    image.linesize = width * 4 + DEST_PADDING;
+    image.pixels.assign(static_cast<std::size_t>(image.linesize) * height, DEST_SENTINEL);
+
+    return image;
+}
+
+/**
+ * @brief Converts a frame with a kernel in two slices, so a slice boundary that isn't on a
+ *        chroma row is covered too.
+ */
+[[nodiscard]] RGBAImage convert_with_kernel(const AVFrame* av_frame, ConversionKernel kernel)
+{
+    RGBAImage image = make_image(av_frame->width, av_frame->height);
+
+    ConversionJob job;
+
+    if (ColorConverter::prepare_job(av_frame, image.pixels.data(), image.linesize, &job) < 0) {
+        ADD_FAILURE() << "The frame isn't supported by the kernels";
+        return image;
+    }
+
+    const int split_row = job.height / 2 + (job.height > 2 ? 1 : 0);
+
+    kernel(job, 0, split_row);
+    kernel(job, split_row, job.height);
+
+    return image;
+}
+
+/**
+ * @brief The conversion in floating point, with the matrix the kernels are built from.
+ */
+[[nodiscard]] RGBAImage convert_with_float(const AVFrame* av_frame)
+{
+    RGBAImage image = make_image(av_frame->width, av_frame->height);
+
+    const auto pix_fmt = static_cast<AVPixelFormat>(av_frame->format);
+    const YUVMatrix matrix =
+        ColorConverter::get_matrix(av_frame->colorspace, ColorConverter::is_full_range(av_frame));
+
+    const int chroma_shift_y = is_422(pix_fmt) ? 0 : 1;
+    const bool is_semi_planar = pix_fmt == AV_PIX_FMT_NV12;
+
+    // Past 512 the 32-bit sum of the kernels wraps around to black, like swscale's does.
+    const auto to_byte = [](float value) {
+        const long rounded = std::lround(value);
+        return static_cast<std::uint8_t>(rounded >= 512 ? 0L : std::clamp(rounded, 0L, 255L));
+    };
+
+    for (int row = 0; row < av_frame->height; ++row) {
+        const std::uint8_t* y_row = av_frame->data[0] + row * av_frame->linesize[0];
+        const int chroma_row = row >> chroma_shift_y;
+
+        const std::uint8_t* u_row = av_frame->data[1] + chroma_row * av_frame->linesize[1];
+        const std::uint8_t* v_row = is_semi_planar
+            ? u_row + 1
+            : av_frame->data[2] + chroma_row * av_frame->linesize[2];
+
+        std::uint8_t* dest_row = image.pixels.data() + row * image.linesize;
+
+        for (int x = 0; x < av_frame->width; ++x) {
+            const int chroma_index = (x >> 1) * (is_semi_planar ? 2 : 1);
+
+            const float luma = (static_cast<float>(y_row[x]) - matrix.y_offset) * matrix.y_gain;
+            const float cb = static_cast<float>(u_row[chroma_index]) - 128.0f;
+            const float cr = static_cast<float>(v_row[chroma_index]) - 128.0f;
+
+            dest_row[x * 4] = to_byte(luma + matrix.rv * cr);
+            dest_row[x * 4 + 1] = to_byte(luma + matrix.gu * cb + matrix.gv * cr);
+            dest_row[x * 4 + 2] = to_byte(luma + matrix.bu * cb);
+            dest_row[x * 4 + 3] = 0xFF;
+        }
+    }
+
+    return image;
+}
+
+/**
+ * @brief The swscale configuration the kernels reproduce, see SAME_SIZE_SWS_FLAGS.
+ */
+[[nodiscard]] RGBAImage convert_with_swscale(const AVFrame* av_frame)
+{
+    RGBAImage image = make_image(av_frame->width, av_frame->height);
+
+    const auto pix_fmt = static_cast<AVPixelFormat>(av_frame->format);
+
+    SwsContext* sws_ctx = sws_getContext(av_frame->width, av_frame->height, pix_fmt,
+        av_frame->width, av_frame->height, AV_PIX_FMT_RGB0, SAME_SIZE_SWS_FLAGS, nullptr,
+        nullptr, nullptr);
+
+    if (!sws_ctx) {
+        ADD_FAILURE() << "Failed to create the swscale context";
+        return image;
+    }
+
+    ColorConverter::set_sws_colorspace(sws_ctx, av_frame);
+
+    std::array<std::uint8_t*, 4> dest = { image.pixels.data(), nullptr, nullptr, nullptr };
+    std::array<int, 4> dest_linesize = { image.linesize, 0, 0, 0 };
+
+    sws_scale(sws_ctx, av_frame->data, av_frame->linesize, 0, av_frame->height, dest.data(),
+        dest_linesize.data());
+
+    sws_freeContext(sws_ctx);
+
+    return image;
+}
+
+/**
+ * @brief Compares the pixels of two images and checks that the padding after each row of
+ *        the first one was left alone.
+ */
+void expect_images_near(
+    const RGBAImage& image, const RGBAImage& expected, int width, int height, int tolerance)
+{
+    int mismatches_nb = 0;
+
+    for (int row = 0; row < height && mismatches_nb < 8; ++row) {
+        const std::uint8_t* pixels = image.pixels.data() + row * image.linesize;
+        const std::uint8_t* expected_pixels = expected.pixels.data() + row * expected.linesize;
+
+        for (int i = 0; i < width * 4 && mismatches_nb < 8; ++i) {
+            if (std::abs(pixels[i] - expected_pixels[i]) > tolerance) {
+                ADD_FAILURE() << "Pixel (" << i / 4 << ", " << row << ") channel " << i % 4
+                              << ": " << static_cast<int>(pixels[i]) << " instead of "
+                              << static_cast<int>(expected_pixels[i]);
+                mismatches_nb++;
+            }
+        }
+
+        for (int i = width * 4; i < image.linesize; ++i) {
+            if (pixels[i] != DEST_SENTINEL) {
+                ADD_FAILURE() << "Row " << row << " was written past its last pixel";
+                mismatches_nb++;
+                break;
+            }
+        }
+    }
+}
+
+struct KernelInfo {
+    ConversionISA isa = ConversionISA::SCALAR;
+    ConversionKernel kernel = nullptr;
+};
+
+/**
+ * @brief The kernels this CPU can run, the scalar one first.
+ */
+[[nodiscard]] std::vector<KernelInfo> get_supported_kernels()
+{
+    std::vector<KernelInfo> kernels = { { ConversionISA::SCALAR,
+        &ColorKernels::convert_rows_scalar } };
+
+#ifdef YAVE_ARCH_X86
+    ColorConverter::set_max_isa(ConversionISA::AVX2);
+    const ConversionISA detected_isa = ColorConverter::get_active_isa();
+
+    if (detected_isa >= ConversionISA::SSE41) {
+        kernels.push_back({ ConversionISA::SSE41, &ColorKernels::convert_rows_sse41 });
+    }
+
+    if (detected_isa >= ConversionISA::AVX2) {
+        kernels.push_back({ ConversionISA::AVX2, &ColorKernels::convert_rows_avx2 });
+    }
+#endif
+
+    return kernels;
+}
+
+class ColorConversionTest : public testing::TestWithParam<TestFormat>
+{
+};
+} // namespace
+
+TEST_P(ColorConversionTest, KernelsMatchScalar)
+{
+    const std::vector<KernelInfo> kernels = get_supported_kernels();
+
+    for (const auto& [width, height] : TEST_SIZES) {
+        const FramePtr av_frame = make_frame(GetParam(), width, height);
+        ASSERT_NE(av_frame, nullptr);
+
+        const RGBAImage scalar = convert_with_kernel(av_frame.get(), kernels.front().kernel);
+
+        for (const KernelInfo& kernel : kernels) {
+            SCOPED_TRACE(std::string(ColorConverter::isa_to_string(kernel.isa)) + " " +
+                std::to_string(width) + "x" + std::to_string(height));
+
+            // Every kernel does the same fixed-point math, the output is identical.
+            expect_images_near(convert_with_kernel(av_frame.get(), kernel.kernel), scalar, width,
+                height, 0);
+        }
+    }
+}
+
+TEST_P(ColorConversionTest, ScalarMatchesFloat)
+{
+    for (const auto& [width, height] : TEST_SIZES) {
+        SCOPED_TRACE(std::to_string(width) + "x" + std::to_string(height));
+
+        const FramePtr av_frame = make_frame(GetParam(), width, height);
+        ASSERT_NE(av_frame, nullptr);
+
+        expect_images_near(convert_with_kernel(av_frame.get(), &ColorKernels::convert_rows_scalar),
+            convert_with_float(av_frame.get()), width, height, FLOAT_TOLERANCE);
+    }
+}
+
+TEST_P(ColorConversionTest, ScalarMatchesSwscale)
+{
+    for (const auto& [width, height] : TEST_SIZES) {
+        SCOPED_TRACE(std::to_string(width) + "x" + std::to_string(height));
+
+        const FramePtr av_frame = make_frame(GetParam(), width, height);
+        ASSERT_NE(av_frame, nullptr);
+
+        expect_images_near(convert_with_kernel(av_frame.get(), &ColorKernels::convert_rows_scalar),
+            convert_with_swscale(av_frame.get()), width, height, 0);
+    }
+}
+
+TEST_P(ColorConversionTest, OddSizesAreLeftToSwscale)
+{
+    for (const auto& [width, height] : { std::pair{ 3, 4 }, std::pair{ 4, 3 } }) {
+        SCOPED_TRACE(std::to_string(width) + "x" + std::to_string(height));
+
+        const FramePtr av_frame = make_frame(GetParam(), width, height);
+        ASSERT_NE(av_frame, nullptr);
+
+        RGBAImage image = make_image(width, height);
+
+        EXPECT_FALSE(ColorConverter::is_supported(av_frame.get()));
+        EXPECT_LT(ColorConverter::convert(av_frame.get(), image.pixels.data(), image.linesize), 0);
+    }
+}
+
+TEST(ColorConverterTest, DispatchFollowsMaxISA)
+{
+    ColorConverter::set_max_isa(ConversionISA::SCALAR);
+    EXPECT_EQ(ColorConverter::get_kernel(), &ColorKernels::convert_rows_scalar);
+
+    ColorConverter::set_max_isa(ConversionISA::AVX2);
+    EXPECT_EQ(ColorConverter::get_kernel(), get_supported_kernels().back().kernel);
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, ColorConversionTest, testing::ValuesIn(TEST_FORMATS),
+    [](const testing::TestParamInfo<TestFormat>& info) { return info.param.name; });
@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "core/backend/frame_cache.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+const std::string TEST_PATH = "test.mp4";
+const std::string OTHER_PATH = "other.mkv";
+
+// 25 fps in a timebase of 1/12800.
+constexpr std::int64_t FRAME_DURATION = 512;
+
+constexpr int FRAME_WIDTH = 64;
+constexpr int FRAME_HEIGHT = 36;
+
+struct FrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+[[nodiscard]] std::int64_t timestamp_of(int frame_number)
+{
+    return frame_number * FRAME_DURATION;
+}
+
+/**
+ * @brief A small decoded frame, its first luma sample tells which frame it is.
+ */
+[[nodiscard]] FramePtr make_frame(
+    int frame_number, int width = FRAME_WIDTH, int height = FRAME_HEIGHT)
+{
+    FramePtr av_frame(av_frame_alloc());
+
+    av_frame->format = AV_PIX_FMT_YUV420P;
+    av_frame->width = width;
+    av_frame->height = height;
+
+    if (av_frame_get_buffer(av_frame.get(), 0) < 0) {
+        return nullptr;
+    }
+
+    av_frame->data[0][0] = static_cast<std::uint8_t>(frame_number);
+
+    return av_frame;
+}
+
+/**
+ * @brief Caches the frames like a decode does, each one knows the frame before it.
+ */
+void insert_decoded(const std::string& path, int first_frame, int frames_nb)
+{
+    for (int i = first_frame; i < first_frame + frames_nb; ++i) {
+        const FramePtr av_frame = make_frame(i);
+        ASSERT_NE(av_frame, nullptr);
+
+        const std::int64_t previous_timestamp =
+            i > first_frame ? timestamp_of(i - 1) : UNKNOWN_PREVIOUS_TIMESTAMP;
+
+        FrameCache::insert(path, av_frame.get(), timestamp_of(i), previous_timestamp);
+    }
+}
+
+[[nodiscard]] bool is_cached(const std::string& path, int frame_number)
+{
+    FramePtr av_frame(av_frame_alloc());
+    std::int64_t timestamp = 0;
+
+    const int response =
+        FrameCache::find_from(path, timestamp_of(frame_number), av_frame.get(), &timestamp);
+
+    return response >= 0 && timestamp == timestamp_of(frame_number);
+}
+
+[[nodiscard]] std::size_t frame_bytes()
+{
+    const FramePtr av_frame = make_frame(0);
+    return FrameCache::calculate_frame_bytes(av_frame.get());
+}
+
+/**
+ * @brief The cache is shared by the whole process, every test starts from an empty one.
+ */
+class FrameCacheTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        FrameCache::set_budget(DEFAULT_FRAME_CACHE_BUDGET_MIB * 1024 * 1024);
+        FrameCache::clear();
+    }
+
+    void TearDown() override
+    {
+        FrameCache::set_budget(DEFAULT_FRAME_CACHE_BUDGET_MIB * 1024 * 1024);
+        FrameCache::clear();
+    }
+};
+} // namespace
+
+TEST_F(FrameCacheTest, FindFromHandsOutAReferenceToTheFrame)
+{
+    insert_decoded(TEST_PATH, 0, 3);
+
+    const FramePtr source = make_frame(7);
+    FrameCache::insert(TEST_PATH, source.get(), timestamp_of(7));
+
+    FramePtr av_frame(av_frame_alloc());
+    std::int64_t timestamp = 0;
+
+    ASSERT_GE(FrameCache::find_from(TEST_PATH, timestamp_of(1), av_frame.get(), &timestamp), 0);
+    EXPECT_EQ(timestamp, timestamp_of(1));
+    EXPECT_EQ(av_frame->data[0][0], 1);
+
+    // The cache shares the decoder's buffer instead of copying it.
+    ASSERT_GE(FrameCache::find_from(TEST_PATH, timestamp_of(7), av_frame.get(), &timestamp), 0);
+    EXPECT_EQ(av_frame->data[0], source->data[0]);
+
+    EXPECT_LT(FrameCache::find_from(OTHER_PATH, timestamp_of(1), av_frame.get(), &timestamp), 0);
+}
+
+TEST_F(FrameCacheTest, FindFromBetweenFramesNeedsTheFrameBefore)
+{
+    insert_decoded(TEST_PATH, 0, 2);
+
+    FramePtr av_frame(av_frame_alloc());
+    std::int64_t timestamp = 0;
+
+    // Frame 1 was decoded right after frame 0, nothing can sit between them.
+    ASSERT_GE(FrameCache::find_from(TEST_PATH, 1, av_frame.get(), &timestamp), 0);
+    EXPECT_EQ(timestamp, timestamp_of(1));
+
+    // Frame 4 doesn't know what came before it, frames 2 and 3 may exist.
+    const FramePtr unknown_frame = make_frame(4);
+    FrameCache::insert(TEST_PATH, unknown_frame.get(), timestamp_of(4));
+
+    EXPECT_LT(FrameCache::find_from(TEST_PATH, timestamp_of(2), av_frame.get(), &timestamp), 0);
+
+    // Past the last cached frame.
+    EXPECT_LT(FrameCache::find_from(TEST_PATH, timestamp_of(5), av_frame.get(), &timestamp), 0);
+}
+
+TEST_F(FrameCacheTest, FindBeforeFollowsThePreviousTimestamp)
+{
+    insert_decoded(TEST_PATH, 10, 3);
+
+    FramePtr av_frame(av_frame_alloc());
+    std::int64_t timestamp = 0;
+
+    ASSERT_GE(FrameCache::find_before(TEST_PATH, timestamp_of(12), av_frame.get(), &timestamp), 0);
+    EXPECT_EQ(timestamp, timestamp_of(11));
+    EXPECT_EQ(av_frame->data[0][0], 11);
+
+    // Between two frames, the frame before is the one on screen.
+    ASSERT_GE(
+        FrameCache::find_before(TEST_PATH, timestamp_of(12) - 1, av_frame.get(), &timestamp), 0);
+    EXPECT_EQ(timestamp, timestamp_of(11));
+
+    // The first decoded frame doesn't know what came before it.
+    EXPECT_LT(FrameCache::find_before(TEST_PATH, timestamp_of(10), av_frame.get(), &timestamp), 0);
+}
+
+TEST_F(FrameCacheTest, FindBeforeMissesAnEvictedPreviousFrame)
+{
+    const std::size_t bytes = frame_bytes();
+    FrameCache::set_budget(2 * bytes);
+
+    insert_decoded(TEST_PATH, 0, 3);
+
+    FramePtr av_frame(av_frame_alloc());
+    std::int64_t timestamp = 0;
+
+    // Frame 1 is still cached, frame 0 was evicted.
+    ASSERT_GE(FrameCache::find_before(TEST_PATH, timestamp_of(2), av_frame.get(), &timestamp), 0);
+    EXPECT_EQ(timestamp, timestamp_of(1));
+
+    EXPECT_LT(FrameCache::find_before(TEST_PATH, timestamp_of(1), av_frame.get(), &timestamp), 0);
+}
+
+TEST_F(FrameCacheTest, InsertingAgainLearnsThePreviousTimestamp)
+{
+    insert_decoded(TEST_PATH, 0, 1);
+
+    // A seek decoded frame 1 first, it didn't know frame 0.
+    const FramePtr av_frame = make_frame(1);
+    FrameCache::insert(TEST_PATH, av_frame.get(), timestamp_of(1));
+
+    FramePtr dest_frame(av_frame_alloc());
+    std::int64_t timestamp = 0;
+
+    EXPECT_LT(FrameCache::find_before(TEST_PATH, timestamp_of(1), dest_frame.get(), &timestamp), 0);
+
+    // The decode from the keyframe did.
+    FrameCache::insert(TEST_PATH, av_frame.get(), timestamp_of(1), timestamp_of(0));
+
+    ASSERT_GE(FrameCache::find_before(TEST_PATH, timestamp_of(1), dest_frame.get(), &timestamp), 0);
+    EXPECT_EQ(timestamp, timestamp_of(0));
+
+    // An unknown timestamp doesn't forget what was learned.
+    FrameCache::insert(TEST_PATH, av_frame.get(), timestamp_of(1));
+    EXPECT_GE(FrameCache::find_before(TEST_PATH, timestamp_of(1), dest_frame.get(), &timestamp), 0);
+
+    EXPECT_EQ(FrameCache::get_stats().frames_nb, 2u);
+}
+
+TEST_F(FrameCacheTest, EvictsTheLeastRecentlyUsedFrame)
+{
+    const std::size_t bytes = frame_bytes();
+    ASSERT_GT(bytes, 0u);
+
+    FrameCache::set_budget(3 * bytes);
+    insert_decoded(TEST_PATH, 0, 3);
+
+    // Frame 0 was shown again, frame 1 is now the oldest.
+    ASSERT_TRUE(is_cached(TEST_PATH, 0));
+
+    insert_decoded(TEST_PATH, 3, 1);
+
+    EXPECT_FALSE(is_cached(TEST_PATH, 1));
+    EXPECT_TRUE(is_cached(TEST_PATH, 0));
+    EXPECT_TRUE(is_cached(TEST_PATH, 2));
+    EXPECT_TRUE(is_cached(TEST_PATH, 3));
+
+    // The frames of every file share the budget.
+    insert_decoded(OTHER_PATH, 0, 1);
+
+    EXPECT_FALSE(is_cached(TEST_PATH, 0));
+    EXPECT_TRUE(is_cached(OTHER_PATH, 0));
+}
+
+TEST_F(FrameCacheTest, StatsAccountForEveryFrame)
+{
+    const std::size_t bytes = frame_bytes();
+    FrameCache::set_budget(10 * bytes);
+
+    const FrameCacheStats empty_stats = FrameCache::get_stats();
+    EXPECT_EQ(empty_stats.frames_nb, 0u);
+    EXPECT_EQ(empty_stats.bytes_used, 0u);
+    EXPECT_EQ(empty_stats.budget_bytes, 10 * bytes);
+
+    insert_decoded(TEST_PATH, 0, 6);
+    insert_decoded(OTHER_PATH, 0, 2);
+
+    FrameCacheStats stats = FrameCache::get_stats();
+    EXPECT_EQ(stats.frames_nb, 8u);
+    EXPECT_EQ(stats.bytes_used, 8 * bytes);
+
+    ASSERT_TRUE(is_cached(TEST_PATH, 5));
+    ASSERT_FALSE(is_cached(TEST_PATH, 6));
+
+    stats = FrameCache::get_stats();
+    EXPECT_EQ(stats.hits_nb - empty_stats.hits_nb, 1u);
+    EXPECT_EQ(stats.misses_nb - empty_stats.misses_nb, 1u);
+
+    // A smaller budget frees the frames above it right away.
+    FrameCache::set_budget(5 * bytes);
+
+    stats = FrameCache::get_stats();
+    EXPECT_EQ(stats.frames_nb, 5u);
+    EXPECT_EQ(stats.bytes_used, 5 * bytes);
+    EXPECT_TRUE(is_cached(TEST_PATH, 5));
+
+    FrameCache::clear();
+
+    stats = FrameCache::get_stats();
+    EXPECT_EQ(stats.frames_nb, 0u);
+    EXPECT_EQ(stats.bytes_used, 0u);
+}
+
+TEST_F(FrameCacheTest, FrameLargerThanTheBudgetIsNotKept)
+{
+    const std::size_t bytes = frame_bytes();
+    FrameCache::set_budget(4 * bytes);
+
+    insert_decoded(TEST_PATH, 0, 2);
+
+    // A file of a much larger size, caching it would only flush the other frames.
+    const FramePtr large_frame = make_frame(0, 4 * FRAME_WIDTH, 4 * FRAME_HEIGHT);
+    ASSERT_GT(FrameCache::calculate_frame_bytes(large_frame.get()), 4 * bytes);
+
+    FrameCache::insert(OTHER_PATH, large_frame.get(), timestamp_of(0));
+
+    const FrameCacheStats stats = FrameCache::get_stats();
+    EXPECT_EQ(stats.frames_nb, 2u);
+    EXPECT_EQ(stats.bytes_used, 2 * bytes);
+
+    EXPECT_FALSE(is_cached(OTHER_PATH, 0));
+    EXPECT_TRUE(is_cached(TEST_PATH, 0));
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "core/backend/keyframe_index.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// A GOP of 250 frames at a timebase of 1/12800, 512 ticks per frame at 25 fps.
+constexpr std::int64_t FRAME_DURATION = 512;
+constexpr std::int64_t GOP_SIZE = 250;
+constexpr std::int64_t GOP_DURATION = GOP_SIZE * FRAME_DURATION;
+constexpr int GOPS_NB = 4;
+
+// Edit lists often shift the first keyframe past 0, B-frames push it by a frame or two.
+constexpr std::int64_t FIRST_PTS = 2 * FRAME_DURATION;
+
+/**
+ * @brief Builds the index a scan of a file with evenly spaced keyframes would give.
+ */
+[[nodiscard]] KeyframeIndex make_index()
+{
+    std::vector<KeyframeEntry> entries;
+
+    for (int i = 0; i < GOPS_NB; ++i) {
+        const std::int64_t pts = FIRST_PTS + i * GOP_DURATION;
+        entries.push_back({ pts, pts - FRAME_DURATION, 4096 + i * 100000, i * GOP_SIZE });
+    }
+
+    return KeyframeIndex(std::move(entries), GOPS_NB * GOP_SIZE);
+}
+} // namespace
+
+TEST(KeyframeIndexTest, EmptyIndexFindsNothing)
+{
+    const KeyframeIndex index;
+
+    EXPECT_EQ(index.find(0), nullptr);
+    EXPECT_EQ(index.find(FIRST_PTS), nullptr);
+}
+
+TEST(KeyframeIndexTest, ExactTimestampFindsItsKeyframe)
+{
+    const KeyframeIndex index = make_index();
+
+    for (int i = 0; i < GOPS_NB; ++i) {
+        const KeyframeEntry* keyframe = index.find(FIRST_PTS + i * GOP_DURATION);
+
+        ASSERT_NE(keyframe, nullptr);
+        EXPECT_EQ(keyframe->frame_number, i * GOP_SIZE);
+    }
+}
+
+TEST(KeyframeIndexTest, TimestampInsideAGopFindsTheKeyframeBefore)
+{
+    const KeyframeIndex index = make_index();
+
+    const KeyframeEntry* keyframe = index.find(FIRST_PTS + GOP_DURATION + 1);
+    ASSERT_NE(keyframe, nullptr);
+    EXPECT_EQ(keyframe->pts, FIRST_PTS + GOP_DURATION);
+
+    // The last frame of a GOP still needs the keyframe that starts it.
+    keyframe = index.find(FIRST_PTS + 2 * GOP_DURATION - FRAME_DURATION);
+    ASSERT_NE(keyframe, nullptr);
+    EXPECT_EQ(keyframe->pts, FIRST_PTS + GOP_DURATION);
+    EXPECT_EQ(keyframe->position, 4096 + 100000);
+}
+
+TEST(KeyframeIndexTest, TimestampBeforeTheFirstKeyframeFindsTheFirst)
+{
+    const KeyframeIndex index = make_index();
+
+    // The frames a seek to 0 asks for come before the first keyframe of the stream.
+    for (const std::int64_t timestamp : { std::int64_t{ 0 }, FIRST_PTS - 1, -GOP_DURATION }) {
+        const KeyframeEntry* keyframe = index.find(timestamp);
+
+        ASSERT_NE(keyframe, nullptr) << "Timestamp " << timestamp;
+        EXPECT_EQ(keyframe, &index.get_entries().front()) << "Timestamp " << timestamp;
+    }
+}
+
+TEST(KeyframeIndexTest, TimestampPastTheEndFindsTheLast)
+{
+    const KeyframeIndex index = make_index();
+
+    const KeyframeEntry* keyframe = index.find(FIRST_PTS + GOPS_NB * GOP_DURATION * 2);
+
+    ASSERT_NE(keyframe, nullptr);
+    EXPECT_EQ(keyframe, &index.get_entries().back());
+    EXPECT_EQ(index.get_frames_nb(), GOPS_NB * GOP_SIZE);
+}
+
+TEST(KeyframeIndexTest, IndexWithoutAStreamRefusesToSeek)
+{
+    const KeyframeIndex index = make_index();
+
+    // Only a scan knows which stream the keyframes belong to.
+    EXPECT_LT(index.seek(nullptr, 0, FIRST_PTS), 0);
+}
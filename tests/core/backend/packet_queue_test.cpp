@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "core/backend/packet_queue.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// The demuxer and a decoder, with a seek every few hundred packets.
+constexpr std::int64_t STRESS_PACKETS_NB = 100000;
+constexpr std::int64_t PACKETS_PER_SEEK = 997;
+
+constexpr int LONG_WAIT_MS = 5000;
+constexpr auto WAKEUP_DEADLINE = std::chrono::milliseconds(1000);
+
+using Clock = std::chrono::steady_clock;
+
+struct PacketDeleter {
+    void operator()(AVPacket* av_packet) const { av_packet_free(&av_packet); }
+};
+
+using PacketPtr = std::unique_ptr<AVPacket, PacketDeleter>;
+
+// The packet carries its index in pts and the number of seeks before it in dts.
+[[nodiscard]] std::int64_t get_seeks_nb(std::int64_t index)
+{
+    return index / PACKETS_PER_SEEK;
+}
+} // namespace
+
+TEST(PacketQueueTest, ClearDropsQueuedPacketsAndBumpsSerial)
+{
+    PacketQueue queue(4);
+    const PacketPtr av_packet(av_packet_alloc());
+
+    const unsigned int serial = queue.getSerial();
+
+    av_packet->pts = 1;
+    ASSERT_EQ(queue.try_enqueue(av_packet.get(), serial), 0);
+
+    queue.clear();
+
+    EXPECT_EQ(queue.getSerial(), serial + 1);
+
+    av_packet->pts = 2;
+    ASSERT_EQ(queue.try_enqueue(av_packet.get(), queue.getSerial()), 0);
+
+    const PacketPtr dest_packet(av_packet_alloc());
+
+    ASSERT_EQ(queue.try_dequeue(dest_packet.get()), 0);
+    EXPECT_EQ(dest_packet->pts, 2);
+
+    EXPECT_EQ(queue.try_dequeue(dest_packet.get()), AVERROR(EAGAIN));
+}
+
+TEST(PacketQueueTest, PacketsReadBeforeAClearAreDropped)
+{
+    PacketQueue queue(4);
+    const PacketPtr av_packet(av_packet_alloc());
+
+    // The demuxer reads the serial, then a seek clears the queue before the packet is added.
+    const unsigned int serial = queue.getSerial();
+    queue.clear();
+
+    av_packet->pts = 1;
+    ASSERT_EQ(queue.try_enqueue(av_packet.get(), serial), 0);
+    EXPECT_TRUE(queue.isEmpty());
+
+    av_packet->pts = 2;
+    ASSERT_EQ(queue.try_enqueue(av_packet.get(), queue.getSerial()), 0);
+
+    const PacketPtr dest_packet(av_packet_alloc());
+
+    ASSERT_EQ(queue.try_dequeue(dest_packet.get()), 0);
+    EXPECT_EQ(dest_packet->pts, 2);
+}
+
+TEST(PacketQueueTest, DequeueWakesUpOnEnqueue)
+{
+    PacketQueue queue(4);
+
+    int response = -1;
+    Clock::duration waited{};
+
+    std::thread consumer([&] {
+        const PacketPtr dest_packet(av_packet_alloc());
+
+        const auto start = Clock::now();
+        response = queue.dequeue(dest_packet.get(), LONG_WAIT_MS);
+        waited = Clock::now() - start;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    const PacketPtr av_packet(av_packet_alloc());
+    ASSERT_EQ(queue.enqueue(av_packet.get(), queue.getSerial()), 0);
+
+    consumer.join();
+
+    EXPECT_EQ(response, 0);
+    EXPECT_LT(waited, WAKEUP_DEADLINE);
+}
+
+TEST(PacketQueueTest, WakeAllReleasesABlockedConsumer)
+{
+    PacketQueue queue(4);
+
+    std::atomic<bool> is_done = false;
+    int response = 0;
+
+    std::thread consumer([&] {
+        const PacketPtr dest_packet(av_packet_alloc());
+
+        response = queue.dequeue(dest_packet.get(), LONG_WAIT_MS);
+        is_done = true;
+    });
+
+    const auto start = Clock::now();
+
+    // The consumer may not sleep yet when the first wakeup goes out, like when stopping.
+    while (!is_done && Clock::now() - start < WAKEUP_DEADLINE) {
+        queue.wake_all();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    consumer.join();
+
+    EXPECT_EQ(response, AVERROR(EAGAIN));
+    EXPECT_LT(Clock::now() - start, WAKEUP_DEADLINE);
+}
+
+/**
+ * The demuxer seeks (clears the queue) in the middle of the stream while the decoder keeps
+ * dequeuing. Once the decoder sees a seek, it must never get a packet from before it, the
+ * packets come out in order and none of the packets after the last seek are lost.
+ */
+TEST(PacketQueueTest, ConcurrentSeeksNeverDeliverStalePackets)
+{
+    PacketQueue queue(MAX_PACKETS_NB);
+
+    std::atomic<std::int64_t> seeks_nb = 0;
+    std::atomic<bool> is_stopped = false;
+
+    std::thread demuxer([&] {
+        const PacketPtr av_packet(av_packet_alloc());
+
+        for (std::int64_t i = 0; i < STRESS_PACKETS_NB && !is_stopped; ++i) {
+            if (i > 0 && i % PACKETS_PER_SEEK == 0) {
+                queue.clear();
+                seeks_nb.store(get_seeks_nb(i), std::memory_order_release);
+            }
+
+            av_packet->pts = i;
+            av_packet->dts = get_seeks_nb(i);
+
+            const unsigned int serial = queue.getSerial();
+
+            while (queue.enqueue(av_packet.get(), serial) == AVERROR(EAGAIN) && !is_stopped) {
+            }
+        }
+    });
+
+    const PacketPtr dest_packet(av_packet_alloc());
+
+    std::int64_t last_index = -1;
+    std::int64_t stale_nb = 0;
+    std::int64_t out_of_order_nb = 0;
+    std::int64_t last_seek_packets_nb = 0;
+
+    const std::int64_t last_seeks_nb = get_seeks_nb(STRESS_PACKETS_NB - 1);
+    auto last_packet_time = Clock::now();
+
+    while (last_index < STRESS_PACKETS_NB - 1) {
+        // Read before the dequeue, like the decoder reads the serial.
+        const std::int64_t seen_seeks_nb = seeks_nb.load(std::memory_order_acquire);
+
+        const int response = queue.dequeue(dest_packet.get(), LONG_WAIT_MS);
+
+        // Also returned early when the packets that woke it up were all stale, the decoders
+        // just try again.
+        if (response == AVERROR(EAGAIN)) {
+            if (Clock::now() - last_packet_time > std::chrono::milliseconds(LONG_WAIT_MS)) {
+                ADD_FAILURE() << "No packet after " << last_index;
+                break;
+            }
+
+            continue;
+        }
+
+        last_packet_time = Clock::now();
+
+        ASSERT_EQ(response, 0);
+
+        stale_nb += dest_packet->dts < seen_seeks_nb ? 1 : 0;
+        out_of_order_nb += dest_packet->pts <= last_index ? 1 : 0;
+        last_seek_packets_nb += dest_packet->dts == last_seeks_nb ? 1 : 0;
+
+        last_index = dest_packet->pts;
+    }
+
+    is_stopped = true;
+    queue.wake_all();
+    demuxer.join();
+
+    EXPECT_EQ(stale_nb, 0);
+    EXPECT_EQ(out_of_order_nb, 0);
+
+    // Nothing clears the queue after the last seek, every packet of it has to arrive.
+    EXPECT_EQ(last_seek_packets_nb, STRESS_PACKETS_NB - last_seeks_nb * PACKETS_PER_SEEK);
+    EXPECT_EQ(queue.getSerial(), static_cast<unsigned int>(last_seeks_nb));
+}
+
+/**
+ * The seeks come from another thread, like seek_frame, so a clear can land between the
+ * moment the demuxer reads the serial and the moment its packet is published. The decoder
+ * must never get a packet that was read before a clear it has already seen.
+ */
+TEST(PacketQueueTest, ClearsFromAnotherThreadNeverDeliverStalePackets)
+{
+    PacketQueue queue(MAX_PACKETS_NB);
+
+    std::atomic<bool> is_stopped = false;
+
+    std::thread demuxer([&] {
+        const PacketPtr av_packet(av_packet_alloc());
+
+        for (std::int64_t i = 0; !is_stopped; ++i) {
+            const unsigned int serial = queue.getSerial();
+
+            // Demuxing takes a while, the window the seeks land in.
+            std::this_thread::yield();
+
+            av_packet->pts = i;
+            av_packet->dts = serial;
+
+            while (queue.enqueue(av_packet.get(), serial) == AVERROR(EAGAIN) && !is_stopped) {
+            }
+        }
+    });
+
+    std::thread seeker([&] {
+        while (!is_stopped) {
+            queue.clear();
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    const PacketPtr dest_packet(av_packet_alloc());
+
+    std::int64_t received_nb = 0;
+    std::int64_t stale_nb = 0;
+
+    const auto start = Clock::now();
+
+    while (received_nb < STRESS_PACKETS_NB && Clock::now() - start < WAKEUP_DEADLINE * 20) {
+        const unsigned int seen_serial = queue.getSerial();
+
+        if (queue.dequeue(dest_packet.get(), LONG_WAIT_MS) != 0) {
+            continue;
+        }
+
+        ++received_nb;
+        stale_nb += dest_packet->dts < seen_serial ? 1 : 0;
+    }
+
+    is_stopped = true;
+    queue.wake_all();
+    demuxer.join();
+    seeker.join();
+
+    EXPECT_GT(received_nb, 0);
+    EXPECT_EQ(stale_nb, 0);
+}
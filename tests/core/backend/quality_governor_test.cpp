@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "core/backend/drift_compensator.hpp"
+#include "core/backend/quality_governor.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// 25 fps, the frames are late by more than a frame on average from the first report on.
+constexpr double FRAME_DURATION = 0.04;
+constexpr double LATE_DIFF = -0.5;
+constexpr double FULL_QUEUE = 1.0;
+
+// A little past the cooldown between two steps down, the governor reads the real clock.
+constexpr auto STEP_DOWN_WAIT = std::chrono::milliseconds(1100);
+
+struct CodecContextDeleter {
+    void operator()(AVCodecContext* av_codec_ctx) const { avcodec_free_context(&av_codec_ctx); }
+};
+
+using CodecContextPtr = std::unique_ptr<AVCodecContext, CodecContextDeleter>;
+
+/**
+ * @brief Reports a run of late frames, as the presenter does while decode falls behind.
+ */
+void report_late_frames(QualityGovernor& governor, int frames_nb = 10)
+{
+    for (int i = 0; i < frames_nb; ++i) {
+        governor.record_lateness(LATE_DIFF, FRAME_DURATION, FULL_QUEUE);
+    }
+}
+
+/**
+ * @brief A governor whose decoder can or can't decode at a lower resolution.
+ */
+class QualityGovernorTest : public testing::Test
+{
+protected:
+    void SetUp() override { m_codec_ctx.reset(avcodec_alloc_context3(&m_codec)); }
+
+    void apply(int max_lowres)
+    {
+        m_codec.max_lowres = max_lowres;
+        m_codec_ctx->codec = &m_codec;
+
+        m_governor.apply(m_codec_ctx.get());
+    }
+
+    AVCodec m_codec{};
+    CodecContextPtr m_codec_ctx;
+    QualityGovernor m_governor;
+};
+} // namespace
+
+TEST_F(QualityGovernorTest, StartsAtTheFullQuality)
+{
+    apply(1);
+
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::FULL);
+    EXPECT_EQ(m_codec_ctx->skip_loop_filter, AVDISCARD_DEFAULT);
+    EXPECT_EQ(m_codec_ctx->skip_frame, AVDISCARD_DEFAULT);
+    EXPECT_EQ(m_governor.get_lowres(), 0);
+    EXPECT_FALSE(m_governor.is_preview_downscaled());
+}
+
+TEST_F(QualityGovernorTest, OnTimeFramesKeepTheFullQuality)
+{
+    for (int i = 0; i < 100; ++i) {
+        m_governor.record_lateness(FRAME_DURATION / 2.0, FRAME_DURATION, FULL_QUEUE);
+    }
+
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::FULL);
+    EXPECT_EQ(m_governor.get_average_lateness(), 0.0);
+}
+
+TEST_F(QualityGovernorTest, ResyncsAreNotLateness)
+{
+    // A seek or a new input, the clocks are far apart for a moment.
+    m_governor.record_lateness(-NOSYNC_THRESHOLD, FRAME_DURATION, FULL_QUEUE);
+    m_governor.record_lateness(-2.0 * NOSYNC_THRESHOLD, FRAME_DURATION, FULL_QUEUE);
+
+    // A stream without a known frame rate.
+    m_governor.record_lateness(LATE_DIFF, 0.0, FULL_QUEUE);
+
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::FULL);
+    EXPECT_EQ(m_governor.get_average_lateness(), 0.0);
+}
+
+TEST_F(QualityGovernorTest, LateFramesStepDownOnceThenWaitForTheCooldown)
+{
+    apply(1);
+    report_late_frames(m_governor);
+
+    EXPECT_GT(m_governor.get_average_lateness(), FRAME_DURATION);
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::SKIP_LOOP_FILTER);
+
+    apply(1);
+    EXPECT_EQ(m_codec_ctx->skip_loop_filter, AVDISCARD_ALL);
+    EXPECT_EQ(m_codec_ctx->skip_frame, AVDISCARD_DEFAULT);
+}
+
+TEST_F(QualityGovernorTest, DecoderWithoutLowresSkipsThatStep)
+{
+    // H.264 and HEVC decoders have no lowres support.
+    apply(0);
+    report_late_frames(m_governor);
+    ASSERT_EQ(m_governor.get_level(), DecodeQuality::SKIP_LOOP_FILTER);
+
+    std::this_thread::sleep_for(STEP_DOWN_WAIT);
+    report_late_frames(m_governor);
+    ASSERT_EQ(m_governor.get_level(), DecodeQuality::SKIP_NONREF_FRAMES);
+
+    apply(0);
+    EXPECT_EQ(m_codec_ctx->skip_loop_filter, AVDISCARD_ALL);
+    EXPECT_EQ(m_codec_ctx->skip_frame, AVDISCARD_NONREF);
+
+    std::this_thread::sleep_for(STEP_DOWN_WAIT);
+    report_late_frames(m_governor);
+
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::PREVIEW_DOWNSCALE);
+    EXPECT_TRUE(m_governor.is_preview_downscaled());
+    EXPECT_EQ(m_governor.get_lowres(), 0);
+}
+
+TEST_F(QualityGovernorTest, FastPlaybackSkipsNonReferenceFrames)
+{
+    m_governor.set_playback_rate(SKIP_NONREF_PLAYBACK_RATE);
+    apply(1);
+
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::FULL);
+    EXPECT_EQ(m_codec_ctx->skip_loop_filter, AVDISCARD_DEFAULT);
+    EXPECT_EQ(m_codec_ctx->skip_frame, AVDISCARD_NONREF);
+
+    m_governor.set_playback_rate(1.0);
+    apply(1);
+
+    EXPECT_EQ(m_codec_ctx->skip_frame, AVDISCARD_DEFAULT);
+}
+
+TEST_F(QualityGovernorTest, DisablingRestoresTheFullQuality)
+{
+    report_late_frames(m_governor);
+    ASSERT_EQ(m_governor.get_level(), DecodeQuality::SKIP_LOOP_FILTER);
+
+    m_governor.set_enabled(false);
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::FULL);
+
+    // The lateness is still measured for the Debugger, the level stays past the cooldown.
+    std::this_thread::sleep_for(STEP_DOWN_WAIT);
+    report_late_frames(m_governor);
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::FULL);
+    EXPECT_GT(m_governor.get_average_lateness(), FRAME_DURATION);
+}
+
+TEST_F(QualityGovernorTest, ResetForgetsTheLateness)
+{
+    report_late_frames(m_governor);
+    ASSERT_EQ(m_governor.get_level(), DecodeQuality::SKIP_LOOP_FILTER);
+
+    // A seek keeps the level, the next frame starts a new average.
+    m_governor.reset(false);
+    m_governor.record_lateness(0.0, FRAME_DURATION, FULL_QUEUE);
+
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::SKIP_LOOP_FILTER);
+    EXPECT_EQ(m_governor.get_average_lateness(), 0.0);
+
+    // A new input starts again at the full quality.
+    m_governor.reset(true);
+    EXPECT_EQ(m_governor.get_level(), DecodeQuality::FULL);
+}
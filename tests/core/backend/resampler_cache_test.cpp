@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "core/backend/resampler_cache.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48000;
+
+struct FrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+/**
+ * @brief The key of a planar float stream converted to the device format.
+ */
+[[nodiscard]] ResamplerKey make_key(std::uint64_t channel_layout, int in_sample_rate)
+{
+    ResamplerKey key;
+    key.in_channel_layout = channel_layout;
+    key.in_sample_format = AV_SAMPLE_FMT_FLTP;
+    key.in_sample_rate = in_sample_rate;
+    key.out_channel_layout = channel_layout;
+    key.out_sample_format = AV_SAMPLE_FMT_FLT;
+    key.out_sample_rate = SAMPLE_RATE;
+
+    return key;
+}
+} // namespace
+
+TEST(ResamplerKeyTest, FromFrameKeepsTheLayoutOfTheFrame)
+{
+    FramePtr av_frame(av_frame_alloc());
+    av_frame->format = AV_SAMPLE_FMT_S16P;
+    av_frame->channel_layout = AV_CH_LAYOUT_5POINT1;
+    av_frame->channels = 6;
+    av_frame->sample_rate = 44100;
+
+    const ResamplerKey key =
+        ResamplerKey::from_frame(av_frame.get(), AV_SAMPLE_FMT_FLT, SAMPLE_RATE, 1);
+
+    EXPECT_EQ(key.in_channel_layout, AV_CH_LAYOUT_5POINT1);
+    EXPECT_EQ(key.out_channel_layout, AV_CH_LAYOUT_5POINT1);
+    EXPECT_EQ(key.in_sample_format, AV_SAMPLE_FMT_S16P);
+    EXPECT_EQ(key.out_sample_format, AV_SAMPLE_FMT_FLT);
+    EXPECT_EQ(key.in_sample_rate, 44100);
+    EXPECT_EQ(key.out_sample_rate, SAMPLE_RATE);
+    EXPECT_EQ(key.flags, 1);
+}
+
+TEST(ResamplerKeyTest, FromFrameWithoutALayoutUsesTheDefaultOne)
+{
+    FramePtr av_frame(av_frame_alloc());
+    av_frame->format = AV_SAMPLE_FMT_FLTP;
+    av_frame->channels = 2;
+    av_frame->sample_rate = SAMPLE_RATE;
+
+    const ResamplerKey key =
+        ResamplerKey::from_frame(av_frame.get(), AV_SAMPLE_FMT_FLT, SAMPLE_RATE);
+
+    EXPECT_EQ(key.in_channel_layout, AV_CH_LAYOUT_STEREO);
+    EXPECT_EQ(key.out_channel_layout, AV_CH_LAYOUT_STEREO);
+}
+
+TEST(ResamplerCacheTest, SameKeyGetsTheSameResampler)
+{
+    ResamplerCache resamplers;
+
+    const ResamplerPtr resampler = resamplers.acquire(make_key(AV_CH_LAYOUT_STEREO, 44100));
+    ASSERT_NE(resampler, nullptr);
+
+    EXPECT_EQ(resamplers.acquire(make_key(AV_CH_LAYOUT_STEREO, 44100)), resampler);
+    EXPECT_EQ(resamplers.size(), 1u);
+}
+
+TEST(ResamplerCacheTest, ChangedFormatGetsANewResampler)
+{
+    ResamplerCache resamplers;
+
+    const ResamplerPtr stereo = resamplers.acquire(make_key(AV_CH_LAYOUT_STEREO, 44100));
+    const ResamplerPtr mono = resamplers.acquire(make_key(AV_CH_LAYOUT_MONO, 44100));
+    const ResamplerPtr other_rate = resamplers.acquire(make_key(AV_CH_LAYOUT_STEREO, 32000));
+
+    ResamplerKey flagged_key = make_key(AV_CH_LAYOUT_STEREO, 44100);
+    flagged_key.flags = SWR_FLAG_RESAMPLE;
+    const ResamplerPtr flagged = resamplers.acquire(flagged_key);
+
+    ASSERT_NE(stereo, nullptr);
+    ASSERT_NE(mono, nullptr);
+    ASSERT_NE(other_rate, nullptr);
+    ASSERT_NE(flagged, nullptr);
+
+    EXPECT_NE(mono, stereo);
+    EXPECT_NE(other_rate, stereo);
+    EXPECT_NE(flagged, stereo);
+    EXPECT_EQ(resamplers.size(), 4u);
+}
+
+TEST(ResamplerCacheTest, EvictsTheLeastRecentlyUsedResampler)
+{
+    ResamplerCache resamplers(2);
+
+    const ResamplerKey first_key = make_key(AV_CH_LAYOUT_STEREO, 44100);
+    const ResamplerKey second_key = make_key(AV_CH_LAYOUT_STEREO, 32000);
+
+    const ResamplerPtr first = resamplers.acquire(first_key);
+    const ResamplerPtr second = resamplers.acquire(second_key);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    // The first resampler was used again, the second one is now the oldest.
+    EXPECT_EQ(resamplers.acquire(first_key), first);
+
+    ASSERT_NE(resamplers.acquire(make_key(AV_CH_LAYOUT_MONO, 44100)), nullptr);
+    EXPECT_EQ(resamplers.size(), 2u);
+
+    EXPECT_EQ(resamplers.acquire(first_key), first);
+    EXPECT_NE(resamplers.acquire(second_key), second);
+}
+
+TEST(ResamplerCacheTest, EvictedResamplerStaysValidWhileHeld)
+{
+    ResamplerCache resamplers(1);
+
+    const ResamplerPtr held = resamplers.acquire(make_key(AV_CH_LAYOUT_MONO, SAMPLE_RATE));
+    ASSERT_NE(held, nullptr);
+
+    ASSERT_NE(resamplers.acquire(make_key(AV_CH_LAYOUT_STEREO, SAMPLE_RATE)), nullptr);
+    resamplers.clear();
+    EXPECT_EQ(resamplers.size(), 0u);
+
+    // The owner still converts with it, e.g. the rest of a frame.
+    float input = 0.5f;
+    float output = 0.0f;
+
+    const std::uint8_t* in_data = reinterpret_cast<const std::uint8_t*>(&input);
+    auto* out_data = reinterpret_cast<std::uint8_t*>(&output);
+
+    EXPECT_EQ(swr_convert(held.get(), &out_data, 1, &in_data, 1), 1);
+    EXPECT_EQ(output, input);
+}
+
+TEST(ResamplerCacheTest, FailedResamplerIsNotCached)
+{
+    ResamplerCache resamplers;
+
+    ResamplerKey key = make_key(AV_CH_LAYOUT_STEREO, SAMPLE_RATE);
+    key.in_sample_rate = 0;
+
+    EXPECT_EQ(resamplers.acquire(key), nullptr);
+    EXPECT_EQ(resamplers.size(), 0u);
+}
@@ -0,0 +1,328 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/backend/seek_worker.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// Far longer than any request takes, only reached when the worker hangs.
+constexpr auto WAIT_TIMEOUT = std::chrono::seconds(5);
+
+// Any other request is also dropped by the transport command wait_idle() queues, so the
+// tests that end with steps wait this long for an extra one instead.
+constexpr auto SETTLE_TIME = std::chrono::milliseconds(50);
+
+/**
+ * @brief The requests a worker ran, in the order it ran them.
+ */
+class RequestLog
+{
+public:
+    void add(const std::string& entry)
+    {
+        std::lock_guard lock(m_mutex);
+        m_entries.push_back(entry);
+        m_added_cond.notify_all();
+    }
+
+    /**
+     * @brief Waits for a number of entries, then for any entry that shouldn't come.
+     */
+    [[nodiscard]] std::vector<std::string> wait_entries(std::size_t entries_nb)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_added_cond.wait_for(
+                lock, WAIT_TIMEOUT, [this, entries_nb] { return m_entries.size() >= entries_nb; });
+        }
+
+        std::this_thread::sleep_for(SETTLE_TIME);
+
+        return get_entries();
+    }
+
+    [[nodiscard]] std::vector<std::string> get_entries()
+    {
+        std::lock_guard lock(m_mutex);
+        return m_entries;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_added_cond;
+    std::vector<std::string> m_entries;
+};
+
+[[nodiscard]] std::string seek_entry(float seconds)
+{
+    return "seek " + std::to_string(static_cast<int>(seconds));
+}
+
+[[nodiscard]] std::string step_entry(FrameStep direction)
+{
+    return direction == FrameStep::NEXT ? "next" : "previous";
+}
+
+/**
+ * @brief Holds the worker in a transport command, the requests that follow queue up
+ *        behind it until the gate opens.
+ */
+class Gate
+{
+public:
+    explicit Gate(SeekWorker& worker)
+    {
+        std::shared_future<void> opened = m_opened.get_future().share();
+        worker.request_transport([opened] { opened.wait(); });
+    }
+
+    ~Gate() { open(); }
+
+    void open()
+    {
+        if (!m_is_open) {
+            m_opened.set_value();
+            m_is_open = true;
+        }
+    }
+
+private:
+    std::promise<void> m_opened;
+    bool m_is_open = false;
+};
+
+/**
+ * @brief Waits until the worker ran every request before this call. Like any transport
+ *        command, it drops the steps that are still waiting.
+ */
+[[nodiscard]] bool wait_idle(SeekWorker& worker)
+{
+    auto is_idle = std::make_shared<std::promise<void>>();
+    std::future<void> idle = is_idle->get_future();
+
+    worker.request_transport([is_idle] { is_idle->set_value(); });
+
+    return idle.wait_for(WAIT_TIMEOUT) == std::future_status::ready;
+}
+
+/**
+ * @brief A worker that only logs what it runs.
+ */
+class SeekWorkerTest : public testing::Test
+{
+protected:
+    RequestLog m_log;
+
+    SeekWorker m_worker{ [this](float seconds) { m_log.add(seek_entry(seconds)); },
+        [this](FrameStep direction) { m_log.add(step_entry(direction)); } };
+};
+} // namespace
+
+TEST_F(SeekWorkerTest, OnlyTheLatestWaitingSeekRuns)
+{
+    Gate gate(m_worker);
+
+    for (int i = 1; i <= 10; ++i) {
+        m_worker.request_seek(static_cast<float>(i));
+    }
+
+    gate.open();
+    ASSERT_TRUE(wait_idle(m_worker));
+
+    EXPECT_EQ(m_log.get_entries(), std::vector<std::string>{ seek_entry(10) });
+}
+
+TEST_F(SeekWorkerTest, StepsAreCountedAndTakenOneByOne)
+{
+    Gate gate(m_worker);
+
+    m_worker.request_step(FrameStep::NEXT);
+    m_worker.request_step(FrameStep::NEXT);
+    m_worker.request_step(FrameStep::NEXT);
+    m_worker.request_step(FrameStep::PREVIOUS);
+
+    gate.open();
+
+    const std::string next = step_entry(FrameStep::NEXT);
+    EXPECT_EQ(m_log.wait_entries(2), (std::vector<std::string>{ next, next }));
+}
+
+TEST_F(SeekWorkerTest, OppositeStepsCancelOut)
+{
+    Gate gate(m_worker);
+
+    m_worker.request_step(FrameStep::PREVIOUS);
+    m_worker.request_step(FrameStep::NEXT);
+
+    gate.open();
+
+    EXPECT_TRUE(m_log.wait_entries(0).empty());
+}
+
+TEST_F(SeekWorkerTest, StepsAfterASeekStartFromIt)
+{
+    Gate gate(m_worker);
+
+    m_worker.request_seek(3.0f);
+    m_worker.request_step(FrameStep::PREVIOUS);
+    m_worker.request_step(FrameStep::PREVIOUS);
+
+    gate.open();
+
+    const std::string previous = step_entry(FrameStep::PREVIOUS);
+    EXPECT_EQ(m_log.wait_entries(3),
+        (std::vector<std::string>{ seek_entry(3), previous, previous }));
+}
+
+TEST_F(SeekWorkerTest, SeekDropsTheWaitingSteps)
+{
+    Gate gate(m_worker);
+
+    m_worker.request_step(FrameStep::NEXT);
+    m_worker.request_step(FrameStep::NEXT);
+    m_worker.request_seek(5.0f);
+
+    gate.open();
+
+    EXPECT_EQ(m_log.wait_entries(1), std::vector<std::string>{ seek_entry(5) });
+}
+
+TEST_F(SeekWorkerTest, TransportDropsTheWaitingSteps)
+{
+    Gate gate(m_worker);
+
+    m_worker.request_seek(5.0f);
+    m_worker.request_step(FrameStep::PREVIOUS);
+    m_worker.request_transport([this] { m_log.add("pause"); });
+
+    gate.open();
+
+    EXPECT_EQ(m_log.wait_entries(2), (std::vector<std::string>{ seek_entry(5), "pause" }));
+}
+
+TEST(SeekWorkerStaleTest, NewerSeekMakesTheRunningOneStale)
+{
+    std::promise<void> started;
+    std::atomic<bool> was_stale_at_start = true;
+    std::atomic<bool> became_stale = false;
+    std::atomic<int> seeks_nb = 0;
+
+    SeekWorker* worker_ptr = nullptr;
+
+    SeekWorker worker(
+        [&](float) {
+            if (seeks_nb++ > 0) {
+                return;
+            }
+
+            was_stale_at_start = worker_ptr->is_stale();
+            started.set_value();
+
+            // Like a decode loop, gives up once a newer target arrives.
+            const auto deadline = std::chrono::steady_clock::now() + WAIT_TIMEOUT;
+
+            while (!worker_ptr->is_stale() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+
+            became_stale = worker_ptr->is_stale();
+        },
+        [](FrameStep) {});
+
+    worker_ptr = &worker;
+
+    // Outside of the worker thread, a seek never gives up.
+    EXPECT_FALSE(worker.is_stale());
+
+    worker.request_seek(1.0f);
+    ASSERT_EQ(started.get_future().wait_for(WAIT_TIMEOUT), std::future_status::ready);
+
+    EXPECT_FALSE(worker.is_stale());
+    worker.request_seek(2.0f);
+
+    ASSERT_TRUE(wait_idle(worker));
+
+    EXPECT_FALSE(was_stale_at_start);
+    EXPECT_TRUE(became_stale);
+    EXPECT_EQ(seeks_nb, 2);
+}
+
+TEST(SeekWorkerStaleTest, StepsDontMakeTheRunningSeekStale)
+{
+    std::promise<void> started;
+    std::promise<void> stepped;
+    std::atomic<bool> was_stale = true;
+
+    SeekWorker* worker_ptr = nullptr;
+
+    SeekWorker worker(
+        [&](float) {
+            started.set_value();
+            stepped.get_future().wait_for(WAIT_TIMEOUT);
+            was_stale = worker_ptr->is_stale();
+        },
+        [](FrameStep) {});
+
+    worker_ptr = &worker;
+
+    worker.request_seek(1.0f);
+    ASSERT_EQ(started.get_future().wait_for(WAIT_TIMEOUT), std::future_status::ready);
+
+    worker.request_step(FrameStep::NEXT);
+    stepped.set_value();
+
+    ASSERT_TRUE(wait_idle(worker));
+    EXPECT_FALSE(was_stale);
+}
+
+TEST(SeekWorkerStaleTest, StopDropsTheWaitingRequests)
+{
+    std::promise<void> started;
+    std::atomic<bool> became_stale = false;
+    RequestLog log;
+
+    SeekWorker* worker_ptr = nullptr;
+
+    SeekWorker worker(
+        [&](float) {
+            started.set_value();
+
+            const auto deadline = std::chrono::steady_clock::now() + WAIT_TIMEOUT;
+
+            while (!worker_ptr->is_stale() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+
+            became_stale = worker_ptr->is_stale();
+        },
+        [&log](FrameStep direction) { log.add(step_entry(direction)); });
+
+    worker_ptr = &worker;
+
+    worker.request_seek(1.0f);
+    ASSERT_EQ(started.get_future().wait_for(WAIT_TIMEOUT), std::future_status::ready);
+
+    worker.request_step(FrameStep::NEXT);
+    worker.request_step(FrameStep::NEXT);
+
+    // Interrupts the running seek and waits for it.
+    worker.stop();
+
+    EXPECT_TRUE(became_stale);
+    EXPECT_TRUE(log.get_entries().empty());
+
+    // The thread starts again on the next request, without the steps dropped before.
+    worker.request_step(FrameStep::PREVIOUS);
+    EXPECT_EQ(log.wait_entries(1), std::vector<std::string>{ step_entry(FrameStep::PREVIOUS) });
+}
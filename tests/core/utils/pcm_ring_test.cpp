@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "core/utils/pcm_ring.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr std::size_t STEREO = 2;
+constexpr std::size_t SURROUND_51 = 6;
+
+// Not a multiple of 6, so the 5.1 frames wrap around the end at every offset.
+constexpr std::size_t STRESS_CAPACITY = 1000;
+constexpr std::uint64_t STRESS_FRAMES_NB = 200000;
+
+/**
+ * @brief Encodes a frame and a channel in a sample, exact in a float up to 2^24.
+ */
+[[nodiscard]] float make_sample(std::uint64_t frame, std::size_t channel)
+{
+    return static_cast<float>((frame % (1 << 20)) * 8 + channel);
+}
+
+[[nodiscard]] std::vector<float> make_frames(
+    std::uint64_t first_frame, std::size_t frames_nb, std::size_t channels_nb)
+{
+    std::vector<float> samples;
+    samples.reserve(frames_nb * channels_nb);
+
+    for (std::uint64_t frame = first_frame; frame < first_frame + frames_nb; ++frame) {
+        for (std::size_t channel = 0; channel < channels_nb; ++channel) {
+            samples.push_back(make_sample(frame, channel));
+        }
+    }
+
+    return samples;
+}
+
+[[nodiscard]] std::size_t channel_of(float sample)
+{
+    return static_cast<std::size_t>(sample) % 8;
+}
+
+[[nodiscard]] std::uint64_t frame_of(float sample)
+{
+    return static_cast<std::uint64_t>(sample) / 8;
+}
+} // namespace
+
+TEST(PCMRingTest, MovesOnlyWholeFrames)
+{
+    // Room for 5.5 stereo frames.
+    PCMRing ring(11);
+
+    const std::vector<float> samples = make_frames(0, 6, STEREO);
+
+    EXPECT_EQ(ring.write(samples.data(), 7, STEREO), 6u);
+    EXPECT_EQ(ring.write(samples.data() + 6, 6, STEREO), 4u);
+    EXPECT_EQ(ring.size(), 10u);
+
+    std::vector<float> dest(12, -1.0f);
+
+    EXPECT_EQ(ring.read(dest.data(), 5, STEREO), 4u);
+    EXPECT_EQ(ring.read(dest.data() + 4, 12, STEREO), 6u);
+    EXPECT_EQ(ring.size(), 0u);
+
+    for (std::size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(dest[i], samples[i]) << "Sample " << i;
+    }
+}
+
+TEST(PCMRingTest, WrapsAroundTheEndInWholeFrames)
+{
+    // 7 samples, every frame boundary lands somewhere else in the storage.
+    PCMRing ring(7);
+
+    std::uint64_t next_written = 0;
+    std::uint64_t next_read = 0;
+
+    for (int i = 0; i < 50; ++i) {
+        const std::vector<float> samples = make_frames(next_written, 3, STEREO);
+        next_written += ring.write(samples.data(), samples.size(), STEREO) / STEREO;
+
+        std::vector<float> dest(6);
+        const std::size_t read_nb = ring.read(dest.data(), dest.size(), STEREO);
+
+        ASSERT_EQ(read_nb % STEREO, 0u);
+
+        for (std::size_t j = 0; j < read_nb; ++j) {
+            EXPECT_EQ(channel_of(dest[j]), j % STEREO) << "Round " << i;
+            EXPECT_EQ(frame_of(dest[j]), next_read + j / STEREO) << "Round " << i;
+        }
+
+        next_read += read_nb / STEREO;
+    }
+
+    EXPECT_EQ(next_read, next_written);
+    EXPECT_GT(ring.get_write_index(), 10 * ring.capacity());
+}
+
+TEST(PCMRingTest, FlushSkipsTheStaleSamples)
+{
+    PCMRing ring(16);
+
+    const std::vector<float> stale = make_frames(0, 3, STEREO);
+    const std::vector<float> fresh = make_frames(100, 2, STEREO);
+
+    ring.write(stale.data(), stale.size(), STEREO);
+    ring.flush();
+    ring.write(fresh.data(), fresh.size(), STEREO);
+
+    std::vector<float> dest(16);
+    ASSERT_EQ(ring.read(dest.data(), dest.size(), STEREO), fresh.size());
+
+    for (std::size_t i = 0; i < fresh.size(); ++i) {
+        EXPECT_EQ(dest[i], fresh[i]) << "Sample " << i;
+    }
+
+    // The consumer is past every sample, a flush now has nothing to skip.
+    EXPECT_EQ(ring.get_read_index(), ring.get_write_index());
+    ring.flush();
+    EXPECT_EQ(ring.read(dest.data(), dest.size(), STEREO), 0u);
+}
+
+TEST(PCMRingTest, FlushOfAnEmptyRingKeepsTheNextSamples)
+{
+    PCMRing ring(16);
+
+    ring.flush();
+
+    const std::vector<float> samples = make_frames(0, 2, STEREO);
+    ring.write(samples.data(), samples.size(), STEREO);
+
+    std::vector<float> dest(16);
+    EXPECT_EQ(ring.read(dest.data(), dest.size(), STEREO), samples.size());
+}
+
+TEST(PCMRingTest, ConcurrentTransferKeepsTheChannelsInOrder)
+{
+    PCMRing ring(STRESS_CAPACITY);
+
+    std::atomic<bool> is_done = false;
+
+    std::thread producer([&ring, &is_done] {
+        std::uint64_t next_frame = 0;
+
+        while (next_frame < STRESS_FRAMES_NB) {
+            // Runs of different lengths, so the writes end at every offset of the storage.
+            const std::size_t frames_nb = 1 + next_frame % 37;
+            const std::vector<float> samples = make_frames(next_frame, frames_nb, SURROUND_51);
+
+            const std::size_t written_nb =
+                ring.write(samples.data(), samples.size(), SURROUND_51);
+
+            next_frame += written_nb / SURROUND_51;
+
+            if (written_nb == 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        is_done = true;
+    });
+
+    // Seeks drop whatever is buffered from another thread, like the player does.
+    std::thread seeker([&ring, &is_done] {
+        while (!is_done) {
+            ring.flush();
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    });
+
+    std::vector<float> dest(97);
+    std::uint64_t last_frame = 0;
+    std::uint64_t misaligned_nb = 0;
+    std::uint64_t backward_nb = 0;
+    bool has_frame = false;
+
+    // Only count, a failed assertion per sample would flood the output.
+    while (true) {
+        const bool was_done = is_done;
+        const std::size_t read_nb = ring.read(dest.data(), dest.size(), SURROUND_51);
+
+        // Everything was written before the flag, so an empty read after it is the end.
+        if (read_nb == 0 && was_done) {
+            break;
+        }
+
+        misaligned_nb += read_nb % SURROUND_51 != 0 ? 1 : 0;
+
+        for (std::size_t i = 0; i < read_nb; ++i) {
+            misaligned_nb += channel_of(dest[i]) != i % SURROUND_51 ? 1 : 0;
+        }
+
+        // A flush may skip frames, but never replays them.
+        for (std::size_t i = 0; i < read_nb; i += SURROUND_51) {
+            const std::uint64_t frame = frame_of(dest[i]);
+            backward_nb += has_frame && frame <= last_frame ? 1 : 0;
+
+            last_frame = frame;
+            has_frame = true;
+        }
+
+        if (read_nb == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    seeker.join();
+
+    EXPECT_EQ(misaligned_nb, 0u);
+    EXPECT_EQ(backward_nb, 0u);
+    EXPECT_TRUE(has_frame);
+}
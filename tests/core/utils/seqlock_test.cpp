@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "core/utils/seqlock.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr std::uint64_t STRESS_UPDATES_NB = 200000;
+constexpr int READERS_NB = 2;
+
+/**
+ * @brief Spans several words, every field is derived from the sequence so a torn copy is
+ *        caught.
+ */
+struct TestSnapshot {
+    std::uint64_t sequence;
+    std::array<double, 5> values;
+    bool is_odd;
+};
+
+[[nodiscard]] TestSnapshot make_snapshot(std::uint64_t sequence)
+{
+    TestSnapshot snapshot{};
+    snapshot.sequence = sequence;
+    snapshot.is_odd = sequence % 2 == 1;
+
+    for (std::size_t i = 0; i < snapshot.values.size(); ++i) {
+        snapshot.values[i] = static_cast<double>(sequence) * static_cast<double>(i + 1);
+    }
+
+    return snapshot;
+}
+
+[[nodiscard]] bool is_consistent(const TestSnapshot& snapshot)
+{
+    const TestSnapshot expected = make_snapshot(snapshot.sequence);
+    return snapshot.values == expected.values && snapshot.is_odd == expected.is_odd;
+}
+} // namespace
+
+TEST(SeqLockTest, LoadsTheLastStoredValue)
+{
+    SeqLock<TestSnapshot> lock(make_snapshot(3));
+
+    EXPECT_EQ(lock.load().sequence, 3u);
+
+    lock.store(make_snapshot(7));
+    EXPECT_EQ(lock.load().sequence, 7u);
+
+    lock.update([](TestSnapshot& snapshot) { snapshot = make_snapshot(snapshot.sequence + 1); });
+    EXPECT_EQ(lock.load().sequence, 8u);
+    EXPECT_TRUE(is_consistent(lock.load()));
+}
+
+TEST(SeqLockTest, ConcurrentReadersSeeNoTornOrOlderSnapshot)
+{
+    SeqLock<TestSnapshot> lock(make_snapshot(0));
+    std::atomic<bool> is_stopped = false;
+
+    std::vector<std::thread> readers;
+    std::array<std::uint64_t, READERS_NB> torn_nb{};
+    std::array<std::uint64_t, READERS_NB> older_nb{};
+
+    for (int reader = 0; reader < READERS_NB; ++reader) {
+        readers.emplace_back([&, reader] {
+            std::uint64_t last_sequence = 0;
+
+            // Only count, a failed assertion per read would flood the output.
+            while (!is_stopped) {
+                const TestSnapshot snapshot = lock.load();
+
+                torn_nb[reader] += is_consistent(snapshot) ? 0 : 1;
+                older_nb[reader] += snapshot.sequence < last_sequence ? 1 : 0;
+                last_sequence = snapshot.sequence;
+            }
+        });
+    }
+
+    for (std::uint64_t sequence = 1; sequence <= STRESS_UPDATES_NB; ++sequence) {
+        lock.store(make_snapshot(sequence));
+    }
+
+    is_stopped = true;
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    for (int reader = 0; reader < READERS_NB; ++reader) {
+        EXPECT_EQ(torn_nb[reader], 0u) << "Reader " << reader;
+        EXPECT_EQ(older_nb[reader], 0u) << "Reader " << reader;
+    }
+}
+
+TEST(SeqLockTest, ConcurrentUpdatesAreNotLost)
+{
+    SeqLock<TestSnapshot> lock(make_snapshot(0));
+
+    const auto increment = [&lock] {
+        for (std::uint64_t i = 0; i < STRESS_UPDATES_NB; ++i) {
+            lock.update(
+                [](TestSnapshot& snapshot) { snapshot = make_snapshot(snapshot.sequence + 1); });
+        }
+    };
+
+    std::thread first_writer(increment);
+    std::thread second_writer(increment);
+
+    first_writer.join();
+    second_writer.join();
+
+    const TestSnapshot snapshot = lock.load();
+
+    EXPECT_EQ(snapshot.sequence, 2 * STRESS_UPDATES_NB);
+    EXPECT_TRUE(is_consistent(snapshot));
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "core/utils/spsc_ring.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// Small enough that both sides keep running into a full and an empty ring.
+constexpr std::size_t STRESS_CAPACITY = 8;
+constexpr std::uint64_t STRESS_ITEMS_NB = 200000;
+
+// Long enough that a missed wakeup fails the test instead of passing after the timeout.
+constexpr int LONG_WAIT_MS = 5000;
+constexpr auto WAKEUP_DEADLINE = std::chrono::milliseconds(1000);
+
+using Clock = std::chrono::steady_clock;
+} // namespace
+
+TEST(SPSCRingTest, KeepsOrderAndCapacity)
+{
+    SPSCRing<int> ring(4);
+
+    for (int i = 0; i < 4; ++i) {
+        int* slot = ring.back();
+        ASSERT_NE(slot, nullptr);
+
+        *slot = i;
+        ring.commit();
+    }
+
+    EXPECT_TRUE(ring.full());
+    EXPECT_EQ(ring.back(), nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        const int* slot = ring.front();
+        ASSERT_NE(slot, nullptr);
+
+        EXPECT_EQ(*slot, i);
+        ring.pop();
+    }
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.front(), nullptr);
+}
+
+TEST(SPSCRingTest, FlushMarksOnlyPublishedSlotsStale)
+{
+    SPSCRing<int> ring(8);
+
+    const auto push = [&ring](int value) {
+        *ring.back() = value;
+        ring.commit();
+    };
+
+    push(0);
+    push(1);
+    push(2);
+
+    ring.flush();
+
+    push(3);
+    push(4);
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(ring.is_front_stale());
+        ring.pop();
+    }
+
+    for (int i = 3; i < 5; ++i) {
+        EXPECT_FALSE(ring.is_front_stale());
+        EXPECT_EQ(*ring.front(), i);
+        ring.pop();
+    }
+
+    EXPECT_FALSE(ring.is_front_stale());
+}
+
+TEST(SPSCRingTest, WaitForDataTimesOutOnEmptyRing)
+{
+    SPSCRing<int> ring(4);
+
+    EXPECT_FALSE(ring.wait_for_data(10));
+}
+
+TEST(SPSCRingTest, WaitForDataWakesUpOnCommit)
+{
+    SPSCRing<int> ring(4);
+
+    std::atomic<bool> is_woken = false;
+    Clock::duration waited{};
+
+    std::thread consumer([&] {
+        const auto start = Clock::now();
+        is_woken = ring.wait_for_data(LONG_WAIT_MS);
+        waited = Clock::now() - start;
+    });
+
+    // Give the consumer time to go to sleep, the commit has to wake it up.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    *ring.back() = 1;
+    ring.commit();
+
+    consumer.join();
+
+    EXPECT_TRUE(is_woken);
+    EXPECT_LT(waited, WAKEUP_DEADLINE);
+}
+
+TEST(SPSCRingTest, WaitForSpaceWakesUpOnPop)
+{
+    SPSCRing<int> ring(1);
+
+    *ring.back() = 1;
+    ring.commit();
+
+    std::atomic<bool> is_woken = false;
+    Clock::duration waited{};
+
+    std::thread producer([&] {
+        const auto start = Clock::now();
+        is_woken = ring.wait_for_space(LONG_WAIT_MS);
+        waited = Clock::now() - start;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ring.pop();
+
+    producer.join();
+
+    EXPECT_TRUE(is_woken);
+    EXPECT_LT(waited, WAKEUP_DEADLINE);
+}
+
+TEST(SPSCRingTest, ConcurrentTransferLosesAndDuplicatesNothing)
+{
+    SPSCRing<std::uint64_t> ring(STRESS_CAPACITY);
+    std::atomic<bool> is_stopped = false;
+
+    std::thread producer([&ring, &is_stopped] {
+        for (std::uint64_t i = 0; i < STRESS_ITEMS_NB; ++i) {
+            std::uint64_t* slot = nullptr;
+
+            while (!(slot = ring.back())) {
+                if (is_stopped) {
+                    return;
+                }
+
+                ring.wait_for_space(LONG_WAIT_MS);
+            }
+
+            *slot = i;
+            ring.commit();
+        }
+    });
+
+    std::uint64_t expected = 0;
+    std::uint64_t mismatches_nb = 0;
+
+    while (expected < STRESS_ITEMS_NB) {
+        const std::uint64_t* slot = ring.front();
+
+        if (!slot) {
+            if (!ring.wait_for_data(LONG_WAIT_MS)) {
+                ADD_FAILURE() << "No item after " << expected;
+                break;
+            }
+
+            continue;
+        }
+
+        // Only count, a failed assertion per item would flood the output.
+        mismatches_nb += *slot != expected ? 1 : 0;
+        expected = *slot + 1;
+
+        ring.pop();
+    }
+
+    is_stopped = true;
+    ring.wake_all();
+    producer.join();
+
+    EXPECT_EQ(mismatches_nb, 0u);
+    EXPECT_TRUE(ring.empty());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "core/utils/triple_buffer.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+constexpr std::uint64_t STRESS_FRAMES_NB = 500000;
+
+/**
+ * @brief A frame the writer fills word by word, a torn read shows up as mixed sequences.
+ */
+struct TestFrame {
+    std::uint64_t sequence = 0;
+    std::array<std::uint64_t, 32> words{};
+};
+
+void fill_frame(TestFrame& frame, std::uint64_t sequence)
+{
+    frame.sequence = sequence;
+    frame.words.fill(sequence);
+}
+} // namespace
+
+TEST(TripleBufferTest, ReaderTakesTheLatestPublishedSlot)
+{
+    TripleBuffer<int> buffer;
+
+    EXPECT_FALSE(buffer.update());
+
+    buffer.back() = 1;
+    EXPECT_FALSE(buffer.publish());
+
+    buffer.back() = 2;
+    EXPECT_TRUE(buffer.publish());
+
+    ASSERT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.front(), 2);
+
+    // Nothing new was published, the front stays.
+    EXPECT_FALSE(buffer.update());
+    EXPECT_EQ(buffer.front(), 2);
+
+    EXPECT_EQ(buffer.get_published_nb(), 2u);
+    EXPECT_EQ(buffer.get_consumed_nb(), 1u);
+    EXPECT_EQ(buffer.get_overwritten_nb(), 1u);
+}
+
+TEST(TripleBufferTest, SidesNeverShareASlot)
+{
+    TripleBuffer<int> buffer;
+
+    for (int i = 0; i < 16; ++i) {
+        buffer.back() = i;
+        EXPECT_NE(&buffer.back(), &buffer.front());
+
+        buffer.publish();
+        EXPECT_NE(&buffer.back(), &buffer.front());
+
+        if (i % 3 == 0) {
+            buffer.update();
+            EXPECT_EQ(buffer.front(), i);
+        }
+    }
+}
+
+TEST(TripleBufferTest, ConcurrentReaderSeesNoTornOrOlderFrame)
+{
+    TripleBuffer<TestFrame> buffer;
+
+    std::thread writer([&buffer] {
+        for (std::uint64_t sequence = 1; sequence <= STRESS_FRAMES_NB; ++sequence) {
+            fill_frame(buffer.back(), sequence);
+            buffer.publish();
+        }
+    });
+
+    std::uint64_t last_sequence = 0;
+    std::uint64_t torn_nb = 0;
+    std::uint64_t older_nb = 0;
+
+    while (last_sequence < STRESS_FRAMES_NB) {
+        if (!buffer.update()) {
+            continue;
+        }
+
+        const TestFrame& frame = buffer.front();
+
+        // Only count, a failed assertion per frame would flood the output.
+        for (const std::uint64_t word : frame.words) {
+            torn_nb += word != frame.sequence ? 1 : 0;
+        }
+
+        older_nb += frame.sequence <= last_sequence ? 1 : 0;
+        last_sequence = frame.sequence;
+    }
+
+    writer.join();
+
+    EXPECT_EQ(torn_nb, 0u);
+    EXPECT_EQ(older_nb, 0u);
+    EXPECT_EQ(buffer.get_published_nb(), STRESS_FRAMES_NB);
+    EXPECT_EQ(buffer.get_consumed_nb() + buffer.get_overwritten_nb(), STRESS_FRAMES_NB);
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <SDL.h>
+
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/yuv_renderer.hpp"
+
+using namespace YAVE;
+
+namespace
+{
+// Sizes around the blocks of the CPU kernels, so their tails are compared too.
+constexpr std::array<std::pair<int, int>, 5> TEST_SIZES = { { { 2, 2 }, { 18, 10 }, { 34, 8 },
+    { 66, 12 }, { 126, 30 } } };
+
+struct TestFormat {
+    AVPixelFormat pix_fmt = AV_PIX_FMT_NONE;
+    AVColorSpace colorspace = AVCOL_SPC_UNSPECIFIED;
+    AVColorRange color_range = AVCOL_RANGE_UNSPECIFIED;
+    const char* name = "";
+};
+
+const std::array<TestFormat, 6> TEST_FORMATS = { {
+    { AV_PIX_FMT_YUV420P, AVCOL_SPC_UNSPECIFIED, AVCOL_RANGE_MPEG, "YUV420P_BT601" },
+    { AV_PIX_FMT_YUV420P, AVCOL_SPC_BT709, AVCOL_RANGE_MPEG, "YUV420P_BT709" },
+    { AV_PIX_FMT_YUVJ420P, AVCOL_SPC_BT470BG, AVCOL_RANGE_JPEG, "YUVJ420P_BT601" },
+    { AV_PIX_FMT_NV12, AVCOL_SPC_BT709, AVCOL_RANGE_MPEG, "NV12_BT709" },
+    { AV_PIX_FMT_YUV422P, AVCOL_SPC_SMPTE170M, AVCOL_RANGE_MPEG, "YUV422P_BT601" },
+    { AV_PIX_FMT_YUVJ422P, AVCOL_SPC_BT709, AVCOL_RANGE_JPEG, "YUVJ422P_BT709" },
+} };
+
+struct FrameDeleter {
+    void operator()(AVFrame* av_frame) const { av_frame_free(&av_frame); }
+};
+
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+/**
+ * @brief A frame of random samples, neighbouring chroma samples differ so a filtered
+ *        chroma lookup shows up.
+ */
+[[nodiscard]] FramePtr make_frame(const TestFormat& format, int width, int height)
+{
+    FramePtr av_frame(av_frame_alloc());
+
+    av_frame->format = format.pix_fmt;
+    av_frame->width = width;
+    av_frame->height = height;
+    av_frame->colorspace = format.colorspace;
+    av_frame->color_range = format.color_range;
+
+    if (av_frame_get_buffer(av_frame.get(), 0) < 0) {
+        return nullptr;
+    }
+
+    std::mt19937 generator(static_cast<unsigned int>(width * 1000 + height));
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    const bool is_422 =
+        format.pix_fmt == AV_PIX_FMT_YUV422P || format.pix_fmt == AV_PIX_FMT_YUVJ422P;
+    const bool is_semi_planar = format.pix_fmt == AV_PIX_FMT_NV12;
+
+    for (int plane = 0; plane < (is_semi_planar ? 2 : 3); ++plane) {
+        const int rows_nb = plane == 0 || is_422 ? height : height / 2;
+        const int row_size = plane == 0 || is_semi_planar ? width : width / 2;
+
+        for (int row = 0; row < rows_nb; ++row) {
+            std::uint8_t* samples = av_frame->data[plane] + row * av_frame->linesize[plane];
+
+            for (int i = 0; i < row_size; ++i) {
+                samples[i] = static_cast<std::uint8_t>(distribution(generator));
+            }
+        }
+    }
+
+    return av_frame;
+}
+
+/**
+ * @brief A hidden window with an OpenGL 3.3 core context. Without a display, SDL's offscreen
+ *        driver gets an EGL context instead, e.g. from Mesa llvmpipe.
+ */
+class GLContext
+{
+public:
+    GLContext()
+    {
+        if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+
+            if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+                m_error = SDL_GetError();
+                return;
+            }
+        }
+
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+
+        m_window = SDL_CreateWindow("yuv_renderer_test", SDL_WINDOWPOS_UNDEFINED,
+            SDL_WINDOWPOS_UNDEFINED, 16, 16, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+
+        if (m_window) {
+            m_gl_context = SDL_GL_CreateContext(m_window);
+        }
+
+        if (!m_gl_context) {
+            m_error = SDL_GetError();
+            return;
+        }
+
+        glewExperimental = GL_TRUE;
+
+        // GLEW also looks for a GLX display, which an EGL context doesn't have.
+        const GLenum glew_status = glewInit();
+
+        if (glew_status != GLEW_OK && !glCreateShader) {
+            m_error = reinterpret_cast<const char*>(glewGetErrorString(glew_status));
+            return;
+        }
+
+        if (m_renderer.init() < 0) {
+            m_error = "The shaders failed to build";
+            return;
+        }
+
+        glGenTextures(1, &m_texture);
+    }
+
+    ~GLContext()
+    {
+        if (m_texture != 0) {
+            glDeleteTextures(1, &m_texture);
+        }
+
+        if (m_gl_context) {
+            SDL_GL_DeleteContext(m_gl_context);
+        }
+
+        if (m_window) {
+            SDL_DestroyWindow(m_window);
+        }
+
+        SDL_Quit();
+    }
+
+    GLContext(const GLContext&) = delete;
+    GLContext& operator=(const GLContext&) = delete;
+
+    [[nodiscard]] bool is_ready() const { return m_texture != 0; }
+    [[nodiscard]] const std::string& get_error() const { return m_error; }
+
+    /**
+     * @brief Renders a frame through the shader and reads the RGBA picture back.
+     */
+    [[nodiscard]] std::vector<std::uint8_t> render(const AVFrame* av_frame)
+    {
+        std::vector<std::uint8_t> pixels(static_cast<std::size_t>(av_frame->width) * 4 *
+            av_frame->height);
+
+        if (m_renderer.render(av_frame, m_texture) < 0) {
+            ADD_FAILURE() << "The frame wasn't rendered";
+            return pixels;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        return pixels;
+    }
+
+private:
+    SDL_Window* m_window = nullptr;
+    SDL_GLContext m_gl_context = nullptr;
+
+    YUVRenderer m_renderer;
+    GLuint m_texture = 0;
+
+    std::string m_error;
+};
+
+class YUVRendererTest : public testing::TestWithParam<TestFormat>
+{
+protected:
+    static void SetUpTestSuite() { s_Context = std::make_unique<GLContext>(); }
+    static void TearDownTestSuite() { s_Context.reset(); }
+
+    void SetUp() override
+    {
+        if (!s_Context->is_ready()) {
+            GTEST_SKIP() << "No OpenGL 3.3 context: " << s_Context->get_error();
+        }
+    }
+
+    static std::unique_ptr<GLContext> s_Context;
+};
+
+std::unique_ptr<GLContext> YUVRendererTest::s_Context;
+} // namespace
+
+TEST_P(YUVRendererTest, ShaderMatchesKernels)
+{
+    for (const auto& [width, height] : TEST_SIZES) {
+        SCOPED_TRACE(std::to_string(width) + "x" + std::to_string(height));
+
+        const FramePtr av_frame = make_frame(GetParam(), width, height);
+        ASSERT_NE(av_frame, nullptr);
+
+        std::vector<std::uint8_t> expected(static_cast<std::size_t>(width) * 4 * height);
+        ASSERT_GE(ColorConverter::convert(av_frame.get(), expected.data(), width * 4), 0);
+
+        const std::vector<std::uint8_t> pixels = s_Context->render(av_frame.get());
+
+        int mismatches_nb = 0;
+
+        for (std::size_t i = 0; i < pixels.size() && mismatches_nb < 8; ++i) {
+            if (pixels[i] != expected[i]) {
+                ADD_FAILURE() << "Pixel (" << i / 4 % width << ", " << i / 4 / width
+                              << ") channel " << i % 4 << ": " << static_cast<int>(pixels[i])
+                              << " instead of " << static_cast<int>(expected[i]);
+                mismatches_nb++;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, YUVRendererTest, testing::ValuesIn(TEST_FORMATS),
+    [](const testing::TestParamInfo<TestFormat>& info) { return info.param.name; });